@@ -30,6 +30,9 @@
 #include "beam.h"
 #include "meshes/one_d_lagrangian_mesh.h"
 
+// Local includes
+#include "beam_preconditioners.h"
+
 using namespace std;
 
 using namespace oomph;
@@ -48,13 +51,36 @@ namespace Global_Physical_Variables
  /// Pressure load
  double P_ext;
 
- /// Load function: Apply a constant external pressure to the beam
+ /// Centre of patch (in terms of the Lagrangian coordinate) on which
+ /// the additional pressure Patch_pressure acts
+ double Patch_centre=0.0;
+
+ /// Half-width of the pressure patch (no patch load if zero)
+ double Patch_half_width=0.0;
+
+ /// Additional pressure acting on the patch
+ double Patch_pressure=0.0;
+
+ /// Load function: Apply a constant external pressure to the beam, plus
+ /// the patch pressure (if any)
  void load(const Vector<double>& xi, const Vector<double> &x,
            const Vector<double>& N, Vector<double>& load)
  {
-  for(unsigned i=0;i<2;i++) {load[i] = -P_ext*N[i];}
+  double p=P_ext;
+  if (fabs(xi[0]-Patch_centre)<Patch_half_width) p+=Patch_pressure;
+  for(unsigned i=0;i<2;i++) {load[i] = -p*N[i];}
  }
 
+ /// Number of (equally spaced) pressure patch load cases for the 
+ /// linearised load case study (0: no study)
+ unsigned N_load_case=0;
+
+ /// Patch pressure in each load case
+ double Load_case_pressure=1.0e-4;
+
+ /// Pressure increment for the (additional) uniform pressure load case
+ double Load_case_pressure_increment=1.0e-4;
+
 } // end of namespace
 
 //======start_of_problem_class==========================================
@@ -70,6 +96,9 @@ public:
  
  /// Conduct a parameter study
  void parameter_study();
+
+ /// Linearised responses to many load cases about the current state
+ void linearised_load_case_study();
  
  /// Return pointer to the mesh
  OneDLagrangianMesh<HermiteBeamElement>* mesh_pt() 
@@ -93,6 +122,8 @@ private:
  /// Pointer to geometric object that represents the beam's undeformed shape
  GeomObject* Undef_beam_pt;
 
+ /// Pointer to multigrid preconditioner (null if not used)
+ HermiteBeamMultigridPreconditioner* Multigrid_preconditioner_pt;
  
 }; // end of problem class
 
@@ -101,7 +132,8 @@ private:
 /// Constructor for elastic beam problem
 //======================================================================
 ElasticBeamProblem::ElasticBeamProblem(const unsigned &n_elem,
-                                       const double &length) : Length(length)
+                                       const double &length) : Length(length),
+                                       Multigrid_preconditioner_pt(0)
 {
  // Set the undeformed beam to be a straight line at y=0
  Undef_beam_pt=new StraightLine(0.0); 
@@ -165,6 +197,19 @@ ElasticBeamProblem::ElasticBeamProblem(const unsigned &n_elem,
  // Assign the global and local equation numbers
  cout << "# of dofs " << assign_eqn_numbers() << std::endl;
 
+ // Use GMRES, preconditioned by geometric multigrid?
+ if (CommandLineArgs::command_line_flag_has_been_set("--multigrid"))
+  {
+   Multigrid_preconditioner_pt=new HermiteBeamMultigridPreconditioner;
+   Multigrid_preconditioner_pt->
+    set_beam_meshes(Vector<SolidMesh*>(1,mesh_pt()));
+   Multigrid_preconditioner_pt->enable_doc_hierarchy();
+
+   GMRES<CRDoubleMatrix>* solver_pt=new GMRES<CRDoubleMatrix>;
+   solver_pt->preconditioner_pt()=Multigrid_preconditioner_pt;
+   linear_solver_pt()=solver_pt;
+  }
+
 } // end of constructor
 
 
@@ -364,6 +409,13 @@ void ElasticBeamProblem::parameter_study()
  
   // Re-assign the global and local equation numbers
   cout << "New # of dofs " << assign_eqn_numbers() << std::endl;
+
+  // Multigrid hierarchy is rebuilt from the new (finer) mesh
+  if (Multigrid_preconditioner_pt!=0)
+   {
+    Multigrid_preconditioner_pt->
+     set_beam_meshes(Vector<SolidMesh*>(1,mesh_pt()));
+   }
  
  
   // Continue parameter study: Go backwards...
@@ -423,11 +475,105 @@ void ElasticBeamProblem::parameter_study()
  
 } // end of parameter study
 
+//=======start_of_linearised_load_case_study===============================
+/// Linearised responses (changes in the nodal displacements) about the
+/// current state to N_load_case pressure patches, each covering one of
+/// N_load_case equal segments of the beam, plus a uniform pressure 
+/// increment. The Jacobian is factorised once and all load cases are
+/// solved for together.
+//=========================================================================
+void ElasticBeamProblem::linearised_load_case_study()
+{
+ unsigned n_case=Global_Physical_Variables::N_load_case;
+
+ // Assemble and factorise Jacobian in the reference state
+ LinearisedLoadCaseBatch batch(this);
+ batch.factorise();
+
+ // Patch load cases
+ Vector<double> xi_case(n_case);
+ Global_Physical_Variables::Patch_half_width=0.5*Length/double(n_case);
+ Global_Physical_Variables::Patch_pressure=
+  Global_Physical_Variables::Load_case_pressure;
+ for (unsigned c=0;c<n_case;c++)
+  {
+   xi_case[c]=(double(c)+0.5)*Length/double(n_case);
+   Global_Physical_Variables::Patch_centre=xi_case[c];
+   batch.add_load_case();
+  }
+ Global_Physical_Variables::Patch_half_width=0.0;
+ Global_Physical_Variables::Patch_pressure=0.0;
+
+ // Uniform pressure load case
+ Global_Physical_Variables::P_ext+=
+  Global_Physical_Variables::Load_case_pressure_increment;
+ batch.add_load_case();
+ Global_Physical_Variables::P_ext-=
+  Global_Physical_Variables::Load_case_pressure_increment;
+
+ // Solve for all of them
+ batch.solve();
+
+ oomph_info << "Linearised responses to " << batch.nload_case() 
+            << " load cases: assembly/factorisation: " 
+            << batch.factorisation_time() << " sec; blocked solve: "
+            << batch.solve_time() << " sec" << std::endl;
+
+ // Document the change in the transverse displacement at the nodes:
+ // one row per load case (influence matrix)
+ ofstream file("RESLT/influence_matrix.dat");
+ unsigned n_node=mesh_pt()->nnode();
+ file << "# patch centre (or -1 for uniform pressure case), then change "
+      << "in y at the " << n_node << " nodes" << std::endl;
+ for (unsigned c=0;c<batch.nload_case();c++)
+  {
+   if (c<n_case)
+    {
+     file << xi_case[c];
+    }
+   else
+    {
+     file << -1.0;
+    }
+   for (unsigned j=0;j<n_node;j++)
+    {
+     int eqn=mesh_pt()->node_pt(j)->position_eqn_number(0,1);
+     double dy=0.0;
+     if (eqn>=0) dy=batch.response(c,unsigned(eqn));
+     file << " " << dy;
+    }
+   file << std::endl;
+  }
+ file.close();
+
+} // end of linearised_load_case_study
+
+
 //========start_of_main================================================
 /// Driver for beam (string under tension) test problem 
 //=====================================================================
-int main()
+int main(int argc, char** argv)
 {
+ // Store command line arguments
+ CommandLineArgs::setup(argc,argv);
+
+ // Use GMRES with geometric multigrid preconditioner
+ CommandLineArgs::specify_command_line_flag("--multigrid");
+
+ // Number of pressure patch load cases for the linearised load case 
+ // study (performed after the parameter study)
+ CommandLineArgs::specify_command_line_flag(
+  "--n_load_case",&Global_Physical_Variables::N_load_case);
+
+ // Patch pressure in each load case
+ CommandLineArgs::specify_command_line_flag(
+  "--load_case_pressure",&Global_Physical_Variables::Load_case_pressure);
+
+ // Parse command line
+ CommandLineArgs::parse_and_assign();
+
+ // Doc what has actually been specified on the command line
+ CommandLineArgs::doc_specified_flags();
 
  // Set the non-dimensional thickness 
  Global_Physical_Variables::H=0.01; 
@@ -461,5 +607,11 @@ int main()
  // Conduct parameter study
  problem.parameter_study();
 
+ // Linearised responses to many load cases
+ if (Global_Physical_Variables::N_load_case>0)
+  {
+   problem.linearised_load_case_study();
+  }
+
 } // end of main
 
@@ -0,0 +1,327 @@
+// LIC// ====================================================================
+// LIC// This file forms part of oomph-lib, the object-oriented,
+// LIC// multi-physics finite-element library, available
+// LIC// at http://www.oomph-lib.org.
+// LIC//
+// LIC// Copyright (C) 2006-2023 Matthias Heil and Andrew Hazel
+// LIC//
+// LIC// This library is free software; you can redistribute it and/or
+// LIC// modify it under the terms of the GNU Lesser General Public
+// LIC// License as published by the Free Software Foundation; either
+// LIC// version 2.1 of the License, or (at your option) any later version.
+// LIC//
+// LIC// This library is distributed in the hope that it will be useful,
+// LIC// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// LIC// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// LIC// Lesser General Public License for more details.
+// LIC//
+// LIC// You should have received a copy of the GNU Lesser General Public
+// LIC// License along with this library; if not, write to the Free Software
+// LIC// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+// LIC// 02110-1301  USA.
+// LIC//
+// LIC// The authors may be contacted at oomph-lib@maths.man.ac.uk.
+// LIC//
+// LIC//====================================================================
+// Cache of the integration point data of one-dimensional (Hermite) beam
+// meshes
+
+#ifndef BEAM_INTEGRATION_POINT_CACHE_HEADER
+#define BEAM_INTEGRATION_POINT_CACHE_HEADER
+
+// OOMPH-LIB includes
+#include "generic.h"
+
+namespace oomph
+{
+  //=========================================================================
+  /// Structure-of-arrays cache of the integration point data of a mesh
+  /// of one-dimensional (Hermite) beam elements: the integration weights,
+  /// the shape functions and their first and second derivatives w.r.t.
+  /// the local coordinate (the same in all elements since the
+  /// generalised nodal positions are defined w.r.t. the local
+  /// coordinate), and the Lagrangian coordinate and undeformed geometry
+  /// (position and its first two derivatives w.r.t. the Lagrangian
+  /// coordinate, as provided by the GeomObject) at all integration points
+  /// of all elements. The per-element data is stored contiguously, element
+  /// by element, so loops over the integration points stream through
+  /// arrays rather than evaluating the shape functions and the (virtual)
+  /// GeomObject functions over and over again.
+  ///
+  /// The data only depends on the Lagrangian coordinates of the nodes so
+  /// the cache must be rebuilt (by calling build()) whenever they change,
+  /// e.g. after a regrading of the mesh.
+  //=========================================================================
+  class BeamIntegrationPointCache
+  {
+  public:
+    /// Constructor: Pass the mesh and the GeomObject that specifies its
+    /// undeformed shape. Builds the cache.
+    BeamIntegrationPointCache(SolidMesh* mesh_pt,
+                              GeomObject* undeformed_beam_pt)
+      : Mesh_pt(mesh_pt), Undeformed_beam_pt(undeformed_beam_pt)
+    {
+      build();
+    }
+
+    /// Broken copy constructor
+    BeamIntegrationPointCache(const BeamIntegrationPointCache& dummy) = delete;
+
+    /// Broken assignment operator
+    void operator=(const BeamIntegrationPointCache&) = delete;
+
+    /// (Re-)build the cache, e.g. after the nodes' Lagrangian coordinates
+    /// have changed
+    void build()
+    {
+      N_element = Mesh_pt->nelement();
+#ifdef PARANOID
+      if (N_element == 0)
+      {
+        throw OomphLibError("Can't build the cache for an empty mesh",
+                            OOMPH_CURRENT_FUNCTION,
+                            OOMPH_EXCEPTION_LOCATION);
+      }
+      if ((Mesh_pt->finite_element_pt(0)->dim() != 1) ||
+          (Undeformed_beam_pt->nlagrangian() != 1))
+      {
+        throw OomphLibError("Only one-dimensional beam meshes are supported",
+                            OOMPH_CURRENT_FUNCTION,
+                            OOMPH_EXCEPTION_LOCATION);
+      }
+#endif
+
+      // Shape functions and integration scheme are the same in all elements
+      FiniteElement* first_el_pt = Mesh_pt->finite_element_pt(0);
+      Integral* integral_pt = first_el_pt->integral_pt();
+      N_intpt = integral_pt->nweight();
+      N_node = first_el_pt->nnode();
+      N_position_type = first_el_pt->nnodal_position_type();
+      N_dim = Undeformed_beam_pt->ndim();
+      unsigned n_shape = N_node * N_position_type;
+
+      Weight.resize(N_intpt);
+      Psi.resize(N_intpt * n_shape);
+      Dpsids.resize(N_intpt * n_shape);
+      D2psids.resize(N_intpt * n_shape);
+
+      Vector<double> s(1);
+      Shape psi(N_node, N_position_type);
+      DShape dpsids(N_node, N_position_type, 1);
+      DShape d2psids(N_node, N_position_type, 1);
+      for (unsigned ipt = 0; ipt < N_intpt; ipt++)
+      {
+        Weight[ipt] = integral_pt->weight(ipt);
+        s[0] = integral_pt->knot(ipt, 0);
+        first_el_pt->d2shape_local(s, psi, dpsids, d2psids);
+        for (unsigned l = 0; l < N_node; l++)
+        {
+          for (unsigned k = 0; k < N_position_type; k++)
+          {
+            unsigned j = ipt * n_shape + l * N_position_type + k;
+            Psi[j] = psi(l, k);
+            Dpsids[j] = dpsids(l, k, 0);
+            D2psids[j] = d2psids(l, k, 0);
+          }
+        }
+      }
+
+      // Lagrangian coordinate and undeformed geometry at the integration
+      // points of all elements
+      unsigned n_entry = N_element * N_intpt;
+      Xi.resize(n_entry);
+      Dxids.resize(n_entry);
+      Undeformed_position.resize(N_dim);
+      Undeformed_tangent.resize(N_dim);
+      Undeformed_second_derivative.resize(N_dim);
+      for (unsigned i = 0; i < N_dim; i++)
+      {
+        Undeformed_position[i].resize(n_entry);
+        Undeformed_tangent[i].resize(n_entry);
+        Undeformed_second_derivative[i].resize(n_entry);
+      }
+
+      Vector<double> zeta(1);
+      Vector<double> r(N_dim);
+      DenseMatrix<double> drdzeta(1, N_dim);
+      RankThreeTensor<double> ddrdzeta(1, 1, N_dim);
+      for (unsigned e = 0; e < N_element; e++)
+      {
+        FiniteElement* el_pt = Mesh_pt->finite_element_pt(e);
+        for (unsigned ipt = 0; ipt < N_intpt; ipt++)
+        {
+          const double* psi_pt = psi_at_knot(ipt);
+          const double* dpsids_pt = dpsids_at_knot(ipt);
+          double xi = 0.0;
+          double dxids = 0.0;
+          for (unsigned l = 0; l < N_node; l++)
+          {
+            SolidNode* nod_pt = static_cast<SolidNode*>(el_pt->node_pt(l));
+            for (unsigned k = 0; k < N_position_type; k++)
+            {
+              unsigned j = l * N_position_type + k;
+              xi += nod_pt->xi_gen(k, 0) * psi_pt[j];
+              dxids += nod_pt->xi_gen(k, 0) * dpsids_pt[j];
+            }
+          }
+
+          unsigned entry = e * N_intpt + ipt;
+          Xi[entry] = xi;
+          Dxids[entry] = dxids;
+
+          zeta[0] = xi;
+          Undeformed_beam_pt->d2position(zeta, r, drdzeta, ddrdzeta);
+          for (unsigned i = 0; i < N_dim; i++)
+          {
+            Undeformed_position[i][entry] = r[i];
+            Undeformed_tangent[i][entry] = drdzeta(0, i);
+            Undeformed_second_derivative[i][entry] = ddrdzeta(0, 0, i);
+          }
+        }
+      }
+    }
+
+    /// Number of elements in the mesh
+    unsigned nelement() const
+    {
+      return N_element;
+    }
+
+    /// Number of integration points per element
+    unsigned nintpt() const
+    {
+      return N_intpt;
+    }
+
+    /// Number of shape functions per element (number of nodes times
+    /// number of position types)
+    unsigned nshape() const
+    {
+      return N_node * N_position_type;
+    }
+
+    /// Integration weight of integration point ipt
+    double weight(const unsigned& ipt) const
+    {
+      return Weight[ipt];
+    }
+
+    /// Pointer to the shape functions at integration point ipt, ordered
+    /// as psi(l,k) -> [l*nnodal_position_type()+k]
+    const double* psi_at_knot(const unsigned& ipt) const
+    {
+      return &Psi[ipt * N_node * N_position_type];
+    }
+
+    /// Pointer to the derivatives of the shape functions w.r.t. the local
+    /// coordinate at integration point ipt (same ordering as psi_at_knot)
+    const double* dpsids_at_knot(const unsigned& ipt) const
+    {
+      return &Dpsids[ipt * N_node * N_position_type];
+    }
+
+    /// Pointer to the second derivatives of the shape functions w.r.t.
+    /// the local coordinate at integration point ipt (same ordering as
+    /// psi_at_knot)
+    const double* d2psids_at_knot(const unsigned& ipt) const
+    {
+      return &D2psids[ipt * N_node * N_position_type];
+    }
+
+    /// Lagrangian coordinate at integration point ipt in element e
+    double xi(const unsigned& e, const unsigned& ipt) const
+    {
+      return Xi[e * N_intpt + ipt];
+    }
+
+    /// Derivative of the Lagrangian coordinate w.r.t. the local
+    /// coordinate at integration point ipt in element e
+    double dxids(const unsigned& e, const unsigned& ipt) const
+    {
+      return Dxids[e * N_intpt + ipt];
+    }
+
+    /// i-th component of the undeformed position at integration point
+    /// ipt in element e
+    double undeformed_position(const unsigned& e,
+                               const unsigned& ipt,
+                               const unsigned& i) const
+    {
+      return Undeformed_position[i][e * N_intpt + ipt];
+    }
+
+    /// i-th component of the derivative of the undeformed position w.r.t.
+    /// the Lagrangian coordinate at integration point ipt in element e
+    double undeformed_tangent(const unsigned& e,
+                              const unsigned& ipt,
+                              const unsigned& i) const
+    {
+      return Undeformed_tangent[i][e * N_intpt + ipt];
+    }
+
+    /// i-th component of the second derivative of the undeformed position
+    /// w.r.t. the Lagrangian coordinate at integration point ipt in
+    /// element e
+    double undeformed_second_derivative(const unsigned& e,
+                                        const unsigned& ipt,
+                                        const unsigned& i) const
+    {
+      return Undeformed_second_derivative[i][e * N_intpt + ipt];
+    }
+
+  private:
+    /// Pointer to the mesh
+    SolidMesh* Mesh_pt;
+
+    /// Pointer to the GeomObject that specifies the undeformed shape
+    GeomObject* Undeformed_beam_pt;
+
+    /// Number of elements
+    unsigned N_element;
+
+    /// Number of integration points per element
+    unsigned N_intpt;
+
+    /// Number of nodes per element
+    unsigned N_node;
+
+    /// Number of position types per node
+    unsigned N_position_type;
+
+    /// Number of Eulerian coordinates
+    unsigned N_dim;
+
+    /// Integration weights
+    std::vector<double> Weight;
+
+    /// Shape functions at the integration points
+    std::vector<double> Psi;
+
+    /// Derivatives of the shape functions at the integration points
+    std::vector<double> Dpsids;
+
+    /// Second derivatives of the shape functions at the integration points
+    std::vector<double> D2psids;
+
+    /// Lagrangian coordinate at [e*N_intpt+ipt]
+    std::vector<double> Xi;
+
+    /// Derivative of the Lagrangian coordinate w.r.t. the local coordinate
+    /// at [e*N_intpt+ipt]
+    std::vector<double> Dxids;
+
+    /// Components of the undeformed position: [i][e*N_intpt+ipt]
+    Vector<std::vector<double>> Undeformed_position;
+
+    /// Components of the derivative of the undeformed position w.r.t.
+    /// the Lagrangian coordinate: [i][e*N_intpt+ipt]
+    Vector<std::vector<double>> Undeformed_tangent;
+
+    /// Components of the second derivative of the undeformed position
+    /// w.r.t. the Lagrangian coordinate: [i][e*N_intpt+ipt]
+    Vector<std::vector<double>> Undeformed_second_derivative;
+  };
+
+} // namespace oomph
+
+#endif
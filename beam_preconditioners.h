@@ -0,0 +1,1851 @@
+// LIC// ====================================================================
+// LIC// This file forms part of oomph-lib, the object-oriented,
+// LIC// multi-physics finite-element library, available
+// LIC// at http://www.oomph-lib.org.
+// LIC//
+// LIC// Copyright (C) 2006-2023 Matthias Heil and Andrew Hazel
+// LIC//
+// LIC// This library is free software; you can redistribute it and/or
+// LIC// modify it under the terms of the GNU Lesser General Public
+// LIC// License as published by the Free Software Foundation; either
+// LIC// version 2.1 of the License, or (at your option) any later version.
+// LIC//
+// LIC// This library is distributed in the hope that it will be useful,
+// LIC// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// LIC// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// LIC// Lesser General Public License for more details.
+// LIC//
+// LIC// You should have received a copy of the GNU Lesser General Public
+// LIC// License along with this library; if not, write to the Free Software
+// LIC// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+// LIC// 02110-1301  USA.
+// LIC//
+// LIC// The authors may be contacted at oomph-lib@maths.man.ac.uk.
+// LIC//
+// LIC//====================================================================
+// Linear algebra helpers and preconditioners for the (Hermite) beam
+// problems
+
+#ifndef BEAM_PRECONDITIONERS_HEADER
+#define BEAM_PRECONDITIONERS_HEADER
+
+// OOMPH-LIB includes
+#include "generic.h"
+
+namespace oomph
+{
+  //=========================================================================
+  /// LU factorisation (with partial pivoting) of a banded matrix with
+  /// kl sub- and ku super-diagonals. Storage follows LAPACK's dgbtrf,
+  /// i.e. column-major with 2*kl+ku+1 entries per column, the top kl
+  /// of which hold the fill-in generated by the row interchanges. Memory
+  /// is therefore O(n) for fixed bandwidth.
+  //=========================================================================
+  class BandedLUFactorisation
+  {
+  public:
+    /// Constructor: Empty
+    BandedLUFactorisation() : N(0), Kl(0), Ku(0), Is_factorised(false) {}
+
+    /// Broken copy constructor
+    BandedLUFactorisation(const BandedLUFactorisation& dummy) = delete;
+
+    /// Broken assignment operator
+    void operator=(const BandedLUFactorisation&) = delete;
+
+    /// Allocate (zeroed) storage for an n x n matrix with kl sub- and
+    /// ku super-diagonals
+    void build(const unsigned& n, const unsigned& kl, const unsigned& ku)
+    {
+      N = n;
+      Kl = kl;
+      Ku = ku;
+      Ldab = 2 * Kl + Ku + 1;
+      Ab.assign(Ldab * N, 0.0);
+      Ipiv.assign(N, 0);
+      Is_factorised = false;
+    }
+
+    /// Copy the (square) matrix, with the bandwidth determined from its
+    /// sparsity pattern
+    void build(const CRDoubleMatrix& matrix)
+    {
+      const unsigned n = matrix.nrow();
+      const int* row_start = matrix.row_start();
+      const int* column_index = matrix.column_index();
+      const double* value = matrix.value();
+
+      // Bandwidth
+      unsigned kl = 0;
+      unsigned ku = 0;
+      for (unsigned i = 0; i < n; i++)
+      {
+        for (int k = row_start[i]; k < row_start[i + 1]; k++)
+        {
+          unsigned j = unsigned(column_index[k]);
+          if (j < i)
+          {
+            kl = std::max(kl, i - j);
+          }
+          else
+          {
+            ku = std::max(ku, j - i);
+          }
+        }
+      }
+
+      // Copy
+      build(n, kl, ku);
+      for (unsigned i = 0; i < n; i++)
+      {
+        for (int k = row_start[i]; k < row_start[i + 1]; k++)
+        {
+          entry(i, unsigned(column_index[k])) += value[k];
+        }
+      }
+    }
+
+    /// Number of rows
+    unsigned nrow() const
+    {
+      return N;
+    }
+
+    /// Number of sub-diagonals
+    unsigned kl() const
+    {
+      return Kl;
+    }
+
+    /// Number of super-diagonals
+    unsigned ku() const
+    {
+      return Ku;
+    }
+
+    /// Is (i,j) inside the band?
+    bool is_in_band(const unsigned& i, const unsigned& j) const
+    {
+      return (i <= j + Kl) && (j <= i + Ku);
+    }
+
+    /// Read/write access to entry (i,j) of the matrix before it's been
+    /// factorised. (i,j) must be inside the band.
+    double& entry(const unsigned& i, const unsigned& j)
+    {
+#ifdef PARANOID
+      if (!is_in_band(i, j))
+      {
+        std::ostringstream error_message;
+        error_message << "Entry (" << i << "," << j
+                      << ") is outside the band [kl=" << Kl << ", ku=" << Ku
+                      << "]" << std::endl;
+        throw OomphLibError(
+          error_message.str(), OOMPH_CURRENT_FUNCTION, OOMPH_EXCEPTION_LOCATION);
+      }
+#endif
+      return Ab[(Kl + Ku + i - j) + j * Ldab];
+    }
+
+    /// LU-decompose the matrix in place
+    void factorise()
+    {
+      // Total number of super-diagonals in U (incl. fill-in)
+      const unsigned kv = Ku + Kl;
+
+      // Furthest column touched by the row interchanges so far
+      unsigned ju = 0;
+
+      for (unsigned j = 0; j < N; j++)
+      {
+        // Number of sub-diagonal entries in this column
+        const unsigned km = std::min(Kl, N - 1 - j);
+
+        // Find pivot
+        unsigned jp = 0;
+        double max_entry = std::fabs(a(j, j, kv));
+        for (unsigned i = 1; i <= km; i++)
+        {
+          if (std::fabs(a(j + i, j, kv)) > max_entry)
+          {
+            max_entry = std::fabs(a(j + i, j, kv));
+            jp = i;
+          }
+        }
+        Ipiv[j] = j + jp;
+
+        if (max_entry == 0.0)
+        {
+          std::ostringstream error_message;
+          error_message << "Banded matrix is singular: zero pivot in column "
+                        << j << std::endl;
+          throw OomphLibError(
+            error_message.str(), OOMPH_CURRENT_FUNCTION, OOMPH_EXCEPTION_LOCATION);
+        }
+
+        // Columns affected by the interchange
+        ju = std::max(ju, std::min(j + Ku + jp, N - 1));
+
+        // Swap rows j and j+jp
+        if (jp != 0)
+        {
+          for (unsigned c = j; c <= ju; c++)
+          {
+            std::swap(a(j, c, kv), a(j + jp, c, kv));
+          }
+        }
+
+        // Compute multipliers and update trailing sub-matrix
+        const double pivot = a(j, j, kv);
+        for (unsigned i = 1; i <= km; i++)
+        {
+          a(j + i, j, kv) /= pivot;
+        }
+        for (unsigned c = j + 1; c <= ju; c++)
+        {
+          const double a_jc = a(j, c, kv);
+          if (a_jc != 0.0)
+          {
+            for (unsigned i = 1; i <= km; i++)
+            {
+              a(j + i, c, kv) -= a(j + i, j, kv) * a_jc;
+            }
+          }
+        }
+      }
+
+      Is_factorised = true;
+    }
+
+    /// Solve (in place) for a single right-hand side
+    void solve(double* rhs) const
+    {
+      solve(1, rhs);
+    }
+
+    /// Solve (in place) for nrhs right-hand sides stored row-wise, i.e.
+    /// entry i of right-hand side r is rhs[i*nrhs+r]. The right-hand sides
+    /// are processed together so each entry of the factors is only
+    /// loaded once.
+    void solve(const unsigned& nrhs, double* rhs) const
+    {
+#ifdef PARANOID
+      if (!Is_factorised)
+      {
+        throw OomphLibError("Matrix has not been factorised",
+                            OOMPH_CURRENT_FUNCTION,
+                            OOMPH_EXCEPTION_LOCATION);
+      }
+#endif
+      const unsigned kv = Ku + Kl;
+
+      // Forward substitution with L (and the row interchanges)
+      for (unsigned j = 0; j + 1 < N; j++)
+      {
+        double* b_j = rhs + j * nrhs;
+        const unsigned l = Ipiv[j];
+        if (l != j)
+        {
+          double* b_l = rhs + l * nrhs;
+          for (unsigned r = 0; r < nrhs; r++)
+          {
+            std::swap(b_j[r], b_l[r]);
+          }
+        }
+        const unsigned km = std::min(Kl, N - 1 - j);
+        for (unsigned i = 1; i <= km; i++)
+        {
+          const double l_ij = Ab[(kv + i) + j * Ldab];
+          double* b_i = rhs + (j + i) * nrhs;
+          for (unsigned r = 0; r < nrhs; r++)
+          {
+            b_i[r] -= l_ij * b_j[r];
+          }
+        }
+      }
+
+      // Back substitution with U
+      for (unsigned jj = N; jj > 0; jj--)
+      {
+        const unsigned j = jj - 1;
+        double* b_j = rhs + j * nrhs;
+        const double inv_diag = 1.0 / Ab[kv + j * Ldab];
+        for (unsigned r = 0; r < nrhs; r++)
+        {
+          b_j[r] *= inv_diag;
+        }
+        const unsigned i_min = (j > kv) ? j - kv : 0;
+        for (unsigned i = i_min; i < j; i++)
+        {
+          const double u_ij = Ab[(kv + i - j) + j * Ldab];
+          double* b_i = rhs + i * nrhs;
+          for (unsigned r = 0; r < nrhs; r++)
+          {
+            b_i[r] -= u_ij * b_j[r];
+          }
+        }
+      }
+    }
+
+  private:
+    /// Access to entry (i,j) in the LAPACK-style band storage
+    double& a(const unsigned& i, const unsigned& j, const unsigned& kv)
+    {
+      return Ab[(kv + i - j) + j * Ldab];
+    }
+
+    /// Number of rows/columns
+    unsigned N;
+
+    /// Number of sub-diagonals
+    unsigned Kl;
+
+    /// Number of super-diagonals
+    unsigned Ku;
+
+    /// Leading dimension of band storage
+    unsigned Ldab;
+
+    /// Band storage
+    std::vector<double> Ab;
+
+    /// Pivots
+    std::vector<unsigned> Ipiv;
+
+    /// Has the matrix been factorised?
+    bool Is_factorised;
+  };
+
+
+  /////////////////////////////////////////////////////////////////////
+  /////////////////////////////////////////////////////////////////////
+  /////////////////////////////////////////////////////////////////////
+
+
+  //=========================================================================
+  /// Block preconditioner for beam problems whose unknowns are the nodal
+  /// positions of one or more (1D, Hermite) beam meshes plus the values
+  /// stored in an (optional) "rigid body" element that couples to all of
+  /// them. The preconditioner is
+  ///
+  ///        [ K_beam     0    ]
+  ///   P =  [                 ]
+  ///        [   0     J_rigid ]
+  ///
+  /// where K_beam is the banded matrix assembled from the beam elements'
+  /// own Jacobians (all couplings to data that isn't a beam dof are
+  /// dropped) and J_rigid is the small dense block of derivatives of
+  /// the rigid body element's residuals w.r.t. its own internal data.
+  /// Because the beam meshes are 1D the bandwidth of K_beam is bounded,
+  /// so storage and cost are O(N). The preconditioner is assembled from
+  /// the elements rather than from an assembled matrix so it can also be
+  /// used in matrix-free solves.
+  //=========================================================================
+  class BeamBlockBandedPreconditioner : public Preconditioner
+  {
+  public:
+    /// Constructor: Pass pointer to the problem
+    BeamBlockBandedPreconditioner(Problem* problem_pt)
+      : Problem_pt(problem_pt), Rigid_body_element_pt(0)
+    {
+    }
+
+    /// Broken copy constructor
+    BeamBlockBandedPreconditioner(const BeamBlockBandedPreconditioner& dummy) =
+      delete;
+
+    /// Broken assignment operator
+    void operator=(const BeamBlockBandedPreconditioner&) = delete;
+
+    /// Destructor: Clean up
+    ~BeamBlockBandedPreconditioner()
+    {
+      clean_up_memory();
+    }
+
+    /// Specify the meshes of beam elements whose dofs form the banded block
+    void set_beam_meshes(const Vector<Mesh*>& beam_mesh_pt)
+    {
+      Beam_mesh_pt = beam_mesh_pt;
+    }
+
+    /// Specify the element that stores the rigid body unknowns (can be
+    /// null)
+    void set_rigid_body_element(GeneralisedElement* rigid_body_element_pt)
+    {
+      Rigid_body_element_pt = rigid_body_element_pt;
+    }
+
+    /// Assemble and factorise the blocks
+    void setup();
+
+    /// Apply the preconditioner: z = P^{-1} r
+    void preconditioner_solve(const DoubleVector& r, DoubleVector& z);
+
+    /// Wipe the factorisations
+    void clean_up_memory()
+    {
+      Beam_block.build(0, 0, 0);
+      Beam_dof_index.clear();
+      Rigid_body_dof.clear();
+      Rigid_body_block_lu.clear();
+      Rigid_body_block_pivot.clear();
+    }
+
+  private:
+    /// Assemble the beam elements' Jacobians into the banded block
+    void setup_beam_block(const unsigned& n_dof);
+
+    /// Finite-difference the rigid body residuals w.r.t. to the rigid
+    /// body unknowns and LU-decompose the resulting dense block
+    void setup_rigid_body_block();
+
+    /// Pointer to the problem
+    Problem* Problem_pt;
+
+    /// Beam meshes
+    Vector<Mesh*> Beam_mesh_pt;
+
+    /// Element that holds the rigid body data
+    GeneralisedElement* Rigid_body_element_pt;
+
+    /// Map from global equation number to row in the banded block (-1 if
+    /// the dof isn't a beam dof)
+    Vector<int> Beam_dof_index;
+
+    /// Global equation numbers of the rows in the banded block
+    Vector<unsigned> Beam_dof;
+
+    /// Banded beam block
+    BandedLUFactorisation Beam_block;
+
+    /// Global equation numbers of the rigid body unknowns
+    Vector<unsigned> Rigid_body_dof;
+
+    /// LU factors of the (dense, row-major) rigid body block
+    Vector<double> Rigid_body_block_lu;
+
+    /// Pivots for the rigid body block
+    Vector<unsigned> Rigid_body_block_pivot;
+  };
+
+
+  //=========================================================================
+  /// Assemble and factorise the blocks
+  //=========================================================================
+  inline void BeamBlockBandedPreconditioner::setup()
+  {
+    clean_up_memory();
+
+    const unsigned n_dof = Problem_pt->ndof();
+
+    // Identify the rigid body dofs first so they're excluded from the
+    // banded block
+    Rigid_body_dof.clear();
+    if (Rigid_body_element_pt != 0)
+    {
+      const unsigned n_internal = Rigid_body_element_pt->ninternal_data();
+      for (unsigned i = 0; i < n_internal; i++)
+      {
+        Data* data_pt = Rigid_body_element_pt->internal_data_pt(i);
+        const unsigned n_value = data_pt->nvalue();
+        for (unsigned v = 0; v < n_value; v++)
+        {
+          const long eqn = data_pt->eqn_number(v);
+          if (eqn >= 0)
+          {
+            Rigid_body_dof.push_back(unsigned(eqn));
+          }
+        }
+      }
+    }
+
+    setup_beam_block(n_dof);
+    setup_rigid_body_block();
+  }
+
+
+  //=========================================================================
+  /// Assemble the beam elements' Jacobians into the banded block
+  //=========================================================================
+  inline void BeamBlockBandedPreconditioner::setup_beam_block(
+    const unsigned& n_dof)
+  {
+    // Flag the rigid body dofs
+    std::vector<bool> is_rigid_body_dof(n_dof, false);
+    const unsigned n_rigid = Rigid_body_dof.size();
+    for (unsigned i = 0; i < n_rigid; i++)
+    {
+      is_rigid_body_dof[Rigid_body_dof[i]] = true;
+    }
+
+    // Collect the beam dofs (in order of their global equation numbers
+    // which, for 1D meshes, keeps the bandwidth small)
+    std::vector<bool> is_beam_dof(n_dof, false);
+    const unsigned n_mesh = Beam_mesh_pt.size();
+    for (unsigned m = 0; m < n_mesh; m++)
+    {
+      const unsigned n_element = Beam_mesh_pt[m]->nelement();
+      for (unsigned e = 0; e < n_element; e++)
+      {
+        GeneralisedElement* elem_pt = Beam_mesh_pt[m]->element_pt(e);
+        const unsigned n_elem_dof = elem_pt->ndof();
+        for (unsigned i = 0; i < n_elem_dof; i++)
+        {
+          const unsigned eqn = elem_pt->eqn_number(i);
+          if (!is_rigid_body_dof[eqn])
+          {
+            is_beam_dof[eqn] = true;
+          }
+        }
+      }
+    }
+    Beam_dof_index.assign(n_dof, -1);
+    Beam_dof.clear();
+    for (unsigned i = 0; i < n_dof; i++)
+    {
+      if (is_beam_dof[i])
+      {
+        Beam_dof_index[i] = Beam_dof.size();
+        Beam_dof.push_back(i);
+      }
+    }
+    const unsigned n_beam_dof = Beam_dof.size();
+
+    // Determine the bandwidth
+    unsigned bandwidth = 0;
+    for (unsigned m = 0; m < n_mesh; m++)
+    {
+      const unsigned n_element = Beam_mesh_pt[m]->nelement();
+      for (unsigned e = 0; e < n_element; e++)
+      {
+        GeneralisedElement* elem_pt = Beam_mesh_pt[m]->element_pt(e);
+        const unsigned n_elem_dof = elem_pt->ndof();
+        for (unsigned i = 0; i < n_elem_dof; i++)
+        {
+          const int row = Beam_dof_index[elem_pt->eqn_number(i)];
+          if (row < 0) continue;
+          for (unsigned j = 0; j < n_elem_dof; j++)
+          {
+            const int col = Beam_dof_index[elem_pt->eqn_number(j)];
+            if (col < 0) continue;
+            bandwidth = std::max(bandwidth, unsigned(std::abs(row - col)));
+          }
+        }
+      }
+    }
+
+    // Assemble
+    Beam_block.build(n_beam_dof, bandwidth, bandwidth);
+    for (unsigned m = 0; m < n_mesh; m++)
+    {
+      const unsigned n_element = Beam_mesh_pt[m]->nelement();
+      for (unsigned e = 0; e < n_element; e++)
+      {
+        GeneralisedElement* elem_pt = Beam_mesh_pt[m]->element_pt(e);
+        const unsigned n_elem_dof = elem_pt->ndof();
+        Vector<double> residuals(n_elem_dof);
+        DenseMatrix<double> jacobian(n_elem_dof, n_elem_dof, 0.0);
+        elem_pt->get_jacobian(residuals, jacobian);
+        for (unsigned i = 0; i < n_elem_dof; i++)
+        {
+          const int row = Beam_dof_index[elem_pt->eqn_number(i)];
+          if (row < 0) continue;
+          for (unsigned j = 0; j < n_elem_dof; j++)
+          {
+            const int col = Beam_dof_index[elem_pt->eqn_number(j)];
+            if (col < 0) continue;
+            Beam_block.entry(row, col) += jacobian(i, j);
+          }
+        }
+      }
+    }
+
+    if (n_beam_dof > 0)
+    {
+      Beam_block.factorise();
+    }
+  }
+
+
+  //=========================================================================
+  /// Finite-difference the rigid body residuals w.r.t. to the rigid
+  /// body unknowns and LU-decompose the resulting dense block. Only
+  /// n_rigid extra residual evaluations are required (rather than one
+  /// per external beam dof, as in the element's own FD Jacobian).
+  //=========================================================================
+  inline void BeamBlockBandedPreconditioner::setup_rigid_body_block()
+  {
+    const unsigned n_rigid = Rigid_body_dof.size();
+    if (n_rigid == 0) return;
+
+    GeneralisedElement* elem_pt = Rigid_body_element_pt;
+    const unsigned n_elem_dof = elem_pt->ndof();
+
+    // Local equation numbers of the rigid body unknowns
+    Vector<unsigned> local_eqn(n_rigid);
+    for (unsigned i = 0; i < n_rigid; i++)
+    {
+      for (unsigned l = 0; l < n_elem_dof; l++)
+      {
+        if (elem_pt->eqn_number(l) == Rigid_body_dof[i])
+        {
+          local_eqn[i] = l;
+        }
+      }
+    }
+
+    // Unperturbed residuals
+    Vector<double> residuals(n_elem_dof);
+    elem_pt->get_residuals(residuals);
+
+    // Finite-difference the internal columns
+    Rigid_body_block_lu.assign(n_rigid * n_rigid, 0.0);
+    Vector<double> residuals_pls(n_elem_dof);
+    const double fd_step = GeneralisedElement::Default_fd_jacobian_step;
+    for (unsigned j = 0; j < n_rigid; j++)
+    {
+      double* value_pt = Problem_pt->dof_pt(Rigid_body_dof[j]);
+      const double backup = *value_pt;
+      *value_pt += fd_step;
+      elem_pt->get_residuals(residuals_pls);
+      *value_pt = backup;
+      for (unsigned i = 0; i < n_rigid; i++)
+      {
+        Rigid_body_block_lu[i * n_rigid + j] =
+          (residuals_pls[local_eqn[i]] - residuals[local_eqn[i]]) / fd_step;
+      }
+    }
+
+    // Dense LU with partial pivoting
+    Rigid_body_block_pivot.resize(n_rigid);
+    double* lu = &Rigid_body_block_lu[0];
+    for (unsigned k = 0; k < n_rigid; k++)
+    {
+      unsigned p = k;
+      for (unsigned i = k + 1; i < n_rigid; i++)
+      {
+        if (std::fabs(lu[i * n_rigid + k]) > std::fabs(lu[p * n_rigid + k]))
+        {
+          p = i;
+        }
+      }
+      Rigid_body_block_pivot[k] = p;
+      if (p != k)
+      {
+        for (unsigned j = 0; j < n_rigid; j++)
+        {
+          std::swap(lu[k * n_rigid + j], lu[p * n_rigid + j]);
+        }
+      }
+      if (lu[k * n_rigid + k] == 0.0)
+      {
+        throw OomphLibError("Rigid body block is singular",
+                            OOMPH_CURRENT_FUNCTION,
+                            OOMPH_EXCEPTION_LOCATION);
+      }
+      for (unsigned i = k + 1; i < n_rigid; i++)
+      {
+        lu[i * n_rigid + k] /= lu[k * n_rigid + k];
+        for (unsigned j = k + 1; j < n_rigid; j++)
+        {
+          lu[i * n_rigid + j] -= lu[i * n_rigid + k] * lu[k * n_rigid + j];
+        }
+      }
+    }
+  }
+
+
+  //=========================================================================
+  /// Apply the preconditioner: z = P^{-1} r. Dofs that are neither beam
+  /// nor rigid body dofs are passed through unchanged.
+  //=========================================================================
+  inline void BeamBlockBandedPreconditioner::preconditioner_solve(
+    const DoubleVector& r, DoubleVector& z)
+  {
+    const unsigned n_dof = r.nrow();
+    if (!z.built())
+    {
+      z.build(r.distribution_pt(), 0.0);
+    }
+    const double* r_pt = r.values_pt();
+    double* z_pt = z.values_pt();
+    for (unsigned i = 0; i < n_dof; i++)
+    {
+      z_pt[i] = r_pt[i];
+    }
+
+    // Beam block
+    const unsigned n_beam_dof = Beam_dof.size();
+    if (n_beam_dof > 0)
+    {
+      Vector<double> rhs(n_beam_dof);
+      for (unsigned i = 0; i < n_beam_dof; i++)
+      {
+        rhs[i] = r_pt[Beam_dof[i]];
+      }
+      Beam_block.solve(&rhs[0]);
+      for (unsigned i = 0; i < n_beam_dof; i++)
+      {
+        z_pt[Beam_dof[i]] = rhs[i];
+      }
+    }
+
+    // Rigid body block
+    const unsigned n_rigid = Rigid_body_dof.size();
+    if (n_rigid > 0)
+    {
+      const double* lu = &Rigid_body_block_lu[0];
+      Vector<double> rhs(n_rigid);
+      for (unsigned i = 0; i < n_rigid; i++)
+      {
+        rhs[i] = r_pt[Rigid_body_dof[i]];
+      }
+      // Apply all row interchanges before the forward substitution: the
+      // factorisation swapped entire rows (incl. the multipliers in L)
+      for (unsigned k = 0; k < n_rigid; k++)
+      {
+        std::swap(rhs[k], rhs[Rigid_body_block_pivot[k]]);
+      }
+      for (unsigned k = 0; k < n_rigid; k++)
+      {
+        for (unsigned i = k + 1; i < n_rigid; i++)
+        {
+          rhs[i] -= lu[i * n_rigid + k] * rhs[k];
+        }
+      }
+      for (unsigned kk = n_rigid; kk > 0; kk--)
+      {
+        const unsigned k = kk - 1;
+        for (unsigned j = k + 1; j < n_rigid; j++)
+        {
+          rhs[k] -= lu[k * n_rigid + j] * rhs[j];
+        }
+        rhs[k] /= lu[k * n_rigid + k];
+      }
+      for (unsigned i = 0; i < n_rigid; i++)
+      {
+        z_pt[Rigid_body_dof[i]] = rhs[i];
+      }
+    }
+  }
+
+
+  /////////////////////////////////////////////////////////////////////
+  /////////////////////////////////////////////////////////////////////
+  /////////////////////////////////////////////////////////////////////
+
+
+  //=========================================================================
+  /// Geometric multigrid preconditioner for problems discretised with
+  /// (1D) Hermite beam elements. The hierarchy of grids is obtained by
+  /// repeatedly merging pairs of adjacent elements of the (fine) beam
+  /// meshes; if a mesh has an odd number of elements its last coarse
+  /// element absorbs three fine ones, so the number of elements needn't
+  /// be even (or a power of two). Graded meshes pass their grading on to
+  /// the coarse meshes. Prolongation is by cubic Hermite interpolation in
+  /// the Lagrangian coordinate, accounting for the scaling of the slope
+  /// dofs by the nodes' xi_gen(1,0); restriction is its transpose, and the
+  /// coarse-grid operators are formed by Galerkin projection,
+  /// A_c = P^T A P. A V-cycle with symmetric Gauss-Seidel smoothing and an
+  /// (exact) banded LU solve on the coarsest grid approximates the inverse
+  /// of the beam block A_bb of the matrix.
+  ///
+  /// Dofs that aren't nodal positions in one of the beam meshes (e.g.
+  /// rigid body unknowns, whose residuals couple to all beam dofs) are
+  /// not part of the hierarchy. They are eliminated by a block
+  /// factorisation with the (dense) Schur complement
+  ///
+  ///   S = A_oo - A_ob M_bb^{-1} A_bo,
+  ///
+  /// where M_bb^{-1} is the V-cycle. Forming S takes one V-cycle per
+  /// non-beam dof in setup(). The preconditioner is a fixed linear
+  /// operator and can be used with (standard) GMRES.
+  //=========================================================================
+  class HermiteBeamMultigridPreconditioner : public Preconditioner
+  {
+  public:
+    /// Constructor: Set defaults
+    HermiteBeamMultigridPreconditioner()
+      : Npre_smooth(2),
+        Npost_smooth(2),
+        Max_nlevel(20),
+        Min_nelement_coarsest(2),
+        Doc_hierarchy(false)
+    {
+    }
+
+    /// Broken copy constructor
+    HermiteBeamMultigridPreconditioner(
+      const HermiteBeamMultigridPreconditioner& dummy) = delete;
+
+    /// Broken assignment operator
+    void operator=(const HermiteBeamMultigridPreconditioner&) = delete;
+
+    /// Destructor: Clean up
+    ~HermiteBeamMultigridPreconditioner()
+    {
+      clean_up_memory();
+    }
+
+    /// Specify the (fine) beam meshes. Needs to be called again if the
+    /// meshes are replaced (e.g. following a manual refinement).
+    void set_beam_meshes(const Vector<SolidMesh*>& beam_mesh_pt)
+    {
+      Beam_mesh_pt = beam_mesh_pt;
+    }
+
+    /// Number of pre-smoothing sweeps
+    unsigned& npre_smooth()
+    {
+      return Npre_smooth;
+    }
+
+    /// Number of post-smoothing sweeps
+    unsigned& npost_smooth()
+    {
+      return Npost_smooth;
+    }
+
+    /// Max. number of levels (incl. the fine level)
+    unsigned& max_nlevel()
+    {
+      return Max_nlevel;
+    }
+
+    /// Don't coarsen meshes below this number of elements
+    unsigned& min_nelement_coarsest()
+    {
+      return Min_nelement_coarsest;
+    }
+
+    /// Doc the size of the levels in setup()
+    void enable_doc_hierarchy()
+    {
+      Doc_hierarchy = true;
+    }
+
+    /// Don't doc the size of the levels in setup()
+    void disable_doc_hierarchy()
+    {
+      Doc_hierarchy = false;
+    }
+
+    /// Number of levels in the current hierarchy
+    unsigned nlevel() const
+    {
+      return Level_matrix.size();
+    }
+
+    /// Build the hierarchy for the beam block of the (CRDoubleMatrix)
+    /// matrix_pt() and the Schur complement of the remaining dofs
+    void setup();
+
+    /// Apply the block factorisation (with one V-cycle, from zero
+    /// initial guess, per solve with the beam block) to r
+    void preconditioner_solve(const DoubleVector& r, DoubleVector& z);
+
+    /// Wipe the hierarchy
+    void clean_up_memory()
+    {
+      Level_matrix.clear();
+      Prolongation.clear();
+      Restriction.clear();
+      Coarsest_lu.build(0, 0, 0);
+      Beam_dof.clear();
+      Other_dof.clear();
+      Beam_other_block = LevelMatrix();
+      Other_beam_block = LevelMatrix();
+      Beam_block_inverse_coupling.clear();
+      Schur_complement_lu.build(0, 0, 0);
+    }
+
+  private:
+    /// Simple compressed-row matrix used for the level operators
+    class LevelMatrix
+    {
+    public:
+      /// Constructor: Empty
+      LevelMatrix() : Nrow(0), Ncol(0) {}
+
+      /// y = A x
+      void multiply(const std::vector<double>& x, std::vector<double>& y) const
+      {
+        y.assign(Nrow, 0.0);
+        for (unsigned i = 0; i < Nrow; i++)
+        {
+          double sum = 0.0;
+          for (unsigned k = Row_start[i]; k < Row_start[i + 1]; k++)
+          {
+            sum += Value[k] * x[Column_index[k]];
+          }
+          y[i] = sum;
+        }
+      }
+
+      /// Return the transpose
+      void get_transpose(LevelMatrix& transpose) const;
+
+      /// result = this * other
+      void multiply(const LevelMatrix& other, LevelMatrix& result) const;
+
+      /// Number of rows
+      unsigned Nrow;
+
+      /// Number of columns
+      unsigned Ncol;
+
+      /// Row starts
+      std::vector<unsigned> Row_start;
+
+      /// Column indices
+      std::vector<unsigned> Column_index;
+
+      /// Values
+      std::vector<double> Value;
+    };
+
+    /// Information about a node on a given level
+    struct LevelNode
+    {
+      /// Lagrangian coordinate
+      double Xi;
+
+      /// Scaling of slope dofs (dxi/ds at the node)
+      double Sigma;
+
+      /// Level dof number for position type k and direction i (stored as
+      /// [2*i+k]; -1 if pinned)
+      int Dof[4];
+    };
+
+    /// Build prolongation from level with coarse_nodes to level with
+    /// fine_nodes for all beam meshes. coarse_node_index[m][j] is the
+    /// number of fine node j of mesh m on the coarse level (-1 if it
+    /// has been removed).
+    void build_prolongation(const Vector<Vector<LevelNode>>& fine_nodes,
+                            const Vector<Vector<LevelNode>>& coarse_nodes,
+                            const Vector<Vector<int>>& coarse_node_index,
+                            const unsigned& n_fine,
+                            const unsigned& n_coarse,
+                            LevelMatrix& prolongation) const;
+
+    /// Symmetric Gauss-Seidel sweep(s) on level l
+    void smooth(const unsigned& l,
+                const std::vector<double>& b,
+                std::vector<double>& x,
+                const unsigned& n_sweep,
+                const bool& forward) const;
+
+    /// Recursive V-cycle
+    void v_cycle(const unsigned& l,
+                 const std::vector<double>& b,
+                 std::vector<double>& x) const;
+
+    /// Beam meshes on the fine level
+    Vector<SolidMesh*> Beam_mesh_pt;
+
+    /// Global equation numbers of the beam dofs (in the order in which
+    /// they're numbered on the fine level)
+    Vector<unsigned> Beam_dof;
+
+    /// Global equation numbers of the remaining dofs
+    Vector<unsigned> Other_dof;
+
+    /// Level operators (0: fine beam block)
+    Vector<LevelMatrix> Level_matrix;
+
+    /// Prolongation from level l+1 to level l
+    Vector<LevelMatrix> Prolongation;
+
+    /// Restriction from level l to level l+1
+    Vector<LevelMatrix> Restriction;
+
+    /// LU factors of the coarsest operator
+    BandedLUFactorisation Coarsest_lu;
+
+    /// Coupling block A_bo (beam rows, other columns)
+    LevelMatrix Beam_other_block;
+
+    /// Coupling block A_ob (other rows, beam columns)
+    LevelMatrix Other_beam_block;
+
+    /// Columns of M_bb^{-1} A_bo, one per non-beam dof
+    Vector<std::vector<double>> Beam_block_inverse_coupling;
+
+    /// LU factors of the (dense) Schur complement of the non-beam dofs
+    BandedLUFactorisation Schur_complement_lu;
+
+    /// Number of pre-smoothing sweeps
+    unsigned Npre_smooth;
+
+    /// Number of post-smoothing sweeps
+    unsigned Npost_smooth;
+
+    /// Max. number of levels
+    unsigned Max_nlevel;
+
+    /// Min. number of elements per mesh on coarsest level
+    unsigned Min_nelement_coarsest;
+
+    /// Doc the hierarchy?
+    bool Doc_hierarchy;
+  };
+
+
+  //=========================================================================
+  /// Return the transpose
+  //=========================================================================
+  inline void HermiteBeamMultigridPreconditioner::LevelMatrix::get_transpose(
+    LevelMatrix& transpose) const
+  {
+    transpose.Nrow = Ncol;
+    transpose.Ncol = Nrow;
+    transpose.Row_start.assign(Ncol + 1, 0);
+    const unsigned nnz = Value.size();
+    for (unsigned k = 0; k < nnz; k++)
+    {
+      transpose.Row_start[Column_index[k] + 1]++;
+    }
+    for (unsigned j = 0; j < Ncol; j++)
+    {
+      transpose.Row_start[j + 1] += transpose.Row_start[j];
+    }
+    transpose.Column_index.resize(nnz);
+    transpose.Value.resize(nnz);
+    std::vector<unsigned> next(transpose.Row_start.begin(),
+                               transpose.Row_start.end() - 1);
+    for (unsigned i = 0; i < Nrow; i++)
+    {
+      for (unsigned k = Row_start[i]; k < Row_start[i + 1]; k++)
+      {
+        const unsigned pos = next[Column_index[k]]++;
+        transpose.Column_index[pos] = i;
+        transpose.Value[pos] = Value[k];
+      }
+    }
+  }
+
+
+  //=========================================================================
+  /// result = this * other (row-by-row with a dense marker array)
+  //=========================================================================
+  inline void HermiteBeamMultigridPreconditioner::LevelMatrix::multiply(
+    const LevelMatrix& other, LevelMatrix& result) const
+  {
+    result.Nrow = Nrow;
+    result.Ncol = other.Ncol;
+    result.Row_start.assign(Nrow + 1, 0);
+    result.Column_index.clear();
+    result.Value.clear();
+
+    std::vector<int> marker(other.Ncol, -1);
+    for (unsigned i = 0; i < Nrow; i++)
+    {
+      const unsigned row_begin = result.Column_index.size();
+      for (unsigned k = Row_start[i]; k < Row_start[i + 1]; k++)
+      {
+        const unsigned j = Column_index[k];
+        const double a_ij = Value[k];
+        for (unsigned kk = other.Row_start[j]; kk < other.Row_start[j + 1];
+             kk++)
+        {
+          const unsigned c = other.Column_index[kk];
+          if (marker[c] < int(row_begin))
+          {
+            marker[c] = result.Column_index.size();
+            result.Column_index.push_back(c);
+            result.Value.push_back(a_ij * other.Value[kk]);
+          }
+          else
+          {
+            result.Value[marker[c]] += a_ij * other.Value[kk];
+          }
+        }
+      }
+      result.Row_start[i + 1] = result.Column_index.size();
+    }
+  }
+
+
+  //=========================================================================
+  /// Build the hierarchy for the beam block of the (CRDoubleMatrix)
+  /// matrix_pt(), then form and factorise the Schur complement of the
+  /// remaining dofs
+  //=========================================================================
+  inline void HermiteBeamMultigridPreconditioner::setup()
+  {
+    clean_up_memory();
+
+    CRDoubleMatrix* cr_matrix_pt = dynamic_cast<CRDoubleMatrix*>(matrix_pt());
+    if (cr_matrix_pt == 0)
+    {
+      throw OomphLibError(
+        "HermiteBeamMultigridPreconditioner requires a CRDoubleMatrix",
+        OOMPH_CURRENT_FUNCTION,
+        OOMPH_EXCEPTION_LOCATION);
+    }
+    const unsigned n_dof = cr_matrix_pt->nrow();
+
+    // Fine-level nodes (sorted by Lagrangian coordinate); their dofs are
+    // labelled by global equation numbers for now
+    const unsigned n_mesh = Beam_mesh_pt.size();
+    Vector<Vector<LevelNode>> nodes(n_mesh);
+    std::vector<bool> is_beam_dof(n_dof, false);
+    for (unsigned m = 0; m < n_mesh; m++)
+    {
+      const unsigned n_node = Beam_mesh_pt[m]->nnode();
+      nodes[m].resize(n_node);
+      for (unsigned j = 0; j < n_node; j++)
+      {
+        SolidNode* nod_pt = Beam_mesh_pt[m]->node_pt(j);
+        LevelNode& level_node = nodes[m][j];
+        level_node.Xi = nod_pt->xi(0);
+        level_node.Sigma =
+          (nod_pt->nlagrangian_type() > 1) ? nod_pt->xi_gen(1, 0) : 0.0;
+        for (unsigned i = 0; i < 2; i++)
+        {
+          for (unsigned k = 0; k < 2; k++)
+          {
+            const int eqn = nod_pt->position_eqn_number(k, i);
+            level_node.Dof[2 * i + k] = eqn;
+            if (eqn >= 0) is_beam_dof[eqn] = true;
+          }
+        }
+      }
+      std::sort(nodes[m].begin(),
+                nodes[m].end(),
+                [](const LevelNode& a, const LevelNode& b)
+                { return a.Xi < b.Xi; });
+
+      // Fall back to element half-lengths if there are no Lagrangian
+      // slope coordinates
+      for (unsigned j = 0; j < n_node; j++)
+      {
+        if (nodes[m][j].Sigma == 0.0)
+        {
+          const double h_left =
+            (j > 0) ? nodes[m][j].Xi - nodes[m][j - 1].Xi : 0.0;
+          const double h_right =
+            (j + 1 < n_node) ? nodes[m][j + 1].Xi - nodes[m][j].Xi : 0.0;
+          nodes[m][j].Sigma = 0.25 * (h_left + h_right);
+          if (j == 0 || j + 1 == n_node) nodes[m][j].Sigma *= 2.0;
+        }
+      }
+    }
+
+    // Number the beam and the remaining dofs separately (in the order of
+    // their global equation numbers)
+    Vector<int> block_index(n_dof, -1);
+    for (unsigned i = 0; i < n_dof; i++)
+    {
+      if (is_beam_dof[i])
+      {
+        block_index[i] = Beam_dof.size();
+        Beam_dof.push_back(i);
+      }
+      else
+      {
+        block_index[i] = Other_dof.size();
+        Other_dof.push_back(i);
+      }
+    }
+    const unsigned n_beam = Beam_dof.size();
+    const unsigned n_other = Other_dof.size();
+    for (unsigned m = 0; m < n_mesh; m++)
+    {
+      const unsigned n_node = nodes[m].size();
+      for (unsigned j = 0; j < n_node; j++)
+      {
+        for (unsigned d = 0; d < 4; d++)
+        {
+          const int eqn = nodes[m][j].Dof[d];
+          if (eqn >= 0) nodes[m][j].Dof[d] = block_index[eqn];
+        }
+      }
+    }
+
+    // Split the matrix into the beam block (the fine-level operator), the
+    // two coupling blocks and the block of the remaining dofs, which
+    // initialises the Schur complement
+    {
+      LevelMatrix fine;
+      fine.Nrow = n_beam;
+      fine.Ncol = n_beam;
+      fine.Row_start.push_back(0);
+      Beam_other_block.Nrow = n_beam;
+      Beam_other_block.Ncol = n_other;
+      Beam_other_block.Row_start.push_back(0);
+      Other_beam_block.Nrow = n_other;
+      Other_beam_block.Ncol = n_beam;
+      Other_beam_block.Row_start.push_back(0);
+      if (n_other > 0)
+      {
+        Schur_complement_lu.build(n_other, n_other - 1, n_other - 1);
+      }
+
+      const int* row_start = cr_matrix_pt->row_start();
+      const int* column_index = cr_matrix_pt->column_index();
+      const double* value = cr_matrix_pt->value();
+      for (unsigned i = 0; i < n_dof; i++)
+      {
+        for (int k = row_start[i]; k < row_start[i + 1]; k++)
+        {
+          const unsigned j = unsigned(column_index[k]);
+          const unsigned block_j = unsigned(block_index[j]);
+          if (is_beam_dof[i] && is_beam_dof[j])
+          {
+            fine.Column_index.push_back(block_j);
+            fine.Value.push_back(value[k]);
+          }
+          else if (is_beam_dof[i])
+          {
+            Beam_other_block.Column_index.push_back(block_j);
+            Beam_other_block.Value.push_back(value[k]);
+          }
+          else if (is_beam_dof[j])
+          {
+            Other_beam_block.Column_index.push_back(block_j);
+            Other_beam_block.Value.push_back(value[k]);
+          }
+          else
+          {
+            Schur_complement_lu.entry(block_index[i], block_j) += value[k];
+          }
+        }
+        if (is_beam_dof[i])
+        {
+          fine.Row_start.push_back(fine.Column_index.size());
+          Beam_other_block.Row_start.push_back(
+            Beam_other_block.Column_index.size());
+        }
+        else
+        {
+          Other_beam_block.Row_start.push_back(
+            Other_beam_block.Column_index.size());
+        }
+      }
+      Level_matrix.push_back(fine);
+    }
+
+    // Coarsen
+    unsigned n_level_dof = n_beam;
+    const unsigned min_nelement = std::max(Min_nelement_coarsest, 1u);
+    while (Level_matrix.size() < Max_nlevel)
+    {
+      // Which meshes can be coarsened?
+      std::vector<bool> coarsen(n_mesh, false);
+      bool coarsen_any = false;
+      for (unsigned m = 0; m < n_mesh; m++)
+      {
+        const unsigned n_element = nodes[m].size() - 1;
+        if (n_element / 2 >= min_nelement)
+        {
+          coarsen[m] = true;
+          coarsen_any = true;
+        }
+      }
+      if (!coarsen_any) break;
+
+      // Build coarse nodes and number the coarse dofs. Merging pairs of
+      // elements removes every second node; with an odd number of
+      // elements the node before the last one goes too, so the last
+      // coarse element spans three fine ones.
+      Vector<Vector<LevelNode>> coarse_nodes(n_mesh);
+      Vector<Vector<int>> coarse_node_index(n_mesh);
+      unsigned n_coarse = 0;
+      for (unsigned m = 0; m < n_mesh; m++)
+      {
+        const unsigned n_node = nodes[m].size();
+        coarse_node_index[m].resize(n_node, -1);
+        Vector<unsigned> fine_node_index;
+        for (unsigned j = 0; j < n_node; j++)
+        {
+          const bool keep = (!coarsen[m]) || (j + 1 == n_node) ||
+                            ((j % 2 == 0) && (j + 2 < n_node));
+          if (!keep) continue;
+          LevelNode coarse_node = nodes[m][j];
+          for (unsigned d = 0; d < 4; d++)
+          {
+            coarse_node.Dof[d] =
+              (nodes[m][j].Dof[d] >= 0) ? int(n_coarse++) : -1;
+          }
+          coarse_node_index[m][j] = coarse_nodes[m].size();
+          coarse_nodes[m].push_back(coarse_node);
+          fine_node_index.push_back(j);
+        }
+
+        // Slope scaling on the coarse mesh
+        if (coarsen[m])
+        {
+          const unsigned n_coarse_node = coarse_nodes[m].size();
+          for (unsigned j = 0; j < n_coarse_node; j++)
+          {
+            // Scale the fine node's slope scaling by the ratio of the
+            // lengths of the adjacent coarse and fine elements
+            const unsigned j_fine = fine_node_index[j];
+            double coarse_length = 0.0;
+            double fine_length = 0.0;
+            if (j > 0)
+            {
+              coarse_length +=
+                coarse_nodes[m][j].Xi - coarse_nodes[m][j - 1].Xi;
+              fine_length += nodes[m][j_fine].Xi - nodes[m][j_fine - 1].Xi;
+            }
+            if (j + 1 < n_coarse_node)
+            {
+              coarse_length +=
+                coarse_nodes[m][j + 1].Xi - coarse_nodes[m][j].Xi;
+              fine_length += nodes[m][j_fine + 1].Xi - nodes[m][j_fine].Xi;
+            }
+            coarse_nodes[m][j].Sigma =
+              nodes[m][j_fine].Sigma * coarse_length / fine_length;
+          }
+        }
+      }
+
+      // Prolongation, restriction and Galerkin coarse operator
+      LevelMatrix prolongation;
+      build_prolongation(nodes,
+                         coarse_nodes,
+                         coarse_node_index,
+                         n_level_dof,
+                         n_coarse,
+                         prolongation);
+      LevelMatrix restriction;
+      prolongation.get_transpose(restriction);
+      LevelMatrix a_p;
+      Level_matrix.back().multiply(prolongation, a_p);
+      LevelMatrix coarse_matrix;
+      restriction.multiply(a_p, coarse_matrix);
+
+      Prolongation.push_back(prolongation);
+      Restriction.push_back(restriction);
+      Level_matrix.push_back(coarse_matrix);
+
+      // Move down a level
+      nodes = coarse_nodes;
+      n_level_dof = n_coarse;
+    }
+
+    // Factorise the coarsest operator
+    const LevelMatrix& coarsest = Level_matrix.back();
+    unsigned bandwidth = 0;
+    for (unsigned i = 0; i < coarsest.Nrow; i++)
+    {
+      for (unsigned k = coarsest.Row_start[i]; k < coarsest.Row_start[i + 1];
+           k++)
+      {
+        const unsigned j = coarsest.Column_index[k];
+        bandwidth = std::max(bandwidth, (i > j) ? i - j : j - i);
+      }
+    }
+    Coarsest_lu.build(coarsest.Nrow, bandwidth, bandwidth);
+    for (unsigned i = 0; i < coarsest.Nrow; i++)
+    {
+      for (unsigned k = coarsest.Row_start[i]; k < coarsest.Row_start[i + 1];
+           k++)
+      {
+        Coarsest_lu.entry(i, coarsest.Column_index[k]) += coarsest.Value[k];
+      }
+    }
+    Coarsest_lu.factorise();
+
+    // Schur complement S = A_oo - A_ob M_bb^{-1} A_bo, one column (and
+    // one V-cycle) per non-beam dof
+    if (n_other > 0)
+    {
+      LevelMatrix coupling_transpose;
+      Beam_other_block.get_transpose(coupling_transpose);
+      Beam_block_inverse_coupling.resize(n_other);
+      std::vector<double> column;
+      std::vector<double> a_ob_w;
+      for (unsigned q = 0; q < n_other; q++)
+      {
+        column.assign(n_beam, 0.0);
+        for (unsigned k = coupling_transpose.Row_start[q];
+             k < coupling_transpose.Row_start[q + 1];
+             k++)
+        {
+          column[coupling_transpose.Column_index[k]] =
+            coupling_transpose.Value[k];
+        }
+        std::vector<double>& w = Beam_block_inverse_coupling[q];
+        w.assign(n_beam, 0.0);
+        if (n_beam > 0) v_cycle(0, column, w);
+        Other_beam_block.multiply(w, a_ob_w);
+        for (unsigned p = 0; p < n_other; p++)
+        {
+          Schur_complement_lu.entry(p, q) -= a_ob_w[p];
+        }
+      }
+      Schur_complement_lu.factorise();
+    }
+
+    if (Doc_hierarchy)
+    {
+      oomph_info << "Hermite beam multigrid: " << nlevel() << " levels with";
+      for (unsigned l = 0; l < nlevel(); l++)
+      {
+        oomph_info << " " << Level_matrix[l].Nrow;
+      }
+      oomph_info << " dofs; Schur complement for " << n_other
+                 << " non-beam dofs" << std::endl;
+    }
+  }
+
+
+  //=========================================================================
+  /// Build prolongation by cubic Hermite interpolation (in the Lagrangian
+  /// coordinate) from the coarse to the fine nodes. The slope dofs are
+  /// x_gen(1,i) = sigma dx_i/dxi where sigma is the node's xi_gen(1,0).
+  //=========================================================================
+  inline void HermiteBeamMultigridPreconditioner::build_prolongation(
+    const Vector<Vector<LevelNode>>& fine_nodes,
+    const Vector<Vector<LevelNode>>& coarse_nodes,
+    const Vector<Vector<int>>& coarse_node_index,
+    const unsigned& n_fine,
+    const unsigned& n_coarse,
+    LevelMatrix& prolongation) const
+  {
+    // Assemble as (column, value) pairs per fine row
+    Vector<Vector<std::pair<unsigned, double>>> row_entries(n_fine);
+
+    const unsigned n_mesh = fine_nodes.size();
+    for (unsigned m = 0; m < n_mesh; m++)
+    {
+      // Coarse node to the left of the current fine node (the first
+      // node is never removed)
+      unsigned left_index = 0;
+      const unsigned n_node = fine_nodes[m].size();
+      for (unsigned j = 0; j < n_node; j++)
+      {
+        const LevelNode& fine = fine_nodes[m][j];
+
+        // Injection for nodes that persist on the coarse level
+        if (coarse_node_index[m][j] >= 0)
+        {
+          left_index = coarse_node_index[m][j];
+          const LevelNode& coarse = coarse_nodes[m][left_index];
+          for (unsigned i = 0; i < 2; i++)
+          {
+            // Position
+            if (fine.Dof[2 * i] >= 0 && coarse.Dof[2 * i] >= 0)
+            {
+              row_entries[fine.Dof[2 * i]].push_back(
+                std::make_pair(unsigned(coarse.Dof[2 * i]), 1.0));
+            }
+            // Slope
+            if (fine.Dof[2 * i + 1] >= 0 && coarse.Dof[2 * i + 1] >= 0)
+            {
+              row_entries[fine.Dof[2 * i + 1]].push_back(std::make_pair(
+                unsigned(coarse.Dof[2 * i + 1]), fine.Sigma / coarse.Sigma));
+            }
+          }
+          continue;
+        }
+
+        // Interpolation for nodes that are removed
+        const LevelNode& left = coarse_nodes[m][left_index];
+        const LevelNode& right = coarse_nodes[m][left_index + 1];
+        const double h = right.Xi - left.Xi;
+        const double t = (fine.Xi - left.Xi) / h;
+
+        // Cubic Hermite basis functions and their derivatives w.r.t. t
+        const double h00 = 2.0 * t * t * t - 3.0 * t * t + 1.0;
+        const double h10 = t * t * t - 2.0 * t * t + t;
+        const double h01 = -2.0 * t * t * t + 3.0 * t * t;
+        const double h11 = t * t * t - t * t;
+        const double dh00 = 6.0 * t * t - 6.0 * t;
+        const double dh10 = 3.0 * t * t - 4.0 * t + 1.0;
+        const double dh01 = -6.0 * t * t + 6.0 * t;
+        const double dh11 = 3.0 * t * t - 2.0 * t;
+
+        for (unsigned i = 0; i < 2; i++)
+        {
+          const int coarse_dof[4] = {left.Dof[2 * i],
+                                     left.Dof[2 * i + 1],
+                                     right.Dof[2 * i],
+                                     right.Dof[2 * i + 1]};
+
+          // Position: x = h00 x_l + h10 h x'_l + h01 x_r + h11 h x'_r
+          // with x' = slope dof / sigma
+          if (fine.Dof[2 * i] >= 0)
+          {
+            const double weight[4] = {
+              h00, h10 * h / left.Sigma, h01, h11 * h / right.Sigma};
+            for (unsigned c = 0; c < 4; c++)
+            {
+              if (coarse_dof[c] >= 0 && weight[c] != 0.0)
+              {
+                row_entries[fine.Dof[2 * i]].push_back(
+                  std::make_pair(unsigned(coarse_dof[c]), weight[c]));
+              }
+            }
+          }
+
+          // Slope: sigma_fine dx/dxi
+          if (fine.Dof[2 * i + 1] >= 0)
+          {
+            const double weight[4] = {fine.Sigma * dh00 / h,
+                                      fine.Sigma * dh10 / left.Sigma,
+                                      fine.Sigma * dh01 / h,
+                                      fine.Sigma * dh11 / right.Sigma};
+            for (unsigned c = 0; c < 4; c++)
+            {
+              if (coarse_dof[c] >= 0 && weight[c] != 0.0)
+              {
+                row_entries[fine.Dof[2 * i + 1]].push_back(
+                  std::make_pair(unsigned(coarse_dof[c]), weight[c]));
+              }
+            }
+          }
+        }
+      }
+    }
+
+    // Compress
+    prolongation.Nrow = n_fine;
+    prolongation.Ncol = n_coarse;
+    prolongation.Row_start.assign(n_fine + 1, 0);
+    prolongation.Column_index.clear();
+    prolongation.Value.clear();
+    for (unsigned i = 0; i < n_fine; i++)
+    {
+      const unsigned n_entry = row_entries[i].size();
+      for (unsigned k = 0; k < n_entry; k++)
+      {
+        prolongation.Column_index.push_back(row_entries[i][k].first);
+        prolongation.Value.push_back(row_entries[i][k].second);
+      }
+      prolongation.Row_start[i + 1] = prolongation.Column_index.size();
+    }
+  }
+
+
+  //=========================================================================
+  /// Gauss-Seidel sweep(s) on level l (forward or backward ordering).
+  /// Rows with zero diagonal are skipped.
+  //=========================================================================
+  inline void HermiteBeamMultigridPreconditioner::smooth(
+    const unsigned& l,
+    const std::vector<double>& b,
+    std::vector<double>& x,
+    const unsigned& n_sweep,
+    const bool& forward) const
+  {
+    const LevelMatrix& a = Level_matrix[l];
+    const unsigned n_row = a.Nrow;
+    for (unsigned sweep = 0; sweep < n_sweep; sweep++)
+    {
+      for (unsigned ii = 0; ii < n_row; ii++)
+      {
+        const unsigned i = forward ? ii : n_row - 1 - ii;
+        double sum = b[i];
+        double diag = 0.0;
+        for (unsigned k = a.Row_start[i]; k < a.Row_start[i + 1]; k++)
+        {
+          const unsigned j = a.Column_index[k];
+          if (j == i)
+          {
+            diag += a.Value[k];
+          }
+          else
+          {
+            sum -= a.Value[k] * x[j];
+          }
+        }
+        if (diag != 0.0)
+        {
+          x[i] = sum / diag;
+        }
+      }
+    }
+  }
+
+
+  //=========================================================================
+  /// Recursive V-cycle for A_l x = b (x is zero on entry)
+  //=========================================================================
+  inline void HermiteBeamMultigridPreconditioner::v_cycle(
+    const unsigned& l,
+    const std::vector<double>& b,
+    std::vector<double>& x) const
+  {
+    // Exact solve on the coarsest level
+    if (l + 1 == Level_matrix.size())
+    {
+      x = b;
+      if (!x.empty()) Coarsest_lu.solve(&x[0]);
+      return;
+    }
+
+    // Pre-smooth (forward sweeps)
+    smooth(l, b, x, Npre_smooth, true);
+
+    // Restrict the residual
+    std::vector<double> residual;
+    Level_matrix[l].multiply(x, residual);
+    const unsigned n_row = residual.size();
+    for (unsigned i = 0; i < n_row; i++)
+    {
+      residual[i] = b[i] - residual[i];
+    }
+    std::vector<double> coarse_rhs;
+    Restriction[l].multiply(residual, coarse_rhs);
+
+    // Coarse-grid correction
+    std::vector<double> coarse_x(coarse_rhs.size(), 0.0);
+    v_cycle(l + 1, coarse_rhs, coarse_x);
+    std::vector<double> correction;
+    Prolongation[l].multiply(coarse_x, correction);
+    for (unsigned i = 0; i < n_row; i++)
+    {
+      x[i] += correction[i];
+    }
+
+    // Post-smooth (backward sweeps, to keep the cycle symmetric)
+    smooth(l, b, x, Npost_smooth, false);
+  }
+
+
+  //=========================================================================
+  /// Apply the block factorisation to r:
+  ///   y_b = M_bb^{-1} r_b,
+  ///   z_o = S^{-1} (r_o - A_ob y_b),
+  ///   z_b = y_b - M_bb^{-1} A_bo z_o,
+  /// where M_bb^{-1} is one V-cycle from zero initial guess.
+  //=========================================================================
+  inline void HermiteBeamMultigridPreconditioner::preconditioner_solve(
+    const DoubleVector& r, DoubleVector& z)
+  {
+    const unsigned n_beam = Beam_dof.size();
+    const unsigned n_other = Other_dof.size();
+#ifdef PARANOID
+    if (n_beam + n_other != r.nrow())
+    {
+      throw OomphLibError("Matrix and residual vector have different sizes",
+                          OOMPH_CURRENT_FUNCTION,
+                          OOMPH_EXCEPTION_LOCATION);
+    }
+#endif
+    const double* r_pt = r.values_pt();
+
+    // Beam block
+    std::vector<double> b(n_beam);
+    for (unsigned i = 0; i < n_beam; i++)
+    {
+      b[i] = r_pt[Beam_dof[i]];
+    }
+    std::vector<double> x(n_beam, 0.0);
+    if (n_beam > 0) v_cycle(0, b, x);
+
+    // Schur complement solve for the remaining dofs and back-substitution
+    std::vector<double> x_other(n_other);
+    if (n_other > 0)
+    {
+      std::vector<double> a_ob_x;
+      Other_beam_block.multiply(x, a_ob_x);
+      for (unsigned p = 0; p < n_other; p++)
+      {
+        x_other[p] = r_pt[Other_dof[p]] - a_ob_x[p];
+      }
+      Schur_complement_lu.solve(&x_other[0]);
+      for (unsigned q = 0; q < n_other; q++)
+      {
+        const std::vector<double>& w = Beam_block_inverse_coupling[q];
+        for (unsigned i = 0; i < n_beam; i++)
+        {
+          x[i] -= w[i] * x_other[q];
+        }
+      }
+    }
+
+    if (!z.built())
+    {
+      z.build(r.distribution_pt(), 0.0);
+    }
+    double* z_pt = z.values_pt();
+    for (unsigned i = 0; i < n_beam; i++)
+    {
+      z_pt[Beam_dof[i]] = x[i];
+    }
+    for (unsigned p = 0; p < n_other; p++)
+    {
+      z_pt[Other_dof[p]] = x_other[p];
+    }
+  }
+
+
+  /////////////////////////////////////////////////////////////////////
+  /////////////////////////////////////////////////////////////////////
+  /////////////////////////////////////////////////////////////////////
+
+
+  //=========================================================================
+  /// Linearised responses to a batch of load cases about a reference
+  /// state. The Jacobian J is assembled and (band-)factorised once; each
+  /// load case contributes the right-hand side -(R_case - R_ref), where
+  /// R_ref are the residuals in the reference state and R_case those
+  /// with the load case applied; all right-hand sides are then solved for
+  /// together with blocked triangular solves. Usage:
+  ///
+  ///   batch.factorise();
+  ///   for (each load case) { apply load; batch.add_load_case();
+  ///                          remove load; }
+  ///   batch.solve();
+  ///   ... batch.response(c,i) ...
+  ///
+  /// The dofs must be numbered such that the Jacobian is banded (as for
+  /// 1D beam meshes).
+  //=========================================================================
+  class LinearisedLoadCaseBatch
+  {
+  public:
+    /// Constructor: Pass pointer to the problem
+    LinearisedLoadCaseBatch(Problem* problem_pt)
+      : Problem_pt(problem_pt),
+        Factorisation_time(0.0),
+        Solve_time(0.0),
+        Is_solved(false)
+    {
+    }
+
+    /// Broken copy constructor
+    LinearisedLoadCaseBatch(const LinearisedLoadCaseBatch& dummy) = delete;
+
+    /// Broken assignment operator
+    void operator=(const LinearisedLoadCaseBatch&) = delete;
+
+    /// Assemble the Jacobian and residuals in the current (reference)
+    /// state and factorise the Jacobian; wipes any load cases
+    void factorise()
+    {
+      double t_start = TimingHelpers::timer();
+      CRDoubleMatrix jacobian;
+      Problem_pt->get_jacobian(Reference_residuals, jacobian);
+      Lu.build(jacobian);
+      Lu.factorise();
+      Factorisation_time = TimingHelpers::timer() - t_start;
+      Rhs.clear();
+      Is_solved = false;
+    }
+
+    /// Add a load case: Its right-hand side is computed from the
+    /// residuals with the load case currently applied. Returns the
+    /// number of the load case.
+    unsigned add_load_case()
+    {
+      const unsigned n_dof = Lu.nrow();
+#ifdef PARANOID
+      if (Problem_pt->ndof() != n_dof)
+      {
+        throw OomphLibError(
+          "Number of dofs has changed since factorise() was called",
+          OOMPH_CURRENT_FUNCTION,
+          OOMPH_EXCEPTION_LOCATION);
+      }
+#endif
+      DoubleVector residuals;
+      Problem_pt->get_residuals(residuals);
+      Rhs.push_back(std::vector<double>(n_dof));
+      std::vector<double>& rhs = Rhs.back();
+      for (unsigned i = 0; i < n_dof; i++)
+      {
+        rhs[i] = -(residuals[i] - Reference_residuals[i]);
+      }
+      Is_solved = false;
+      return Rhs.size() - 1;
+    }
+
+    /// Number of load cases
+    unsigned nload_case() const
+    {
+      return Rhs.size();
+    }
+
+    /// Solve for the linearised responses to all load cases
+    void solve()
+    {
+      double t_start = TimingHelpers::timer();
+      const unsigned n_dof = Lu.nrow();
+      const unsigned n_case = Rhs.size();
+
+      // Pack row-wise, solve together and unpack
+      std::vector<double> block(n_dof * n_case);
+      for (unsigned c = 0; c < n_case; c++)
+      {
+        for (unsigned i = 0; i < n_dof; i++)
+        {
+          block[i * n_case + c] = Rhs[c][i];
+        }
+      }
+      if (n_case > 0)
+      {
+        Lu.solve(n_case, &block[0]);
+      }
+      for (unsigned c = 0; c < n_case; c++)
+      {
+        for (unsigned i = 0; i < n_dof; i++)
+        {
+          Rhs[c][i] = block[i * n_case + c];
+        }
+      }
+      Solve_time = TimingHelpers::timer() - t_start;
+      Is_solved = true;
+    }
+
+    /// Linearised change in the i-th dof in response to load case c
+    /// (after solve())
+    double response(const unsigned& c, const unsigned& i) const
+    {
+#ifdef PARANOID
+      if (!Is_solved)
+      {
+        throw OomphLibError("Responses haven't been computed; call solve()",
+                            OOMPH_CURRENT_FUNCTION,
+                            OOMPH_EXCEPTION_LOCATION);
+      }
+#endif
+      return Rhs[c][i];
+    }
+
+    /// Wall-clock time for assembly and factorisation of the Jacobian
+    double factorisation_time() const
+    {
+      return Factorisation_time;
+    }
+
+    /// Wall-clock time for the (blocked) solve of all load cases
+    double solve_time() const
+    {
+      return Solve_time;
+    }
+
+  private:
+    /// Pointer to the problem
+    Problem* Problem_pt;
+
+    /// Band-LU factorisation of the Jacobian in the reference state
+    BandedLUFactorisation Lu;
+
+    /// Residuals in the reference state
+    DoubleVector Reference_residuals;
+
+    /// Right-hand sides for the load cases (overwritten by the responses
+    /// in solve())
+    std::vector<std::vector<double>> Rhs;
+
+    /// Time for assembly and factorisation of the Jacobian
+    double Factorisation_time;
+
+    /// Time for the solve
+    double Solve_time;
+
+    /// Have the responses been computed?
+    bool Is_solved;
+  };
+
+} // namespace oomph
+
+#endif
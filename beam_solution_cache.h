@@ -0,0 +1,629 @@
+// LIC// ====================================================================
+// LIC// This file forms part of oomph-lib, the object-oriented,
+// LIC// multi-physics finite-element library, available
+// LIC// at http://www.oomph-lib.org.
+// LIC//
+// LIC// Copyright (C) 2006-2023 Matthias Heil and Andrew Hazel
+// LIC//
+// LIC// This library is free software; you can redistribute it and/or
+// LIC// modify it under the terms of the GNU Lesser General Public
+// LIC// License as published by the Free Software Foundation; either
+// LIC// version 2.1 of the License, or (at your option) any later version.
+// LIC//
+// LIC// This library is distributed in the hope that it will be useful,
+// LIC// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// LIC// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// LIC// Lesser General Public License for more details.
+// LIC//
+// LIC// You should have received a copy of the GNU Lesser General Public
+// LIC// License along with this library; if not, write to the Free Software
+// LIC// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+// LIC// 02110-1301  USA.
+// LIC//
+// LIC// The authors may be contacted at oomph-lib@maths.man.ac.uk.
+// LIC//
+// Persistent cache of converged beam solutions for warm starts
+
+#ifndef BEAM_SOLUTION_CACHE_HEADER
+#define BEAM_SOLUTION_CACHE_HEADER
+
+// OOMPH-LIB includes
+#include "generic.h"
+
+namespace oomph
+{
+  //=========================================================================
+  /// Persistent (on-disk) cache of converged solutions of the beam
+  /// problems, indexed by a vector of parameters (e.g. q, alpha and I).
+  /// Each entry contains the (Hermite) nodal positions and slopes of a
+  /// set of one-dimensional SolidMeshes (e.g. the arms of a boomerang),
+  /// parametrised by the nodes' Lagrangian coordinates, and the values of
+  /// a set of Data objects (e.g. the rigid body data). A new run can
+  /// then be seeded with the cached solution nearest to its parameters,
+  /// or with the linear interpolation in the last parameter (the
+  /// continuation parameter) between the nearest cached solutions that
+  /// bracket it and agree in the other parameters.
+  /// The cached shapes are interpolated at the Lagrangian coordinates of
+  /// the nodes of the target mesh, so the number (and distribution) of
+  /// the elements may differ from those of the cached solutions.
+  ///
+  /// The cache lives in an (existing) directory that contains one file
+  /// per entry and an index (index.dat) with one line per entry: the
+  /// parameters followed by the name of the file. Entries for the same
+  /// parameters are overwritten.
+  //=========================================================================
+  class BeamSolutionCache
+  {
+  public:
+    /// Constructor: Pass the directory and the scales of the parameters
+    /// (the distance between two sets of parameters is the Euclidean norm
+    /// of their difference divided, componentwise, by the scales).
+    /// Reads the index if it exists.
+    BeamSolutionCache(const std::string& directory,
+                      const Vector<double>& parameter_scale)
+      : Directory(directory), Parameter_scale(parameter_scale)
+    {
+      read_index();
+    }
+
+    /// Broken copy constructor
+    BeamSolutionCache(const BeamSolutionCache& dummy) = delete;
+
+    /// Broken assignment operator
+    void operator=(const BeamSolutionCache&) = delete;
+
+    /// Number of cached solutions
+    unsigned nentry() const
+    {
+      return Entry_parameters.size();
+    }
+
+    /// Add the current solution (nodal positions and slopes of the
+    /// meshes and the current values of the Data) to the cache
+    void store(const Vector<double>& parameters,
+               const Vector<SolidMesh*>& mesh_pt,
+               const Vector<Data*>& data_pt);
+
+    /// Seed the (unpinned) nodal positions and slopes of the meshes and
+    /// the (unpinned) values of the Data with the cached solution(s)
+    /// nearest to the given parameters. Returns false (and leaves
+    /// everything unchanged) if the cache is empty or its solutions
+    /// don't have the same number of meshes.
+    bool warm_start(const Vector<double>& parameters,
+                    const Vector<SolidMesh*>& mesh_pt,
+                    const Vector<Data*>& data_pt);
+
+  private:
+    /// The cached shape of one mesh
+    struct MeshShape
+    {
+      /// Lagrangian coordinates of the nodes
+      Vector<double> Xi;
+
+      /// Derivatives of the Lagrangian coordinates w.r.t. the local
+      /// coordinate (the Hermite slopes xi_gen(1,0))
+      Vector<double> Dxids;
+
+      /// Nodal positions
+      Vector<Vector<double>> X;
+
+      /// Derivatives of the nodal positions w.r.t. the local coordinate
+      /// (the Hermite slopes x_gen(1,i))
+      Vector<Vector<double>> Dxds;
+    };
+
+    /// A cached solution
+    struct Solution
+    {
+      /// Shapes of the meshes
+      Vector<MeshShape> Shape;
+
+      /// Values of the Data
+      Vector<Vector<double>> Data_values;
+    };
+
+    /// Read the index (if it exists)
+    void read_index();
+
+    /// Read a cached solution
+    void read_solution(const std::string& filename, Solution& solution);
+
+    /// Interpolate the cached shape of a mesh at the Lagrangian
+    /// coordinate xi: position and its derivative w.r.t. the Lagrangian
+    /// coordinate
+    void interpolate(const MeshShape& shape,
+                     const double& xi,
+                     Vector<double>& x,
+                     Vector<double>& dxdxi);
+
+    /// Distance between two sets of parameters
+    double distance(const Vector<double>& parameters1,
+                    const Vector<double>& parameters2) const
+    {
+      double d = 0.0;
+      unsigned n_parameter = Parameter_scale.size();
+      for (unsigned p = 0; p < n_parameter; p++)
+      {
+        double dp = (parameters1[p] - parameters2[p]) / Parameter_scale[p];
+        d += dp * dp;
+      }
+      return std::sqrt(d);
+    }
+
+    /// Hermite shape functions (and their derivatives w.r.t. the local
+    /// coordinate s in [-1,1]) of the left/right node's value and slope
+    static void hermite_shape(const double& s, double psi[4], double dpsi[4])
+    {
+      psi[0] = 0.25 * (s * s * s - 3.0 * s + 2.0);
+      psi[1] = 0.25 * (s * s * s - s * s - s + 1.0);
+      psi[2] = 0.25 * (-s * s * s + 3.0 * s + 2.0);
+      psi[3] = 0.25 * (s * s * s + s * s - s - 1.0);
+      dpsi[0] = 0.25 * (3.0 * s * s - 3.0);
+      dpsi[1] = 0.25 * (3.0 * s * s - 2.0 * s - 1.0);
+      dpsi[2] = 0.25 * (-3.0 * s * s + 3.0);
+      dpsi[3] = 0.25 * (3.0 * s * s + 2.0 * s - 1.0);
+    }
+
+    /// Directory of the cache
+    std::string Directory;
+
+    /// Scales of the parameters
+    Vector<double> Parameter_scale;
+
+    /// Parameters of the entries
+    Vector<Vector<double>> Entry_parameters;
+
+    /// Files containing the entries (relative to the directory)
+    Vector<std::string> Entry_filename;
+  };
+
+
+  //=========================================================================
+  /// Read the index, keeping the last entry for each file
+  //=========================================================================
+  inline void BeamSolutionCache::read_index()
+  {
+    Entry_parameters.clear();
+    Entry_filename.clear();
+    std::ifstream index_file((Directory + "/index.dat").c_str());
+    unsigned n_parameter = Parameter_scale.size();
+    std::string line;
+    while (getline(index_file, line))
+    {
+      std::istringstream line_stream(line);
+      Vector<double> parameters(n_parameter);
+      for (unsigned p = 0; p < n_parameter; p++)
+      {
+        line_stream >> parameters[p];
+      }
+      std::string filename;
+      line_stream >> filename;
+      if (!line_stream)
+      {
+        continue;
+      }
+      unsigned n_entry = Entry_filename.size();
+      unsigned e = 0;
+      while ((e < n_entry) && (Entry_filename[e] != filename))
+      {
+        e++;
+      }
+      if (e == n_entry)
+      {
+        Entry_parameters.push_back(parameters);
+        Entry_filename.push_back(filename);
+      }
+      else
+      {
+        Entry_parameters[e] = parameters;
+      }
+    }
+  }
+
+
+  //=========================================================================
+  /// Write the current solution to a file and add it to the index
+  //=========================================================================
+  inline void BeamSolutionCache::store(const Vector<double>& parameters,
+                                       const Vector<SolidMesh*>& mesh_pt,
+                                       const Vector<Data*>& data_pt)
+  {
+    // File name from the parameters
+    std::ostringstream filename;
+    filename << "solution";
+    unsigned n_parameter = parameters.size();
+    for (unsigned p = 0; p < n_parameter; p++)
+    {
+      filename << "_" << std::setprecision(10) << parameters[p];
+    }
+    filename << ".dat";
+
+    std::ofstream solution_file((Directory + "/" + filename.str()).c_str());
+    if (!solution_file)
+    {
+      std::ostringstream error_message;
+      error_message << "Couldn't write to the solution cache in " << Directory
+                    << std::endl;
+      throw OomphLibError(error_message.str(),
+                          OOMPH_CURRENT_FUNCTION,
+                          OOMPH_EXCEPTION_LOCATION);
+    }
+    solution_file << std::setprecision(17);
+
+    // Nodes of each mesh: xi, dxi/ds, then the positions and their slopes
+    unsigned n_mesh = mesh_pt.size();
+    solution_file << n_mesh << std::endl;
+    for (unsigned m = 0; m < n_mesh; m++)
+    {
+      unsigned n_node = mesh_pt[m]->nnode();
+      unsigned n_dim = mesh_pt[m]->node_pt(0)->ndim();
+      solution_file << n_node << " " << n_dim << std::endl;
+      for (unsigned j = 0; j < n_node; j++)
+      {
+        SolidNode* nod_pt = mesh_pt[m]->node_pt(j);
+        solution_file << nod_pt->xi(0) << " " << nod_pt->xi_gen(1, 0);
+        for (unsigned i = 0; i < n_dim; i++)
+        {
+          solution_file << " " << nod_pt->x_gen(0, i);
+        }
+        for (unsigned i = 0; i < n_dim; i++)
+        {
+          solution_file << " " << nod_pt->x_gen(1, i);
+        }
+        solution_file << std::endl;
+      }
+    }
+
+    // Data
+    unsigned n_data = data_pt.size();
+    solution_file << n_data << std::endl;
+    for (unsigned d = 0; d < n_data; d++)
+    {
+      unsigned n_value = data_pt[d]->nvalue();
+      solution_file << n_value;
+      for (unsigned i = 0; i < n_value; i++)
+      {
+        solution_file << " " << data_pt[d]->value(i);
+      }
+      solution_file << std::endl;
+    }
+    solution_file.close();
+
+    // Add to the index
+    std::ofstream index_file((Directory + "/index.dat").c_str(),
+                             std::ios_base::app);
+    index_file << std::setprecision(17);
+    for (unsigned p = 0; p < n_parameter; p++)
+    {
+      index_file << parameters[p] << " ";
+    }
+    index_file << filename.str() << std::endl;
+    index_file.close();
+
+    // Update our copy of the index
+    unsigned n_entry = Entry_filename.size();
+    unsigned e = 0;
+    while ((e < n_entry) && (Entry_filename[e] != filename.str()))
+    {
+      e++;
+    }
+    if (e == n_entry)
+    {
+      Entry_parameters.push_back(parameters);
+      Entry_filename.push_back(filename.str());
+    }
+    else
+    {
+      Entry_parameters[e] = parameters;
+    }
+  }
+
+
+  //=========================================================================
+  /// Read a cached solution
+  //=========================================================================
+  inline void BeamSolutionCache::read_solution(const std::string& filename,
+                                               Solution& solution)
+  {
+    std::ifstream solution_file((Directory + "/" + filename).c_str());
+    unsigned n_mesh = 0;
+    solution_file >> n_mesh;
+    solution.Shape.resize(n_mesh);
+    bool too_few_nodes = false;
+    for (unsigned m = 0; m < n_mesh; m++)
+    {
+      MeshShape& shape = solution.Shape[m];
+      unsigned n_node = 0;
+      unsigned n_dim = 0;
+      solution_file >> n_node >> n_dim;
+      shape.Xi.resize(n_node);
+      shape.Dxids.resize(n_node);
+      shape.X.assign(n_node, Vector<double>(n_dim));
+      shape.Dxds.assign(n_node, Vector<double>(n_dim));
+      for (unsigned j = 0; j < n_node; j++)
+      {
+        solution_file >> shape.Xi[j] >> shape.Dxids[j];
+        for (unsigned i = 0; i < n_dim; i++)
+        {
+          solution_file >> shape.X[j][i];
+        }
+        for (unsigned i = 0; i < n_dim; i++)
+        {
+          solution_file >> shape.Dxds[j][i];
+        }
+      }
+      if (n_node < 2)
+      {
+        too_few_nodes = true;
+      }
+    }
+    unsigned n_data = 0;
+    solution_file >> n_data;
+    solution.Data_values.resize(n_data);
+    for (unsigned d = 0; d < n_data; d++)
+    {
+      unsigned n_value = 0;
+      solution_file >> n_value;
+      solution.Data_values[d].resize(n_value);
+      for (unsigned i = 0; i < n_value; i++)
+      {
+        solution_file >> solution.Data_values[d][i];
+      }
+    }
+    if ((!solution_file) || too_few_nodes)
+    {
+      std::ostringstream error_message;
+      error_message << "Couldn't read the cached solution " << Directory << "/"
+                    << filename << std::endl;
+      throw OomphLibError(error_message.str(),
+                          OOMPH_CURRENT_FUNCTION,
+                          OOMPH_EXCEPTION_LOCATION);
+    }
+  }
+
+
+  //=========================================================================
+  /// Locate the Lagrangian coordinate in the cached solution (bisection
+  /// over the nodes, then Newton iteration for the local coordinate of
+  /// the Hermite-interpolated Lagrangian coordinate) and interpolate
+  //=========================================================================
+  inline void BeamSolutionCache::interpolate(const MeshShape& shape,
+                                             const double& xi,
+                                             Vector<double>& x,
+                                             Vector<double>& dxdxi)
+  {
+    unsigned n_element = shape.Xi.size() - 1;
+    unsigned e_low = 0;
+    unsigned e_high = n_element - 1;
+    while (e_low < e_high)
+    {
+      unsigned e_mid = (e_low + e_high + 1) / 2;
+      if (shape.Xi[e_mid] <= xi)
+      {
+        e_low = e_mid;
+      }
+      else
+      {
+        e_high = e_mid - 1;
+      }
+    }
+    unsigned e = e_low;
+
+    double psi[4];
+    double dpsi[4];
+    double xi_left = shape.Xi[e];
+    double xi_right = shape.Xi[e + 1];
+    double s = -1.0 + 2.0 * (xi - xi_left) / (xi_right - xi_left);
+    if (s < -1.0) s = -1.0;
+    if (s > 1.0) s = 1.0;
+    double dxids = 0.0;
+    for (unsigned iter = 0; iter < 20; iter++)
+    {
+      hermite_shape(s, psi, dpsi);
+      double residual = xi_left * psi[0] + shape.Dxids[e] * psi[1] +
+                        xi_right * psi[2] + shape.Dxids[e + 1] * psi[3] -
+                        xi;
+      dxids = xi_left * dpsi[0] + shape.Dxids[e] * dpsi[1] +
+              xi_right * dpsi[2] + shape.Dxids[e + 1] * dpsi[3];
+      double ds = -residual / dxids;
+      s += ds;
+      if (s < -1.0) s = -1.0;
+      if (s > 1.0) s = 1.0;
+      if (std::fabs(ds) < 1.0e-14) break;
+    }
+    hermite_shape(s, psi, dpsi);
+    dxids = xi_left * dpsi[0] + shape.Dxids[e] * dpsi[1] +
+            xi_right * dpsi[2] + shape.Dxids[e + 1] * dpsi[3];
+
+    unsigned n_dim = shape.X[0].size();
+    x.resize(n_dim);
+    dxdxi.resize(n_dim);
+    for (unsigned i = 0; i < n_dim; i++)
+    {
+      x[i] = shape.X[e][i] * psi[0] + shape.Dxds[e][i] * psi[1] +
+             shape.X[e + 1][i] * psi[2] + shape.Dxds[e + 1][i] * psi[3];
+      dxdxi[i] =
+        (shape.X[e][i] * dpsi[0] + shape.Dxds[e][i] * dpsi[1] +
+         shape.X[e + 1][i] * dpsi[2] + shape.Dxds[e + 1][i] * dpsi[3]) /
+        dxids;
+    }
+  }
+
+
+  //=========================================================================
+  /// Seed the mesh and the Data with the nearest cached solution(s)
+  //=========================================================================
+  inline bool BeamSolutionCache::warm_start(const Vector<double>& parameters,
+                                            const Vector<SolidMesh*>& mesh_pt,
+                                            const Vector<Data*>& data_pt)
+  {
+    unsigned n_entry = Entry_parameters.size();
+    if (n_entry == 0)
+    {
+      return false;
+    }
+
+    // Nearest entry
+    unsigned nearest = 0;
+    for (unsigned e = 1; e < n_entry; e++)
+    {
+      if (distance(Entry_parameters[e], parameters) <
+          distance(Entry_parameters[nearest], parameters))
+      {
+        nearest = e;
+      }
+    }
+
+    // Nearest entries below and above in the last parameter that agree
+    // with the nearest one in the others
+    unsigned n_parameter = Parameter_scale.size();
+    unsigned last = n_parameter - 1;
+    int below = -1;
+    int above = -1;
+    for (unsigned e = 0; e < n_entry; e++)
+    {
+      Vector<double> other_parameters(Entry_parameters[e]);
+      other_parameters[last] = Entry_parameters[nearest][last];
+      if (distance(other_parameters, Entry_parameters[nearest]) > 1.0e-10)
+      {
+        continue;
+      }
+      double p = Entry_parameters[e][last];
+      if ((p <= parameters[last]) &&
+          ((below < 0) || (p > Entry_parameters[below][last])))
+      {
+        below = e;
+      }
+      if ((p > parameters[last]) &&
+          ((above < 0) || (p < Entry_parameters[above][last])))
+      {
+        above = e;
+      }
+    }
+
+    // Cached solution(s) to be used and their weights
+    Vector<unsigned> entry(1, nearest);
+    Vector<double> weight(1, 1.0);
+    if ((below >= 0) && (above >= 0))
+    {
+      double p_below = Entry_parameters[below][last];
+      double p_above = Entry_parameters[above][last];
+      double w = (parameters[last] - p_below) / (p_above - p_below);
+      entry.resize(2);
+      weight.resize(2);
+      entry[0] = below;
+      entry[1] = above;
+      weight[0] = 1.0 - w;
+      weight[1] = w;
+    }
+    else if (below >= 0)
+    {
+      entry[0] = below;
+    }
+    else if (above >= 0)
+    {
+      entry[0] = above;
+    }
+
+    // Read them
+    unsigned n_used = entry.size();
+    Vector<Solution> solution(n_used);
+    for (unsigned k = 0; k < n_used; k++)
+    {
+      read_solution(Entry_filename[entry[k]], solution[k]);
+      oomph_info << "Warm start from cached solution "
+                 << Entry_filename[entry[k]] << " (weight " << weight[k]
+                 << ")" << std::endl;
+    }
+
+    // The cached solutions must contain the same meshes
+    unsigned n_mesh = mesh_pt.size();
+    for (unsigned k = 0; k < n_used; k++)
+    {
+      if (solution[k].Shape.size() != n_mesh)
+      {
+        oomph_info << "Warning: Cached solution " << Entry_filename[entry[k]]
+                   << " has " << solution[k].Shape.size()
+                   << " meshes rather than " << n_mesh << "; no warm start"
+                   << std::endl;
+        return false;
+      }
+    }
+
+    // Interpolate the positions and slopes (w.r.t. the Lagrangian
+    // coordinate) at the nodes of the meshes
+    for (unsigned m = 0; m < n_mesh; m++)
+    {
+      unsigned n_node = mesh_pt[m]->nnode();
+      unsigned n_dim = mesh_pt[m]->node_pt(0)->ndim();
+      Vector<double> x(n_dim);
+      Vector<double> dxdxi(n_dim);
+      for (unsigned j = 0; j < n_node; j++)
+      {
+        SolidNode* nod_pt = mesh_pt[m]->node_pt(j);
+        Vector<double> x_blend(n_dim, 0.0);
+        Vector<double> dxdxi_blend(n_dim, 0.0);
+        for (unsigned k = 0; k < n_used; k++)
+        {
+          interpolate(solution[k].Shape[m], nod_pt->xi(0), x, dxdxi);
+          for (unsigned i = 0; i < n_dim; i++)
+          {
+            x_blend[i] += weight[k] * x[i];
+            dxdxi_blend[i] += weight[k] * dxdxi[i];
+          }
+        }
+        for (unsigned i = 0; i < n_dim; i++)
+        {
+          if (!nod_pt->position_is_pinned(0, i))
+          {
+            nod_pt->x_gen(0, i) = x_blend[i];
+          }
+          if ((nod_pt->nposition_type() > 1) &&
+              (!nod_pt->position_is_pinned(1, i)))
+          {
+            nod_pt->x_gen(1, i) = dxdxi_blend[i] * nod_pt->xi_gen(1, 0);
+          }
+        }
+      }
+    }
+
+    // Data (if compatible)
+    unsigned n_data = data_pt.size();
+    for (unsigned d = 0; d < n_data; d++)
+    {
+      unsigned n_value = data_pt[d]->nvalue();
+      bool compatible = true;
+      for (unsigned k = 0; k < n_used; k++)
+      {
+        if ((solution[k].Data_values.size() != n_data) ||
+            (solution[k].Data_values[d].size() != n_value))
+        {
+          compatible = false;
+        }
+      }
+      if (!compatible)
+      {
+        oomph_info << "Warning: Data " << d
+                   << " doesn't match the cached solution; not seeded"
+                   << std::endl;
+        continue;
+      }
+      for (unsigned i = 0; i < n_value; i++)
+      {
+        if (!data_pt[d]->is_pinned(i))
+        {
+          double value = 0.0;
+          for (unsigned k = 0; k < n_used; k++)
+          {
+            value += weight[k] * solution[k].Data_values[d][i];
+          }
+          data_pt[d]->set_value(i, value);
+        }
+      }
+    }
+    return true;
+  }
+
+} // namespace oomph
+
+#endif
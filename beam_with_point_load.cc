@@ -30,13 +30,27 @@
 #include "beam.h"
 #include "meshes/one_d_lagrangian_mesh.h"
 
+// Local includes
+#include "beam_preconditioners.h"
+#include "dual_number.h"
+
 using namespace std;
 
 using namespace oomph;
 
 
 //========= start_of_point_load_wrapper==============================
-/// Class to impose point load to (wrapped) beam element
+/// Class to impose point loads to (wrapped) beam element. Each load
+/// can combine a "dead" part (fixed Cartesian components), a follower
+/// part whose components are specified w.r.t. the local (unit) tangent 
+/// and normal vectors (and therefore rotate with the beam) and a point 
+/// moment (work conjugate to the local rotation of the tangent). 
+/// The loads are stored as structure-of-arrays, sorted by their local
+/// coordinate, and all of them are evaluated in a single pass over the 
+/// element's table. The Jacobian contributions of the 
+/// displacement-dependent loads are assembled analytically or, 
+/// optionally, by forward-mode automatic differentiation of the 
+/// (templated) residuals.
 //=====================================================================
 template<class ELEMENT> 
 class BeamPointLoadElement : public virtual ELEMENT
@@ -45,7 +59,8 @@ class BeamPointLoadElement : public virtual ELEMENT
 public:
 
  /// Constructor
- BeamPointLoadElement()
+ BeamPointLoadElement() : Include_point_load(true),
+                          Use_automatic_differentiation(false)
   {
   }
  
@@ -53,15 +68,77 @@ public:
  ~BeamPointLoadElement(){}
 
 
- /// Set local coordinate and magnitude of point load
+ /// Set local coordinate and magnitude of a single (dead) point load;
+ /// wipes any previously assigned loads
  // include "bending" term too and tidy up terminology);
  // also pass pointers rather than actual values.
  void setup(const Vector<double>& s_point_load,
             const Vector<double>& point_load)
   {
-   S_point_load=s_point_load;
-   Point_load=point_load;
+   clear_point_loads();
+   Vector<double> no_follower_load;
+   add_point_load(s_point_load[0],point_load,no_follower_load,0.0);
+  }
+
+ /// Wipe all point loads
+ void clear_point_loads()
+  {
+   S_point_load.clear();
+   Dead_load_x.clear();
+   Dead_load_y.clear();
+   Follower_load_tangential.clear();
+   Follower_load_normal.clear();
+   Point_moment.clear();
+  }
+
+ /// Add a point load at local coordinate s: dead load (Cartesian
+ /// components), follower load (tangential and normal components,
+ /// w.r.t. the local unit tangent t and normal n=(-t[1],t[0])) and
+ /// point moment. Empty vectors indicate that there's no dead/follower
+ /// load. Loads should be added in order of increasing s (as done by
+ /// BeamPointLoadManager) though this is not essential.
+ void add_point_load(const double& s,
+                     const Vector<double>& dead_load,
+                     const Vector<double>& follower_load,
+                     const double& point_moment)
+  {
+   S_point_load.push_back(s);
+   if (dead_load.size()==0)
+    {
+     Dead_load_x.push_back(0.0);
+     Dead_load_y.push_back(0.0);
+    }
+   else
+    {
+     Dead_load_x.push_back(dead_load[0]);
+     Dead_load_y.push_back(dead_load[1]);
+    }
+   if (follower_load.size()==0)
+    {
+     Follower_load_tangential.push_back(0.0);
+     Follower_load_normal.push_back(0.0);
+    }
+   else
+    {
+     Follower_load_tangential.push_back(follower_load[0]);
+     Follower_load_normal.push_back(follower_load[1]);
+    }
+   Point_moment.push_back(point_moment);
   }
+
+ /// Number of point loads acting on this element
+ unsigned npoint_load() const {return S_point_load.size();}
+
+ /// Compute the point loads' contribution to the Jacobian by
+ /// automatic differentiation rather than from the hand-coded
+ /// derivatives
+ void enable_automatic_differentiation()
+  {Use_automatic_differentiation=true;}
+
+ /// Compute the point loads' contribution to the Jacobian from the 
+ /// hand-coded derivatives (default)
+ void disable_automatic_differentiation()
+  {Use_automatic_differentiation=false;}
  
  
  /// Add the element's contribution to its residual vector (wrapper)
@@ -71,7 +148,12 @@ public:
    ELEMENT::fill_in_contribution_to_residuals(residuals);
 
    // Add point load contribution
-   fill_in_point_load_contribution_to_residuals(residuals);
+   if (Include_point_load)
+    {
+     fill_in_generic_point_load_contribution(residuals,
+                                             GeneralisedElement::Dummy_matrix,
+                                             0);
+    }
   }
 
  
@@ -81,27 +163,52 @@ public:
  void fill_in_contribution_to_jacobian(Vector<double> &residuals,
                                        DenseMatrix<double> &jacobian)
   {
-   //Call the generic routine
+   // Call the generic routine. The wrapped element may finite-difference
+   // its (full, i.e. virtual) residuals so exclude the point load there;
+   // its contribution to the Jacobian is added analytically below.
+   Include_point_load=false;
    ELEMENT::fill_in_contribution_to_jacobian(residuals,
                                              jacobian);
+   Include_point_load=true;
 
-   // Add point load contribution (doesn't (currently) depend
-   // on displacements hierher think about this in fsi context)
-   fill_in_point_load_contribution_to_residuals(residuals);
+   // Add point load contribution
+   if (Use_automatic_differentiation)
+    {
+     fill_in_point_load_contribution_by_automatic_differentiation(residuals,
+                                                                  jacobian);
+    }
+   else
+    {
+     fill_in_generic_point_load_contribution(residuals,jacobian,1);
+    }
   }
  
 
 private:
 
  
- /// Add the point load contribution to the residual vector
- void fill_in_point_load_contribution_to_residuals(Vector<double> &residuals)
+ /// Add the point load contributions to the residual vector and, if 
+ /// flag=1, the Jacobian matrix. Contributions from all loads are
+ /// accumulated in local (dense) arrays and scattered once.
+ void fill_in_generic_point_load_contribution(Vector<double> &residuals,
+                                              DenseMatrix<double> &jacobian,
+                                              const unsigned& flag)
   {
    // No further action
-   if (S_point_load.size()==0) return;
+   const unsigned n_load = S_point_load.size();
+   if (n_load==0) return;
    
    // Set the dimension of the global coordinates
    const unsigned n_dim = this->Undeformed_beam_pt->ndim();
+
+#ifdef PARANOID
+   if (n_dim!=2)
+    {
+     throw OomphLibError("Point loads only work in 2D",
+                         OOMPH_CURRENT_FUNCTION,
+                         OOMPH_EXCEPTION_LOCATION);
+    }
+#endif
    
    // Set the number of lagrangian coordinates
    const unsigned n_lagrangian = this->Undeformed_beam_pt->nlagrangian();
@@ -111,12 +218,9 @@ private:
    
    // Find out how many positional dofs there are
    const unsigned n_position_type = this->nnodal_position_type();
-   
-   // Integer to store the local equation number
-   int local_eqn = 0;
-   
-   // Set up memory for the shape functions and derivs.
-   // hierher do we need all of these?
+
+   // Number of shape functions
+   const unsigned n_shape = n_node*n_position_type;
    
    // # of nodes, # of positional dofs
    Shape psi(n_node, n_position_type);
@@ -126,30 +230,153 @@ private:
    
    // # of nodes, # of positional dofs, # of derivs)
    DShape d2psidxi(n_node, n_position_type, n_lagrangian);
+
+   // Local coordinate
+   Vector<double> s(1);
+
+   // Accumulated residuals and derivatives w.r.t. the generalised nodal
+   // positions, indexed by (shape fct)*2+(coordinate direction)
+   Vector<double> local_residuals(2*n_shape,0.0);
+   DenseMatrix<double> local_jacobian;
+   if (flag) local_jacobian.resize(2*n_shape,2*n_shape,0.0);
    
-   // Get shape functions and derivatives
-   double J = this->d2shape_lagrangian(S_point_load, psi, dpsidxi, d2psidxi);
-   
-   
-   // Loop over the number of nodes
-   for (unsigned n = 0; n < n_node; n++)
+   // Single pass over the element's load table
+   for (unsigned p=0;p<n_load;p++)
     {
-     // Loop over the type of degree of freedom
-     for (unsigned k = 0; k < n_position_type; k++)
+     // Get shape functions and derivatives
+     s[0]=S_point_load[p];
+     this->d2shape_lagrangian(s, psi, dpsidxi, d2psidxi);
+
+     const double f_t=Follower_load_tangential[p];
+     const double f_n=Follower_load_normal[p];
+     const double moment=Point_moment[p];
+     const bool follower=((f_t!=0.0)||(f_n!=0.0));
+
+     // Total force: dead load plus follower load
+     double force[2]={Dead_load_x[p],Dead_load_y[p]};
+
+     // Derivative of the rotation angle of the tangent w.r.t. a=dR/dxi 
+     // (the point moment is work-conjugate to this angle): dtheta/da=n/|a|,
+     // and derivatives of force and dtheta/da w.r.t. a
+     double dthetada[2]={0.0,0.0};
+     double dforceda[2][2]={{0.0,0.0},{0.0,0.0}};
+     double d2thetada2[2][2]={{0.0,0.0},{0.0,0.0}};
+     if (follower||(moment!=0.0))
       {
-       // Loop over the coordinate directions
-       for (unsigned i = 0; i < n_dim; i++)
+       // Tangent vector a=dR/dxi
+       double a[2]={0.0,0.0};
+       for (unsigned n=0;n<n_node;n++)
+        {
+         for (unsigned k=0;k<n_position_type;k++)
+          {
+           a[0]+=this->nodal_position_gen(n,k,0)*dpsidxi(n,k,0);
+           a[1]+=this->nodal_position_gen(n,k,1)*dpsidxi(n,k,0);
+          }
+        }
+       const double a_norm=sqrt(a[0]*a[0]+a[1]*a[1]);
+       const double t[2]={a[0]/a_norm,a[1]/a_norm};
+       const double normal[2]={-t[1],t[0]};
+       
+       for (unsigned i=0;i<2;i++)
+        {
+         force[i]+=f_t*t[i]+f_n*normal[i];
+         dthetada[i]=normal[i]/a_norm;
+        }
+
+       if (flag)
+        {
+         // dt_i/da_j = (delta_ij - t_i t_j)/|a|; n = (-t_1, t_0)
+         double dtda[2][2];
+         for (unsigned i=0;i<2;i++)
+          {
+           for (unsigned j=0;j<2;j++)
+            {
+             dtda[i][j]=(double(i==j)-t[i]*t[j])/a_norm;
+            }
+          }
+         for (unsigned j=0;j<2;j++)
+          {
+           dforceda[0][j]=f_t*dtda[0][j]-f_n*dtda[1][j];
+           dforceda[1][j]=f_t*dtda[1][j]+f_n*dtda[0][j];
+          }
+
+         const double a_norm4=a_norm*a_norm*a_norm*a_norm;
+         d2thetada2[0][0]=2.0*a[0]*a[1]/a_norm4;
+         d2thetada2[0][1]=(a[1]*a[1]-a[0]*a[0])/a_norm4;
+         d2thetada2[1][0]=d2thetada2[0][1];
+         d2thetada2[1][1]=-d2thetada2[0][0];
+        }
+      }
+
+     // Accumulate
+     for (unsigned n=0;n<n_node;n++)
+      {
+       for (unsigned k=0;k<n_position_type;k++)
+        {
+         const unsigned row=n*n_position_type+k;
+         const double psi_row=psi(n,k);
+         const double dpsi_row=dpsidxi(n,k,0);
+         for (unsigned i=0;i<2;i++)
+          {
+           local_residuals[2*row+i]+=
+            force[i]*psi_row+moment*dthetada[i]*dpsi_row;
+
+           if (flag&&(follower||(moment!=0.0)))
+            {
+             for (unsigned m=0;m<n_node;m++)
+              {
+               for (unsigned l=0;l<n_position_type;l++)
+                {
+                 const unsigned col=m*n_position_type+l;
+                 const double dpsi_col=dpsidxi(m,l,0);
+                 for (unsigned j=0;j<2;j++)
+                  {
+                   local_jacobian(2*row+i,2*col+j)+=
+                    (dforceda[i][j]*psi_row+
+                     moment*d2thetada2[i][j]*dpsi_row)*dpsi_col;
+                  }
+                }
+              }
+            }
+          }
+        }
+      }
+    } // end of loop over loads
+
+   // Scatter
+   for (unsigned n=0;n<n_node;n++)
+    {
+     for (unsigned k=0;k<n_position_type;k++)
+      {
+       const unsigned row=n*n_position_type+k;
+       for (unsigned i=0;i<2;i++)
         {
          // Find the equation number
-         local_eqn = this->position_local_eqn(n, k, i);
-         
+         int local_eqn=this->position_local_eqn(n,k,i);
+
          // If it's not a boundary condition
-         if (local_eqn >= 0)
+         if (local_eqn>=0)
           {
-           // Point load
-           residuals[local_eqn] += Point_load[i]*psi(n,k);
-
-           oomph_info << "adding "  << Point_load[i]*psi(n,k) << std::endl;
+           residuals[local_eqn]+=local_residuals[2*row+i];
+           if (flag)
+            {
+             for (unsigned m=0;m<n_node;m++)
+              {
+               for (unsigned l=0;l<n_position_type;l++)
+                {
+                 const unsigned col=m*n_position_type+l;
+                 for (unsigned j=0;j<2;j++)
+                  {
+                   int local_unknown=this->position_local_eqn(m,l,j);
+                   if (local_unknown>=0)
+                    {
+                     jacobian(local_eqn,local_unknown)+=
+                      local_jacobian(2*row+i,2*col+j);
+                    }
+                  }
+                }
+              }
+            }
           }
         }
       }
@@ -157,11 +384,426 @@ private:
    
   }
  
- /// Local coordinates of point at which point load is applied
+ /// Point load contributions to the residuals (indexed by
+ /// (shape fct)*2+(coordinate direction)) for given generalised nodal
+ /// positions x_gen (indexed in the same way). Templated on the scalar
+ /// type so it can be differentiated automatically.
+ template<class SCALAR>
+ void get_point_load_residuals(const Vector<SCALAR>& x_gen,
+                               Vector<SCALAR>& local_residuals)
+  {
+   const unsigned n_load = S_point_load.size();
+   const unsigned n_lagrangian = this->Undeformed_beam_pt->nlagrangian();
+   const unsigned n_node = this->nnode();
+   const unsigned n_position_type = this->nnodal_position_type();
+   Shape psi(n_node, n_position_type);
+   DShape dpsidxi(n_node, n_position_type, n_lagrangian);
+   DShape d2psidxi(n_node, n_position_type, n_lagrangian);
+   Vector<double> s(1);
+   for (unsigned p=0;p<n_load;p++)
+    {
+     s[0]=S_point_load[p];
+     this->d2shape_lagrangian(s, psi, dpsidxi, d2psidxi);
+
+     const double f_t=Follower_load_tangential[p];
+     const double f_n=Follower_load_normal[p];
+     const double moment=Point_moment[p];
+
+     // Total force and derivative of the rotation angle of the tangent
+     // w.r.t. a=dR/dxi
+     SCALAR force[2]={Dead_load_x[p],Dead_load_y[p]};
+     SCALAR dthetada[2]={0.0,0.0};
+     if ((f_t!=0.0)||(f_n!=0.0)||(moment!=0.0))
+      {
+       SCALAR a[2]={0.0,0.0};
+       for (unsigned n=0;n<n_node;n++)
+        {
+         for (unsigned k=0;k<n_position_type;k++)
+          {
+           const unsigned row=n*n_position_type+k;
+           a[0]+=x_gen[2*row]*dpsidxi(n,k,0);
+           a[1]+=x_gen[2*row+1]*dpsidxi(n,k,0);
+          }
+        }
+       const SCALAR a_norm=sqrt(a[0]*a[0]+a[1]*a[1]);
+       const SCALAR t[2]={a[0]/a_norm,a[1]/a_norm};
+       const SCALAR normal[2]={-t[1],t[0]};
+       for (unsigned i=0;i<2;i++)
+        {
+         force[i]+=f_t*t[i]+f_n*normal[i];
+         dthetada[i]=normal[i]/a_norm;
+        }
+      }
+
+     for (unsigned n=0;n<n_node;n++)
+      {
+       for (unsigned k=0;k<n_position_type;k++)
+        {
+         const unsigned row=n*n_position_type+k;
+         for (unsigned i=0;i<2;i++)
+          {
+           local_residuals[2*row+i]+=
+            force[i]*psi(n,k)+moment*dthetada[i]*dpsidxi(n,k,0);
+          }
+        }
+      }
+    }
+  }
+
+
+ /// Add the point load contributions to the residual vector and the
+ /// Jacobian matrix, obtained by forward-mode automatic differentiation
+ /// of get_point_load_residuals(...) in a single pass (all eight 
+ /// generalised nodal positions are seeded simultaneously)
+ void fill_in_point_load_contribution_by_automatic_differentiation(
+  Vector<double> &residuals, DenseMatrix<double> &jacobian)
+  {
+   // No further action
+   if (S_point_load.size()==0) return;
+
+   const unsigned n_node = this->nnode();
+   const unsigned n_position_type = this->nnodal_position_type();
+
+#ifdef PARANOID
+   if ((this->Undeformed_beam_pt->ndim()!=2)||
+       (2*n_node*n_position_type!=8))
+    {
+     throw OomphLibError(
+      "Automatic differentiation only implemented for 2D Hermite elements",
+      OOMPH_CURRENT_FUNCTION,
+      OOMPH_EXCEPTION_LOCATION);
+    }
+#endif
+
+   // Seed the generalised nodal positions
+   Vector<DualNumber<8> > x_gen(8);
+   for (unsigned n=0;n<n_node;n++)
+    {
+     for (unsigned k=0;k<n_position_type;k++)
+      {
+       const unsigned row=n*n_position_type+k;
+       for (unsigned i=0;i<2;i++)
+        {
+         x_gen[2*row+i]=
+          DualNumber<8>(this->nodal_position_gen(n,k,i),2*row+i);
+        }
+      }
+    }
+
+   // Residuals and their derivatives
+   Vector<DualNumber<8> > local_residuals(8);
+   get_point_load_residuals(x_gen,local_residuals);
+
+   // Scatter
+   for (unsigned n=0;n<n_node;n++)
+    {
+     for (unsigned k=0;k<n_position_type;k++)
+      {
+       const unsigned row=n*n_position_type+k;
+       for (unsigned i=0;i<2;i++)
+        {
+         int local_eqn=this->position_local_eqn(n,k,i);
+         if (local_eqn>=0)
+          {
+           residuals[local_eqn]+=local_residuals[2*row+i].value();
+           for (unsigned m=0;m<n_node;m++)
+            {
+             for (unsigned l=0;l<n_position_type;l++)
+              {
+               const unsigned col=m*n_position_type+l;
+               for (unsigned j=0;j<2;j++)
+                {
+                 int local_unknown=this->position_local_eqn(m,l,j);
+                 if (local_unknown>=0)
+                  {
+                   jacobian(local_eqn,local_unknown)+=
+                    local_residuals[2*row+i].derivative(2*col+j);
+                  }
+                }
+              }
+            }
+          }
+        }
+      }
+    }
+  }
+
+ /// Local coordinates of the points at which the loads are applied
  Vector<double> S_point_load;
 
- /// Magnitude of point load
- Vector<double> Point_load;
+ /// x-components of the dead loads
+ Vector<double> Dead_load_x;
+
+ /// y-components of the dead loads
+ Vector<double> Dead_load_y;
+
+ /// Tangential components of the follower loads
+ Vector<double> Follower_load_tangential;
+
+ /// Normal components of the follower loads
+ Vector<double> Follower_load_normal;
+
+ /// Point moments
+ Vector<double> Point_moment;
+
+ /// Include the point load in fill_in_contribution_to_residuals(...)?
+ /// Temporarily disabled while the wrapped element computes its Jacobian
+ bool Include_point_load;
+
+ /// Use automatic differentiation for the point loads' contribution to
+ /// the Jacobian?
+ bool Use_automatic_differentiation;
+
+ };
+
+
+
+//========= start_of_point_load_manager==============================
+/// Class that distributes point loads, specified in terms of the
+/// Lagrangian coordinate, to the BeamPointLoadElements in a 
+/// OneDLagrangianMesh. The owning elements are located once (by 
+/// sorting the loads and sweeping through the elements) and each
+/// element receives its loads as a compact table, sorted by local 
+/// coordinate.
+//=====================================================================
+template<class ELEMENT> 
+class BeamPointLoadManager
+{
+
+public:
+
+ /// Constructor: Pass the mesh of BeamPointLoadElement<ELEMENT>s
+ /// (elements must be ordered by increasing Lagrangian coordinate, as
+ /// in a OneDLagrangianMesh)
+ BeamPointLoadManager(SolidMesh* mesh_pt) : Mesh_pt(mesh_pt)
+  {}
+
+ /// Broken copy constructor
+ BeamPointLoadManager(const BeamPointLoadManager& dummy) = delete;
+
+ /// Broken assignment operator
+ void operator=(const BeamPointLoadManager&) = delete;
+
+ /// Add point load at Lagrangian coordinate xi: dead load (Cartesian
+ /// components), follower load (tangential and normal components)
+ /// and point moment; empty vectors indicate no dead/follower load.
+ /// Returns the index of the load. Loads only take effect after
+ /// calling assign_point_loads().
+ unsigned add_point_load(const double& xi,
+                         const Vector<double>& dead_load,
+                         const Vector<double>& follower_load,
+                         const double& point_moment)
+  {
+   Xi.push_back(xi);
+   Dead_load.push_back(dead_load);
+   Follower_load.push_back(follower_load);
+   Point_moment.push_back(point_moment);
+   return Xi.size()-1;
+  }
+
+ /// Number of point loads
+ unsigned npoint_load() const {return Xi.size();}
+
+ /// Lagrangian coordinate of i-th load (use move_point_load(...) to
+ /// change it once the loads have been assigned)
+ double xi(const unsigned& i) const {return Xi[i];}
+
+ /// Dead load (Cartesian components) of i-th load. Note: Changes to
+ /// the load (here and below) only take effect after the next call to
+ /// assign_point_loads()
+ Vector<double>& dead_load(const unsigned& i) {return Dead_load[i];}
+
+ /// Follower load (tangential and normal components) of i-th load
+ Vector<double>& follower_load(const unsigned& i) {return Follower_load[i];}
+
+ /// Point moment of i-th load
+ double& point_moment(const unsigned& i) {return Point_moment[i];}
+
+ /// Element that contains the i-th load (after assign_point_loads())
+ BeamPointLoadElement<ELEMENT>* element_pt(const unsigned& i) 
+  {
+   return dynamic_cast<BeamPointLoadElement<ELEMENT>*>(
+    Mesh_pt->element_pt(Element_index[i]));
+  }
+
+ /// Local coordinate of the i-th load in its element (after 
+ /// assign_point_loads())
+ double s(const unsigned& i) {return S[i];}
+
+ /// Locate the elements that contain the loads and pass each element
+ /// its (sorted) table of loads
+ void assign_point_loads()
+  {
+   const unsigned n_load=Xi.size();
+   const unsigned n_element=Mesh_pt->nelement();
+
+   // Wipe existing loads
+   for (unsigned e=0;e<n_element;e++)
+    {
+     dynamic_cast<BeamPointLoadElement<ELEMENT>*>(Mesh_pt->element_pt(e))
+      ->clear_point_loads();
+    }
+   Element_index.resize(n_load);
+   S.resize(n_load);
+   Element_load_index.clear();
+   Element_load_index.resize(n_element);
+   if (n_load==0) return;
+
+   // Sort loads by Lagrangian coordinate
+   Vector<unsigned> order(n_load);
+   for (unsigned i=0;i<n_load;i++) order[i]=i;
+   std::sort(order.begin(),order.end(),
+             [this](const unsigned& i, const unsigned& j)
+             {return Xi[i]<Xi[j];});
+
+   // Sweep through the elements and loads simultaneously (each
+   // search starts from the element that contains the previous load)
+   unsigned e=0;
+   for (unsigned ii=0;ii<n_load;ii++)
+    {
+     const unsigned i=order[ii];
+     locate(Xi[i],e,S[i]);
+     Element_index[i]=e;
+     Element_load_index[e].push_back(i);
+    }
+
+   // Pass the tables to the elements
+   for (unsigned e=0;e<n_element;e++)
+    {
+     if (Element_load_index[e].size()!=0) rebuild_element_table(e);
+    }
+  }
+
+ /// Move the i-th load to Lagrangian coordinate new_xi, handing it over
+ /// to a different element if required; only the tables of the 
+ /// affected element(s) are rebuilt. The load stays on the beam: new_xi
+ /// is clamped to the Lagrangian coordinates of its ends. Requires a
+ /// previous call to assign_point_loads().
+ void move_point_load(const unsigned& i, const double& new_xi)
+  {
+#ifdef PARANOID
+   if (Element_index.size()!=Xi.size())
+    {
+     throw OomphLibError(
+      "Loads haven't been assigned; call assign_point_loads() first",
+      OOMPH_CURRENT_FUNCTION,
+      OOMPH_EXCEPTION_LOCATION);
+    }
+#endif
+   const unsigned n_element=Mesh_pt->nelement();
+   FiniteElement* last_el_pt=Mesh_pt->finite_element_pt(n_element-1);
+   const double xi_min=dynamic_cast<SolidNode*>(
+    Mesh_pt->finite_element_pt(0)->node_pt(0))->xi(0);
+   const double xi_max=dynamic_cast<SolidNode*>(
+    last_el_pt->node_pt(last_el_pt->nnode()-1))->xi(0);
+   Xi[i]=std::min(std::max(new_xi,xi_min),xi_max);
+
+   // Remove from the current element's table
+   const unsigned e_old=Element_index[i];
+   Vector<unsigned>& old_index=Element_load_index[e_old];
+   old_index.erase(std::find(old_index.begin(),old_index.end(),i));
+
+   // Locate (searching from the current element) and insert into the
+   // new element's table, retaining the order
+   unsigned e_new=e_old;
+   locate(Xi[i],e_new,S[i]);
+   Element_index[i]=e_new;
+   Vector<unsigned>& new_index=Element_load_index[e_new];
+   Vector<unsigned>::iterator it=new_index.begin();
+   while ((it!=new_index.end())&&(S[*it]<S[i])) it++;
+   new_index.insert(it,i);
+
+   rebuild_element_table(e_old);
+   if (e_new!=e_old) rebuild_element_table(e_new);
+  }
+
+private:
+
+ /// Mesh of BeamPointLoadElement<ELEMENT>s
+ SolidMesh* Mesh_pt;
+
+ /// Lagrangian coordinates of the loads
+ Vector<double> Xi;
+
+ /// Dead loads
+ Vector<Vector<double> > Dead_load;
+
+ /// Follower loads
+ Vector<Vector<double> > Follower_load;
+
+ /// Point moments
+ Vector<double> Point_moment;
+
+ /// Find the element e and local coordinate s that contain the 
+ /// Lagrangian coordinate xi; the search starts from the element e
+ /// that's passed in
+ void locate(const double& xi, unsigned& e, double& s)
+  {
+   const unsigned n_element=Mesh_pt->nelement();
+
+   // Walk left or right until we've found the element
+   while (e>0)
+    {
+     SolidNode* left_nod_pt=dynamic_cast<SolidNode*>(
+      Mesh_pt->finite_element_pt(e)->node_pt(0));
+     if (xi>=left_nod_pt->xi(0)) break;
+     e--;
+    }
+   while (e+1<n_element)
+    {
+     FiniteElement* el_pt=Mesh_pt->finite_element_pt(e);
+     SolidNode* right_nod_pt=
+      dynamic_cast<SolidNode*>(el_pt->node_pt(el_pt->nnode()-1));
+     if (xi<=right_nod_pt->xi(0)) break;
+     e++;
+    }
+   FiniteElement* el_pt=Mesh_pt->finite_element_pt(e);
+
+   // Local coordinate: Start from the affine approximation
+   SolidNode* left_nod_pt=dynamic_cast<SolidNode*>(el_pt->node_pt(0));
+   SolidNode* right_nod_pt=
+    dynamic_cast<SolidNode*>(el_pt->node_pt(el_pt->nnode()-1));
+   Vector<double> s_local(1);
+   s_local[0]=-1.0+2.0*(xi-left_nod_pt->xi(0))/
+    (right_nod_pt->xi(0)-left_nod_pt->xi(0));
+   Vector<double> zeta(1,xi);
+   GeomObject* geom_obj_pt=0;
+   el_pt->locate_zeta(zeta,geom_obj_pt,s_local,true);
+   if (geom_obj_pt==0)
+    {
+     std::ostringstream error_message;
+     error_message << "Point load at xi = " << xi
+                   << " is not located in the mesh" << std::endl;
+     throw OomphLibError(error_message.str(),
+                         OOMPH_CURRENT_FUNCTION,
+                         OOMPH_EXCEPTION_LOCATION);
+    }
+   s=s_local[0];
+  }
+
+ /// Pass element e its (sorted) table of loads
+ void rebuild_element_table(const unsigned& e)
+  {
+   BeamPointLoadElement<ELEMENT>* el_pt=
+    dynamic_cast<BeamPointLoadElement<ELEMENT>*>(Mesh_pt->element_pt(e));
+   el_pt->clear_point_loads();
+   const unsigned n=Element_load_index[e].size();
+   for (unsigned k=0;k<n;k++)
+    {
+     const unsigned i=Element_load_index[e][k];
+     el_pt->add_point_load(S[i],Dead_load[i],Follower_load[i],
+                           Point_moment[i]);
+    }
+  }
+
+ /// Index of the elements that contain the loads
+ Vector<unsigned> Element_index;
+
+ /// Indices of the loads in each element, sorted by local coordinate
+ Vector<Vector<unsigned> > Element_load_index;
+
+ /// Local coordinates of the loads in their elements
+ Vector<double> S;
 
  };
 
@@ -231,6 +873,45 @@ namespace Global_Physical_Variables
  /// Locatino of point load
  Vector<double> S_point_load{0.5};
 
+ /// Lagrangian coordinate of the point load: Initialised from 
+ /// S_point_load (in the middle element) when the problem is built;
+ /// can then be used as a continuation parameter
+ double Xi_point_load=0.0;
+
+ /// Final value of Xi_point_load for the continuation in the
+ /// position of the point load (as a fraction of the beam's length)
+ double Xi_point_load_end_fraction=0.9;
+
+ /// Initial arclength increment for the continuation in the
+ /// position of the point load
+ double Ds_point_load=0.1;
+
+ /// Number of (equally spaced) point load cases for the linearised
+ /// load case study (0: no study)
+ unsigned N_load_case=0;
+
+ /// Magnitude of the (transverse, dead) point load in each load case
+ double Load_case_point_load=1.0e-4;
+
+ /// Pressure increment for the (additional) pressure load case
+ double Load_case_pressure_increment=1.0e-4;
+
+ /// Follower point load (tangential and normal components), 
+ /// applied at the same point
+ Vector<double> Follower_point_load{0.0,0.0};
+
+ /// Point moment, applied at the same point
+ double Point_moment=0.0;
+
+ /// Number of additional, equally spaced follower point loads that 
+ /// (in total) approximate a distributed normal load of magnitude
+ /// Point_load_array_pressure
+ unsigned N_point_load_array=0;
+
+ /// Magnitude of the distributed load approximated by the array of
+ /// point loads
+ double Point_load_array_pressure=0.0;
+
 
 
 } // end of namespace
@@ -248,6 +929,59 @@ public:
  
  /// Conduct a parameter study
  void parameter_study();
+
+ /// Slide the point load along the beam, using arc-length continuation
+ /// in its Lagrangian coordinate
+ void slide_point_load();
+
+ /// Linearised responses to many load cases about the current state
+ void linearised_load_case_study();
+
+ /// Check the Jacobian (with the point loads' contributions from the
+ /// hand-coded derivatives or by automatic differentiation) against the
+ /// finite-difference Jacobian of the residuals in the current state:
+ /// throw an error if they differ by more than tol times the max. entry
+ void check_jacobian(const double& tol=1.0e-5)
+  {
+   DoubleVector residuals;
+   DenseDoubleMatrix jacobian;
+   get_jacobian(residuals,jacobian);
+   unsigned n_dof=ndof();
+   DenseMatrix<double> fd_jacobian(n_dof,n_dof,0.0);
+   get_fd_jacobian(residuals,fd_jacobian);
+   double diff=0.0;
+   double scale=0.0;
+   for (unsigned i=0;i<n_dof;i++)
+    {
+     for (unsigned j=0;j<n_dof;j++)
+      {
+       diff=std::max(diff,std::fabs(jacobian(i,j)-fd_jacobian(i,j)));
+       scale=std::max(scale,std::fabs(fd_jacobian(i,j)));
+      }
+    }
+   oomph_info << "Jacobian vs finite differencing: max. difference " 
+              << diff << " (max. entry " << scale << ")" << std::endl;
+   if (diff>tol*scale)
+    {
+     std::ostringstream error_message;
+     error_message << "Jacobian differs from the finite-difference one: "
+                   << "max. difference " << diff << " for max. entry "
+                   << scale << std::endl;
+     throw OomphLibError(error_message.str(),
+                         OOMPH_CURRENT_FUNCTION,
+                         OOMPH_EXCEPTION_LOCATION);
+    }
+  }
+
+ /// Move the point load if its position has been changed
+ void actions_after_change_in_global_parameter(double* const& parameter_pt)
+  {
+   if (parameter_pt==&Global_Physical_Variables::Xi_point_load)
+    {
+     Point_load_manager_pt->move_point_load(
+      0,Global_Physical_Variables::Xi_point_load);
+    }
+  }
  
  /// Return pointer to the mesh
  OneDLagrangianMesh<BeamPointLoadElement<HermiteBeamElement>>* mesh_pt() 
@@ -271,6 +1005,49 @@ private:
  /// Pointer to geometric object that represents the beam's undeformed shape
  GeomObject* Undef_beam_pt;
 
+ /// Point load manager
+ BeamPointLoadManager<HermiteBeamElement>* Point_load_manager_pt;
+
+ /// Index of the (zero by default) "probe" load in the point load manager
+ /// that's used to apply the load cases in linearised_load_case_study()
+ unsigned Probe_load_index;
+
+ /// Apply (apply=true) or remove load case c of the linearised load case
+ /// study: c < N_load_case are the transverse point loads (applied via 
+ /// the probe load at Lagrangian coordinate xi_case), c = N_load_case
+ /// is the pressure increment
+ void set_load_case(const unsigned& c, const double& xi_case,
+                    const bool& apply)
+  {
+   if (c<Global_Physical_Variables::N_load_case)
+    {
+     if (apply)
+      {
+       Point_load_manager_pt->dead_load(Probe_load_index)[1]=
+        Global_Physical_Variables::Load_case_point_load;
+       Point_load_manager_pt->move_point_load(Probe_load_index,xi_case);
+      }
+     else
+      {
+       Point_load_manager_pt->dead_load(Probe_load_index)[1]=0.0;
+       Point_load_manager_pt->move_point_load(Probe_load_index,0.5*Length);
+      }
+    }
+   else
+    {
+     if (apply)
+      {
+       Global_Physical_Variables::P_ext+=
+        Global_Physical_Variables::Load_case_pressure_increment;
+      }
+     else
+      {
+       Global_Physical_Variables::P_ext-=
+        Global_Physical_Variables::Load_case_pressure_increment;
+      }
+    }
+  }
+
 }; // end of problem class
 
 
@@ -324,6 +1101,13 @@ ElasticBeamProblem::ElasticBeamProblem(const unsigned &n_elem,
 
    // Set the undeformed shape for each element
    elem_pt->undeformed_beam_pt() = Undef_beam_pt;
+
+   // Differentiate the point loads automatically?
+   if (CommandLineArgs::command_line_flag_has_been_set(
+        "--automatic_differentiation"))
+    {
+     elem_pt->enable_automatic_differentiation();
+    }
   } // end of loop over elements
 
  // Choose node at which displacement is documented (halfway along -- provided
@@ -339,19 +1123,63 @@ ElasticBeamProblem::ElasticBeamProblem(const unsigned &n_elem,
  Doc_node_pt=mesh_pt()->node_pt((n_nod+1)/2-1);
 
 
- // Apply point load to middle element
+ // Apply point load to middle element: Specified in terms of the 
+ // local coordinate there, so convert to Lagrangian coordinate
  unsigned e_middle=unsigned(double(n_element)*0.5);
  BeamPointLoadElement<HermiteBeamElement>* middle_elem_pt =
   dynamic_cast<BeamPointLoadElement<HermiteBeamElement>*>(
    mesh_pt()->element_pt(e_middle));
+ Global_Physical_Variables::Xi_point_load=
+  middle_elem_pt->interpolated_xi(Global_Physical_Variables::S_point_load,0);
+ Point_load_manager_pt=
+  new BeamPointLoadManager<HermiteBeamElement>(mesh_pt());
+ Point_load_manager_pt->add_point_load(
+  Global_Physical_Variables::Xi_point_load,
+  Global_Physical_Variables::Point_load,
+  Global_Physical_Variables::Follower_point_load,
+  Global_Physical_Variables::Point_moment);
+
+ // Array of equally spaced follower loads (one per segment of equal 
+ // length, applied at the segment's midpoint)
+ unsigned n_array=Global_Physical_Variables::N_point_load_array;
+ Vector<double> no_dead_load;
+ Vector<double> follower_load(2,0.0);
+ if (n_array>0)
+  {
+   follower_load[1]=-Global_Physical_Variables::Point_load_array_pressure*
+    Length/double(n_array);
+  }
+ for (unsigned j=0;j<n_array;j++)
+  {
+   Point_load_manager_pt->add_point_load((double(j)+0.5)*Length/
+                                         double(n_array),
+                                         no_dead_load,follower_load,0.0);
+  }
+
+ // Probe load for the linearised load case study: Zero, for now
+ Vector<double> zero_load(2,0.0);
+ Probe_load_index=Point_load_manager_pt->add_point_load(
+  0.5*Length,zero_load,Vector<double>(),0.0);
 
- // hierher rewrite to pointers!
- middle_elem_pt->setup(Global_Physical_Variables::S_point_load,
-                       Global_Physical_Variables::Point_load);
+ // Locate the loads and pass them to the elements
+ Point_load_manager_pt->assign_point_loads();
                         
  // Assign the global and local equation numbers
  cout << "# of dofs " << assign_eqn_numbers() << std::endl;
 
+ // Use GMRES, preconditioned by geometric multigrid?
+ if (CommandLineArgs::command_line_flag_has_been_set("--multigrid"))
+  {
+   HermiteBeamMultigridPreconditioner* prec_pt=
+    new HermiteBeamMultigridPreconditioner;
+   prec_pt->set_beam_meshes(Vector<SolidMesh*>(1,mesh_pt()));
+   prec_pt->enable_doc_hierarchy();
+
+   GMRES<CRDoubleMatrix>* solver_pt=new GMRES<CRDoubleMatrix>;
+   solver_pt->preconditioner_pt()=prec_pt;
+   linear_solver_pt()=solver_pt;
+  }
+
 } // end of constructor
 
 
@@ -440,11 +1268,273 @@ void ElasticBeamProblem::parameter_study()
  
 } // end of parameter study
 
+//=======start_of_slide_point_load========================================
+/// Slide the point load (load 0 in the point load manager) along the
+/// beam, using arc-length continuation in its Lagrangian coordinate. 
+/// Each step starts from the previous converged solution; the load is
+/// handed over between elements in actions_after_change_in_global_parameter()
+/// The sliding stops at the end of the specified range (within [0,L]):
+/// the final step is re-solved with the load at the end, and a step that
+/// fails (e.g. because the load can't be located) ends the sliding at
+/// the previous position.
+//=========================================================================
+void ElasticBeamProblem::slide_point_load()
+{
+ // Open a trace file
+ ofstream trace("RESLT/trace_slide_point_load.dat");
+ trace << "VARIABLES=\"x_i_l_o_a_d\",\"x\",\"y\"" << std::endl;
+
+ // Output file stream used for writing results
+ ofstream file;
+
+ // String used for the filename
+ char filename[100]; 
+ 
+ double xi_end=
+  std::min(Global_Physical_Variables::Xi_point_load_end_fraction,1.0)*Length;
+ double ds=Global_Physical_Variables::Ds_point_load;
+ unsigned max_step=1000;
+ DoubleVector dofs_backup;
+ for (unsigned i=0;i<max_step;i++)
+  {
+   // Backup
+   get_dofs(dofs_backup);
+   double xi_backup=Global_Physical_Variables::Xi_point_load;
+
+   // Take a step; at the end of the range, clamp the load there and
+   // re-solve
+   bool done=false;
+   try
+    {
+     ds=arc_length_step_solve(&Global_Physical_Variables::Xi_point_load,ds);
+     if ((Global_Physical_Variables::Xi_point_load<0.0)||
+         (Global_Physical_Variables::Xi_point_load>xi_end))
+      {
+       Global_Physical_Variables::Xi_point_load=std::min(
+        std::max(Global_Physical_Variables::Xi_point_load,0.0),xi_end);
+       Point_load_manager_pt->move_point_load(
+        0,Global_Physical_Variables::Xi_point_load);
+       newton_solve();
+       done=true;
+      }
+    }
+   catch (OomphLibError&)
+    {
+     oomph_info << "Sliding the point load failed beyond xi = "
+                << xi_backup << "; stopping there" << std::endl;
+     Global_Physical_Variables::Xi_point_load=xi_backup;
+     Point_load_manager_pt->move_point_load(0,xi_backup);
+     set_dofs(dofs_backup);
+     break;
+    }
+
+   // Position of the beam at the load
+   BeamPointLoadElement<HermiteBeamElement>* el_pt=
+    Point_load_manager_pt->element_pt(0);
+   Vector<double> s(1,Point_load_manager_pt->s(0));
+   
+   trace << Global_Physical_Variables::Xi_point_load << " " 
+         << el_pt->interpolated_x(s,0) << " " 
+         << el_pt->interpolated_x(s,1) << std::endl;
+
+   // Document the solution
+   sprintf(filename,"RESLT/beam_slide%i.dat",i);
+   file.open(filename);
+   mesh_pt()->output(file,5);
+   file.close();
+
+   // Done?
+   if (done) break;
+  }
+ trace.close();
+
+} // end of slide_point_load
+
+
+//=======start_of_linearised_load_case_study===============================
+/// Linearised responses (changes in the nodal displacements) about the
+/// current state to N_load_case transverse point loads, equally spaced 
+/// along the beam, plus a pressure increment. The Jacobian is factorised 
+/// once and all load cases are solved for together.
+//=========================================================================
+void ElasticBeamProblem::linearised_load_case_study()
+{
+ unsigned n_case=Global_Physical_Variables::N_load_case;
+
+ // Assemble and factorise Jacobian in the reference state
+ LinearisedLoadCaseBatch batch(this);
+ batch.factorise();
+
+ // Point load cases (applied via the probe load), followed by the 
+ // pressure load case
+ Vector<double> xi_case(n_case+1,-1.0);
+ for (unsigned c=0;c<=n_case;c++)
+  {
+   if (c<n_case) xi_case[c]=(double(c)+0.5)*Length/double(n_case);
+   set_load_case(c,xi_case[c],true);
+   batch.add_load_case();
+   set_load_case(c,xi_case[c],false);
+  }
+
+ // Solve for all of them
+ batch.solve();
+
+ oomph_info << "Linearised responses to " << batch.nload_case() 
+            << " load cases: assembly/factorisation: " 
+            << batch.factorisation_time() << " sec; blocked solve: "
+            << batch.solve_time() << " sec" << std::endl;
+
+ // Document the change in the transverse displacement at the nodes:
+ // one row per load case (influence matrix)
+ ofstream file("RESLT/influence_matrix.dat");
+ unsigned n_node=mesh_pt()->nnode();
+ file << "# xi_load (or -1 for pressure case), then change in y at the "
+      << n_node << " nodes" << std::endl;
+ for (unsigned c=0;c<batch.nload_case();c++)
+  {
+   file << xi_case[c];
+   for (unsigned j=0;j<n_node;j++)
+    {
+     int eqn=mesh_pt()->node_pt(j)->position_eqn_number(0,1);
+     double dy=0.0;
+     if (eqn>=0) dy=batch.response(c,unsigned(eqn));
+     file << " " << dy;
+    }
+   file << std::endl;
+  }
+ file.close();
+
+ // Check the blocked solve against separate solves for each load case
+ // with SuperLU?
+ if (CommandLineArgs::command_line_flag_has_been_set("--check_load_cases"))
+  {
+   DoubleVector reference_residuals;
+   CRDoubleMatrix jacobian;
+   get_jacobian(reference_residuals,jacobian);
+   SuperLUSolver direct_solver;
+   direct_solver.enable_resolve();
+   unsigned n_dof=ndof();
+   double diff=0.0;
+   double scale=0.0;
+   for (unsigned c=0;c<=n_case;c++)
+    {
+     set_load_case(c,xi_case[c],true);
+     DoubleVector residuals;
+     get_residuals(residuals);
+     set_load_case(c,xi_case[c],false);
+     DoubleVector rhs(reference_residuals.distribution_pt(),0.0);
+     for (unsigned i=0;i<n_dof;i++)
+      {
+       rhs[i]=-(residuals[i]-reference_residuals[i]);
+      }
+     DoubleVector dx;
+     if (c==0)
+      {
+       direct_solver.solve(&jacobian,rhs,dx);
+      }
+     else
+      {
+       direct_solver.resolve(rhs,dx);
+      }
+     for (unsigned i=0;i<n_dof;i++)
+      {
+       diff=std::max(diff,std::fabs(batch.response(c,i)-dx[i]));
+       scale=std::max(scale,std::fabs(dx[i]));
+      }
+    }
+   oomph_info << "Blocked banded solve vs SuperLU for the " << n_case+1
+              << " load cases: max. difference " << diff 
+              << " (max. response " << scale << ")" << std::endl;
+   if (diff>1.0e-8*scale)
+    {
+     std::ostringstream error_message;
+     error_message << "Linearised responses from the blocked banded solve "
+                   << "differ from SuperLU's: max. difference " << diff
+                   << " for max. response " << scale << std::endl;
+     throw OomphLibError(error_message.str(),
+                         OOMPH_CURRENT_FUNCTION,
+                         OOMPH_EXCEPTION_LOCATION);
+    }
+  }
+
+} // end of linearised_load_case_study
+
+
 //========start_of_main================================================
 /// Driver for beam (string under tension) test problem 
 //=====================================================================
-int main()
+int main(int argc, char** argv)
 {
+ // Store command line arguments
+ CommandLineArgs::setup(argc,argv);
+
+ // Use GMRES with geometric multigrid preconditioner
+ CommandLineArgs::specify_command_line_flag("--multigrid");
+
+ // Compute the point loads' Jacobian by automatic differentiation
+ CommandLineArgs::specify_command_line_flag("--automatic_differentiation");
+
+ // Check the Jacobian against finite differencing after the parameter
+ // study
+ CommandLineArgs::specify_command_line_flag("--check_jacobian");
+
+ // Follower point load: tangential and normal components
+ CommandLineArgs::specify_command_line_flag(
+  "--follower_load_tangential",
+  &Global_Physical_Variables::Follower_point_load[0]);
+ CommandLineArgs::specify_command_line_flag(
+  "--follower_load_normal",
+  &Global_Physical_Variables::Follower_point_load[1]);
+
+ // Point moment
+ CommandLineArgs::specify_command_line_flag(
+  "--point_moment",&Global_Physical_Variables::Point_moment);
+
+ // Dead point load
+ CommandLineArgs::specify_command_line_flag(
+  "--point_load_x",&Global_Physical_Variables::Point_load[0]);
+ CommandLineArgs::specify_command_line_flag(
+  "--point_load_y",&Global_Physical_Variables::Point_load[1]);
+
+ // Slide the point load along the beam after the parameter study
+ CommandLineArgs::specify_command_line_flag("--slide_point_load");
+
+ // Number of point load cases for the linearised load case study
+ // (performed after the parameter study)
+ CommandLineArgs::specify_command_line_flag(
+  "--n_load_case",&Global_Physical_Variables::N_load_case);
+
+ // Check the blocked solve for the load cases against separate solves
+ // with SuperLU
+ CommandLineArgs::specify_command_line_flag("--check_load_cases");
+
+ // Magnitude of the point load in each load case
+ CommandLineArgs::specify_command_line_flag(
+  "--load_case_point_load",
+  &Global_Physical_Variables::Load_case_point_load);
+
+ // Final position for --slide_point_load (as a fraction of the length)
+ CommandLineArgs::specify_command_line_flag(
+  "--xi_point_load_end_fraction",
+  &Global_Physical_Variables::Xi_point_load_end_fraction);
+
+ // Initial arclength increment for --slide_point_load
+ CommandLineArgs::specify_command_line_flag(
+  "--ds_point_load",&Global_Physical_Variables::Ds_point_load);
+
+ // Number of (equally spaced) follower point loads that approximate a 
+ // distributed normal load, and the magnitude of that load
+ CommandLineArgs::specify_command_line_flag(
+  "--n_point_load_array",&Global_Physical_Variables::N_point_load_array);
+ CommandLineArgs::specify_command_line_flag(
+  "--point_load_array_pressure",
+  &Global_Physical_Variables::Point_load_array_pressure);
+
+ // Parse command line
+ CommandLineArgs::parse_and_assign();
+
+ // Doc what has actually been specified on the command line
+ CommandLineArgs::doc_specified_flags();
 
  // Set the non-dimensional thickness 
  Global_Physical_Variables::H=0.01; 
@@ -478,5 +1568,24 @@ int main()
  // Conduct parameter study
  problem.parameter_study();
 
+ // Check the Jacobian (including the point loads' contributions) in the
+ // final state
+ if (CommandLineArgs::command_line_flag_has_been_set("--check_jacobian"))
+  {
+   problem.check_jacobian();
+  }
+
+ // Slide the point load along the beam?
+ if (CommandLineArgs::command_line_flag_has_been_set("--slide_point_load"))
+  {
+   problem.slide_point_load();
+  }
+
+ // Linearised responses to many load cases
+ if (Global_Physical_Variables::N_load_case>0)
+  {
+   problem.linearised_load_case_study();
+  }
+
 } // end of main
 
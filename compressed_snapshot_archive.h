@@ -0,0 +1,736 @@
+// LIC// ====================================================================
+// LIC// This file forms part of oomph-lib, the object-oriented,
+// LIC// multi-physics finite-element library, available
+// LIC// at http://www.oomph-lib.org.
+// LIC//
+// LIC// Copyright (C) 2006-2023 Matthias Heil and Andrew Hazel
+// LIC//
+// LIC// This library is free software; you can redistribute it and/or
+// LIC// modify it under the terms of the GNU Lesser General Public
+// LIC// License as published by the Free Software Foundation; either
+// LIC// version 2.1 of the License, or (at your option) any later version.
+// LIC//
+// LIC// This library is distributed in the hope that it will be useful,
+// LIC// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// LIC// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// LIC// Lesser General Public License for more details.
+// LIC//
+// LIC// You should have received a copy of the GNU Lesser General Public
+// LIC// License along with this library; if not, write to the Free Software
+// LIC// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+// LIC// 02110-1301  USA.
+// LIC//
+// LIC// The authors may be contacted at oomph-lib@maths.man.ac.uk.
+// LIC//
+// Lossless compressed binary archive of (nodal) snapshots
+
+#ifndef COMPRESSED_SNAPSHOT_ARCHIVE_HEADER
+#define COMPRESSED_SNAPSHOT_ARCHIVE_HEADER
+
+// OOMPH-LIB includes
+#include "generic.h"
+
+namespace oomph
+{
+  //=========================================================================
+  /// Adaptive binary range coder (as in LZMA) and the adaptive models for
+  /// the compressed snapshots. Each bit is coded with an adaptive
+  /// probability (11 bits); bytes and other small symbols are coded as
+  /// binary trees of such bits.
+  //=========================================================================
+  namespace SnapshotRangeCoder
+  {
+    /// Number of bits in the probabilities
+    const unsigned N_probability_bit = 11;
+
+    /// Adaptation rate of the probabilities (as a shift)
+    const unsigned N_move_bit = 5;
+
+    /// Range below which the coder renormalises
+    const uint32_t Top = uint32_t(1) << 24;
+
+    /// Adaptive probability (of a zero bit) of a bit, initially 1/2
+    class BitModel
+    {
+    public:
+      /// Constructor: Probability 1/2
+      BitModel() : Probability(1 << (N_probability_bit - 1)) {}
+
+      /// Probability of a zero bit (scaled by 2^N_probability_bit)
+      uint16_t Probability;
+    };
+
+    /// Encoder: Appends the code to a byte buffer
+    class Encoder
+    {
+    public:
+      /// Constructor: Pass the buffer the code is appended to
+      Encoder(std::vector<unsigned char>& buffer)
+        : Buffer(buffer), Low(0), Range(0xFFFFFFFF), Cache(0), Cache_size(1)
+      {
+      }
+
+      /// Encode a bit with the adaptive model
+      void encode_bit(BitModel& model, const unsigned& bit)
+      {
+        uint32_t bound = (Range >> N_probability_bit) * model.Probability;
+        if (bit == 0)
+        {
+          Range = bound;
+          model.Probability +=
+            ((1 << N_probability_bit) - model.Probability) >> N_move_bit;
+        }
+        else
+        {
+          Low += bound;
+          Range -= bound;
+          model.Probability -= model.Probability >> N_move_bit;
+        }
+        while (Range < Top)
+        {
+          Range <<= 8;
+          shift_low();
+        }
+      }
+
+      /// Encode the n_bit-bit symbol with the binary tree of adaptive
+      /// models tree[1],...,tree[2^n_bit-1] (most significant bit first)
+      void encode_symbol(BitModel* tree,
+                         const unsigned& n_bit,
+                         const unsigned& symbol)
+      {
+        unsigned node = 1;
+        for (unsigned b = n_bit; b > 0; b--)
+        {
+          unsigned bit = (symbol >> (b - 1)) & 1;
+          encode_bit(tree[node], bit);
+          node = (node << 1) | bit;
+        }
+      }
+
+      /// Write the remaining bytes of the code (the encoder can't be used
+      /// afterwards)
+      void flush()
+      {
+        for (unsigned i = 0; i < 5; i++)
+        {
+          shift_low();
+        }
+      }
+
+    private:
+      /// Output the top byte of Low (resolving carries via the cache)
+      void shift_low()
+      {
+        if ((uint32_t(Low) < 0xFF000000) || ((Low >> 32) != 0))
+        {
+          unsigned char carry = static_cast<unsigned char>(Low >> 32);
+          unsigned char byte = Cache;
+          do
+          {
+            Buffer.push_back(static_cast<unsigned char>(byte + carry));
+            byte = 0xFF;
+          } while (--Cache_size != 0);
+          Cache = static_cast<unsigned char>(uint32_t(Low) >> 24);
+        }
+        Cache_size++;
+        Low = uint64_t(uint32_t(Low) << 8);
+      }
+
+      /// The code
+      std::vector<unsigned char>& Buffer;
+
+      /// Lower end of the current interval (33 bits)
+      uint64_t Low;
+
+      /// Width of the current interval
+      uint32_t Range;
+
+      /// Byte that may still be affected by a carry
+      unsigned char Cache;
+
+      /// Number of pending bytes (the cache and 0xFF bytes)
+      uint64_t Cache_size;
+    };
+
+    /// Decoder: Reads the code from a byte buffer
+    class Decoder
+    {
+    public:
+      /// Constructor: Pass the code and its length
+      Decoder(const unsigned char* code, const unsigned long& n_byte)
+        : Code_pt(code),
+          N_byte(n_byte),
+          Position(0),
+          Value(0),
+          Range(0xFFFFFFFF)
+      {
+        for (unsigned i = 0; i < 5; i++)
+        {
+          Value = (Value << 8) | next_byte();
+        }
+      }
+
+      /// Decode a bit with the adaptive model
+      unsigned decode_bit(BitModel& model)
+      {
+        uint32_t bound = (Range >> N_probability_bit) * model.Probability;
+        unsigned bit = 0;
+        if (Value < bound)
+        {
+          Range = bound;
+          model.Probability +=
+            ((1 << N_probability_bit) - model.Probability) >> N_move_bit;
+        }
+        else
+        {
+          Value -= bound;
+          Range -= bound;
+          model.Probability -= model.Probability >> N_move_bit;
+          bit = 1;
+        }
+        while (Range < Top)
+        {
+          Range <<= 8;
+          Value = (Value << 8) | next_byte();
+        }
+        return bit;
+      }
+
+      /// Decode an n_bit-bit symbol coded with encode_symbol(...)
+      unsigned decode_symbol(BitModel* tree, const unsigned& n_bit)
+      {
+        unsigned node = 1;
+        for (unsigned b = 0; b < n_bit; b++)
+        {
+          node = (node << 1) | decode_bit(tree[node]);
+        }
+        return node - (1 << n_bit);
+      }
+
+    private:
+      /// Next byte of the code (zero beyond its end)
+      uint32_t next_byte()
+      {
+        if (Position < N_byte)
+        {
+          return Code_pt[Position++];
+        }
+        return 0;
+      }
+
+      /// The code
+      const unsigned char* Code_pt;
+
+      /// Length of the code
+      unsigned long N_byte;
+
+      /// Position of the next byte in the code
+      unsigned long Position;
+
+      /// Code value relative to the lower end of the current interval
+      uint32_t Value;
+
+      /// Width of the current interval
+      uint32_t Range;
+    };
+
+  } // namespace SnapshotRangeCoder
+
+
+  //=========================================================================
+  /// Model for the compressed snapshots, shared by the writer and the
+  /// reader (which must update it identically): Each double is predicted
+  /// (by its value in the previous snapshot, or by linear extrapolation
+  /// from the previous two snapshots, whichever is better for the
+  /// snapshot as a whole) and the XOR of the bit patterns of the value
+  /// and its prediction is coded as the number of leading zero bytes
+  /// followed by the remaining bytes, most significant first. Smoothly
+  /// varying values (and constant ones, e.g. pinned positions) give long
+  /// runs of leading zeroes and the byte statistics are learned by the
+  /// adaptive models. The models are carried over from one snapshot to
+  /// the next.
+  //=========================================================================
+  class SnapshotModel
+  {
+  public:
+    /// Predictor for the values
+    enum Predictor
+    {
+      Previous_value,
+      Linear_extrapolation
+    };
+
+    /// Constructor: Initial models
+    SnapshotModel() : Predictor_tree(3), Byte_tree(8 * 256)
+    {
+      for (unsigned c = 0; c < 9; c++)
+      {
+        N_zero_byte_tree[c].resize(16);
+      }
+    }
+
+    /// Bit pattern of a double
+    static uint64_t bits(const double& x)
+    {
+      uint64_t b = 0;
+      std::memcpy(&b, &x, sizeof(double));
+      return b;
+    }
+
+    /// Double with the given bit pattern
+    static double value(const uint64_t& b)
+    {
+      double x = 0.0;
+      std::memcpy(&x, &b, sizeof(double));
+      return x;
+    }
+
+    /// Number of leading zero bytes of a 64-bit word
+    static unsigned n_leading_zero_byte(const uint64_t& x)
+    {
+      unsigned n = 0;
+      while ((n < 8) && (((x >> (56 - 8 * n)) & 0xFF) == 0))
+      {
+        n++;
+      }
+      return n;
+    }
+
+    /// Bit pattern of the prediction of value i (given the previous two
+    /// snapshots, which have to be of the right size if used)
+    static uint64_t prediction(const Predictor& predictor,
+                               const Vector<double>& previous,
+                               const Vector<double>& previous_previous,
+                               const unsigned& i)
+    {
+      if (previous.empty())
+      {
+        return 0;
+      }
+      if (predictor == Previous_value)
+      {
+        return bits(previous[i]);
+      }
+      // (2 x is exact so this is evaluated the same way on all
+      // platforms, with or without fused multiply-adds)
+      return bits(2.0 * previous[i] - previous_previous[i]);
+    }
+
+    /// Binary tree model for the predictor
+    Vector<SnapshotRangeCoder::BitModel> Predictor_tree;
+
+    /// Binary tree models for the number of leading zero bytes (0 to 8,
+    /// as a 4-bit symbol), in the context of the number of leading zero
+    /// bytes of the previous value
+    Vector<SnapshotRangeCoder::BitModel> N_zero_byte_tree[9];
+
+    /// Binary tree models for the bytes, in the context of their position
+    /// in the word (tree for position p starts at entry 256*p)
+    Vector<SnapshotRangeCoder::BitModel> Byte_tree;
+  };
+
+
+  //=========================================================================
+  /// Writer for lossless compressed archives of snapshots (e.g. the nodal
+  /// positions and rigid body data at each continuation step or
+  /// timestep). Each snapshot is a vector of doubles (plus a label, e.g.
+  /// the time or the continuation parameter) and is reconstructed
+  /// bitwise-exactly by the CompressedSnapshotReader. The snapshots are
+  /// coded relative to the previous ones (see SnapshotModel) so they
+  /// have to be read in sequence. Each snapshot is written (and the file
+  /// flushed) as soon as it's added so the archive is valid even if the
+  /// run is aborted.
+  ///
+  /// File format: "OOMPHSNP", then for each snapshot the number of values
+  /// (uint64), the label (double), the number of bytes of the code
+  /// (uint64) and the code (all in the machine's byte order).
+  //=========================================================================
+  class CompressedSnapshotWriter
+  {
+  public:
+    /// Constructor: Pass the name of the archive
+    CompressedSnapshotWriter(const std::string& filename)
+      : Outfile(filename.c_str(), std::ios_base::binary), N_raw_byte(0),
+        N_compressed_byte(0)
+    {
+      if (!Outfile)
+      {
+        std::ostringstream error_message;
+        error_message << "Couldn't open " << filename << std::endl;
+        throw OomphLibError(error_message.str(),
+                            OOMPH_CURRENT_FUNCTION,
+                            OOMPH_EXCEPTION_LOCATION);
+      }
+      Outfile.write("OOMPHSNP", 8);
+      Outfile.flush();
+    }
+
+    /// Broken copy constructor
+    CompressedSnapshotWriter(const CompressedSnapshotWriter& dummy) = delete;
+
+    /// Broken assignment operator
+    void operator=(const CompressedSnapshotWriter&) = delete;
+
+    /// Add a snapshot
+    void add_snapshot(const double& label, const Vector<double>& values);
+
+    /// Total size of the snapshots' values (in bytes)
+    unsigned long n_raw_byte() const
+    {
+      return N_raw_byte;
+    }
+
+    /// Total size of the snapshots in the archive (in bytes)
+    unsigned long n_compressed_byte() const
+    {
+      return N_compressed_byte;
+    }
+
+  private:
+    /// The archive
+    std::ofstream Outfile;
+
+    /// The adaptive models
+    SnapshotModel Model;
+
+    /// The previous two snapshots
+    Vector<double> Previous;
+    Vector<double> Previous_previous;
+
+    /// Workspace for the code
+    std::vector<unsigned char> Code;
+
+    /// Total size of the snapshots' values
+    unsigned long N_raw_byte;
+
+    /// Total size of the snapshots in the archive
+    unsigned long N_compressed_byte;
+  };
+
+
+  //=========================================================================
+  /// Code the snapshot and append it to the archive
+  //=========================================================================
+  inline void CompressedSnapshotWriter::add_snapshot(
+    const double& label, const Vector<double>& values)
+  {
+    const unsigned n_value = values.size();
+
+    // Forget the previous snapshots if the number of values has changed
+    if (Previous.size() != n_value)
+    {
+      Previous.clear();
+      Previous_previous.clear();
+    }
+    if (Previous_previous.size() != n_value)
+    {
+      Previous_previous.clear();
+    }
+
+    // Pick the predictor that leaves the most leading zero bytes
+    SnapshotModel::Predictor predictor = SnapshotModel::Previous_value;
+    if (!Previous_previous.empty())
+    {
+      unsigned long n_zero_previous = 0;
+      unsigned long n_zero_extrapolation = 0;
+      for (unsigned i = 0; i < n_value; i++)
+      {
+        uint64_t x = SnapshotModel::bits(values[i]);
+        n_zero_previous += SnapshotModel::n_leading_zero_byte(
+          x ^ SnapshotModel::prediction(SnapshotModel::Previous_value,
+                                        Previous,
+                                        Previous_previous,
+                                        i));
+        n_zero_extrapolation += SnapshotModel::n_leading_zero_byte(
+          x ^ SnapshotModel::prediction(SnapshotModel::Linear_extrapolation,
+                                        Previous,
+                                        Previous_previous,
+                                        i));
+      }
+      if (n_zero_extrapolation > n_zero_previous)
+      {
+        predictor = SnapshotModel::Linear_extrapolation;
+      }
+    }
+
+    // Code the snapshot
+    Code.clear();
+    SnapshotRangeCoder::Encoder encoder(Code);
+    encoder.encode_symbol(&Model.Predictor_tree[0], 1, unsigned(predictor));
+    unsigned context = 8;
+    for (unsigned i = 0; i < n_value; i++)
+    {
+      uint64_t residual =
+        SnapshotModel::bits(values[i]) ^
+        SnapshotModel::prediction(predictor, Previous, Previous_previous, i);
+      unsigned n_zero = SnapshotModel::n_leading_zero_byte(residual);
+      encoder.encode_symbol(&Model.N_zero_byte_tree[context][0], 4, n_zero);
+      for (unsigned p = n_zero; p < 8; p++)
+      {
+        unsigned byte = unsigned((residual >> (56 - 8 * p)) & 0xFF);
+        encoder.encode_symbol(&Model.Byte_tree[256 * p], 8, byte);
+      }
+      context = n_zero;
+    }
+    encoder.flush();
+
+    // Write it
+    uint64_t n_value_64 = n_value;
+    uint64_t n_byte = Code.size();
+    Outfile.write(reinterpret_cast<const char*>(&n_value_64),
+                  sizeof(n_value_64));
+    Outfile.write(reinterpret_cast<const char*>(&label), sizeof(label));
+    Outfile.write(reinterpret_cast<const char*>(&n_byte), sizeof(n_byte));
+    Outfile.write(reinterpret_cast<const char*>(&Code[0]), n_byte);
+    Outfile.flush();
+    N_raw_byte += n_value * sizeof(double);
+    N_compressed_byte +=
+      sizeof(n_value_64) + sizeof(label) + sizeof(n_byte) + n_byte;
+
+    // Remember the snapshot
+    Previous_previous.swap(Previous);
+    Previous = values;
+  }
+
+
+  //=========================================================================
+  /// Reader for archives written by the CompressedSnapshotWriter: Returns
+  /// the snapshots in sequence
+  //=========================================================================
+  class CompressedSnapshotReader
+  {
+  public:
+    /// Constructor: Pass the name of the archive
+    CompressedSnapshotReader(const std::string& filename)
+      : Infile(filename.c_str(), std::ios_base::binary)
+    {
+      char magic[8];
+      Infile.read(magic, 8);
+      if ((!Infile) || (std::string(magic, 8) != "OOMPHSNP"))
+      {
+        std::ostringstream error_message;
+        error_message << filename << " is not a snapshot archive" << std::endl;
+        throw OomphLibError(error_message.str(),
+                            OOMPH_CURRENT_FUNCTION,
+                            OOMPH_EXCEPTION_LOCATION);
+      }
+    }
+
+    /// Broken copy constructor
+    CompressedSnapshotReader(const CompressedSnapshotReader& dummy) = delete;
+
+    /// Broken assignment operator
+    void operator=(const CompressedSnapshotReader&) = delete;
+
+    /// Read the next snapshot; returns false (and leaves the arguments
+    /// unchanged) at the end of the archive
+    bool read_next_snapshot(double& label, Vector<double>& values);
+
+  private:
+    /// The archive
+    std::ifstream Infile;
+
+    /// The adaptive models
+    SnapshotModel Model;
+
+    /// The previous two snapshots
+    Vector<double> Previous;
+    Vector<double> Previous_previous;
+
+    /// Workspace for the code
+    std::vector<unsigned char> Code;
+  };
+
+
+  //=========================================================================
+  /// Read and decode the next snapshot
+  //=========================================================================
+  inline bool CompressedSnapshotReader::read_next_snapshot(
+    double& label, Vector<double>& values)
+  {
+    uint64_t n_value_64 = 0;
+    double snapshot_label = 0.0;
+    uint64_t n_byte = 0;
+    Infile.read(reinterpret_cast<char*>(&n_value_64), sizeof(n_value_64));
+    Infile.read(reinterpret_cast<char*>(&snapshot_label),
+                sizeof(snapshot_label));
+    Infile.read(reinterpret_cast<char*>(&n_byte), sizeof(n_byte));
+    if (!Infile)
+    {
+      return false;
+    }
+    Code.resize(n_byte);
+    Infile.read(reinterpret_cast<char*>(&Code[0]), n_byte);
+    if (!Infile)
+    {
+      throw OomphLibError("Snapshot archive is truncated",
+                          OOMPH_CURRENT_FUNCTION,
+                          OOMPH_EXCEPTION_LOCATION);
+    }
+
+    // Same bookkeeping of the previous snapshots as in the writer
+    const unsigned n_value = unsigned(n_value_64);
+    if (Previous.size() != n_value)
+    {
+      Previous.clear();
+      Previous_previous.clear();
+    }
+    if (Previous_previous.size() != n_value)
+    {
+      Previous_previous.clear();
+    }
+
+    // Decode
+    Vector<double> snapshot(n_value);
+    SnapshotRangeCoder::Decoder decoder(&Code[0], n_byte);
+    SnapshotModel::Predictor predictor = SnapshotModel::Predictor(
+      decoder.decode_symbol(&Model.Predictor_tree[0], 1));
+    unsigned context = 8;
+    for (unsigned i = 0; i < n_value; i++)
+    {
+      unsigned n_zero =
+        decoder.decode_symbol(&Model.N_zero_byte_tree[context][0], 4);
+      uint64_t residual = 0;
+      for (unsigned p = n_zero; p < 8; p++)
+      {
+        uint64_t byte = decoder.decode_symbol(&Model.Byte_tree[256 * p], 8);
+        residual |= byte << (56 - 8 * p);
+      }
+      snapshot[i] = SnapshotModel::value(
+        residual ^
+        SnapshotModel::prediction(predictor, Previous, Previous_previous, i));
+      context = n_zero;
+    }
+
+    // Remember the snapshot
+    Previous_previous.swap(Previous);
+    Previous = snapshot;
+    label = snapshot_label;
+    values = snapshot;
+    return true;
+  }
+
+
+  //=========================================================================
+  /// Helpers to gather the nodal state of SolidMeshes (Lagrangian and
+  /// Eulerian positions and nodal values) and the internal data of
+  /// elements (e.g. rigid body data) into a snapshot, and to scatter a
+  /// snapshot back. All time levels are included so a scattered snapshot
+  /// reproduces the state (including the history values) bitwise-exactly.
+  //=========================================================================
+  namespace NodalSnapshot
+  {
+    /// Gather or scatter the values of a Data object
+    inline void copy_data_values(Data* data_pt,
+                                 const bool& gather,
+                                 Vector<double>& values,
+                                 unsigned& index)
+    {
+      unsigned n_tstorage = data_pt->ntstorage();
+      unsigned n_value = data_pt->nvalue();
+      for (unsigned t = 0; t < n_tstorage; t++)
+      {
+        for (unsigned i = 0; i < n_value; i++)
+        {
+          if (gather)
+          {
+            values.push_back(data_pt->value(t, i));
+          }
+          else
+          {
+            data_pt->set_value(t, i, values[index]);
+          }
+          index++;
+        }
+      }
+    }
+
+    /// Gather (gather=true; appended to values) or scatter the state
+    inline void copy_state(const Vector<SolidMesh*>& mesh_pt,
+                           const Vector<GeneralisedElement*>& element_pt,
+                           const bool& gather,
+                           Vector<double>& values)
+    {
+      unsigned index = 0;
+      unsigned n_mesh = mesh_pt.size();
+      for (unsigned m = 0; m < n_mesh; m++)
+      {
+        unsigned n_node = mesh_pt[m]->nnode();
+        for (unsigned j = 0; j < n_node; j++)
+        {
+          SolidNode* node_pt = mesh_pt[m]->node_pt(j);
+
+          // Lagrangian coordinates (which may have been moved by
+          // r-adaptation)
+          unsigned n_lagrangian = node_pt->nlagrangian();
+          unsigned n_lagrangian_type = node_pt->nlagrangian_type();
+          for (unsigned k = 0; k < n_lagrangian_type; k++)
+          {
+            for (unsigned i = 0; i < n_lagrangian; i++)
+            {
+              if (gather)
+              {
+                values.push_back(node_pt->xi_gen(k, i));
+              }
+              else
+              {
+                node_pt->xi_gen(k, i) = values[index];
+              }
+              index++;
+            }
+          }
+
+          // Positions and nodal values
+          copy_data_values(
+            node_pt->variable_position_pt(), gather, values, index);
+          copy_data_values(node_pt, gather, values, index);
+        }
+      }
+      unsigned n_element = element_pt.size();
+      for (unsigned e = 0; e < n_element; e++)
+      {
+        unsigned n_internal = element_pt[e]->ninternal_data();
+        for (unsigned i = 0; i < n_internal; i++)
+        {
+          copy_data_values(
+            element_pt[e]->internal_data_pt(i), gather, values, index);
+        }
+      }
+#ifdef PARANOID
+      if (index != values.size())
+      {
+        std::ostringstream error_message;
+        error_message << "Snapshot has " << values.size()
+                      << " values but the state has " << index << std::endl;
+        throw OomphLibError(error_message.str(),
+                            OOMPH_CURRENT_FUNCTION,
+                            OOMPH_EXCEPTION_LOCATION);
+      }
+#endif
+    }
+
+    /// Gather the state of the meshes and elements into a snapshot
+    inline void get_values(const Vector<SolidMesh*>& mesh_pt,
+                           const Vector<GeneralisedElement*>& element_pt,
+                           Vector<double>& values)
+    {
+      values.clear();
+      copy_state(mesh_pt, element_pt, true, values);
+    }
+
+    /// Scatter a snapshot (gathered by get_values(...) for the same meshes
+    /// and elements) back into the meshes and elements
+    inline void set_values(const Vector<SolidMesh*>& mesh_pt,
+                           const Vector<GeneralisedElement*>& element_pt,
+                           const Vector<double>& values)
+    {
+      Vector<double> snapshot(values);
+      copy_state(mesh_pt, element_pt, false, snapshot);
+    }
+
+  } // namespace NodalSnapshot
+
+} // namespace oomph
+
+#endif
@@ -0,0 +1,341 @@
+// LIC// ====================================================================
+// LIC// This file forms part of oomph-lib, the object-oriented,
+// LIC// multi-physics finite-element library, available
+// LIC// at http://www.oomph-lib.org.
+// LIC//
+// LIC// Copyright (C) 2006-2023 Matthias Heil and Andrew Hazel
+// LIC//
+// LIC// This library is free software; you can redistribute it and/or
+// LIC// modify it under the terms of the GNU Lesser General Public
+// LIC// License as published by the Free Software Foundation; either
+// LIC// version 2.1 of the License, or (at your option) any later version.
+// LIC//
+// LIC// This library is distributed in the hope that it will be useful,
+// LIC// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// LIC// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// LIC// Lesser General Public License for more details.
+// LIC//
+// LIC// You should have received a copy of the GNU Lesser General Public
+// LIC// License along with this library; if not, write to the Free Software
+// LIC// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+// LIC// 02110-1301  USA.
+// LIC//
+// LIC// The authors may be contacted at oomph-lib@maths.man.ac.uk.
+// LIC//
+// LIC//====================================================================
+// Dual numbers for forward-mode automatic differentiation
+
+#ifndef DUAL_NUMBER_HEADER
+#define DUAL_NUMBER_HEADER
+
+// OOMPH-LIB includes
+#include "generic.h"
+
+namespace oomph
+{
+  //=========================================================================
+  /// Dual number for forward-mode automatic differentiation with N
+  /// directional derivatives ("tangents") that are propagated together,
+  /// so residual code templated on the scalar type provides N columns of
+  /// the Jacobian in a single pass. Storage is fixed-size so no heap
+  /// allocations are involved.
+  //=========================================================================
+  template<unsigned N>
+  class DualNumber
+  {
+  public:
+    /// Constructor: Zero value and derivatives
+    DualNumber() : Value(0.0)
+    {
+      for (unsigned j = 0; j < N; j++)
+      {
+        Derivative[j] = 0.0;
+      }
+    }
+
+    /// Constructor: A constant (zero derivatives)
+    DualNumber(const double& value) : Value(value)
+    {
+      for (unsigned j = 0; j < N; j++)
+      {
+        Derivative[j] = 0.0;
+      }
+    }
+
+    /// Constructor: An independent variable, seeded with unit derivative
+    /// in direction j_seed
+    DualNumber(const double& value, const unsigned& j_seed) : Value(value)
+    {
+#ifdef PARANOID
+      if (j_seed >= N)
+      {
+        std::ostringstream error_message;
+        error_message << "Seed direction " << j_seed
+                      << " exceeds the number of derivatives, " << N
+                      << std::endl;
+        throw OomphLibError(error_message.str(),
+                            OOMPH_CURRENT_FUNCTION,
+                            OOMPH_EXCEPTION_LOCATION);
+      }
+#endif
+      for (unsigned j = 0; j < N; j++)
+      {
+        Derivative[j] = 0.0;
+      }
+      Derivative[j_seed] = 1.0;
+    }
+
+    /// Value
+    double value() const
+    {
+      return Value;
+    }
+
+    /// Value (non-const)
+    double& value()
+    {
+      return Value;
+    }
+
+    /// j-th derivative
+    double derivative(const unsigned& j) const
+    {
+      return Derivative[j];
+    }
+
+    /// j-th derivative (non-const)
+    double& derivative(const unsigned& j)
+    {
+      return Derivative[j];
+    }
+
+    /// Number of derivatives
+    static constexpr unsigned nderivative()
+    {
+      return N;
+    }
+
+    /// Add dual number
+    DualNumber& operator+=(const DualNumber& b)
+    {
+      Value += b.Value;
+      for (unsigned j = 0; j < N; j++)
+      {
+        Derivative[j] += b.Derivative[j];
+      }
+      return *this;
+    }
+
+    /// Subtract dual number
+    DualNumber& operator-=(const DualNumber& b)
+    {
+      Value -= b.Value;
+      for (unsigned j = 0; j < N; j++)
+      {
+        Derivative[j] -= b.Derivative[j];
+      }
+      return *this;
+    }
+
+    /// Multiply by dual number
+    DualNumber& operator*=(const DualNumber& b)
+    {
+      for (unsigned j = 0; j < N; j++)
+      {
+        Derivative[j] = Derivative[j] * b.Value + Value * b.Derivative[j];
+      }
+      Value *= b.Value;
+      return *this;
+    }
+
+    /// Divide by dual number
+    DualNumber& operator/=(const DualNumber& b)
+    {
+      double inverse = 1.0 / b.Value;
+      Value *= inverse;
+      for (unsigned j = 0; j < N; j++)
+      {
+        Derivative[j] = (Derivative[j] - Value * b.Derivative[j]) * inverse;
+      }
+      return *this;
+    }
+
+  private:
+    /// Value
+    double Value;
+
+    /// Derivatives
+    double Derivative[N];
+  };
+
+
+  /// Unary minus
+  template<unsigned N>
+  inline DualNumber<N> operator-(const DualNumber<N>& a)
+  {
+    DualNumber<N> result(a);
+    result *= -1.0;
+    return result;
+  }
+
+  /// Addition
+  template<unsigned N>
+  inline DualNumber<N> operator+(DualNumber<N> a, const DualNumber<N>& b)
+  {
+    return a += b;
+  }
+
+  /// Addition of a constant
+  template<unsigned N>
+  inline DualNumber<N> operator+(DualNumber<N> a, const double& b)
+  {
+    a.value() += b;
+    return a;
+  }
+
+  /// Addition to a constant
+  template<unsigned N>
+  inline DualNumber<N> operator+(const double& a, DualNumber<N> b)
+  {
+    b.value() += a;
+    return b;
+  }
+
+  /// Subtraction
+  template<unsigned N>
+  inline DualNumber<N> operator-(DualNumber<N> a, const DualNumber<N>& b)
+  {
+    return a -= b;
+  }
+
+  /// Subtraction of a constant
+  template<unsigned N>
+  inline DualNumber<N> operator-(DualNumber<N> a, const double& b)
+  {
+    a.value() -= b;
+    return a;
+  }
+
+  /// Subtraction from a constant
+  template<unsigned N>
+  inline DualNumber<N> operator-(const double& a, const DualNumber<N>& b)
+  {
+    DualNumber<N> result(-b);
+    result.value() += a;
+    return result;
+  }
+
+  /// Multiplication
+  template<unsigned N>
+  inline DualNumber<N> operator*(DualNumber<N> a, const DualNumber<N>& b)
+  {
+    return a *= b;
+  }
+
+  /// Multiplication by a constant
+  template<unsigned N>
+  inline DualNumber<N> operator*(DualNumber<N> a, const double& b)
+  {
+    a.value() *= b;
+    for (unsigned j = 0; j < N; j++)
+    {
+      a.derivative(j) *= b;
+    }
+    return a;
+  }
+
+  /// Multiplication of a constant
+  template<unsigned N>
+  inline DualNumber<N> operator*(const double& a, const DualNumber<N>& b)
+  {
+    return b * a;
+  }
+
+  /// Division
+  template<unsigned N>
+  inline DualNumber<N> operator/(DualNumber<N> a, const DualNumber<N>& b)
+  {
+    return a /= b;
+  }
+
+  /// Division by a constant
+  template<unsigned N>
+  inline DualNumber<N> operator/(const DualNumber<N>& a, const double& b)
+  {
+    return a * (1.0 / b);
+  }
+
+  /// Division of a constant
+  template<unsigned N>
+  inline DualNumber<N> operator/(const double& a, const DualNumber<N>& b)
+  {
+    return DualNumber<N>(a) /= b;
+  }
+
+  /// Square root
+  template<unsigned N>
+  inline DualNumber<N> sqrt(const DualNumber<N>& a)
+  {
+    DualNumber<N> result;
+    result.value() = std::sqrt(a.value());
+    double factor = 0.5 / result.value();
+    for (unsigned j = 0; j < N; j++)
+    {
+      result.derivative(j) = factor * a.derivative(j);
+    }
+    return result;
+  }
+
+  /// Sine
+  template<unsigned N>
+  inline DualNumber<N> sin(const DualNumber<N>& a)
+  {
+    DualNumber<N> result;
+    result.value() = std::sin(a.value());
+    double factor = std::cos(a.value());
+    for (unsigned j = 0; j < N; j++)
+    {
+      result.derivative(j) = factor * a.derivative(j);
+    }
+    return result;
+  }
+
+  /// Cosine
+  template<unsigned N>
+  inline DualNumber<N> cos(const DualNumber<N>& a)
+  {
+    DualNumber<N> result;
+    result.value() = std::cos(a.value());
+    double factor = -std::sin(a.value());
+    for (unsigned j = 0; j < N; j++)
+    {
+      result.derivative(j) = factor * a.derivative(j);
+    }
+    return result;
+  }
+
+
+  //=========================================================================
+  /// Helpers for code that is templated on the scalar type (double or
+  /// DualNumber)
+  //=========================================================================
+  namespace DualNumberHelpers
+  {
+    /// Value of a double
+    inline double value(const double& a)
+    {
+      return a;
+    }
+
+    /// Value of a dual number
+    template<unsigned N>
+    inline double value(const DualNumber<N>& a)
+    {
+      return a.value();
+    }
+
+  } // namespace DualNumberHelpers
+
+} // namespace oomph
+
+#endif
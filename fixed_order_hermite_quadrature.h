@@ -0,0 +1,174 @@
+// LIC// ====================================================================
+// LIC// This file forms part of oomph-lib, the object-oriented,
+// LIC// multi-physics finite-element library, available
+// LIC// at http://www.oomph-lib.org.
+// LIC//
+// LIC// Copyright (C) 2006-2023 Matthias Heil and Andrew Hazel
+// LIC//
+// LIC// This library is free software; you can redistribute it and/or
+// LIC// modify it under the terms of the GNU Lesser General Public
+// LIC// License as published by the Free Software Foundation; either
+// LIC// version 2.1 of the License, or (at your option) any later version.
+// LIC//
+// LIC// This library is distributed in the hope that it will be useful,
+// LIC// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// LIC// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// LIC// Lesser General Public License for more details.
+// LIC//
+// LIC// You should have received a copy of the GNU Lesser General Public
+// LIC// License along with this library; if not, write to the Free Software
+// LIC// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+// LIC// 02110-1301  USA.
+// LIC//
+// LIC// The authors may be contacted at oomph-lib@maths.man.ac.uk.
+// LIC//
+// LIC//====================================================================
+// Compile-time Gauss-Legendre rules and one-dimensional Hermite shape
+// functions, for fully unrolled loops over the integration points of
+// Hermite beam elements
+
+#ifndef FIXED_ORDER_HERMITE_QUADRATURE_HEADER
+#define FIXED_ORDER_HERMITE_QUADRATURE_HEADER
+
+// OOMPH-LIB includes
+#include "generic.h"
+
+namespace oomph
+{
+  //=========================================================================
+  /// Knots and weights of the NINTPT-point Gauss-Legendre rule on [-1,1]
+  /// as constexpr functions, so loops over the integration points with
+  /// the compile-time bound NINTPT can be unrolled and the knots and
+  /// weights folded into constants. Only specialised for the rules
+  /// implemented by oomph-lib's Gauss<1,NINTPT> (2, 3 or 4 points); the
+  /// knots are ordered in the same way.
+  //=========================================================================
+  template<unsigned NINTPT>
+  class GaussLegendreTable
+  {
+  };
+
+
+  //=========================================================================
+  /// Two-point Gauss-Legendre rule
+  //=========================================================================
+  template<>
+  class GaussLegendreTable<2>
+  {
+  public:
+    /// Knot of integration point i
+    static constexpr double knot(const unsigned i)
+    {
+      return (i == 0) ? -0.57735026918962576451 : 0.57735026918962576451;
+    }
+
+    /// Weight of integration point i
+    static constexpr double weight(const unsigned i)
+    {
+      return 1.0;
+    }
+
+    /// The corresponding (run-time) integration scheme
+    static Integral* integral_pt()
+    {
+      static Gauss<1, 2> integral;
+      return &integral;
+    }
+  };
+
+
+  //=========================================================================
+  /// Three-point Gauss-Legendre rule
+  //=========================================================================
+  template<>
+  class GaussLegendreTable<3>
+  {
+  public:
+    /// Knot of integration point i
+    static constexpr double knot(const unsigned i)
+    {
+      return (i == 0) ? -0.77459666924148337704 :
+                        ((i == 1) ? 0.0 : 0.77459666924148337704);
+    }
+
+    /// Weight of integration point i
+    static constexpr double weight(const unsigned i)
+    {
+      return (i == 1) ? 8.0 / 9.0 : 5.0 / 9.0;
+    }
+
+    /// The corresponding (run-time) integration scheme
+    static Integral* integral_pt()
+    {
+      static Gauss<1, 3> integral;
+      return &integral;
+    }
+  };
+
+
+  //=========================================================================
+  /// Four-point Gauss-Legendre rule
+  //=========================================================================
+  template<>
+  class GaussLegendreTable<4>
+  {
+  public:
+    /// Knot of integration point i
+    static constexpr double knot(const unsigned i)
+    {
+      return (i == 0) ?
+               -0.86113631159405257522 :
+               ((i == 1) ? -0.33998104358485626480 :
+                           ((i == 2) ? 0.33998104358485626480 :
+                                       0.86113631159405257522));
+    }
+
+    /// Weight of integration point i
+    static constexpr double weight(const unsigned i)
+    {
+      return ((i == 0) || (i == 3)) ? 0.34785484513745385737 :
+                                      0.65214515486254614263;
+    }
+
+    /// The corresponding (run-time) integration scheme
+    static Integral* integral_pt()
+    {
+      static Gauss<1, 4> integral;
+      return &integral;
+    }
+  };
+
+
+  //=========================================================================
+  /// One-dimensional (two-node) Hermite shape functions and their
+  /// derivatives w.r.t. the local coordinate s as constexpr functions.
+  /// Shape function j corresponds to psi(l,k) with j=2*l+k, as in
+  /// OneDimensionalHermite::shape(...) and dshape(...).
+  //=========================================================================
+  namespace OneDHermiteShape
+  {
+    /// Shape function j at local coordinate s
+    constexpr double psi(const unsigned j, const double s)
+    {
+      return (j == 0) ?
+               0.25 * (s * s * s - 3.0 * s + 2.0) :
+               ((j == 1) ? 0.25 * (s * s * s - s * s - s + 1.0) :
+                           ((j == 2) ? 0.25 * (-s * s * s + 3.0 * s + 2.0) :
+                                       0.25 * (s * s * s + s * s - s - 1.0)));
+    }
+
+    /// Derivative of shape function j w.r.t. the local coordinate at s
+    constexpr double dpsids(const unsigned j, const double s)
+    {
+      return (j == 0) ?
+               0.75 * (s * s - 1.0) :
+               ((j == 1) ? 0.25 * (3.0 * s * s - 2.0 * s - 1.0) :
+                           ((j == 2) ? 0.75 * (1.0 - s * s) :
+                                       0.25 * (3.0 * s * s + 2.0 * s - 1.0)));
+    }
+
+  } // namespace OneDHermiteShape
+
+} // namespace oomph
+
+#endif
@@ -0,0 +1,111 @@
+// LIC// ====================================================================
+// LIC// This file forms part of oomph-lib, the object-oriented,
+// LIC// multi-physics finite-element library, available
+// LIC// at http://www.oomph-lib.org.
+// LIC//
+// LIC// Copyright (C) 2006-2023 Matthias Heil and Andrew Hazel
+// LIC//
+// LIC// This library is free software; you can redistribute it and/or
+// LIC// modify it under the terms of the GNU Lesser General Public
+// LIC// License as published by the Free Software Foundation; either
+// LIC// version 2.1 of the License, or (at your option) any later version.
+// LIC//
+// LIC// This library is distributed in the hope that it will be useful,
+// LIC// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// LIC// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// LIC// Lesser General Public License for more details.
+// LIC//
+// LIC// You should have received a copy of the GNU Lesser General Public
+// LIC// License along with this library; if not, write to the Free Software
+// LIC// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+// LIC// 02110-1301  USA.
+// LIC//
+// LIC// The authors may be contacted at oomph-lib@maths.man.ac.uk.
+// LIC//
+// LIC//====================================================================
+// Stack-resident vector of fixed (compile-time) size
+
+#ifndef FIXED_SIZE_VECTOR_HEADER
+#define FIXED_SIZE_VECTOR_HEADER
+
+// OOMPH-LIB includes
+#include "generic.h"
+
+namespace oomph
+{
+  //=========================================================================
+  /// Vector of N entries of type T whose storage lives on the stack (or
+  /// inside the enclosing object), so, unlike oomph-lib's Vector, creating
+  /// one doesn't involve any heap allocation. Intended for the small
+  /// (position, normal, traction, ...) vectors in the inner loops of
+  /// element computations. Entries are not initialised unless an initial
+  /// value is passed to the constructor.
+  //=========================================================================
+  template<class T, unsigned N>
+  class FixedSizeVector
+  {
+  public:
+    /// Constructor: Entries are left uninitialised
+    FixedSizeVector() {}
+
+    /// Constructor: Initialise all entries to the given value
+    explicit FixedSizeVector(const T& initial_value)
+    {
+      initialise(initial_value);
+    }
+
+    /// Set all entries to the given value
+    void initialise(const T& value)
+    {
+      for (unsigned i = 0; i < N; i++)
+      {
+        Data[i] = value;
+      }
+    }
+
+    /// Number of entries
+    static constexpr unsigned size()
+    {
+      return N;
+    }
+
+    /// Access to i-th entry
+    T& operator[](const unsigned& i)
+    {
+#ifdef RANGE_CHECKING
+      range_check(i);
+#endif
+      return Data[i];
+    }
+
+    /// Access to i-th entry (const version)
+    const T& operator[](const unsigned& i) const
+    {
+#ifdef RANGE_CHECKING
+      range_check(i);
+#endif
+      return Data[i];
+    }
+
+  private:
+    /// Check that the index is in range
+    void range_check(const unsigned& i) const
+    {
+      if (i >= N)
+      {
+        std::ostringstream error_message;
+        error_message << "Range Error: " << i << " is not in the range (0,"
+                      << N - 1 << ")" << std::endl;
+        throw OomphLibError(error_message.str(),
+                            OOMPH_CURRENT_FUNCTION,
+                            OOMPH_EXCEPTION_LOCATION);
+      }
+    }
+
+    /// The entries
+    T Data[N];
+  };
+
+} // namespace oomph
+
+#endif
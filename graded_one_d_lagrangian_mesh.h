@@ -0,0 +1,910 @@
+// LIC// ====================================================================
+// LIC// This file forms part of oomph-lib, the object-oriented,
+// LIC// multi-physics finite-element library, available
+// LIC// at http://www.oomph-lib.org.
+// LIC//
+// LIC// Copyright (C) 2006-2023 Matthias Heil and Andrew Hazel
+// LIC//
+// LIC// This library is free software; you can redistribute it and/or
+// LIC// modify it under the terms of the GNU Lesser General Public
+// LIC// License as published by the Free Software Foundation; either
+// LIC// version 2.1 of the License, or (at your option) any later version.
+// LIC//
+// LIC// This library is distributed in the hope that it will be useful,
+// LIC// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// LIC// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// LIC// Lesser General Public License for more details.
+// LIC//
+// LIC// You should have received a copy of the GNU Lesser General Public
+// LIC// License along with this library; if not, write to the Free Software
+// LIC// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+// LIC// 02110-1301  USA.
+// LIC//
+// LIC// The authors may be contacted at oomph-lib@maths.man.ac.uk.
+// LIC//
+// LIC//====================================================================
+// Graded one-dimensional Lagrangian meshes for the (Hermite) beam problems
+
+#ifndef GRADED_ONE_D_LAGRANGIAN_MESH_HEADER
+#define GRADED_ONE_D_LAGRANGIAN_MESH_HEADER
+
+// OOMPH-LIB includes
+#include "generic.h"
+#include "meshes/one_d_lagrangian_mesh.h"
+
+namespace oomph
+{
+  //=========================================================================
+  /// Base class for monotonic mappings xi(t) of the unit interval onto
+  /// itself. They define the node distribution in a
+  /// GradedOneDLagrangianMesh: the nodes of an n_element mesh are located
+  /// at the images of the equally spaced points t_j = j/n_element.
+  //=========================================================================
+  class OneDMeshGrading
+  {
+  public:
+    /// Constructor: Empty
+    OneDMeshGrading() {}
+
+    /// Broken copy constructor
+    OneDMeshGrading(const OneDMeshGrading& dummy) = delete;
+
+    /// Broken assignment operator
+    void operator=(const OneDMeshGrading&) = delete;
+
+    /// Destructor: Empty
+    virtual ~OneDMeshGrading() {}
+
+    /// Mapped coordinate xi(t), both in [0,1]
+    virtual double xi(const double& t) const = 0;
+
+    /// Derivative dxi/dt of the mapping
+    virtual double dxidt(const double& t) const = 0;
+  };
+
+
+  //=========================================================================
+  /// Base class for gradings that cluster the nodes at one or both ends
+  /// of the interval. Derived classes only provide a one-sided mapping
+  /// that clusters the nodes at t=0; the symmetric versions are obtained
+  /// by reflection.
+  //=========================================================================
+  class ClusteredOneDMeshGrading : public OneDMeshGrading
+  {
+  public:
+    /// Where to cluster the nodes
+    enum ClusteringType
+    {
+      Cluster_at_start,
+      Cluster_at_end,
+      Cluster_at_both_ends
+    };
+
+    /// Constructor: Specify where the nodes are clustered
+    ClusteredOneDMeshGrading(const ClusteringType& clustering)
+      : Clustering(clustering)
+    {
+    }
+
+    /// Mapped coordinate xi(t)
+    double xi(const double& t) const
+    {
+      switch (Clustering)
+      {
+        case Cluster_at_start:
+          return one_sided_xi(t);
+
+        case Cluster_at_end:
+          return 1.0 - one_sided_xi(1.0 - t);
+
+        default:
+          if (t <= 0.5)
+          {
+            return 0.5 * one_sided_xi(2.0 * t);
+          }
+          return 1.0 - 0.5 * one_sided_xi(2.0 * (1.0 - t));
+      }
+    }
+
+    /// Derivative dxi/dt of the mapping
+    double dxidt(const double& t) const
+    {
+      switch (Clustering)
+      {
+        case Cluster_at_start:
+          return one_sided_dxidt(t);
+
+        case Cluster_at_end:
+          return one_sided_dxidt(1.0 - t);
+
+        default:
+          if (t <= 0.5)
+          {
+            return one_sided_dxidt(2.0 * t);
+          }
+          return one_sided_dxidt(2.0 * (1.0 - t));
+      }
+    }
+
+  protected:
+    /// One-sided mapping that clusters the nodes at t=0
+    virtual double one_sided_xi(const double& t) const = 0;
+
+    /// Derivative of the one-sided mapping
+    virtual double one_sided_dxidt(const double& t) const = 0;
+
+  private:
+    /// Where to cluster the nodes
+    ClusteringType Clustering;
+  };
+
+
+  //=========================================================================
+  /// Geometric grading: xi(t) = (R^t-1)/(R-1), so successive elements grow
+  /// by a constant factor and the ratio of the element lengths at the
+  /// coarse and the fine ends of the graded region approaches R as the
+  /// number of elements increases.
+  //=========================================================================
+  class GeometricOneDMeshGrading : public ClusteredOneDMeshGrading
+  {
+  public:
+    /// Constructor: Specify the ratio R (>0) of the largest and
+    /// smallest element lengths and where to cluster the nodes
+    GeometricOneDMeshGrading(const double& ratio,
+                             const ClusteringType& clustering)
+      : ClusteredOneDMeshGrading(clustering), Ratio(ratio)
+    {
+#ifdef PARANOID
+      if (ratio <= 0.0)
+      {
+        std::ostringstream error_message;
+        error_message << "Ratio of element lengths must be positive, not "
+                      << ratio << std::endl;
+        throw OomphLibError(error_message.str(),
+                            OOMPH_CURRENT_FUNCTION,
+                            OOMPH_EXCEPTION_LOCATION);
+      }
+#endif
+    }
+
+  protected:
+    /// One-sided mapping that clusters the nodes at t=0
+    double one_sided_xi(const double& t) const
+    {
+      if (std::fabs(Ratio - 1.0) < 1.0e-12)
+      {
+        return t;
+      }
+      return (std::pow(Ratio, t) - 1.0) / (Ratio - 1.0);
+    }
+
+    /// Derivative of the one-sided mapping
+    double one_sided_dxidt(const double& t) const
+    {
+      if (std::fabs(Ratio - 1.0) < 1.0e-12)
+      {
+        return 1.0;
+      }
+      return std::log(Ratio) * std::pow(Ratio, t) / (Ratio - 1.0);
+    }
+
+  private:
+    /// Ratio of largest and smallest element lengths
+    double Ratio;
+  };
+
+
+  //=========================================================================
+  /// Hyperbolic tangent grading: xi(t) = 1 + tanh(delta (t-1))/tanh(delta).
+  /// The stretching parameter delta controls the strength of the
+  /// clustering; the ratio of the element lengths at the coarse and the
+  /// fine ends is cosh^2(delta).
+  //=========================================================================
+  class TanhOneDMeshGrading : public ClusteredOneDMeshGrading
+  {
+  public:
+    /// Constructor: Specify stretching parameter delta (>=0) and where
+    /// to cluster the nodes
+    TanhOneDMeshGrading(const double& delta, const ClusteringType& clustering)
+      : ClusteredOneDMeshGrading(clustering), Delta(delta)
+    {
+#ifdef PARANOID
+      if (delta < 0.0)
+      {
+        std::ostringstream error_message;
+        error_message << "Stretching parameter must not be negative, not "
+                      << delta << std::endl;
+        throw OomphLibError(error_message.str(),
+                            OOMPH_CURRENT_FUNCTION,
+                            OOMPH_EXCEPTION_LOCATION);
+      }
+#endif
+    }
+
+  protected:
+    /// One-sided mapping that clusters the nodes at t=0
+    double one_sided_xi(const double& t) const
+    {
+      if (Delta < 1.0e-8)
+      {
+        return t;
+      }
+      return 1.0 + std::tanh(Delta * (t - 1.0)) / std::tanh(Delta);
+    }
+
+    /// Derivative of the one-sided mapping
+    double one_sided_dxidt(const double& t) const
+    {
+      if (Delta < 1.0e-8)
+      {
+        return 1.0;
+      }
+      double c = std::cosh(Delta * (t - 1.0));
+      return Delta / (std::tanh(Delta) * c * c);
+    }
+
+  private:
+    /// Stretching parameter
+    double Delta;
+  };
+
+
+  //=========================================================================
+  /// Grading defined by a user-specified (positive) element density
+  /// rho(xi), xi in [0,1]: the number of elements in [0,xi] is proportional
+  /// to int_0^xi rho, i.e. the local element length is inversely
+  /// proportional to rho. The mapping is obtained by inverting the
+  /// cumulative density which is tabulated (using Gauss quadrature) when
+  /// the object is constructed.
+  //=========================================================================
+  class DensityOneDMeshGrading : public OneDMeshGrading
+  {
+  public:
+    /// Function pointer to element density
+    typedef double (*DensityFctPt)(const double& xi);
+
+    /// Constructor: Pass element density and (optionally) the number of
+    /// intervals used to tabulate its integral
+    DensityOneDMeshGrading(DensityFctPt density_fct_pt,
+                           const unsigned& n_table = 1000)
+      : Density_fct_pt(density_fct_pt)
+    {
+      tabulate(n_table);
+    }
+
+    /// Mapped coordinate xi(t)
+    double xi(const double& t) const
+    {
+      // Target value of the cumulative density
+      double target = t * Cumulative_density.back();
+
+      // Bracketing interval in the table
+      unsigned n_table = Cumulative_density.size() - 1;
+      std::vector<double>::const_iterator it =
+        std::upper_bound(Cumulative_density.begin(),
+                         Cumulative_density.end(),
+                         target);
+      int k = int(it - Cumulative_density.begin()) - 1;
+      if (k < 0) k = 0;
+      if (k > int(n_table) - 1) k = n_table - 1;
+
+      // Safeguarded Newton iteration for the root within the interval,
+      // based on the cubic Hermite interpolant of the cumulative
+      // density (whose derivative is the density itself)
+      double h = 1.0 / double(n_table);
+      double xi_left = double(k) * h;
+      double a = 0.0;
+      double b = 1.0;
+      double rho_left = Density_fct_pt(xi_left);
+      double rho_right = Density_fct_pt(xi_left + h);
+      double f_left = Cumulative_density[k];
+      double f_right = Cumulative_density[k + 1];
+      double u = 0.5;
+      if (f_right > f_left)
+      {
+        u = (target - f_left) / (f_right - f_left);
+      }
+      for (unsigned iter = 0; iter < 50; iter++)
+      {
+        double u2 = u * u;
+        double u3 = u2 * u;
+        double f = (2.0 * u3 - 3.0 * u2 + 1.0) * f_left +
+                   (u3 - 2.0 * u2 + u) * h * rho_left +
+                   (-2.0 * u3 + 3.0 * u2) * f_right +
+                   (u3 - u2) * h * rho_right - target;
+        double df = (6.0 * u2 - 6.0 * u) * f_left +
+                    (3.0 * u2 - 4.0 * u + 1.0) * h * rho_left +
+                    (-6.0 * u2 + 6.0 * u) * f_right +
+                    (3.0 * u2 - 2.0 * u) * h * rho_right;
+        if (f > 0.0)
+        {
+          b = u;
+        }
+        else
+        {
+          a = u;
+        }
+        double u_new = u - f / df;
+        if ((df <= 0.0) || (u_new <= a) || (u_new >= b))
+        {
+          u_new = 0.5 * (a + b);
+        }
+        if (std::fabs(u_new - u) < 1.0e-14)
+        {
+          u = u_new;
+          break;
+        }
+        u = u_new;
+      }
+      return xi_left + u * h;
+    }
+
+    /// Derivative dxi/dt of the mapping
+    double dxidt(const double& t) const
+    {
+      return Cumulative_density.back() / Density_fct_pt(xi(t));
+    }
+
+  private:
+    /// Tabulate the cumulative density at n_table+1 equally spaced points
+    void tabulate(const unsigned& n_table)
+    {
+#ifdef PARANOID
+      if (n_table == 0)
+      {
+        throw OomphLibError("Need at least one interval in the table",
+                            OOMPH_CURRENT_FUNCTION,
+                            OOMPH_EXCEPTION_LOCATION);
+      }
+#endif
+      // Three-point Gauss rule on [-1,1]
+      const double s_gauss[3] = {-std::sqrt(0.6), 0.0, std::sqrt(0.6)};
+      const double w_gauss[3] = {5.0 / 9.0, 8.0 / 9.0, 5.0 / 9.0};
+
+      double h = 1.0 / double(n_table);
+      Cumulative_density.assign(n_table + 1, 0.0);
+      for (unsigned k = 0; k < n_table; k++)
+      {
+        double integral = 0.0;
+        for (unsigned i = 0; i < 3; i++)
+        {
+          double rho =
+            Density_fct_pt((double(k) + 0.5 * (1.0 + s_gauss[i])) * h);
+#ifdef PARANOID
+          if (rho <= 0.0)
+          {
+            std::ostringstream error_message;
+            error_message << "Element density must be positive; found "
+                          << rho << std::endl;
+            throw OomphLibError(error_message.str(),
+                                OOMPH_CURRENT_FUNCTION,
+                                OOMPH_EXCEPTION_LOCATION);
+          }
+#endif
+          integral += 0.5 * h * w_gauss[i] * rho;
+        }
+        Cumulative_density[k + 1] = Cumulative_density[k] + integral;
+      }
+    }
+
+    /// Pointer to element density
+    DensityFctPt Density_fct_pt;
+
+    /// Integral of the density from 0 to the k-th table point
+    std::vector<double> Cumulative_density;
+  };
+
+
+  //=========================================================================
+  /// Grading that equidistributes a monitor function, specified by its
+  /// values at a set of (increasing) sample points and interpolated
+  /// linearly between them: the integral of the monitor function is the
+  /// same for all elements. The samples are optionally smoothed to avoid
+  /// abrupt changes in element size.
+  //=========================================================================
+  class EquidistributingOneDMeshGrading : public OneDMeshGrading
+  {
+  public:
+    /// Constructor: Pass (strictly increasing) sample points, the
+    /// (positive) values of the monitor function there and the number
+    /// of smoothing sweeps applied to the monitor function
+    EquidistributingOneDMeshGrading(const Vector<double>& xi_sample,
+                                    const Vector<double>& monitor,
+                                    const unsigned& n_smooth = 2)
+    {
+      unsigned n_sample = xi_sample.size();
+#ifdef PARANOID
+      if ((n_sample < 2) || (monitor.size() != n_sample))
+      {
+        std::ostringstream error_message;
+        error_message << "Need at least two samples and as many monitor "
+                      << "values as sample points; have " << n_sample
+                      << " sample points and " << monitor.size()
+                      << " monitor values" << std::endl;
+        throw OomphLibError(error_message.str(),
+                            OOMPH_CURRENT_FUNCTION,
+                            OOMPH_EXCEPTION_LOCATION);
+      }
+#endif
+
+      // Normalise the sample points to [0,1]
+      double xi_min = xi_sample[0];
+      double xi_range = xi_sample[n_sample - 1] - xi_min;
+      Xi.resize(n_sample);
+      Monitor.resize(n_sample);
+      for (unsigned k = 0; k < n_sample; k++)
+      {
+        Xi[k] = (xi_sample[k] - xi_min) / xi_range;
+        Monitor[k] = monitor[k];
+#ifdef PARANOID
+        if (monitor[k] <= 0.0)
+        {
+          std::ostringstream error_message;
+          error_message << "Monitor function must be positive; found "
+                        << monitor[k] << " at sample point " << k
+                        << std::endl;
+          throw OomphLibError(error_message.str(),
+                              OOMPH_CURRENT_FUNCTION,
+                              OOMPH_EXCEPTION_LOCATION);
+        }
+        if ((k > 0) && (xi_sample[k] <= xi_sample[k - 1]))
+        {
+          std::ostringstream error_message;
+          error_message << "Sample points must be strictly increasing"
+                        << std::endl;
+          throw OomphLibError(error_message.str(),
+                              OOMPH_CURRENT_FUNCTION,
+                              OOMPH_EXCEPTION_LOCATION);
+        }
+#endif
+      }
+
+      // Smooth with the (1,2,1)/4 filter; end values are retained
+      std::vector<double> backup(n_sample);
+      for (unsigned sweep = 0; sweep < n_smooth; sweep++)
+      {
+        for (unsigned k = 0; k < n_sample; k++)
+        {
+          backup[k] = Monitor[k];
+        }
+        for (unsigned k = 1; k + 1 < n_sample; k++)
+        {
+          Monitor[k] =
+            0.25 * (backup[k - 1] + 2.0 * backup[k] + backup[k + 1]);
+        }
+      }
+
+      // Cumulative integral of the (piecewise linear) monitor function
+      Cumulative_monitor.assign(n_sample, 0.0);
+      for (unsigned k = 1; k < n_sample; k++)
+      {
+        Cumulative_monitor[k] =
+          Cumulative_monitor[k - 1] +
+          0.5 * (Xi[k] - Xi[k - 1]) * (Monitor[k] + Monitor[k - 1]);
+      }
+    }
+
+    /// Mapped coordinate xi(t)
+    double xi(const double& t) const
+    {
+      // Target value of the cumulative monitor function
+      double target = t * Cumulative_monitor.back();
+
+      // Bracketing interval
+      unsigned n_sample = Xi.size();
+      std::vector<double>::const_iterator it = std::upper_bound(
+        Cumulative_monitor.begin(), Cumulative_monitor.end(), target);
+      int k = int(it - Cumulative_monitor.begin()) - 1;
+      if (k < 0) k = 0;
+      if (k > int(n_sample) - 2) k = n_sample - 2;
+
+      // The cumulative monitor function is quadratic within the
+      // interval; solve for the offset (in a form that is stable if the
+      // monitor function is locally constant)
+      double h = Xi[k + 1] - Xi[k];
+      double slope = (Monitor[k + 1] - Monitor[k]) / h;
+      double r = target - Cumulative_monitor[k];
+      double discriminant = Monitor[k] * Monitor[k] + 2.0 * slope * r;
+      if (discriminant < 0.0) discriminant = 0.0;
+      double u = 2.0 * r / (Monitor[k] + std::sqrt(discriminant));
+      if (u < 0.0) u = 0.0;
+      if (u > h) u = h;
+      return Xi[k] + u;
+    }
+
+    /// Derivative dxi/dt of the mapping
+    double dxidt(const double& t) const
+    {
+      return Cumulative_monitor.back() / monitor(xi(t));
+    }
+
+  private:
+    /// Linearly interpolated monitor function
+    double monitor(const double& xi) const
+    {
+      unsigned n_sample = Xi.size();
+      std::vector<double>::const_iterator it =
+        std::upper_bound(Xi.begin(), Xi.end(), xi);
+      int k = int(it - Xi.begin()) - 1;
+      if (k < 0) k = 0;
+      if (k > int(n_sample) - 2) k = n_sample - 2;
+      double u = (xi - Xi[k]) / (Xi[k + 1] - Xi[k]);
+      return (1.0 - u) * Monitor[k] + u * Monitor[k + 1];
+    }
+
+    /// Normalised sample points
+    std::vector<double> Xi;
+
+    /// (Smoothed) monitor function at the sample points
+    std::vector<double> Monitor;
+
+    /// Integral of the monitor function from 0 to the k-th sample point
+    std::vector<double> Cumulative_monitor;
+  };
+
+
+  //=========================================================================
+  /// OneDLagrangianMesh whose nodes are distributed according to a
+  /// OneDMeshGrading rather than uniformly. The Lagrangian coordinate
+  /// of each node and its derivative w.r.t. the local coordinate, which
+  /// acts as the Hermite slope dof xi_gen(1,0), are taken from the
+  /// (smooth) grading; the nodal positions and their slopes then follow
+  /// from the undeformed GeomObject via the chain rule, so the Hermite
+  /// interpolation of both the Lagrangian coordinate and the undeformed
+  /// shape is continuous and consistent across elements of different
+  /// sizes. The nodes can also be moved while the beam is deformed
+  /// (r-adaptivity), in which case the current (Hermite) solution is
+  /// interpolated onto the new nodes.
+  //=========================================================================
+  template<class ELEMENT>
+  class GradedOneDLagrangianMesh : public OneDLagrangianMesh<ELEMENT>
+  {
+  public:
+    /// Constructor: Pass number of elements, length (in terms of the
+    /// Lagrangian coordinate), GeomObject that specifies the undeformed
+    /// shape, the grading (null for uniform spacing) and (optionally) the
+    /// timestepper
+    GradedOneDLagrangianMesh(
+      const unsigned& n_element,
+      const double& length,
+      GeomObject* const& undef_eulerian_posn_pt,
+      OneDMeshGrading* const& grading_pt,
+      TimeStepper* time_stepper_pt = &Mesh::Default_TimeStepper)
+      : OneDLagrangianMesh<ELEMENT>(
+          n_element, length, undef_eulerian_posn_pt, time_stepper_pt),
+        Length(length),
+        Undef_eulerian_posn_pt(undef_eulerian_posn_pt)
+    {
+      // Base class has already placed the nodes uniformly
+      if (grading_pt != 0)
+      {
+        regrade(grading_pt);
+      }
+    }
+
+    /// Re-distribute the nodes according to the specified grading (null
+    /// for uniform spacing) and reset them to the undeformed configuration
+    void regrade(OneDMeshGrading* const& grading_pt)
+    {
+      unsigned n_element = this->nelement();
+      unsigned n_dim = Undef_eulerian_posn_pt->ndim();
+      Vector<double> zeta(1);
+      Vector<double> r(n_dim);
+      DenseMatrix<double> drdzeta(1, n_dim);
+
+      // Derivative of the uniform coordinate t w.r.t. the local coordinate
+      double dtds = 0.5 / double(n_element);
+
+      for (unsigned e = 0; e < n_element; e++)
+      {
+        FiniteElement* el_pt = this->finite_element_pt(e);
+        unsigned n_node = el_pt->nnode();
+        for (unsigned j = 0; j < n_node; j++)
+        {
+          SolidNode* nod_pt = static_cast<SolidNode*>(el_pt->node_pt(j));
+
+          // Uniform coordinate of the node
+          double t = (double(e) + double(j) / double(n_node - 1)) /
+                     double(n_element);
+
+          // Lagrangian coordinate and its derivative w.r.t. the local
+          // coordinate
+          zeta[0] = Length * t;
+          double dxids = Length * dtds;
+          if (grading_pt != 0)
+          {
+            zeta[0] = Length * grading_pt->xi(t);
+            dxids *= grading_pt->dxidt(t);
+          }
+          nod_pt->xi(0) = zeta[0];
+          if (nod_pt->nlagrangian_type() > 1)
+          {
+            nod_pt->xi_gen(1, 0) = dxids;
+          }
+
+          // Undeformed position and its slope
+          Undef_eulerian_posn_pt->position(zeta, r);
+          Undef_eulerian_posn_pt->dposition(zeta, drdzeta);
+          for (unsigned i = 0; i < n_dim; i++)
+          {
+            nod_pt->x_gen(0, i) = r[i];
+            if (nod_pt->nposition_type() > 1)
+            {
+              nod_pt->x_gen(1, i) = drdzeta(0, i) * dxids;
+            }
+          }
+        }
+      }
+    }
+
+    /// Move the nodes to the distribution specified by the grading
+    /// without changing the (deformed) shape of the beam: the nodal
+    /// positions and slopes are obtained by interpolating the current
+    /// solution at the new Lagrangian coordinates.
+    void redistribute_nodes(OneDMeshGrading* const& grading_pt)
+    {
+      unsigned n_element = this->nelement();
+      unsigned n_dim = this->finite_element_pt(0)->node_pt(0)->ndim();
+      double dtds = 0.5 / double(n_element);
+
+      // Evaluate the current solution at the nodes' new Lagrangian
+      // coordinates before moving any of them. (One entry per vertex
+      // node; a OneDLagrangianMesh of Hermite elements has n_element+1.)
+      Vector<double> new_xi(n_element + 1);
+      Vector<double> new_dxids(n_element + 1);
+      Vector<Vector<double>> new_x(n_element + 1, Vector<double>(n_dim));
+      Vector<Vector<double>> new_dxdxi(n_element + 1,
+                                       Vector<double>(n_dim));
+      for (unsigned j = 0; j <= n_element; j++)
+      {
+        double t = double(j) / double(n_element);
+        new_xi[j] = Length * grading_pt->xi(t);
+        new_dxids[j] = Length * grading_pt->dxidt(t) * dtds;
+
+        // Locate the point in the current mesh
+        unsigned e = 0;
+        double s = 0.0;
+        locate_lagrangian_coordinate(new_xi[j], e, s);
+
+        // Position and its derivative w.r.t. the Lagrangian coordinate
+        double dxids_old = 0.0;
+        Vector<double> drds(n_dim);
+        double curvature = 0.0;
+        interpolate(e, s, new_x[j], drds, dxids_old, curvature);
+        for (unsigned i = 0; i < n_dim; i++)
+        {
+          new_dxdxi[j][i] = drds[i] / dxids_old;
+        }
+      }
+
+      // Now move the nodes
+      for (unsigned e = 0; e < n_element; e++)
+      {
+        FiniteElement* el_pt = this->finite_element_pt(e);
+        for (unsigned l = 0; l < 2; l++)
+        {
+          SolidNode* nod_pt = static_cast<SolidNode*>(el_pt->node_pt(l));
+          unsigned j = e + l;
+          nod_pt->xi(0) = new_xi[j];
+          nod_pt->xi_gen(1, 0) = new_dxids[j];
+          for (unsigned i = 0; i < n_dim; i++)
+          {
+            nod_pt->x_gen(0, i) = new_x[j][i];
+            nod_pt->x_gen(1, i) = new_dxdxi[j][i] * new_dxids[j];
+          }
+        }
+      }
+    }
+
+    /// Tabulate the curvature-based monitor function
+    /// |dR/dxi| sqrt(1 + weight kappa^2) (i.e. the deformed arclength,
+    /// weighted by the curvature kappa) at n_sample points per element
+    /// plus the two ends of the beam
+    void get_curvature_monitor(const double& weight,
+                               const unsigned& n_sample,
+                               Vector<double>& xi,
+                               Vector<double>& monitor)
+    {
+      unsigned n_element = this->nelement();
+      unsigned n_dim = this->finite_element_pt(0)->node_pt(0)->ndim();
+      xi.clear();
+      monitor.clear();
+      Vector<double> r(n_dim);
+      Vector<double> drds(n_dim);
+      for (unsigned e = 0; e < n_element; e++)
+      {
+        // First element contributes its left end, last one its right end
+        unsigned n_point = n_sample;
+        if (e == 0) n_point++;
+        if (e == n_element - 1) n_point++;
+        for (unsigned k = 0; k < n_point; k++)
+        {
+          double s = 0.0;
+          if ((e == 0) && (k == 0))
+          {
+            s = -1.0;
+          }
+          else if ((e == n_element - 1) && (k == n_point - 1))
+          {
+            s = 1.0;
+          }
+          else
+          {
+            unsigned kk = k;
+            if (e == 0) kk--;
+            s = -1.0 + (2.0 * double(kk) + 1.0) / double(n_sample);
+          }
+
+          double dxids = 0.0;
+          double curvature = 0.0;
+          interpolate(e, s, r, drds, dxids, curvature);
+          double drds_norm = 0.0;
+          for (unsigned i = 0; i < n_dim; i++)
+          {
+            drds_norm += drds[i] * drds[i];
+          }
+          drds_norm = std::sqrt(drds_norm);
+
+          xi.push_back(
+            static_cast<SolidFiniteElement*>(this->finite_element_pt(e))
+              ->interpolated_xi(Vector<double>(1, s), 0));
+          monitor.push_back(drds_norm / dxids *
+                            std::sqrt(1.0 + weight * curvature * curvature));
+        }
+      }
+    }
+
+    /// Write the nodes' Lagrangian coordinates and their slopes (which
+    /// are not part of the problem's dump if the mesh has been moved)
+    void dump_lagrangian_coordinates(std::ostream& dump_file)
+    {
+      unsigned n_node = this->nnode();
+      dump_file << n_node << " # number of nodes" << std::endl;
+      for (unsigned j = 0; j < n_node; j++)
+      {
+        SolidNode* nod_pt = this->node_pt(j);
+        dump_file << nod_pt->xi(0) << " " << nod_pt->xi_gen(1, 0)
+                  << std::endl;
+      }
+    }
+
+    /// Read the nodes' Lagrangian coordinates and their slopes
+    void read_lagrangian_coordinates(std::istream& restart_file)
+    {
+      std::string input_string;
+      getline(restart_file, input_string, '#');
+      restart_file.ignore(80, '\n');
+      unsigned n_node = unsigned(atoi(input_string.c_str()));
+      if (n_node != this->nnode())
+      {
+        std::ostringstream error_message;
+        error_message << "Number of nodes in restart file (" << n_node
+                      << ") doesn't match the mesh (" << this->nnode()
+                      << ")" << std::endl;
+        throw OomphLibError(error_message.str(),
+                            OOMPH_CURRENT_FUNCTION,
+                            OOMPH_EXCEPTION_LOCATION);
+      }
+      for (unsigned j = 0; j < n_node; j++)
+      {
+        SolidNode* nod_pt = this->node_pt(j);
+        restart_file >> nod_pt->xi(0) >> nod_pt->xi_gen(1, 0);
+      }
+      restart_file.ignore(80, '\n');
+    }
+
+  private:
+    /// Find the element e and local coordinate s at which the
+    /// (Hermite-interpolated) Lagrangian coordinate equals xi
+    void locate_lagrangian_coordinate(const double& xi,
+                                      unsigned& e,
+                                      double& s)
+    {
+      // Bisection over the (monotonically increasing) vertex nodes
+      unsigned n_element = this->nelement();
+      unsigned e_low = 0;
+      unsigned e_high = n_element - 1;
+      while (e_low < e_high)
+      {
+        unsigned e_mid = (e_low + e_high + 1) / 2;
+        if (static_cast<SolidNode*>(this->finite_element_pt(e_mid)->node_pt(0))
+              ->xi(0) <= xi)
+        {
+          e_low = e_mid;
+        }
+        else
+        {
+          e_high = e_mid - 1;
+        }
+      }
+      e = e_low;
+
+      // Newton iteration for the local coordinate, starting from the
+      // affine approximation
+      FiniteElement* el_pt = this->finite_element_pt(e);
+      SolidNode* left_nod_pt = static_cast<SolidNode*>(el_pt->node_pt(0));
+      SolidNode* right_nod_pt = static_cast<SolidNode*>(el_pt->node_pt(1));
+      double xi_left = left_nod_pt->xi(0);
+      double xi_right = right_nod_pt->xi(0);
+      s = -1.0 + 2.0 * (xi - xi_left) / (xi_right - xi_left);
+      Vector<double> r(el_pt->node_pt(0)->ndim());
+      Vector<double> drds(el_pt->node_pt(0)->ndim());
+      for (unsigned iter = 0; iter < 20; iter++)
+      {
+        double dxids = 0.0;
+        double curvature = 0.0;
+        interpolate(e, s, r, drds, dxids, curvature);
+        double residual =
+          static_cast<SolidFiniteElement*>(el_pt)->interpolated_xi(
+            Vector<double>(1, s), 0) -
+          xi;
+        double ds = -residual / dxids;
+        s += ds;
+        if (s < -1.0) s = -1.0;
+        if (s > 1.0) s = 1.0;
+        if (std::fabs(ds) < 1.0e-14) break;
+      }
+    }
+
+    /// Interpolate position r, its derivative w.r.t. the local
+    /// coordinate, the derivative of the Lagrangian coordinate w.r.t. the
+    /// local coordinate and the curvature at local coordinate s in
+    /// element e
+    void interpolate(const unsigned& e,
+                     const double& s,
+                     Vector<double>& r,
+                     Vector<double>& drds,
+                     double& dxids,
+                     double& curvature)
+    {
+      FiniteElement* el_pt = this->finite_element_pt(e);
+      unsigned n_node = el_pt->nnode();
+      unsigned n_position_type = el_pt->nnodal_position_type();
+      unsigned n_dim = el_pt->node_pt(0)->ndim();
+      Shape psi(n_node, n_position_type);
+      DShape dpsids(n_node, n_position_type, 1);
+      DShape d2psids(n_node, n_position_type, 1);
+      el_pt->d2shape_local(Vector<double>(1, s), psi, dpsids, d2psids);
+
+      Vector<double> d2rds2(n_dim, 0.0);
+      for (unsigned i = 0; i < n_dim; i++)
+      {
+        r[i] = 0.0;
+        drds[i] = 0.0;
+      }
+      dxids = 0.0;
+      for (unsigned l = 0; l < n_node; l++)
+      {
+        SolidNode* nod_pt = static_cast<SolidNode*>(el_pt->node_pt(l));
+        for (unsigned k = 0; k < n_position_type; k++)
+        {
+          dxids += nod_pt->xi_gen(k, 0) * dpsids(l, k, 0);
+          for (unsigned i = 0; i < n_dim; i++)
+          {
+            r[i] += nod_pt->x_gen(k, i) * psi(l, k);
+            drds[i] += nod_pt->x_gen(k, i) * dpsids(l, k, 0);
+            d2rds2[i] += nod_pt->x_gen(k, i) * d2psids(l, k, 0);
+          }
+        }
+      }
+
+      // Curvature (independent of the parametrisation; planar curves only)
+      curvature = 0.0;
+      if (n_dim == 2)
+      {
+        double drds_norm = std::sqrt(drds[0] * drds[0] + drds[1] * drds[1]);
+        curvature = (drds[0] * d2rds2[1] - drds[1] * d2rds2[0]) /
+                    (drds_norm * drds_norm * drds_norm);
+      }
+    }
+
+    /// Length of the domain (in terms of the Lagrangian coordinate)
+    double Length;
+
+    /// GeomObject that specifies the undeformed shape
+    GeomObject* Undef_eulerian_posn_pt;
+  };
+
+} // namespace oomph
+
+#endif
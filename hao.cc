@@ -30,6 +30,9 @@
 #include "beam.h"
 #include "meshes/one_d_lagrangian_mesh.h"
 
+// Local includes
+#include "beam_preconditioners.h"
+
 using namespace std;
 using namespace oomph;
 
@@ -200,7 +203,10 @@ public:
 
 
 protected:
-  // Fill in contribution to residuals
+  // Fill in contribution to residuals. Note: The Jacobian is still
+  // obtained by finite differencing (GeneralisedElement's default);
+  // the RigidBodyElement in reparametrise_beam_test.cc has the version
+  // that differentiates the drag and torque automatically.
   void fill_in_contribution_to_residuals(Vector<double>& residuals)
   {
     oomph_info << "ndof in element: " << residuals.size() << std::endl;
@@ -1275,6 +1281,22 @@ ElasticBeamProblem::ElasticBeamProblem(const unsigned& n_elem, const double& q)
   // Assign the global and local equation numbers
   cout << "# of dofs " << assign_eqn_numbers() << std::endl;
 
+  // Use GMRES, preconditioned by geometric multigrid?
+  if (CommandLineArgs::command_line_flag_has_been_set("--multigrid"))
+  {
+    HermiteBeamMultigridPreconditioner* prec_pt =
+      new HermiteBeamMultigridPreconditioner;
+    Vector<SolidMesh*> beam_mesh_pt(2);
+    beam_mesh_pt[0] = Beam_mesh_pt;
+    beam_mesh_pt[1] = Beam_mesh_second_arm_pt;
+    prec_pt->set_beam_meshes(beam_mesh_pt);
+    prec_pt->enable_doc_hierarchy();
+
+    GMRES<CRDoubleMatrix>* solver_pt = new GMRES<CRDoubleMatrix>;
+    solver_pt->preconditioner_pt() = prec_pt;
+    linear_solver_pt() = solver_pt;
+  }
+
 } // end of constructor
 
 
@@ -1329,8 +1351,20 @@ void ElasticBeamProblem::parameter_study()
 //========start_of_main================================================
 /// Driver for beam (string under tension) test problem
 //=====================================================================
-int main()
+int main(int argc, char** argv)
 {
+  // Store command line arguments
+  CommandLineArgs::setup(argc, argv);
+
+  // Use GMRES with geometric multigrid preconditioner
+  CommandLineArgs::specify_command_line_flag("--multigrid");
+
+  // Parse command line
+  CommandLineArgs::parse_and_assign();
+
+  // Doc what has actually been specified on the command line
+  CommandLineArgs::doc_specified_flags();
+
   // Set the non-dimensional thickness
   Global_Physical_Variables::H = 0.01;
 
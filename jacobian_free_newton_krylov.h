@@ -0,0 +1,468 @@
+// LIC// ====================================================================
+// LIC// This file forms part of oomph-lib, the object-oriented,
+// LIC// multi-physics finite-element library, available
+// LIC// at http://www.oomph-lib.org.
+// LIC//
+// LIC// Copyright (C) 2006-2023 Matthias Heil and Andrew Hazel
+// LIC//
+// LIC// This library is free software; you can redistribute it and/or
+// LIC// modify it under the terms of the GNU Lesser General Public
+// LIC// License as published by the Free Software Foundation; either
+// LIC// version 2.1 of the License, or (at your option) any later version.
+// LIC//
+// LIC// This library is distributed in the hope that it will be useful,
+// LIC// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// LIC// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// LIC// Lesser General Public License for more details.
+// LIC//
+// LIC// You should have received a copy of the GNU Lesser General Public
+// LIC// License along with this library; if not, write to the Free Software
+// LIC// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+// LIC// 02110-1301  USA.
+// LIC//
+// LIC// The authors may be contacted at oomph-lib@maths.man.ac.uk.
+// LIC//
+// LIC//====================================================================
+// Jacobian-free Newton-Krylov linear solver
+
+#ifndef JACOBIAN_FREE_NEWTON_KRYLOV_HEADER
+#define JACOBIAN_FREE_NEWTON_KRYLOV_HEADER
+
+// OOMPH-LIB includes
+#include "generic.h"
+
+namespace oomph
+{
+  //=========================================================================
+  /// Linear solver for use in the Problem's Newton iteration that never
+  /// forms the Jacobian. Jacobian-vector products are approximated by
+  /// directional differences of the assembled residual,
+  ///
+  ///    J v ~ ( R(x + eps v) - R(x) ) / eps,
+  ///
+  /// and the Newton correction is obtained with right-preconditioned,
+  /// restarted GMRES(m). Storage is therefore O(m N) where the Krylov
+  /// dimension m is bounded by krylov_dimension(). The preconditioner
+  /// (if any) is set up once per Newton step; it must not rely on the
+  /// matrix passed to Preconditioner::setup(...) since there is none.
+  ///
+  /// The linearisation point is retained after solve(...) so resolve(...)
+  /// (as required, e.g., by the block elimination in arc-length
+  /// continuation) works with the same (matrix-free) Jacobian.
+  //=========================================================================
+  class JacobianFreeNewtonKrylovSolver : public LinearSolver
+  {
+  public:
+    /// Constructor: Pass pointer to the problem whose residuals are to be
+    /// differentiated
+    JacobianFreeNewtonKrylovSolver(Problem* problem_pt)
+      : Problem_pt(problem_pt),
+        Preconditioner_pt(0),
+        Krylov_dimension(30),
+        Max_iter(500),
+        Tolerance(1.0e-6),
+        Iterations(0),
+        Nresidual_evaluation(0)
+    {
+    }
+
+    /// Broken copy constructor
+    JacobianFreeNewtonKrylovSolver(const JacobianFreeNewtonKrylovSolver& dummy) =
+      delete;
+
+    /// Broken assignment operator
+    void operator=(const JacobianFreeNewtonKrylovSolver&) = delete;
+
+    /// Destructor (empty; preconditioner isn't owned)
+    ~JacobianFreeNewtonKrylovSolver() {}
+
+    /// Access to (right) preconditioner
+    Preconditioner*& preconditioner_pt()
+    {
+      return Preconditioner_pt;
+    }
+
+    /// Max. dimension of the Krylov subspace before restart
+    unsigned& krylov_dimension()
+    {
+      return Krylov_dimension;
+    }
+
+    /// Max. total number of GMRES iterations per solve
+    unsigned& max_iter()
+    {
+      return Max_iter;
+    }
+
+    /// Relative tolerance for the GMRES residual
+    double& tolerance()
+    {
+      return Tolerance;
+    }
+
+    /// Number of GMRES iterations taken in most recent solve
+    unsigned iterations() const
+    {
+      return Iterations;
+    }
+
+    /// Number of residual evaluations in most recent solve
+    unsigned nresidual_evaluation() const
+    {
+      return Nresidual_evaluation;
+    }
+
+    /// Solve J dx = R(x) at the current dofs of the problem (which must be
+    /// the problem passed to the constructor), returning dx in result.
+    void solve(Problem* const& problem_pt, DoubleVector& result)
+    {
+#ifdef PARANOID
+      if (problem_pt != Problem_pt)
+      {
+        throw OomphLibError(
+          "Solver was constructed for a different problem",
+          OOMPH_CURRENT_FUNCTION,
+          OOMPH_EXCEPTION_LOCATION);
+      }
+#endif
+      double t_start = TimingHelpers::timer();
+
+      // Store linearisation point and the residuals there
+      const unsigned n_dof = Problem_pt->ndof();
+      Linearisation_point.resize(n_dof);
+      for (unsigned i = 0; i < n_dof; i++)
+      {
+        Linearisation_point[i] = Problem_pt->dof(i);
+      }
+      DoubleVector residuals;
+      Problem_pt->get_residuals(residuals);
+      Residuals_at_linearisation_point.resize(n_dof);
+      for (unsigned i = 0; i < n_dof; i++)
+      {
+        Residuals_at_linearisation_point[i] = residuals[i];
+      }
+      Nresidual_evaluation = 1;
+
+      // Set up the preconditioner at the new linearisation point
+      if (Preconditioner_pt != 0)
+      {
+        Preconditioner_pt->setup();
+      }
+
+      // Solve
+      result.build(Problem_pt->dof_distribution_pt(), 0.0);
+      gmres(Residuals_at_linearisation_point, result);
+
+      if (Doc_time)
+      {
+        oomph_info << "Time for JFNK solve [sec]: "
+                   << TimingHelpers::timer() - t_start << " ("
+                   << Iterations << " GMRES iterations, "
+                   << Nresidual_evaluation << " residual evaluations)"
+                   << std::endl;
+      }
+    }
+
+    /// Re-solve with the same (matrix-free) Jacobian and preconditioner
+    /// but a new right-hand side
+    void resolve(const DoubleVector& rhs, DoubleVector& result)
+    {
+#ifdef PARANOID
+      if (Linearisation_point.size() != Problem_pt->ndof())
+      {
+        throw OomphLibError("resolve() called before solve()",
+                            OOMPH_CURRENT_FUNCTION,
+                            OOMPH_EXCEPTION_LOCATION);
+      }
+#endif
+      const unsigned n_dof = Problem_pt->ndof();
+      Vector<double> b(n_dof);
+      for (unsigned i = 0; i < n_dof; i++)
+      {
+        b[i] = rhs[i];
+      }
+      Nresidual_evaluation = 0;
+      result.build(Problem_pt->dof_distribution_pt(), 0.0);
+      gmres(b, result);
+    }
+
+    /// Wipe the stored linearisation point
+    void clean_up_memory()
+    {
+      Linearisation_point.clear();
+      Residuals_at_linearisation_point.clear();
+    }
+
+  private:
+    /// Directional difference approximation to J v
+    void jacobian_vector_product(const Vector<double>& v, Vector<double>& jv);
+
+    /// Right-preconditioned, restarted GMRES for J x = b
+    void gmres(const Vector<double>& b, DoubleVector& x);
+
+    /// Apply the preconditioner (or identity if there isn't one)
+    void apply_preconditioner(const Vector<double>& r, Vector<double>& z)
+    {
+      const unsigned n_dof = r.size();
+      if (Preconditioner_pt == 0)
+      {
+        z = r;
+        return;
+      }
+      DoubleVector r_vec(Problem_pt->dof_distribution_pt(), 0.0);
+      DoubleVector z_vec(Problem_pt->dof_distribution_pt(), 0.0);
+      for (unsigned i = 0; i < n_dof; i++)
+      {
+        r_vec[i] = r[i];
+      }
+      Preconditioner_pt->preconditioner_solve(r_vec, z_vec);
+      z.resize(n_dof);
+      for (unsigned i = 0; i < n_dof; i++)
+      {
+        z[i] = z_vec[i];
+      }
+    }
+
+    /// Pointer to the problem
+    Problem* Problem_pt;
+
+    /// Pointer to the (right) preconditioner
+    Preconditioner* Preconditioner_pt;
+
+    /// Max. dimension of the Krylov subspace before restart
+    unsigned Krylov_dimension;
+
+    /// Max. total number of GMRES iterations
+    unsigned Max_iter;
+
+    /// Relative tolerance
+    double Tolerance;
+
+    /// Number of iterations taken in most recent solve
+    unsigned Iterations;
+
+    /// Number of residual evaluations in most recent solve
+    unsigned Nresidual_evaluation;
+
+    /// Dofs at which the Jacobian is evaluated
+    Vector<double> Linearisation_point;
+
+    /// Residuals at the linearisation point
+    Vector<double> Residuals_at_linearisation_point;
+  };
+
+
+  //=========================================================================
+  /// Directional difference approximation to J v. The increment follows
+  /// Knoll & Keyes (2004): eps = sqrt(eps_mach) (1 + |x|) / |v|.
+  //=========================================================================
+  inline void JacobianFreeNewtonKrylovSolver::jacobian_vector_product(
+    const Vector<double>& v, Vector<double>& jv)
+  {
+    const unsigned n_dof = v.size();
+
+    double v_norm = 0.0;
+    double x_norm = 0.0;
+    for (unsigned i = 0; i < n_dof; i++)
+    {
+      v_norm += v[i] * v[i];
+      x_norm += Linearisation_point[i] * Linearisation_point[i];
+    }
+    v_norm = sqrt(v_norm);
+    x_norm = sqrt(x_norm);
+
+    jv.resize(n_dof);
+    if (v_norm == 0.0)
+    {
+      for (unsigned i = 0; i < n_dof; i++)
+      {
+        jv[i] = 0.0;
+      }
+      return;
+    }
+    const double eps =
+      sqrt(std::numeric_limits<double>::epsilon()) * (1.0 + x_norm) / v_norm;
+
+    // Perturb the dofs, get the residuals and reset
+    for (unsigned i = 0; i < n_dof; i++)
+    {
+      Problem_pt->dof(i) = Linearisation_point[i] + eps * v[i];
+    }
+    DoubleVector residuals;
+    Problem_pt->get_residuals(residuals);
+    Nresidual_evaluation++;
+    for (unsigned i = 0; i < n_dof; i++)
+    {
+      Problem_pt->dof(i) = Linearisation_point[i];
+      jv[i] = (residuals[i] - Residuals_at_linearisation_point[i]) / eps;
+    }
+  }
+
+
+  //=========================================================================
+  /// Right-preconditioned, restarted GMRES for J x = b (with x = 0 as the
+  /// initial guess). Only Krylov_dimension+1 basis vectors are stored.
+  //=========================================================================
+  inline void JacobianFreeNewtonKrylovSolver::gmres(const Vector<double>& b,
+                                                    DoubleVector& x)
+  {
+    const unsigned n_dof = b.size();
+    const unsigned m = Krylov_dimension;
+
+    double b_norm = 0.0;
+    for (unsigned i = 0; i < n_dof; i++)
+    {
+      b_norm += b[i] * b[i];
+    }
+    b_norm = sqrt(b_norm);
+
+    Iterations = 0;
+    if (b_norm == 0.0) return;
+
+    // Krylov basis, Hessenberg matrix and Givens rotations
+    Vector<Vector<double>> basis(m + 1);
+    DenseMatrix<double> hessenberg(m + 1, m, 0.0);
+    Vector<double> cs(m), sn(m), g(m + 1);
+    Vector<double> w, z, r(n_dof);
+
+    double* x_pt = x.values_pt();
+    bool converged = false;
+    while (!converged && Iterations < Max_iter)
+    {
+      // r = b - J x (x is zero at the first sweep)
+      double r_norm = 0.0;
+      if (Iterations == 0)
+      {
+        r = b;
+      }
+      else
+      {
+        Vector<double> x_current(n_dof);
+        for (unsigned i = 0; i < n_dof; i++)
+        {
+          x_current[i] = x_pt[i];
+        }
+        jacobian_vector_product(x_current, w);
+        for (unsigned i = 0; i < n_dof; i++)
+        {
+          r[i] = b[i] - w[i];
+        }
+      }
+      for (unsigned i = 0; i < n_dof; i++)
+      {
+        r_norm += r[i] * r[i];
+      }
+      r_norm = sqrt(r_norm);
+      if (r_norm <= Tolerance * b_norm) break;
+
+      basis[0].resize(n_dof);
+      for (unsigned i = 0; i < n_dof; i++)
+      {
+        basis[0][i] = r[i] / r_norm;
+      }
+      for (unsigned k = 0; k <= m; k++)
+      {
+        g[k] = 0.0;
+      }
+      g[0] = r_norm;
+
+      // Arnoldi with modified Gram-Schmidt
+      unsigned j = 0;
+      for (j = 0; j < m && Iterations < Max_iter; j++)
+      {
+        Iterations++;
+        apply_preconditioner(basis[j], z);
+        jacobian_vector_product(z, w);
+        for (unsigned k = 0; k <= j; k++)
+        {
+          double h = 0.0;
+          for (unsigned i = 0; i < n_dof; i++)
+          {
+            h += w[i] * basis[k][i];
+          }
+          hessenberg(k, j) = h;
+          for (unsigned i = 0; i < n_dof; i++)
+          {
+            w[i] -= h * basis[k][i];
+          }
+        }
+        double h_next = 0.0;
+        for (unsigned i = 0; i < n_dof; i++)
+        {
+          h_next += w[i] * w[i];
+        }
+        h_next = sqrt(h_next);
+        hessenberg(j + 1, j) = h_next;
+
+        // Apply previous rotations to the new column and generate a new
+        // one to eliminate the sub-diagonal entry
+        for (unsigned k = 0; k < j; k++)
+        {
+          const double tmp =
+            cs[k] * hessenberg(k, j) + sn[k] * hessenberg(k + 1, j);
+          hessenberg(k + 1, j) =
+            -sn[k] * hessenberg(k, j) + cs[k] * hessenberg(k + 1, j);
+          hessenberg(k, j) = tmp;
+        }
+        const double denom = sqrt(hessenberg(j, j) * hessenberg(j, j) +
+                                  h_next * h_next);
+        cs[j] = hessenberg(j, j) / denom;
+        sn[j] = h_next / denom;
+        hessenberg(j, j) = denom;
+        hessenberg(j + 1, j) = 0.0;
+        g[j + 1] = -sn[j] * g[j];
+        g[j] = cs[j] * g[j];
+
+        if (std::fabs(g[j + 1]) <= Tolerance * b_norm || h_next == 0.0)
+        {
+          converged = true;
+          j++;
+          break;
+        }
+
+        basis[j + 1].resize(n_dof);
+        for (unsigned i = 0; i < n_dof; i++)
+        {
+          basis[j + 1][i] = w[i] / h_next;
+        }
+      }
+
+      // Back-substitute for the coefficients of the Krylov basis vectors
+      Vector<double> y(j);
+      for (unsigned kk = j; kk > 0; kk--)
+      {
+        const unsigned k = kk - 1;
+        y[k] = g[k];
+        for (unsigned l = k + 1; l < j; l++)
+        {
+          y[k] -= hessenberg(k, l) * y[l];
+        }
+        y[k] /= hessenberg(k, k);
+      }
+
+      // Update the solution: x += M^{-1} V y
+      Vector<double> v_y(n_dof, 0.0);
+      for (unsigned k = 0; k < j; k++)
+      {
+        for (unsigned i = 0; i < n_dof; i++)
+        {
+          v_y[i] += y[k] * basis[k][i];
+        }
+      }
+      apply_preconditioner(v_y, z);
+      for (unsigned i = 0; i < n_dof; i++)
+      {
+        x_pt[i] += z[i];
+      }
+    }
+
+    if (!converged && Iterations >= Max_iter)
+    {
+      oomph_info << "Warning: JFNK GMRES did not converge in " << Max_iter
+                 << " iterations" << std::endl;
+    }
+  }
+
+} // namespace oomph
+
+#endif
@@ -0,0 +1,452 @@
+// LIC// ====================================================================
+// LIC// This file forms part of oomph-lib, the object-oriented,
+// LIC// multi-physics finite-element library, available
+// LIC// at http://www.oomph-lib.org.
+// LIC//
+// LIC// Copyright (C) 2006-2023 Matthias Heil and Andrew Hazel
+// LIC//
+// LIC// This library is free software; you can redistribute it and/or
+// LIC// modify it under the terms of the GNU Lesser General Public
+// LIC// License as published by the Free Software Foundation; either
+// LIC// version 2.1 of the License, or (at your option) any later version.
+// LIC//
+// LIC// This library is distributed in the hope that it will be useful,
+// LIC// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// LIC// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// LIC// Lesser General Public License for more details.
+// LIC//
+// LIC// You should have received a copy of the GNU Lesser General Public
+// LIC// License along with this library; if not, write to the Free Software
+// LIC// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+// LIC// 02110-1301  USA.
+// LIC//
+// LIC// The authors may be contacted at oomph-lib@maths.man.ac.uk.
+// LIC//
+// LIC//====================================================================
+// Linear solver that re-uses the Jacobian's factorisation across Newton
+// iterations and continuation steps (modified Newton/Broyden)
+
+#ifndef JACOBIAN_REUSE_NEWTON_SOLVER_HEADER
+#define JACOBIAN_REUSE_NEWTON_SOLVER_HEADER
+
+// OOMPH-LIB includes
+#include "generic.h"
+
+namespace oomph
+{
+  //=========================================================================
+  /// Linear solver for use in the Problem's Newton iteration (including
+  /// the one in arc-length continuation) that keeps the LU factorisation
+  /// of the Jacobian across Newton iterations and continuation steps.
+  /// The inverse of the "frozen" Jacobian, J_0^{-1}, is corrected by
+  /// (good) Broyden rank-one updates,
+  ///
+  ///    H_{k+1} = (I + (s - H_k y) s^T / (s^T H_k y)) H_k,
+  ///
+  /// where s is the change in the dofs between successive calls and y is
+  /// the corresponding change in the residuals (evaluated at the same
+  /// value of the continuation parameter, if one is specified, so y
+  /// doesn't pick up the change in the residuals due to the change in
+  /// the parameter). Only the vectors of the rank-one updates are stored;
+  /// applying H_k costs one back-substitution plus O(k N) operations.
+  ///
+  /// The Jacobian is re-assembled and re-factorised only if the residual
+  /// fails to contract by (at least) the factor max_contraction_rate()
+  /// between successive Newton iterations of a step, or once the max.
+  /// number of Broyden updates has been reached. Call start_new_step()
+  /// before each (continuation) step so the contraction rate isn't
+  /// assessed across the predictor, and doc_statistics(...) after it.
+  ///
+  /// resolve(...) (as required by the block elimination in arc-length
+  /// continuation) applies the same approximate inverse, H_k.
+  //=========================================================================
+  class JacobianReuseNewtonSolver : public LinearSolver
+  {
+  public:
+    /// Constructor: Pass pointer to the problem. The Jacobian is
+    /// factorised with SuperLU.
+    JacobianReuseNewtonSolver(Problem* problem_pt)
+      : Problem_pt(problem_pt),
+        Factorisation_solver_pt(new SuperLUSolver),
+        Parameter_pt(0),
+        Max_contraction_rate(0.5),
+        Max_broyden_update(20),
+        Use_broyden_update(true),
+        Have_factorisation(false),
+        Parameter_at_previous_solve(0.0),
+        Previous_residual_norm(0.0),
+        Nsolve_in_step(0),
+        Nfactorisation_in_step(0),
+        Nbroyden_update_in_step(0),
+        Nsolve_total(0),
+        Nfactorisation_total(0),
+        Nstep(0)
+    {
+      Factorisation_solver_pt->enable_resolve();
+    }
+
+    /// Broken copy constructor
+    JacobianReuseNewtonSolver(const JacobianReuseNewtonSolver& dummy) =
+      delete;
+
+    /// Broken assignment operator
+    void operator=(const JacobianReuseNewtonSolver&) = delete;
+
+    /// Destructor: Kill the solver that does the factorisation
+    ~JacobianReuseNewtonSolver()
+    {
+      delete Factorisation_solver_pt;
+      Factorisation_solver_pt = 0;
+    }
+
+    /// Specify the continuation parameter (null: none). The Broyden
+    /// updates then only account for the dependence of the residuals on
+    /// the dofs, at the cost of one additional residual evaluation per
+    /// iteration in which the parameter has changed.
+    void set_parameter_pt(double* parameter_pt)
+    {
+      Parameter_pt = parameter_pt;
+    }
+
+    /// Max. ratio of the norms of the residuals in successive Newton
+    /// iterations before the Jacobian is re-factorised
+    double& max_contraction_rate()
+    {
+      return Max_contraction_rate;
+    }
+
+    /// Max. number of Broyden updates before the Jacobian is
+    /// re-factorised
+    unsigned& max_broyden_update()
+    {
+      return Max_broyden_update;
+    }
+
+    /// Enable Broyden updates (default)
+    void enable_broyden_update()
+    {
+      Use_broyden_update = true;
+    }
+
+    /// Disable Broyden updates (i.e. use the modified Newton method with
+    /// the frozen Jacobian)
+    void disable_broyden_update()
+    {
+      Use_broyden_update = false;
+    }
+
+    /// Re-factorise the Jacobian in the next solve, e.g. after the nodes
+    /// have been moved
+    void force_refresh()
+    {
+      Have_factorisation = false;
+    }
+
+    /// Start a new (continuation) step: Reset the per-step statistics and
+    /// don't assess the contraction rate in the step's first iteration
+    void start_new_step()
+    {
+      Nsolve_in_step = 0;
+      Nfactorisation_in_step = 0;
+      Nbroyden_update_in_step = 0;
+      Nstep++;
+    }
+
+    /// Number of Newton iterations (solves) in current step
+    unsigned nsolve_in_step() const
+    {
+      return Nsolve_in_step;
+    }
+
+    /// Number of factorisations of the Jacobian in current step
+    unsigned nfactorisation_in_step() const
+    {
+      return Nfactorisation_in_step;
+    }
+
+    /// Number of Broyden updates in current step
+    unsigned nbroyden_update_in_step() const
+    {
+      return Nbroyden_update_in_step;
+    }
+
+    /// Doc the statistics for the current step and the totals: The number
+    /// of factorisations saved relative to the full Newton method (which
+    /// factorises the Jacobian in every iteration)
+    void doc_statistics(std::ostream& outfile) const
+    {
+      outfile << "Jacobian reuse: step " << Nstep << ": " << Nsolve_in_step
+              << " Newton iterations, " << Nfactorisation_in_step
+              << " factorisations (" << Nsolve_in_step - Nfactorisation_in_step
+              << " saved), " << Nbroyden_update_in_step
+              << " Broyden updates; total: "
+              << Nsolve_total - Nfactorisation_total << " of " << Nsolve_total
+              << " factorisations saved" << std::endl;
+    }
+
+    /// Solve J dx = R(x) at the current dofs of the problem (which must be
+    /// the problem passed to the constructor), returning dx in result.
+    void solve(Problem* const& problem_pt, DoubleVector& result);
+
+    /// Apply the current approximation to the inverse Jacobian to rhs
+    void resolve(const DoubleVector& rhs, DoubleVector& result)
+    {
+#ifdef PARANOID
+      if (!Have_factorisation)
+      {
+        throw OomphLibError("resolve() called before solve()",
+                            OOMPH_CURRENT_FUNCTION,
+                            OOMPH_EXCEPTION_LOCATION);
+      }
+#endif
+      apply_inverse(rhs, result);
+    }
+
+    /// Wipe the factorisation and the Broyden updates
+    void clean_up_memory()
+    {
+      Factorisation_solver_pt->clean_up_memory();
+      Have_factorisation = false;
+      Broyden_u.clear();
+      Broyden_v.clear();
+    }
+
+  private:
+    /// Apply H_k (the frozen inverse Jacobian, corrected by the Broyden
+    /// updates) to rhs
+    void apply_inverse(const DoubleVector& rhs, DoubleVector& result);
+
+    /// Dot product of two vectors of length n_dof
+    static double dot(const Vector<double>& a, const DoubleVector& b)
+    {
+      double sum = 0.0;
+      const unsigned n_dof = a.size();
+      for (unsigned i = 0; i < n_dof; i++)
+      {
+        sum += a[i] * b[i];
+      }
+      return sum;
+    }
+
+    /// Pointer to the problem
+    Problem* Problem_pt;
+
+    /// Solver that factorises the Jacobian (and keeps the factors)
+    LinearSolver* Factorisation_solver_pt;
+
+    /// Pointer to the continuation parameter (null if none)
+    double* Parameter_pt;
+
+    /// Max. ratio of the norms of the residuals in successive Newton
+    /// iterations before the Jacobian is re-factorised
+    double Max_contraction_rate;
+
+    /// Max. number of Broyden updates before the Jacobian is re-factorised
+    unsigned Max_broyden_update;
+
+    /// Use Broyden updates?
+    bool Use_broyden_update;
+
+    /// Is there a (valid) factorisation?
+    bool Have_factorisation;
+
+    /// Rank-one updates: H_k = (I + u_{k-1} v_{k-1}^T) ... (I + u_0 v_0^T)
+    /// J_0^{-1}
+    Vector<Vector<double>> Broyden_u;
+    Vector<Vector<double>> Broyden_v;
+
+    /// Dofs at the previous solve
+    Vector<double> Dofs_at_previous_solve;
+
+    /// Residuals at the previous solve
+    Vector<double> Residuals_at_previous_solve;
+
+    /// Value of the continuation parameter at the previous solve
+    double Parameter_at_previous_solve;
+
+    /// Norm of the residuals at the previous solve
+    double Previous_residual_norm;
+
+    /// Number of solves (Newton iterations) in current step
+    unsigned Nsolve_in_step;
+
+    /// Number of factorisations in current step
+    unsigned Nfactorisation_in_step;
+
+    /// Number of Broyden updates in current step
+    unsigned Nbroyden_update_in_step;
+
+    /// Total number of solves
+    unsigned Nsolve_total;
+
+    /// Total number of factorisations
+    unsigned Nfactorisation_total;
+
+    /// Number of steps
+    unsigned Nstep;
+  };
+
+
+  //=========================================================================
+  /// Solve J dx = R(x): Decide if the Jacobian needs to be re-factorised
+  /// (no factorisation yet, change in the number of dofs, poor
+  /// contraction of the residuals or too many Broyden updates); if not,
+  /// perform the Broyden update based on the most recent step and apply
+  /// the updated inverse.
+  //=========================================================================
+  inline void JacobianReuseNewtonSolver::solve(Problem* const& problem_pt,
+                                               DoubleVector& result)
+  {
+#ifdef PARANOID
+    if (problem_pt != Problem_pt)
+    {
+      throw OomphLibError("Solver was constructed for a different problem",
+                          OOMPH_CURRENT_FUNCTION,
+                          OOMPH_EXCEPTION_LOCATION);
+    }
+#endif
+    double t_start = TimingHelpers::timer();
+
+    const unsigned n_dof = Problem_pt->ndof();
+    Vector<double> dofs(n_dof);
+    for (unsigned i = 0; i < n_dof; i++)
+    {
+      dofs[i] = Problem_pt->dof(i);
+    }
+    DoubleVector residuals;
+    Problem_pt->get_residuals(residuals);
+    double residual_norm = residuals.norm();
+
+    // Do we have to re-factorise?
+    bool refresh =
+      (!Have_factorisation) || (Dofs_at_previous_solve.size() != n_dof);
+    if ((!refresh) && (Nsolve_in_step > 0))
+    {
+      if (residual_norm > Max_contraction_rate * Previous_residual_norm)
+      {
+        refresh = true;
+      }
+    }
+    if ((!refresh) && Use_broyden_update &&
+        (Broyden_u.size() >= Max_broyden_update))
+    {
+      refresh = true;
+    }
+
+    if (refresh)
+    {
+      // Assemble and factorise the Jacobian, and solve
+      Broyden_u.clear();
+      Broyden_v.clear();
+      Factorisation_solver_pt->solve(Problem_pt, result);
+      Have_factorisation = true;
+      Nfactorisation_in_step++;
+      Nfactorisation_total++;
+    }
+    else
+    {
+      // Broyden update based on the most recent step (not across the
+      // predictor of a new continuation step)
+      if (Use_broyden_update && (Nsolve_in_step > 0))
+      {
+        // Change in dofs, s, and the residuals, y
+        Vector<double> s(n_dof);
+        DoubleVector y(Problem_pt->dof_distribution_pt(), 0.0);
+        for (unsigned i = 0; i < n_dof; i++)
+        {
+          s[i] = dofs[i] - Dofs_at_previous_solve[i];
+          y[i] = residuals[i] - Residuals_at_previous_solve[i];
+        }
+
+        // Take out the change due to the change in the parameter:
+        // y = R(x_k, lambda_k) - R(x_{k-1}, lambda_k)
+        if ((Parameter_pt != 0) &&
+            (*Parameter_pt != Parameter_at_previous_solve))
+        {
+          for (unsigned i = 0; i < n_dof; i++)
+          {
+            Problem_pt->dof(i) = Dofs_at_previous_solve[i];
+          }
+          DoubleVector old_residuals;
+          Problem_pt->get_residuals(old_residuals);
+          for (unsigned i = 0; i < n_dof; i++)
+          {
+            Problem_pt->dof(i) = dofs[i];
+            y[i] = residuals[i] - old_residuals[i];
+          }
+        }
+
+        // H_k y; skip the update if s^T H_k y is (nearly) zero
+        DoubleVector z;
+        apply_inverse(y, z);
+        double denom = dot(s, z);
+        double s_norm = 0.0;
+        for (unsigned i = 0; i < n_dof; i++)
+        {
+          s_norm += s[i] * s[i];
+        }
+        s_norm = sqrt(s_norm);
+        if (std::fabs(denom) >
+            std::numeric_limits<double>::epsilon() * s_norm * z.norm())
+        {
+          Vector<double> u(n_dof);
+          for (unsigned i = 0; i < n_dof; i++)
+          {
+            u[i] = (s[i] - z[i]) / denom;
+          }
+          Broyden_u.push_back(u);
+          Broyden_v.push_back(s);
+          Nbroyden_update_in_step++;
+        }
+      }
+
+      apply_inverse(residuals, result);
+    }
+
+    // Remember the current state for the next iteration
+    Dofs_at_previous_solve = dofs;
+    Residuals_at_previous_solve.resize(n_dof);
+    for (unsigned i = 0; i < n_dof; i++)
+    {
+      Residuals_at_previous_solve[i] = residuals[i];
+    }
+    if (Parameter_pt != 0)
+    {
+      Parameter_at_previous_solve = *Parameter_pt;
+    }
+    Previous_residual_norm = residual_norm;
+    Nsolve_in_step++;
+    Nsolve_total++;
+
+    if (Doc_time)
+    {
+      oomph_info << "Time for Jacobian reuse solve [sec]: "
+                 << TimingHelpers::timer() - t_start
+                 << (refresh ? " (re-factorised)" : " (re-used)") << std::endl;
+    }
+  }
+
+
+  //=========================================================================
+  /// Apply H_k = (I + u_{k-1} v_{k-1}^T) ... (I + u_0 v_0^T) J_0^{-1} to
+  /// rhs
+  //=========================================================================
+  inline void JacobianReuseNewtonSolver::apply_inverse(const DoubleVector& rhs,
+                                                       DoubleVector& result)
+  {
+    Factorisation_solver_pt->resolve(rhs, result);
+    const unsigned n_update = Broyden_u.size();
+    const unsigned n_dof = Problem_pt->ndof();
+    for (unsigned j = 0; j < n_update; j++)
+    {
+      double factor = dot(Broyden_v[j], result);
+      for (unsigned i = 0; i < n_dof; i++)
+      {
+        result[i] += factor * Broyden_u[j][i];
+      }
+    }
+  }
+
+} // namespace oomph
+
+#endif
@@ -0,0 +1,984 @@
+// LIC// ====================================================================
+// LIC// This file forms part of oomph-lib, the object-oriented,
+// LIC// multi-physics finite-element library, available
+// LIC// at http://www.oomph-lib.org.
+// LIC//
+// LIC// Copyright (C) 2006-2023 Matthias Heil and Andrew Hazel
+// LIC//
+// LIC// This library is free software; you can redistribute it and/or
+// LIC// modify it under the terms of the GNU Lesser General Public
+// LIC// License as published by the Free Software Foundation; either
+// LIC// version 2.1 of the License, or (at your option) any later version.
+// LIC//
+// LIC// This library is distributed in the hope that it will be useful,
+// LIC// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// LIC// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// LIC// Lesser General Public License for more details.
+// LIC//
+// LIC// You should have received a copy of the GNU Lesser General Public
+// LIC// License along with this library; if not, write to the Free Software
+// LIC// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+// LIC// 02110-1301  USA.
+// LIC//
+// LIC// The authors may be contacted at oomph-lib@maths.man.ac.uk.
+// LIC//
+// LIC//====================================================================
+// Nonlocal (Stokeslet) correction to the resistive-force slender body
+// traction, evaluated with a treecode
+
+#ifndef NONLOCAL_SLENDER_BODY_OPERATOR_HEADER
+#define NONLOCAL_SLENDER_BODY_OPERATOR_HEADER
+
+// OOMPH-LIB includes
+#include "generic.h"
+
+// Local includes
+#include "slender_body_traction_kernel.h"
+
+namespace oomph
+{
+  //=========================================================================
+  /// Nonlocal slender body operator. The resistive-force traction
+  ///
+  ///    f = -w + 1/2 (w.T) T,
+  ///
+  /// (w: velocity of the beam relative to the undisturbed flow; T: unit
+  /// tangent) only accounts for the local flow. Here w is replaced by
+  /// w - u, where
+  ///
+  ///    u(x) = kappa \int G(x - X(s')) f(s') ds',
+  ///    G(r) = I/|r| + r r^T/|r|^3,
+  ///
+  /// is the velocity induced by the traction on all arms (Stokeslet line
+  /// integral), excluding the part of the same arm within an arclength
+  /// cutoff of x (which is represented by the local term). In the
+  /// non-dimensionalisation of the resistive-force traction
+  /// kappa = 1/(2 ln(1/epsilon)) where epsilon is the slenderness of the
+  /// beam. The traction is therefore corrected by
+  ///
+  ///    Delta f = u - 1/2 (u.T) T,
+  ///
+  /// and u depends on the (corrected) traction. The resulting linear
+  /// system for the induced velocity,
+  ///
+  ///    u - kappa K[Delta f(u)] = kappa K[f_local],
+  ///
+  /// is solved with (matrix-free, restarted) GMRES; a plain fixed point
+  /// iteration doesn't converge for realistic slenderness since the
+  /// (logarithmically large) contribution of the rest of the arm makes
+  /// the norm of the operator exceed one.
+  ///
+  /// The line integrals are evaluated at the integration points of the
+  /// beam elements, with a treecode (quadtree with monopole and dipole
+  /// expansions of the Stokeslet) for the far field, so the cost is
+  /// O(N log N) rather than O(N^2). In the near field, the source
+  /// points' segments are subdivided to resolve the 1/|r| singularity.
+  ///
+  /// The induced velocity is only available at the integration points;
+  /// it is updated explicitly (by update(...)), i.e. it's treated as
+  /// lagged within a Newton iteration so the element residuals remain
+  /// local and the Jacobian remains sparse.
+  //=========================================================================
+  class NonlocalSlenderBodyOperator
+  {
+  public:
+    /// Constructor: Pass the coefficient kappa and the arclength cutoff
+    /// for the local region
+    NonlocalSlenderBodyOperator(const double& kappa, const double& cutoff)
+      : Kappa(kappa),
+        Cutoff(cutoff),
+        Opening_angle(0.2),
+        Max_leaf_size(8),
+        Near_field_factor(2.0),
+        N_near_field_subdivision(8),
+        Krylov_dimension(30),
+        Max_iter(200),
+        Tolerance(1.0e-10),
+        Iterations(0)
+    {
+    }
+
+    /// Broken copy constructor
+    NonlocalSlenderBodyOperator(const NonlocalSlenderBodyOperator& dummy) =
+      delete;
+
+    /// Broken assignment operator
+    void operator=(const NonlocalSlenderBodyOperator&) = delete;
+
+    /// Opening angle of the treecode: Clusters of source points are
+    /// approximated by their expansions if their radius is less than
+    /// the opening angle times their distance from the target point
+    double& opening_angle()
+    {
+      return Opening_angle;
+    }
+
+    /// Max. number of points in a leaf of the tree
+    unsigned& max_leaf_size()
+    {
+      return Max_leaf_size;
+    }
+
+    /// Source points closer than near_field_factor() times the length of
+    /// their segment are treated with the subdivided quadrature
+    double& near_field_factor()
+    {
+      return Near_field_factor;
+    }
+
+    /// Number of sub-segments in the near field quadrature
+    unsigned& n_near_field_subdivision()
+    {
+      return N_near_field_subdivision;
+    }
+
+    /// Max. dimension of the Krylov subspace before restart
+    unsigned& krylov_dimension()
+    {
+      return Krylov_dimension;
+    }
+
+    /// Max. total number of GMRES iterations
+    unsigned& max_iter()
+    {
+      return Max_iter;
+    }
+
+    /// Relative tolerance for the GMRES residual
+    double& tolerance()
+    {
+      return Tolerance;
+    }
+
+    /// Number of GMRES iterations taken in most recent update
+    unsigned iterations() const
+    {
+      return Iterations;
+    }
+
+    /// Compute the induced velocity at the integration points of all
+    /// arms. For each arm, the batch contains the position vectors and
+    /// unit normals before the rigid body motion, the premultiplied
+    /// integration weights (ordered along the arm) and the local
+    /// (resistive-force) traction on the actual beam. The rigid body
+    /// motion is a rotation by theta[arm] followed by the translation
+    /// (shift_x[arm], shift_y[arm]); the arms may belong to different
+    /// bodies. element_pt[arm][e] is the e-th element of the arm, whose
+    /// n_intpt integration points are stored from e*n_intpt onwards.
+    void update(const Vector<SlenderBodyTractionBatch>& batch,
+                const Vector<double>& theta,
+                const Vector<double>& shift_x,
+                const Vector<double>& shift_y,
+                const Vector<Vector<const FiniteElement*>>& element_pt);
+
+    /// Compute the induced velocity for the arms of a single body (all
+    /// arms are translated by (shift_x, shift_y))
+    void update(const Vector<SlenderBodyTractionBatch>& batch,
+                const Vector<double>& theta,
+                const double& shift_x,
+                const double& shift_y,
+                const Vector<Vector<const FiniteElement*>>& element_pt)
+    {
+      unsigned n_arm = batch.size();
+      update(batch,
+             theta,
+             Vector<double>(n_arm, shift_x),
+             Vector<double>(n_arm, shift_y),
+             element_pt);
+    }
+
+    /// Get the induced velocity (in the actual configuration) at
+    /// integration point ipt of the element. Returns false (and zero
+    /// velocity) if it's not available.
+    bool induced_velocity(const FiniteElement* el_pt,
+                          const unsigned& ipt,
+                          double& u_x,
+                          double& u_y) const
+    {
+      u_x = 0.0;
+      u_y = 0.0;
+      std::map<const FiniteElement*, std::pair<unsigned, unsigned>>::
+        const_iterator it = Element_offset.find(el_pt);
+      if (it == Element_offset.end())
+      {
+        return false;
+      }
+      unsigned p = First_point[it->second.first] + it->second.second + ipt;
+      u_x = Induced_velocity_x[p];
+      u_y = Induced_velocity_y[p];
+      return true;
+    }
+
+    /// Correction to the traction, Delta f = u - 1/2 (u.T) T, for induced
+    /// velocity u at a point with unit normal N (T = (N_y, -N_x))
+    static void traction_correction(const double& u_x,
+                                     const double& u_y,
+                                     const double& n_x,
+                                     const double& n_y,
+                                     double& delta_f_x,
+                                     double& delta_f_y)
+    {
+      double u_dot_t = u_x * n_y - u_y * n_x;
+      delta_f_x = u_x - 0.5 * u_dot_t * n_y;
+      delta_f_y = u_y + 0.5 * u_dot_t * n_x;
+    }
+
+    /// Add the corrections to the traction on the actual beam, the
+    /// traction in the reference configuration and (if r_centre is
+    /// non-null) the torque density about r_centre at the points in the
+    /// batch for the given arm (the batch must have been evaluated for the
+    /// same rigid body motion). Does nothing if the induced velocity
+    /// isn't available for the arm.
+    void add_correction(const unsigned& arm,
+                        const double& theta,
+                        const double& shift_x,
+                        const double& shift_y,
+                        const double* r_centre,
+                        SlenderBodyTractionBatch& batch) const;
+
+  private:
+    /// Node of the quadtree
+    struct TreeNode
+    {
+      /// Centre and half-width of the box
+      double Centre[2];
+      double Half_width;
+
+      /// Radius of the cluster (max. distance of its points from the
+      /// expansion centre)
+      double Radius;
+
+      /// Expansion centre
+      double Expansion_centre[2];
+
+      /// Range of (sorted) points in the box: [First, Last)
+      unsigned First;
+      unsigned Last;
+
+      /// Index of the first child (0: leaf); children are contiguous
+      unsigned First_child;
+      unsigned Nchild;
+
+      /// Monopole: Total force
+      double Force[2];
+
+      /// Dipole: sum of (y - c)_k F_j, stored as Dipole[k][j]
+      double Dipole[2][2];
+    };
+
+    /// Build the tree for the current points
+    void build_tree();
+
+    /// Recursively subdivide a tree node
+    void subdivide(const unsigned& node);
+
+    /// Compute the monopole and dipole moments of all tree nodes for the
+    /// current forces
+    void compute_moments();
+
+    /// Evaluate the induced velocity at point p (without the factor kappa)
+    void evaluate(const unsigned& p, double& u_x, double& u_y) const;
+
+    /// Induced velocity kappa K[F] at all points (stored as
+    /// [u_x[0..n), u_y[0..n)]) for the forces F = W (f_local + Delta f(u))
+    /// (or without the local traction if include_local is false)
+    void induced_velocity_for_traction(const bool& include_local,
+                                       const Vector<double>& u,
+                                       Vector<double>& result);
+
+    /// Residual of the linear system: result = u - kappa K[W Delta f(u)]
+    void apply_operator(const Vector<double>& u, Vector<double>& result)
+    {
+      induced_velocity_for_traction(false, u, result);
+      const unsigned n = u.size();
+      for (unsigned i = 0; i < n; i++)
+      {
+        result[i] = u[i] - result[i];
+      }
+    }
+
+    /// Restarted GMRES for the linear system (with x = 0 as the initial
+    /// guess)
+    void gmres(const Vector<double>& b, Vector<double>& x);
+
+    /// Add the contribution of source point q to the velocity at point p
+    void add_direct_contribution(const unsigned& p,
+                                 const unsigned& q,
+                                 double& u_x,
+                                 double& u_y) const;
+
+    /// Add the Stokeslet G(r) F to u
+    static void add_stokeslet(const double& r_x,
+                              const double& r_y,
+                              const double& f_x,
+                              const double& f_y,
+                              double& u_x,
+                              double& u_y)
+    {
+      double r2 = r_x * r_x + r_y * r_y;
+      double r_inv = 1.0 / sqrt(r2);
+      double r_dot_f = r_x * f_x + r_y * f_y;
+      double r3_inv = r_inv / r2;
+      u_x += f_x * r_inv + r_x * r_dot_f * r3_inv;
+      u_y += f_y * r_inv + r_y * r_dot_f * r3_inv;
+    }
+
+    /// Coefficient kappa
+    double Kappa;
+
+    /// Arclength cutoff for the local region
+    double Cutoff;
+
+    /// Opening angle of the treecode
+    double Opening_angle;
+
+    /// Max. number of points in a leaf
+    unsigned Max_leaf_size;
+
+    /// Factor for the near field
+    double Near_field_factor;
+
+    /// Number of sub-segments in the near field quadrature
+    unsigned N_near_field_subdivision;
+
+    /// Max. dimension of the Krylov subspace before restart
+    unsigned Krylov_dimension;
+
+    /// Max. total number of GMRES iterations
+    unsigned Max_iter;
+
+    /// Relative tolerance for GMRES
+    double Tolerance;
+
+    /// Number of GMRES iterations in most recent update
+    unsigned Iterations;
+
+    /// Index of the first point of each arm in the arrays below (plus
+    /// the total number of points as the last entry)
+    Vector<unsigned> First_point;
+
+    /// Arm and first point (relative to the arm's first point) of each
+    /// element
+    std::map<const FiniteElement*, std::pair<unsigned, unsigned>>
+      Element_offset;
+
+    /// Data at all points (actual configuration): position, unit normal,
+    /// premultiplied weight, arclength along the arm and arm
+    Vector<double> X;
+    Vector<double> Y;
+    Vector<double> N_x;
+    Vector<double> N_y;
+    Vector<double> W;
+    Vector<double> S;
+    Vector<unsigned> Arm;
+
+    /// Local (resistive-force) traction at all points
+    Vector<double> Local_f_x;
+    Vector<double> Local_f_y;
+
+    /// Force (traction times weight) at all points
+    Vector<double> F_x;
+    Vector<double> F_y;
+
+    /// Induced velocity at all points
+    Vector<double> Induced_velocity_x;
+    Vector<double> Induced_velocity_y;
+
+    /// Tree nodes (the root is node 0)
+    Vector<TreeNode> Tree;
+
+    /// Points in tree order
+    Vector<unsigned> Sorted_point;
+  };
+
+
+  //=========================================================================
+  /// Compute the induced velocity: Collect the points in the actual
+  /// configuration, build the tree and solve the linear system for the
+  /// induced velocity with GMRES (one treecode evaluation per iteration).
+  //=========================================================================
+  inline void NonlocalSlenderBodyOperator::update(
+    const Vector<SlenderBodyTractionBatch>& batch,
+    const Vector<double>& theta,
+    const Vector<double>& shift_x,
+    const Vector<double>& shift_y,
+    const Vector<Vector<const FiniteElement*>>& element_pt)
+  {
+    // Collect the points in the actual configuration
+    unsigned n_arm = batch.size();
+    First_point.resize(n_arm + 1);
+    First_point[0] = 0;
+    for (unsigned a = 0; a < n_arm; a++)
+    {
+      First_point[a + 1] = First_point[a] + batch[a].npoint();
+    }
+    unsigned n_point = First_point[n_arm];
+    X.resize(n_point);
+    Y.resize(n_point);
+    N_x.resize(n_point);
+    N_y.resize(n_point);
+    W.resize(n_point);
+    S.resize(n_point);
+    Arm.resize(n_point);
+    F_x.resize(n_point);
+    F_y.resize(n_point);
+    Induced_velocity_x.assign(n_point, 0.0);
+    Induced_velocity_y.assign(n_point, 0.0);
+    Local_f_x.resize(n_point);
+    Local_f_y.resize(n_point);
+    for (unsigned a = 0; a < n_arm; a++)
+    {
+      double cos_theta = cos(theta[a]);
+      double sin_theta = sin(theta[a]);
+      double s = 0.0;
+      for (unsigned i = 0; i < batch[a].npoint(); i++)
+      {
+        unsigned p = First_point[a] + i;
+        double x0 = batch[a].R_0_x[i];
+        double y0 = batch[a].R_0_y[i];
+        X[p] = cos_theta * x0 - sin_theta * y0 + shift_x[a];
+        Y[p] = sin_theta * x0 + cos_theta * y0 + shift_y[a];
+        N_x[p] = cos_theta * batch[a].N_0_x[i] - sin_theta * batch[a].N_0_y[i];
+        N_y[p] = sin_theta * batch[a].N_0_x[i] + cos_theta * batch[a].N_0_y[i];
+        W[p] = batch[a].W[i];
+        S[p] = s + 0.5 * W[p];
+        s += W[p];
+        Arm[p] = a;
+        Local_f_x[p] = batch[a].Traction_x[i];
+        Local_f_y[p] = batch[a].Traction_y[i];
+      }
+    }
+
+    // Elements
+    Element_offset.clear();
+    for (unsigned a = 0; a < n_arm; a++)
+    {
+      unsigned n_element = element_pt[a].size();
+      if (n_element == 0) continue;
+      unsigned n_intpt = batch[a].npoint() / n_element;
+      for (unsigned e = 0; e < n_element; e++)
+      {
+        Element_offset[element_pt[a][e]] = std::make_pair(a, e * n_intpt);
+      }
+    }
+
+    if (n_point == 0) return;
+    build_tree();
+
+    // Right hand side: Velocity induced by the local traction
+    Vector<double> zero(2 * n_point, 0.0);
+    Vector<double> rhs;
+    induced_velocity_for_traction(true, zero, rhs);
+
+    // Solve
+    Vector<double> u(2 * n_point, 0.0);
+    gmres(rhs, u);
+    for (unsigned p = 0; p < n_point; p++)
+    {
+      Induced_velocity_x[p] = u[p];
+      Induced_velocity_y[p] = u[n_point + p];
+    }
+  }
+
+
+  //=========================================================================
+  /// Induced velocity kappa K[F] at all points for the forces
+  /// F = W (f_local + Delta f(u)) (or F = W Delta f(u))
+  //=========================================================================
+  inline void NonlocalSlenderBodyOperator::induced_velocity_for_traction(
+    const bool& include_local, const Vector<double>& u, Vector<double>& result)
+  {
+    const unsigned n_point = X.size();
+    for (unsigned p = 0; p < n_point; p++)
+    {
+      double delta_f_x = 0.0;
+      double delta_f_y = 0.0;
+      traction_correction(
+        u[p], u[n_point + p], N_x[p], N_y[p], delta_f_x, delta_f_y);
+      if (include_local)
+      {
+        delta_f_x += Local_f_x[p];
+        delta_f_y += Local_f_y[p];
+      }
+      F_x[p] = delta_f_x * W[p];
+      F_y[p] = delta_f_y * W[p];
+    }
+    compute_moments();
+
+    // The evaluations at the different points are independent (the tree
+    // is only read)
+    result.resize(2 * n_point);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 64)
+#endif
+    for (unsigned p = 0; p < n_point; p++)
+    {
+      double u_x = 0.0;
+      double u_y = 0.0;
+      evaluate(p, u_x, u_y);
+      result[p] = Kappa * u_x;
+      result[n_point + p] = Kappa * u_y;
+    }
+  }
+
+
+  //=========================================================================
+  /// Restarted GMRES (Givens rotations, modified Gram-Schmidt) for the
+  /// linear system for the induced velocity, with x = 0 as initial guess
+  //=========================================================================
+  inline void NonlocalSlenderBodyOperator::gmres(const Vector<double>& b,
+                                                 Vector<double>& x)
+  {
+    const unsigned n = b.size();
+    const unsigned m = Krylov_dimension;
+
+    double b_norm = 0.0;
+    for (unsigned i = 0; i < n; i++)
+    {
+      b_norm += b[i] * b[i];
+    }
+    b_norm = sqrt(b_norm);
+
+    x.assign(n, 0.0);
+    Iterations = 0;
+    if (b_norm == 0.0) return;
+
+    Vector<Vector<double>> basis(m + 1);
+    DenseMatrix<double> hessenberg(m + 1, m, 0.0);
+    Vector<double> cs(m), sn(m), g(m + 1);
+    Vector<double> w, r(n);
+    bool converged = false;
+    while (!converged && Iterations < Max_iter)
+    {
+      // r = b - A x
+      if (Iterations == 0)
+      {
+        r = b;
+      }
+      else
+      {
+        apply_operator(x, w);
+        for (unsigned i = 0; i < n; i++)
+        {
+          r[i] = b[i] - w[i];
+        }
+      }
+      double r_norm = 0.0;
+      for (unsigned i = 0; i < n; i++)
+      {
+        r_norm += r[i] * r[i];
+      }
+      r_norm = sqrt(r_norm);
+      if (r_norm <= Tolerance * b_norm) break;
+
+      basis[0].resize(n);
+      for (unsigned i = 0; i < n; i++)
+      {
+        basis[0][i] = r[i] / r_norm;
+      }
+      for (unsigned k = 0; k <= m; k++)
+      {
+        g[k] = 0.0;
+      }
+      g[0] = r_norm;
+
+      // Arnoldi
+      unsigned j = 0;
+      for (j = 0; j < m && Iterations < Max_iter; j++)
+      {
+        Iterations++;
+        apply_operator(basis[j], w);
+        for (unsigned k = 0; k <= j; k++)
+        {
+          double h = 0.0;
+          for (unsigned i = 0; i < n; i++)
+          {
+            h += w[i] * basis[k][i];
+          }
+          hessenberg(k, j) = h;
+          for (unsigned i = 0; i < n; i++)
+          {
+            w[i] -= h * basis[k][i];
+          }
+        }
+        double h_next = 0.0;
+        for (unsigned i = 0; i < n; i++)
+        {
+          h_next += w[i] * w[i];
+        }
+        h_next = sqrt(h_next);
+        hessenberg(j + 1, j) = h_next;
+
+        for (unsigned k = 0; k < j; k++)
+        {
+          const double tmp =
+            cs[k] * hessenberg(k, j) + sn[k] * hessenberg(k + 1, j);
+          hessenberg(k + 1, j) =
+            -sn[k] * hessenberg(k, j) + cs[k] * hessenberg(k + 1, j);
+          hessenberg(k, j) = tmp;
+        }
+        const double denom = sqrt(hessenberg(j, j) * hessenberg(j, j) +
+                                  h_next * h_next);
+        cs[j] = hessenberg(j, j) / denom;
+        sn[j] = h_next / denom;
+        hessenberg(j, j) = denom;
+        hessenberg(j + 1, j) = 0.0;
+        g[j + 1] = -sn[j] * g[j];
+        g[j] = cs[j] * g[j];
+
+        if (std::fabs(g[j + 1]) <= Tolerance * b_norm || h_next == 0.0)
+        {
+          converged = true;
+          j++;
+          break;
+        }
+        basis[j + 1].resize(n);
+        for (unsigned i = 0; i < n; i++)
+        {
+          basis[j + 1][i] = w[i] / h_next;
+        }
+      }
+
+      // Update x with the solution of the (upper triangular) least
+      // squares problem
+      Vector<double> y(j, 0.0);
+      for (int k = int(j) - 1; k >= 0; k--)
+      {
+        double sum = g[k];
+        for (unsigned l = k + 1; l < j; l++)
+        {
+          sum -= hessenberg(k, l) * y[l];
+        }
+        y[k] = sum / hessenberg(k, k);
+      }
+      for (unsigned k = 0; k < j; k++)
+      {
+        for (unsigned i = 0; i < n; i++)
+        {
+          x[i] += y[k] * basis[k][i];
+        }
+      }
+    }
+
+    if (!converged && Iterations >= Max_iter)
+    {
+      oomph_info << "Warning: GMRES for the nonlocal slender body traction "
+                 << "didn't converge in " << Iterations << " iterations"
+                 << std::endl;
+    }
+  }
+
+
+  //=========================================================================
+  /// Add the corrections to the traction (and torque density) in the batch
+  //=========================================================================
+  inline void NonlocalSlenderBodyOperator::add_correction(
+    const unsigned& arm,
+    const double& theta,
+    const double& shift_x,
+    const double& shift_y,
+    const double* r_centre,
+    SlenderBodyTractionBatch& batch) const
+  {
+    if ((arm + 1 >= First_point.size()) ||
+        (First_point[arm + 1] - First_point[arm] != batch.npoint()))
+    {
+      return;
+    }
+    double cos_theta = cos(theta);
+    double sin_theta = sin(theta);
+    unsigned n_point = batch.npoint();
+    for (unsigned i = 0; i < n_point; i++)
+    {
+      unsigned p = First_point[arm] + i;
+      double n_x = cos_theta * batch.N_0_x[i] - sin_theta * batch.N_0_y[i];
+      double n_y = sin_theta * batch.N_0_x[i] + cos_theta * batch.N_0_y[i];
+      double delta_f_x = 0.0;
+      double delta_f_y = 0.0;
+      traction_correction(Induced_velocity_x[p],
+                          Induced_velocity_y[p],
+                          n_x,
+                          n_y,
+                          delta_f_x,
+                          delta_f_y);
+      batch.Traction_x[i] += delta_f_x;
+      batch.Traction_y[i] += delta_f_y;
+      batch.Traction_0_x[i] += delta_f_x * cos_theta + delta_f_y * sin_theta;
+      batch.Traction_0_y[i] += delta_f_y * cos_theta - delta_f_x * sin_theta;
+      if (r_centre != 0)
+      {
+        double r_x = cos_theta * batch.R_0_x[i] -
+                     sin_theta * batch.R_0_y[i] + shift_x;
+        double r_y = sin_theta * batch.R_0_x[i] +
+                     cos_theta * batch.R_0_y[i] + shift_y;
+        batch.Torque_density[i] += (r_x - r_centre[0]) * delta_f_y -
+                                   (r_y - r_centre[1]) * delta_f_x;
+      }
+    }
+  }
+
+
+  //=========================================================================
+  /// Build the quadtree: The root box encloses all points; boxes with
+  /// more than Max_leaf_size points are subdivided into (non-empty)
+  /// quadrants.
+  //=========================================================================
+  inline void NonlocalSlenderBodyOperator::build_tree()
+  {
+    unsigned n_point = X.size();
+    Sorted_point.resize(n_point);
+    double x_min = X[0], x_max = X[0], y_min = Y[0], y_max = Y[0];
+    for (unsigned p = 0; p < n_point; p++)
+    {
+      Sorted_point[p] = p;
+      x_min = std::min(x_min, X[p]);
+      x_max = std::max(x_max, X[p]);
+      y_min = std::min(y_min, Y[p]);
+      y_max = std::max(y_max, Y[p]);
+    }
+
+    Tree.clear();
+    TreeNode root;
+    root.Centre[0] = 0.5 * (x_min + x_max);
+    root.Centre[1] = 0.5 * (y_min + y_max);
+    root.Half_width = 0.5 * std::max(x_max - x_min, y_max - y_min) *
+                      (1.0 + 1.0e-12);
+    root.First = 0;
+    root.Last = n_point;
+    root.First_child = 0;
+    root.Nchild = 0;
+    Tree.push_back(root);
+    subdivide(0);
+  }
+
+
+  //=========================================================================
+  /// Subdivide a tree node into its non-empty quadrants (recursively)
+  //=========================================================================
+  inline void NonlocalSlenderBodyOperator::subdivide(const unsigned& node)
+  {
+    // Expansion centre (centroid of the points) and radius
+    double c_x = 0.0;
+    double c_y = 0.0;
+    unsigned first = Tree[node].First;
+    unsigned last = Tree[node].Last;
+    for (unsigned k = first; k < last; k++)
+    {
+      c_x += X[Sorted_point[k]];
+      c_y += Y[Sorted_point[k]];
+    }
+    c_x /= double(last - first);
+    c_y /= double(last - first);
+    double radius = 0.0;
+    for (unsigned k = first; k < last; k++)
+    {
+      double d_x = X[Sorted_point[k]] - c_x;
+      double d_y = Y[Sorted_point[k]] - c_y;
+      radius = std::max(radius, sqrt(d_x * d_x + d_y * d_y));
+    }
+    Tree[node].Expansion_centre[0] = c_x;
+    Tree[node].Expansion_centre[1] = c_y;
+    Tree[node].Radius = radius;
+
+    // Leaf? (Also stop if the points coincide)
+    if ((last - first <= Max_leaf_size) || (radius == 0.0))
+    {
+      return;
+    }
+
+    // Sort the points into the quadrants
+    double centre[2] = {Tree[node].Centre[0], Tree[node].Centre[1]};
+    Vector<Vector<unsigned>> quadrant_point(4);
+    for (unsigned k = first; k < last; k++)
+    {
+      unsigned p = Sorted_point[k];
+      unsigned q = (X[p] >= centre[0] ? 1 : 0) + (Y[p] >= centre[1] ? 2 : 0);
+      quadrant_point[q].push_back(p);
+    }
+
+    // Create the (non-empty) children
+    unsigned first_child = Tree.size();
+    unsigned n_child = 0;
+    unsigned k = first;
+    double half_width = 0.5 * Tree[node].Half_width;
+    for (unsigned q = 0; q < 4; q++)
+    {
+      if (quadrant_point[q].size() == 0) continue;
+      TreeNode child;
+      child.Centre[0] = centre[0] + ((q & 1) ? half_width : -half_width);
+      child.Centre[1] = centre[1] + ((q & 2) ? half_width : -half_width);
+      child.Half_width = half_width;
+      child.First = k;
+      for (unsigned j = 0; j < quadrant_point[q].size(); j++)
+      {
+        Sorted_point[k++] = quadrant_point[q][j];
+      }
+      child.Last = k;
+      child.First_child = 0;
+      child.Nchild = 0;
+      Tree.push_back(child);
+      n_child++;
+    }
+    Tree[node].First_child = first_child;
+    Tree[node].Nchild = n_child;
+
+    // Recurse (Tree may be re-allocated so use indices)
+    for (unsigned c = 0; c < n_child; c++)
+    {
+      subdivide(first_child + c);
+    }
+  }
+
+
+  //=========================================================================
+  /// Monopole (total force) and dipole moments about the expansion
+  /// centres
+  //=========================================================================
+  inline void NonlocalSlenderBodyOperator::compute_moments()
+  {
+    unsigned n_node = Tree.size();
+    for (unsigned n = 0; n < n_node; n++)
+    {
+      TreeNode& node = Tree[n];
+      node.Force[0] = node.Force[1] = 0.0;
+      node.Dipole[0][0] = node.Dipole[0][1] = 0.0;
+      node.Dipole[1][0] = node.Dipole[1][1] = 0.0;
+      for (unsigned k = node.First; k < node.Last; k++)
+      {
+        unsigned p = Sorted_point[k];
+        double d[2] = {X[p] - node.Expansion_centre[0],
+                       Y[p] - node.Expansion_centre[1]};
+        double f[2] = {F_x[p], F_y[p]};
+        for (unsigned j = 0; j < 2; j++)
+        {
+          node.Force[j] += f[j];
+          for (unsigned i = 0; i < 2; i++)
+          {
+            node.Dipole[i][j] += d[i] * f[j];
+          }
+        }
+      }
+    }
+  }
+
+
+  //=========================================================================
+  /// Evaluate the induced velocity at point p (without the factor kappa)
+  /// by traversing the tree: Clusters that are well separated from p
+  /// (and can't contain points of p's local region) are approximated by
+  ///
+  ///    G(r) F - dG/dr_k (r) M_k
+  ///
+  /// (r: vector from the expansion centre to p; F: total force;
+  /// M_kj = sum (y - c)_k F_j); leaves that aren't are summed directly.
+  //=========================================================================
+  inline void NonlocalSlenderBodyOperator::evaluate(const unsigned& p,
+                                                    double& u_x,
+                                                    double& u_y) const
+  {
+    u_x = 0.0;
+    u_y = 0.0;
+    Vector<unsigned> stack(1, 0);
+    while (!stack.empty())
+    {
+      unsigned n = stack.back();
+      stack.pop_back();
+      const TreeNode& node = Tree[n];
+      double r[2] = {X[p] - node.Expansion_centre[0],
+                     Y[p] - node.Expansion_centre[1]};
+      double dist = sqrt(r[0] * r[0] + r[1] * r[1]);
+
+      // Far field: Expansion
+      if ((node.Radius < Opening_angle * dist) &&
+          (dist - node.Radius > Cutoff) &&
+          (dist - node.Radius > Near_field_factor * node.Radius))
+      {
+        add_stokeslet(r[0], r[1], node.Force[0], node.Force[1], u_x, u_y);
+
+        // dG_ij/dr_k = (-delta_ij r_k + delta_ik r_j + delta_jk r_i)/|r|^3
+        //              - 3 r_i r_j r_k/|r|^5
+        double r3_inv = 1.0 / (dist * dist * dist);
+        double r5_inv = r3_inv / (dist * dist);
+        double u[2] = {0.0, 0.0};
+        for (unsigned i = 0; i < 2; i++)
+        {
+          for (unsigned j = 0; j < 2; j++)
+          {
+            for (unsigned k = 0; k < 2; k++)
+            {
+              double dg = (-double(i == j) * r[k] + double(i == k) * r[j] +
+                           double(j == k) * r[i]) *
+                            r3_inv -
+                          3.0 * r[i] * r[j] * r[k] * r5_inv;
+              u[i] -= dg * node.Dipole[k][j];
+            }
+          }
+        }
+        u_x += u[0];
+        u_y += u[1];
+      }
+      // Leaf: Direct summation
+      else if (node.Nchild == 0)
+      {
+        for (unsigned k = node.First; k < node.Last; k++)
+        {
+          add_direct_contribution(p, Sorted_point[k], u_x, u_y);
+        }
+      }
+      // Descend
+      else
+      {
+        for (unsigned c = 0; c < node.Nchild; c++)
+        {
+          stack.push_back(node.First_child + c);
+        }
+      }
+    }
+  }
+
+
+  //=========================================================================
+  /// Add the contribution of source point q to the velocity at point p
+  /// (without the factor kappa), skipping p's local region. If p is close
+  /// to q's segment (relative to its length), the segment (straight, of
+  /// length W[q], centred on q and aligned with the tangent) is
+  /// subdivided and the force is distributed uniformly along it.
+  //=========================================================================
+  inline void NonlocalSlenderBodyOperator::add_direct_contribution(
+    const unsigned& p, const unsigned& q, double& u_x, double& u_y) const
+  {
+    // Local region (represented by the resistive-force term)?
+    if ((Arm[p] == Arm[q]) && (std::fabs(S[p] - S[q]) <= Cutoff))
+    {
+      return;
+    }
+    if (p == q) return;
+
+    double r_x = X[p] - X[q];
+    double r_y = Y[p] - Y[q];
+    double dist = sqrt(r_x * r_x + r_y * r_y);
+    if (dist > Near_field_factor * W[q])
+    {
+      add_stokeslet(r_x, r_y, F_x[q], F_y[q], u_x, u_y);
+      return;
+    }
+
+    // Near field: Subdivide the segment (midpoint rule)
+    double t_x = N_y[q];
+    double t_y = -N_x[q];
+    unsigned n_sub = N_near_field_subdivision;
+    double f_x = F_x[q] / double(n_sub);
+    double f_y = F_y[q] / double(n_sub);
+    for (unsigned j = 0; j < n_sub; j++)
+    {
+      double offset = W[q] * ((double(j) + 0.5) / double(n_sub) - 0.5);
+      double d_x = r_x - offset * t_x;
+      double d_y = r_y - offset * t_y;
+      if ((d_x == 0.0) && (d_y == 0.0)) continue;
+      add_stokeslet(d_x, d_y, f_x, f_y, u_x, u_y);
+    }
+  }
+
+} // namespace oomph
+
+#endif
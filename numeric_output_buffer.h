@@ -0,0 +1,172 @@
+// LIC// ====================================================================
+// LIC// This file forms part of oomph-lib, the object-oriented,
+// LIC// multi-physics finite-element library, available
+// LIC// at http://www.oomph-lib.org.
+// LIC//
+// LIC// Copyright (C) 2006-2023 Matthias Heil and Andrew Hazel
+// LIC//
+// LIC// This library is free software; you can redistribute it and/or
+// LIC// modify it under the terms of the GNU Lesser General Public
+// LIC// License as published by the Free Software Foundation; either
+// LIC// version 2.1 of the License, or (at your option) any later version.
+// LIC//
+// LIC// This library is distributed in the hope that it will be useful,
+// LIC// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// LIC// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// LIC// Lesser General Public License for more details.
+// LIC//
+// LIC// You should have received a copy of the GNU Lesser General Public
+// LIC// License along with this library; if not, write to the Free Software
+// LIC// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+// LIC// 02110-1301  USA.
+// LIC//
+// LIC// The authors may be contacted at oomph-lib@maths.man.ac.uk.
+// LIC//
+// Buffered output of formatted numbers
+
+#ifndef NUMERIC_OUTPUT_BUFFER_HEADER
+#define NUMERIC_OUTPUT_BUFFER_HEADER
+
+// OOMPH-LIB includes
+#include "generic.h"
+
+namespace oomph
+{
+  //=========================================================================
+  /// Buffer for the output of (mainly) floating point numbers to a
+  /// stream: The numbers are formatted with snprintf(...) directly into
+  /// a character buffer that is written to the stream in large blocks,
+  /// rather than through the stream's operator<< (and its sentry and
+  /// locale machinery) for every scalar. Doubles are formatted like
+  /// operator<< does in the "C" locale, i.e. with the stream's precision
+  /// and fixed/scientific/default floatfield. Lines are terminated with
+  /// '\n' rather than std::endl so the stream is only flushed when the
+  /// buffer is written (on destruction or an explicit call to flush()).
+  //=========================================================================
+  class NumericOutputBuffer
+  {
+  public:
+    /// Constructor: Pass the stream and the size of the buffer
+    NumericOutputBuffer(std::ostream& outfile, const unsigned& capacity = 65536)
+      : Outfile(outfile), Buffer(capacity), Size(0)
+    {
+      // Mimic the stream's format for floating point numbers
+      std::ios_base::fmtflags flags = outfile.flags();
+      std::ios_base::fmtflags floatfield = flags & std::ios_base::floatfield;
+      bool uppercase = (flags & std::ios_base::uppercase) != 0;
+      if (floatfield == std::ios_base::fixed)
+      {
+        Double_format = "%.*f";
+      }
+      else if (floatfield == std::ios_base::scientific)
+      {
+        Double_format = uppercase ? "%.*E" : "%.*e";
+      }
+      else
+      {
+        Double_format = uppercase ? "%.*G" : "%.*g";
+      }
+      Precision = int(outfile.precision());
+    }
+
+    /// Broken copy constructor
+    NumericOutputBuffer(const NumericOutputBuffer& dummy) = delete;
+
+    /// Broken assignment operator
+    void operator=(const NumericOutputBuffer&) = delete;
+
+    /// Destructor: Write what's left in the buffer to the stream
+    ~NumericOutputBuffer()
+    {
+      flush();
+    }
+
+    /// Add a double
+    NumericOutputBuffer& operator<<(const double& x)
+    {
+      int n = snprintf(
+        &Buffer[Size], Buffer.size() - Size, Double_format, Precision, x);
+      if (Size + n >= Buffer.size())
+      {
+        // Didn't fit: Write the buffer (and grow it if the number on its
+        // own doesn't fit either) and try again
+        flush();
+        if (unsigned(n) >= Buffer.size())
+        {
+          Buffer.resize(n + 1);
+        }
+        n = snprintf(&Buffer[0], Buffer.size(), Double_format, Precision, x);
+      }
+      Size += n;
+      return *this;
+    }
+
+    /// Add an integer
+    NumericOutputBuffer& operator<<(const int& i)
+    {
+      char text[16];
+      snprintf(text, sizeof(text), "%d", i);
+      return *this << text;
+    }
+
+    /// Add an unsigned
+    NumericOutputBuffer& operator<<(const unsigned& i)
+    {
+      char text[16];
+      snprintf(text, sizeof(text), "%u", i);
+      return *this << text;
+    }
+
+    /// Add a string
+    NumericOutputBuffer& operator<<(const char* text)
+    {
+      while (*text != '\0')
+      {
+        *this << *text;
+        text++;
+      }
+      return *this;
+    }
+
+    /// Add a character
+    NumericOutputBuffer& operator<<(const char& c)
+    {
+      if (Size + 1 >= Buffer.size())
+      {
+        flush();
+      }
+      Buffer[Size] = c;
+      Size++;
+      return *this;
+    }
+
+    /// Write the buffer to the stream
+    void flush()
+    {
+      if (Size > 0)
+      {
+        Outfile.write(&Buffer[0], Size);
+        Size = 0;
+      }
+    }
+
+  private:
+    /// The stream
+    std::ostream& Outfile;
+
+    /// The buffer
+    std::vector<char> Buffer;
+
+    /// Number of characters in the buffer
+    unsigned Size;
+
+    /// printf format for doubles (precision passed as an argument)
+    const char* Double_format;
+
+    /// Precision for doubles
+    int Precision;
+  };
+
+} // namespace oomph
+
+#endif
@@ -0,0 +1,616 @@
+// LIC// ====================================================================
+// LIC// This file forms part of oomph-lib, the object-oriented,
+// LIC// multi-physics finite-element library, available
+// LIC// at http://www.oomph-lib.org.
+// LIC//
+// LIC// Copyright (C) 2006-2023 Matthias Heil and Andrew Hazel
+// LIC//
+// LIC// This library is free software; you can redistribute it and/or
+// LIC// modify it under the terms of the GNU Lesser General Public
+// LIC// License as published by the Free Software Foundation; either
+// LIC// version 2.1 of the License, or (at your option) any later version.
+// LIC//
+// LIC// This library is distributed in the hope that it will be useful,
+// LIC// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// LIC// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// LIC// Lesser General Public License for more details.
+// LIC//
+// LIC// You should have received a copy of the GNU Lesser General Public
+// LIC// License along with this library; if not, write to the Free Software
+// LIC// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+// LIC// 02110-1301  USA.
+// LIC//
+// LIC// The authors may be contacted at oomph-lib@maths.man.ac.uk.
+// LIC//
+// Block-diagonal direct solver for problems with many (uncoupled or
+// weakly coupled) elastic particles
+
+#ifndef PARTICLE_BLOCK_SOLVER_HEADER
+#define PARTICLE_BLOCK_SOLVER_HEADER
+
+// OOMPH-LIB includes
+#include "generic.h"
+
+// Banded LU factorisation
+#include "beam_preconditioners.h"
+
+namespace oomph
+{
+  //=========================================================================
+  /// Linear solver for problems that contain many particles, each
+  /// consisting of one or more beam meshes and a "rigid body" element
+  /// whose internal data couple to all of the particle's beam dofs. If
+  /// the particles only interact through terms that are not included in
+  /// the Jacobian (e.g. the lagged hydrodynamic interactions), the
+  /// Jacobian is block-diagonal with one block per particle, and each
+  /// block has the "arrow" structure
+  ///
+  ///        [ A  B ]
+  ///        [ C  D ]
+  ///
+  /// where A is the banded block of the beam dofs and D the small dense
+  /// block of the rigid body dofs. Each block is solved exactly via the
+  /// Schur complement S = D - C A^{-1} B, so the cost is linear in the
+  /// number of particles and in the number of beam dofs per particle.
+  /// The blocks are independent and are factorised and solved in
+  /// parallel if OpenMP is enabled. Entries of the Jacobian that couple
+  /// different particles are ignored (they are counted and reported if
+  /// Doc_time is set).
+  //=========================================================================
+  class ParticleBlockDiagonalSolver : public LinearSolver
+  {
+  public:
+    /// Constructor: Pass pointer to the problem
+    ParticleBlockDiagonalSolver(Problem* problem_pt)
+      : Problem_pt(problem_pt), N_dof_at_setup(0)
+    {
+    }
+
+    /// Broken copy constructor
+    ParticleBlockDiagonalSolver(const ParticleBlockDiagonalSolver& dummy) =
+      delete;
+
+    /// Broken assignment operator
+    void operator=(const ParticleBlockDiagonalSolver&) = delete;
+
+    /// Destructor: Clean up
+    ~ParticleBlockDiagonalSolver()
+    {
+      clean_up_memory();
+    }
+
+    /// Add a particle: the meshes of its beam elements and the element
+    /// that stores its rigid body unknowns (as internal data)
+    void add_particle(const Vector<Mesh*>& beam_mesh_pt,
+                      GeneralisedElement* rigid_body_element_pt)
+    {
+      Particle_beam_mesh_pt.push_back(beam_mesh_pt);
+      Particle_rigid_body_element_pt.push_back(rigid_body_element_pt);
+      N_dof_at_setup = 0;
+    }
+
+    /// Number of particles
+    unsigned nparticle() const
+    {
+      return Particle_beam_mesh_pt.size();
+    }
+
+    /// Assemble the Jacobian, factorise its diagonal blocks and solve
+    /// for the Newton correction
+    void solve(Problem* const& problem_pt, DoubleVector& result);
+
+    /// Re-use the factorisation for another right-hand side
+    void resolve(const DoubleVector& rhs, DoubleVector& result)
+    {
+      apply_inverse(rhs, result);
+    }
+
+    /// Wipe the factorisation
+    void clean_up_memory()
+    {
+      unsigned n_particle = Block.size();
+      for (unsigned p = 0; p < n_particle; p++)
+      {
+        delete Block[p].Beam_block_pt;
+        Block[p].Beam_block_pt = 0;
+      }
+      Block.clear();
+    }
+
+  private:
+    /// Factorised diagonal block of one particle
+    struct ParticleBlock
+    {
+      /// Global equation numbers of the beam dofs (in increasing order)
+      Vector<unsigned> Beam_dof;
+
+      /// Global equation numbers of the rigid body dofs
+      Vector<unsigned> Rigid_body_dof;
+
+      /// Banded LU factorisation of the beam block, A
+      BandedLUFactorisation* Beam_block_pt;
+
+      /// A^{-1} B (row-major, n_beam x n_rigid)
+      Vector<double> A_inv_b;
+
+      /// C (row-major, n_rigid x n_beam)
+      Vector<double> C;
+
+      /// LU factors of the Schur complement (row-major) and pivots
+      Vector<double> Schur_lu;
+      Vector<unsigned> Schur_pivot;
+    };
+
+    /// Identify the dofs of each particle
+    void setup_particle_dofs();
+
+    /// Factorise the diagonal block of particle p
+    void factorise_block(const unsigned& p, const CRDoubleMatrix& jacobian);
+
+    /// Apply the inverse of the block-diagonal matrix
+    void apply_inverse(const DoubleVector& rhs, DoubleVector& result) const;
+
+    /// Pointer to the problem
+    Problem* Problem_pt;
+
+    /// Beam meshes of each particle
+    Vector<Vector<Mesh*>> Particle_beam_mesh_pt;
+
+    /// Rigid body element of each particle
+    Vector<GeneralisedElement*> Particle_rigid_body_element_pt;
+
+    /// Particle (-1: none) and index within its beam (or rigid body)
+    /// dofs for each global dof
+    Vector<int> Dof_particle;
+    Vector<unsigned> Dof_local_index;
+    Vector<bool> Dof_is_rigid_body_dof;
+
+    /// Number of dofs when the particles' dofs were identified
+    unsigned N_dof_at_setup;
+
+    /// Factorised blocks
+    Vector<ParticleBlock> Block;
+  };
+
+
+  //=========================================================================
+  /// Identify the dofs of each particle: the rigid body element's
+  /// internal dofs and all other dofs of the elements in its beam meshes
+  //=========================================================================
+  inline void ParticleBlockDiagonalSolver::setup_particle_dofs()
+  {
+    const unsigned n_dof = Problem_pt->ndof();
+    Dof_particle.assign(n_dof, -1);
+    Dof_local_index.assign(n_dof, 0);
+    Dof_is_rigid_body_dof.assign(n_dof, false);
+
+    clean_up_memory();
+    const unsigned n_particle = nparticle();
+    Block.resize(n_particle);
+    for (unsigned p = 0; p < n_particle; p++)
+    {
+      ParticleBlock& block = Block[p];
+      block.Beam_block_pt = 0;
+
+      // Rigid body dofs
+      GeneralisedElement* rigid_pt = Particle_rigid_body_element_pt[p];
+      const unsigned n_internal = rigid_pt->ninternal_data();
+      for (unsigned i = 0; i < n_internal; i++)
+      {
+        Data* data_pt = rigid_pt->internal_data_pt(i);
+        const unsigned n_value = data_pt->nvalue();
+        for (unsigned v = 0; v < n_value; v++)
+        {
+          const long eqn = data_pt->eqn_number(v);
+          if (eqn >= 0)
+          {
+            Dof_particle[eqn] = int(p);
+            Dof_is_rigid_body_dof[eqn] = true;
+            Dof_local_index[eqn] = block.Rigid_body_dof.size();
+            block.Rigid_body_dof.push_back(unsigned(eqn));
+          }
+        }
+      }
+
+      // Beam dofs: all other dofs of the beam elements
+      std::set<unsigned> beam_dof;
+      const unsigned n_mesh = Particle_beam_mesh_pt[p].size();
+      for (unsigned m = 0; m < n_mesh; m++)
+      {
+        Mesh* mesh_pt = Particle_beam_mesh_pt[p][m];
+        const unsigned n_element = mesh_pt->nelement();
+        for (unsigned e = 0; e < n_element; e++)
+        {
+          GeneralisedElement* el_pt = mesh_pt->element_pt(e);
+          const unsigned n_el_dof = el_pt->ndof();
+          for (unsigned l = 0; l < n_el_dof; l++)
+          {
+            const unsigned eqn = el_pt->eqn_number(l);
+            if (!Dof_is_rigid_body_dof[eqn])
+            {
+#ifdef PARANOID
+              if ((Dof_particle[eqn] >= 0) && (Dof_particle[eqn] != int(p)))
+              {
+                std::ostringstream error_message;
+                error_message << "Dof " << eqn << " belongs to particles "
+                              << Dof_particle[eqn] << " and " << p
+                              << std::endl;
+                throw OomphLibError(error_message.str(),
+                                    OOMPH_CURRENT_FUNCTION,
+                                    OOMPH_EXCEPTION_LOCATION);
+              }
+#endif
+              beam_dof.insert(eqn);
+              Dof_particle[eqn] = int(p);
+            }
+          }
+        }
+      }
+      block.Beam_dof.assign(beam_dof.begin(), beam_dof.end());
+      const unsigned n_beam = block.Beam_dof.size();
+      for (unsigned i = 0; i < n_beam; i++)
+      {
+        Dof_local_index[block.Beam_dof[i]] = i;
+      }
+    }
+
+#ifdef PARANOID
+    for (unsigned i = 0; i < n_dof; i++)
+    {
+      if (Dof_particle[i] < 0)
+      {
+        std::ostringstream error_message;
+        error_message << "Dof " << i << " doesn't belong to any particle"
+                      << std::endl;
+        throw OomphLibError(error_message.str(),
+                            OOMPH_CURRENT_FUNCTION,
+                            OOMPH_EXCEPTION_LOCATION);
+      }
+    }
+#endif
+    N_dof_at_setup = n_dof;
+  }
+
+
+  //=========================================================================
+  /// Factorise the diagonal block of particle p: banded LU of the beam
+  /// block A, A^{-1} B and dense LU of the Schur complement
+  /// S = D - C A^{-1} B
+  //=========================================================================
+  inline void ParticleBlockDiagonalSolver::factorise_block(
+    const unsigned& p, const CRDoubleMatrix& jacobian)
+  {
+    ParticleBlock& block = Block[p];
+    const unsigned n_beam = block.Beam_dof.size();
+    const unsigned n_rigid = block.Rigid_body_dof.size();
+    const int* row_start = jacobian.row_start();
+    const int* column_index = jacobian.column_index();
+    const double* value = jacobian.value();
+
+    // Bandwidth of the beam block
+    unsigned kl = 0;
+    unsigned ku = 0;
+    for (unsigned i = 0; i < n_beam; i++)
+    {
+      const unsigned row = block.Beam_dof[i];
+      for (int k = row_start[row]; k < row_start[row + 1]; k++)
+      {
+        const unsigned col = unsigned(column_index[k]);
+        if ((Dof_particle[col] == int(p)) && (!Dof_is_rigid_body_dof[col]))
+        {
+          const unsigned j = Dof_local_index[col];
+          if (j < i)
+          {
+            kl = std::max(kl, i - j);
+          }
+          else
+          {
+            ku = std::max(ku, j - i);
+          }
+        }
+      }
+    }
+
+    // Copy the blocks
+    delete block.Beam_block_pt;
+    block.Beam_block_pt = new BandedLUFactorisation;
+    block.Beam_block_pt->build(n_beam, kl, ku);
+    block.A_inv_b.assign(n_beam * n_rigid, 0.0);
+    block.C.assign(n_rigid * n_beam, 0.0);
+    block.Schur_lu.assign(n_rigid * n_rigid, 0.0);
+    for (unsigned i = 0; i < n_beam; i++)
+    {
+      const unsigned row = block.Beam_dof[i];
+      for (int k = row_start[row]; k < row_start[row + 1]; k++)
+      {
+        const unsigned col = unsigned(column_index[k]);
+        if (Dof_particle[col] == int(p))
+        {
+          const unsigned j = Dof_local_index[col];
+          if (Dof_is_rigid_body_dof[col])
+          {
+            block.A_inv_b[i * n_rigid + j] += value[k];
+          }
+          else
+          {
+            block.Beam_block_pt->entry(i, j) += value[k];
+          }
+        }
+      }
+    }
+    for (unsigned i = 0; i < n_rigid; i++)
+    {
+      const unsigned row = block.Rigid_body_dof[i];
+      for (int k = row_start[row]; k < row_start[row + 1]; k++)
+      {
+        const unsigned col = unsigned(column_index[k]);
+        if (Dof_particle[col] == int(p))
+        {
+          const unsigned j = Dof_local_index[col];
+          if (Dof_is_rigid_body_dof[col])
+          {
+            block.Schur_lu[i * n_rigid + j] += value[k];
+          }
+          else
+          {
+            block.C[i * n_beam + j] += value[k];
+          }
+        }
+      }
+    }
+
+    // Factorise A and compute A^{-1} B (all columns at once)
+    block.Beam_block_pt->factorise();
+    if ((n_beam > 0) && (n_rigid > 0))
+    {
+      block.Beam_block_pt->solve(n_rigid, &block.A_inv_b[0]);
+    }
+
+    // Schur complement S = D - C A^{-1} B...
+    double* lu = (n_rigid > 0) ? &block.Schur_lu[0] : 0;
+    for (unsigned i = 0; i < n_rigid; i++)
+    {
+      for (unsigned k = 0; k < n_beam; k++)
+      {
+        const double c_ik = block.C[i * n_beam + k];
+        if (c_ik != 0.0)
+        {
+          for (unsigned j = 0; j < n_rigid; j++)
+          {
+            lu[i * n_rigid + j] -= c_ik * block.A_inv_b[k * n_rigid + j];
+          }
+        }
+      }
+    }
+
+    // ...and its dense LU with partial pivoting
+    block.Schur_pivot.resize(n_rigid);
+    for (unsigned k = 0; k < n_rigid; k++)
+    {
+      unsigned piv = k;
+      for (unsigned i = k + 1; i < n_rigid; i++)
+      {
+        if (std::fabs(lu[i * n_rigid + k]) > std::fabs(lu[piv * n_rigid + k]))
+        {
+          piv = i;
+        }
+      }
+      block.Schur_pivot[k] = piv;
+      if (piv != k)
+      {
+        for (unsigned j = 0; j < n_rigid; j++)
+        {
+          std::swap(lu[k * n_rigid + j], lu[piv * n_rigid + j]);
+        }
+      }
+      if (lu[k * n_rigid + k] == 0.0)
+      {
+        std::ostringstream error_message;
+        error_message << "Schur complement of the rigid body block of "
+                      << "particle " << p << " is singular" << std::endl;
+        throw OomphLibError(error_message.str(),
+                            OOMPH_CURRENT_FUNCTION,
+                            OOMPH_EXCEPTION_LOCATION);
+      }
+      for (unsigned i = k + 1; i < n_rigid; i++)
+      {
+        lu[i * n_rigid + k] /= lu[k * n_rigid + k];
+        for (unsigned j = k + 1; j < n_rigid; j++)
+        {
+          lu[i * n_rigid + j] -= lu[i * n_rigid + k] * lu[k * n_rigid + j];
+        }
+      }
+    }
+  }
+
+
+  //=========================================================================
+  /// Assemble the Jacobian, factorise the particles' diagonal blocks and
+  /// solve J result = residuals
+  //=========================================================================
+  inline void ParticleBlockDiagonalSolver::solve(Problem* const& problem_pt,
+                                                 DoubleVector& result)
+  {
+#ifdef PARANOID
+    if (problem_pt != Problem_pt)
+    {
+      throw OomphLibError("Solver was constructed for a different problem",
+                          OOMPH_CURRENT_FUNCTION,
+                          OOMPH_EXCEPTION_LOCATION);
+    }
+#endif
+    double t_start = TimingHelpers::timer();
+
+    // (Re-)identify the particles' dofs if the equation numbering has
+    // changed
+    if (Problem_pt->ndof() != N_dof_at_setup)
+    {
+      setup_particle_dofs();
+    }
+
+    // Assemble
+    DoubleVector residuals;
+    CRDoubleMatrix jacobian;
+    Problem_pt->get_jacobian(residuals, jacobian);
+    double t_assembly = TimingHelpers::timer();
+
+    // Factorise the blocks (independently). Exceptions can't leave the
+    // parallel region so record the first failure and re-throw it
+    // afterwards.
+    const int n_particle = int(nparticle());
+    std::string error_string;
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+    for (int p = 0; p < n_particle; p++)
+    {
+      try
+      {
+        factorise_block(unsigned(p), jacobian);
+      }
+      catch (OomphLibError& error)
+      {
+#ifdef _OPENMP
+#pragma omp critical
+#endif
+        if (error_string.empty())
+        {
+          std::ostringstream error_message;
+          error_message << "Factorisation of the block of particle " << p
+                        << " failed" << std::endl;
+          error_string = error_message.str();
+        }
+      }
+    }
+    if (!error_string.empty())
+    {
+      throw OomphLibError(
+        error_string, OOMPH_CURRENT_FUNCTION, OOMPH_EXCEPTION_LOCATION);
+    }
+    double t_factorise = TimingHelpers::timer();
+
+    // Solve
+    apply_inverse(residuals, result);
+
+    if (Doc_time)
+    {
+      // Count the (ignored) entries that couple different particles
+      unsigned n_coupling = 0;
+      const unsigned n_dof = Problem_pt->ndof();
+      const int* row_start = jacobian.row_start();
+      const int* column_index = jacobian.column_index();
+      const double* value = jacobian.value();
+      for (unsigned i = 0; i < n_dof; i++)
+      {
+        for (int k = row_start[i]; k < row_start[i + 1]; k++)
+        {
+          if ((Dof_particle[column_index[k]] != Dof_particle[i]) &&
+              (value[k] != 0.0))
+          {
+            n_coupling++;
+          }
+        }
+      }
+      oomph_info << "Time for assembly of the Jacobian [sec]: "
+                 << t_assembly - t_start << std::endl
+                 << "Time for factorisation of " << n_particle
+                 << " particle blocks [sec]: " << t_factorise - t_assembly
+                 << std::endl
+                 << "Time for block-diagonal solve [sec]: "
+                 << TimingHelpers::timer() - t_factorise << std::endl
+                 << "Number of ignored inter-particle entries: " << n_coupling
+                 << std::endl;
+    }
+  }
+
+
+  //=========================================================================
+  /// Apply the inverse of the block-diagonal matrix: For each particle,
+  /// y = A^{-1} r_beam, x_rigid = S^{-1} (r_rigid - C y) and
+  /// x_beam = y - A^{-1} B x_rigid
+  //=========================================================================
+  inline void ParticleBlockDiagonalSolver::apply_inverse(
+    const DoubleVector& rhs, DoubleVector& result) const
+  {
+    if (!result.built())
+    {
+      result.build(rhs.distribution_pt(), 0.0);
+    }
+    const double* rhs_pt = rhs.values_pt();
+    double* result_pt = result.values_pt();
+
+    const int n_particle = int(Block.size());
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+    for (int p = 0; p < n_particle; p++)
+    {
+      const ParticleBlock& block = Block[p];
+      const unsigned n_beam = block.Beam_dof.size();
+      const unsigned n_rigid = block.Rigid_body_dof.size();
+
+      // y = A^{-1} r_beam
+      Vector<double> y(n_beam);
+      for (unsigned i = 0; i < n_beam; i++)
+      {
+        y[i] = rhs_pt[block.Beam_dof[i]];
+      }
+      if (n_beam > 0)
+      {
+        block.Beam_block_pt->solve(1, &y[0]);
+      }
+
+      // x_rigid = S^{-1} (r_rigid - C y)
+      Vector<double> x_rigid(n_rigid);
+      for (unsigned i = 0; i < n_rigid; i++)
+      {
+        x_rigid[i] = rhs_pt[block.Rigid_body_dof[i]];
+        for (unsigned k = 0; k < n_beam; k++)
+        {
+          x_rigid[i] -= block.C[i * n_beam + k] * y[k];
+        }
+      }
+      const double* lu = (n_rigid > 0) ? &block.Schur_lu[0] : 0;
+      // Apply all row interchanges before the forward substitution: the
+      // factorisation swapped entire rows (incl. the multipliers in L)
+      for (unsigned k = 0; k < n_rigid; k++)
+      {
+        std::swap(x_rigid[k], x_rigid[block.Schur_pivot[k]]);
+      }
+      for (unsigned k = 0; k < n_rigid; k++)
+      {
+        for (unsigned i = k + 1; i < n_rigid; i++)
+        {
+          x_rigid[i] -= lu[i * n_rigid + k] * x_rigid[k];
+        }
+      }
+      for (unsigned kk = n_rigid; kk > 0; kk--)
+      {
+        const unsigned k = kk - 1;
+        for (unsigned j = k + 1; j < n_rigid; j++)
+        {
+          x_rigid[k] -= lu[k * n_rigid + j] * x_rigid[j];
+        }
+        x_rigid[k] /= lu[k * n_rigid + k];
+      }
+
+      // x_beam = y - A^{-1} B x_rigid
+      for (unsigned i = 0; i < n_beam; i++)
+      {
+        double x = y[i];
+        for (unsigned j = 0; j < n_rigid; j++)
+        {
+          x -= block.A_inv_b[i * n_rigid + j] * x_rigid[j];
+        }
+        result_pt[block.Beam_dof[i]] = x;
+      }
+      for (unsigned i = 0; i < n_rigid; i++)
+      {
+        result_pt[block.Rigid_body_dof[i]] = x_rigid[i];
+      }
+    }
+  }
+
+} // namespace oomph
+
+#endif
@@ -25,11 +25,34 @@
 // LIC//====================================================================
 // Driver function for a simple beam problem
 
+// System includes (for running the Richardson extrapolation in parallel
+// processes)
+#include <sys/wait.h>
+#include <unistd.h>
+
 // OOMPH-LIB includes
 #include "generic.h"
 #include "beam.h"
 #include "meshes/one_d_lagrangian_mesh.h"
 
+// Local includes
+#include "beam_preconditioners.h"
+#include "jacobian_free_newton_krylov.h"
+#include "jacobian_reuse_newton_solver.h"
+#include "nonlocal_slender_body_operator.h"
+#include "particle_block_solver.h"
+#include "graded_one_d_lagrangian_mesh.h"
+#include "beam_integration_point_cache.h"
+#include "fixed_size_vector.h"
+#include "slender_body_traction_kernel.h"
+#include "numeric_output_buffer.h"
+#include "vtk_output.h"
+#include "compressed_snapshot_archive.h"
+#include "beam_solution_cache.h"
+#include "shift_invert_arnoldi.h"
+#include "fixed_order_hermite_quadrature.h"
+#include "dual_number.h"
+
 using namespace std;
 using namespace oomph;
 
@@ -82,6 +105,112 @@ namespace Global_Physical_Variables
   /// Value of ds for second interval
   double Ds_interval2 = 10.0;
 
+  /// Max. number of (converged) continuation steps in the parameter study
+  /// (0: continue until I becomes negative or there's no solution)
+  unsigned Max_continuation_steps = 0;
+
+  /// Number of steps in which I is increased from zero to its target
+  /// value in a steady solve (e.g. for --richardson)
+  unsigned N_steady_step = 10;
+
+  /// Max. dimension of the Krylov subspace for the Jacobian-free
+  /// Newton-Krylov solver (only used with --jfnk)
+  unsigned Krylov_dimension = 30;
+
+  /// Max. ratio of the residuals in successive Newton iterations before
+  /// the Jacobian is re-factorised (only used with --jacobian_reuse)
+  double Max_contraction_rate = 0.5;
+
+  /// Max. number of growth rates of the orientation (the finite
+  /// eigenvalues nearest zero of J v = lambda M v) documented by the
+  /// stability analysis (only used with --stability)
+  unsigned N_stability_eigenvalue = 4;
+
+  /// Dimension of the Krylov subspace for the shift-invert Arnoldi
+  /// method in the stability analysis (only used with --stability)
+  unsigned Arnoldi_dimension = 20;
+
+  /// Slenderness (radius/length) of the beam, which determines the
+  /// strength of the nonlocal slender body interaction (only used with
+  /// --nonlocal_slender_body)
+  double Slenderness = 0.01;
+
+  /// Arclength cutoff for the local region in the nonlocal slender body
+  /// operator (only used with --nonlocal_slender_body)
+  double Nonlocal_cutoff = 0.1;
+
+  /// Opening angle of the treecode in the nonlocal slender body operator
+  /// (0: direct summation; only used with --nonlocal_slender_body)
+  double Nonlocal_opening_angle = 0.2;
+
+  /// Initial timestep for the time-dependent sedimentation (only used
+  /// with --unsteady)
+  double Dt = 0.01;
+
+  /// End time for the time-dependent sedimentation
+  double T_max = 10.0;
+
+  /// Target for the global temporal error norm in the adaptive time
+  /// stepping
+  double Temporal_tolerance = 1.0e-4;
+
+  /// Number of timesteps between outputs of the beam shape (the
+  /// trajectory of the rigid body is documented after every step)
+  unsigned Unsteady_doc_interval = 10;
+
+  /// Number of particles in the suspension (0: single boomerang)
+  unsigned N_particle = 0;
+
+  /// Distance between neighbouring particles in the (square) lattice of
+  /// initial positions of the suspension
+  double Particle_spacing = 3.0;
+
+  /// Number of members of the ensemble of independent boomerangs (0: no
+  /// ensemble)
+  unsigned N_ensemble = 0;
+
+  /// Max. relative perturbation of the aspect ratio, opening angle and
+  /// thickness of the ensemble members
+  double Ensemble_perturbation = 0.05;
+
+  /// Seed for the random perturbations of the ensemble members
+  unsigned Ensemble_seed = 1;
+
+  /// Node distribution in the beam meshes: 0: uniform; 1: geometric;
+  /// 2: tanh; 3: user-specified element density (see element_density(...))
+  unsigned Mesh_grading = 0;
+
+  /// Parameter for graded meshes: ratio of largest to smallest element
+  /// (geometric), stretching parameter (tanh) or amplitude of the
+  /// boundary layer in the element density (user-specified density)
+  double Grading_parameter = 4.0;
+
+  /// Element density (in terms of the normalised Lagrangian coordinate
+  /// xi in [0,1]) for user-specified grading: Clusters elements near the
+  /// clamped junction (xi=0) and the free tip (xi=1) where the bending
+  /// moment and traction vary most rapidly
+  double element_density(const double& xi)
+  {
+    double boundary_layer_thickness = 0.1;
+    return 1.0 + Grading_parameter *
+                   (exp(-xi / boundary_layer_thickness) +
+                    exp(-(1.0 - xi) / boundary_layer_thickness));
+  }
+
+  /// Number of continuation steps between r-adaptations, in which the
+  /// nodes are moved to equidistribute the curvature-based monitor
+  /// function (0: no r-adaptation)
+  unsigned R_adapt_interval = 0;
+
+  /// Weight of the (squared) curvature in the monitor function for
+  /// r-adaptation
+  double Monitor_weight = 10.0;
+
+  /// Number of Gauss points for the compile-time specialised slender
+  /// body computations in the beam elements (2, 3 or 4; 0: use the
+  /// generic implementation with the default integration scheme)
+  unsigned Fixed_quadrature_order = 0;
+
 } // namespace Global_Physical_Variables
 
 
@@ -90,6 +219,10 @@ namespace Global_Physical_Variables
 /////////////////////////////////////////////////////////////////////
 
 
+// Forward declaration
+class HaoHermiteBeamElement;
+
+
 //=========================================================================
 /// RigidBodyElement
 //=========================================================================
@@ -97,18 +230,38 @@ class RigidBodyElement : public GeneralisedElement
 {
 public:
   /// Constructor: Pass initial values for rigid body parameters (pinned
-  /// by default)
+  /// by default). If a timestepper is specified, the orientation
+  /// (Theta_eq) and position (X0, Y0) are time-dependent unknowns that
+  /// evolve with the (overdamped) rigid body motion determined by the
+  /// balance of drag and torque; otherwise we solve for a pseudo
+  /// "equilibrium position" in which the orientation remains constant.
   RigidBodyElement(const double& V,
                    const double& U0,
                    const double& Theta_eq,
                    const double& X0,
-                   const double& Y0)
+                   const double& Y0,
+                   TimeStepper* time_stepper_pt = 0)
+    : Use_automatic_differentiation(false),
+      Use_incremental_finite_differences(false),
+      Nonlocal_operator_pt(0),
+      Nonlocal_first_arm(0),
+      Time_stepper_pt(time_stepper_pt)
   {
     // Create internal data which contains the "rigid body" parameters
-    for (unsigned i = 0; i < 5; i++)
+    // (V, U0, Theta_eq, X0, Y0 and the angular velocity Omega)
+    for (unsigned i = 0; i < 6; i++)
     {
-      // Create data: One value, no timedependence, free by default
-      add_internal_data(new Data(1));
+      // Orientation and position are time-dependent in the
+      // time-dependent mode
+      if ((time_stepper_pt != 0) && (i >= 2) && (i <= 4))
+      {
+        add_internal_data(new Data(time_stepper_pt, 1));
+      }
+      else
+      {
+        // Create data: One value, no timedependence, free by default
+        add_internal_data(new Data(1));
+      }
     }
 
     // Give them a value:
@@ -116,11 +269,18 @@ public:
     internal_data_pt(1)->set_value(0, U0);
     internal_data_pt(2)->set_value(0, Theta_eq);
 
-    // These are just initial values so pin
+    // These are just initial values so pin (unless they evolve in time)
     internal_data_pt(3)->set_value(0, X0);
-    internal_data_pt(3)->pin(0);
     internal_data_pt(4)->set_value(0, Y0);
-    internal_data_pt(4)->pin(0);
+
+    // The angular velocity vanishes in the pseudo "equilibrium position"
+    internal_data_pt(5)->set_value(0, 0.0);
+    if (time_stepper_pt == 0)
+    {
+      internal_data_pt(3)->pin(0);
+      internal_data_pt(4)->pin(0);
+      internal_data_pt(5)->pin(0);
+    }
   }
 
 
@@ -128,8 +288,9 @@ public:
   /// parameters
   Vector<Data*> rigid_body_parameters()
   {
-    Vector<Data*> tmp_pt(5);
-    for (unsigned i = 0; i < 5; i++)
+    unsigned n_internal = ninternal_data();
+    Vector<Data*> tmp_pt(n_internal);
+    for (unsigned i = 0; i < n_internal; i++)
     {
       tmp_pt[i] = internal_data_pt(i);
     }
@@ -137,6 +298,21 @@ public:
   }
 
 
+  /// Angular velocity of the rigid body motion (zero in the pseudo
+  /// "equilibrium position")
+  double angular_velocity()
+  {
+    return internal_data_pt(5)->value(0);
+  }
+
+
+  /// Is the rigid body motion time-dependent?
+  bool is_time_dependent() const
+  {
+    return (Time_stepper_pt != 0);
+  }
+
+
   /// Helper function to compute the meaningful parameter values
   /// from enumerated data
   void get_parameters(
@@ -150,6 +326,13 @@ public:
   }
 
 
+  /// Number of beam meshes that contribute to the drag and torque
+  unsigned nbeam_mesh() const
+  {
+    return Beam_mesh_pt.size();
+  }
+
+
   /// Pass pointer to the Mesh of HaoHermiteBeamElements
   /// and add their unknowns to be external data for this element
   void set_pointer_to_beam_meshes(const Vector<SolidMesh*>& beam_mesh_pt)
@@ -166,27 +349,232 @@ public:
       unsigned nnode = beam_mesh_pt[i]->nnode();
       for (unsigned j = 0; j < nnode; j++)
       {
-        add_external_data(beam_mesh_pt[i]->node_pt(j)->variable_position_pt());
+        SolidNode* node_pt = beam_mesh_pt[i]->node_pt(j);
+        Node_external_data_index[node_pt] =
+          add_external_data(node_pt->variable_position_pt());
+
+        // Work out where the generalised positions are stored in the
+        // nodes' variable position Data (same for all nodes)
+        if ((i == 0) && (j == 0))
+        {
+          Data* position_data_pt = node_pt->variable_position_pt();
+          for (unsigned k = 0; k < 2; k++)
+          {
+            for (unsigned d = 0; d < 2; d++)
+            {
+              Position_value_index[k][d] = 0;
+              unsigned n_value = position_data_pt->nvalue();
+              for (unsigned v = 0; v < n_value; v++)
+              {
+                if (position_data_pt->value_pt(v) == &node_pt->x_gen(k, d))
+                {
+                  Position_value_index[k][d] = v;
+                }
+              }
+            }
+          }
+        }
+      }
+    }
+
+    // Record which elements are affected by the external Data (i.e.
+    // which elements' contributions to the drag and torque change when
+    // a nodal position is perturbed)
+    Adjacent_element.clear();
+    Adjacent_element.resize(nexternal_data());
+    for (unsigned i = 0; i < npointer; i++)
+    {
+      unsigned n_element = beam_mesh_pt[i]->nelement();
+      for (unsigned e = 0; e < n_element; e++)
+      {
+        FiniteElement* el_pt = beam_mesh_pt[i]->finite_element_pt(e);
+        unsigned n_node = el_pt->nnode();
+        for (unsigned l = 0; l < n_node; l++)
+        {
+          Adjacent_element[Node_external_data_index[el_pt->node_pt(l)]]
+            .push_back(std::make_pair(i, e));
+        }
+      }
+    }
+  }
+
+
+  /// Compute the Jacobian by forward-mode automatic differentiation of
+  /// the drag and torque (rather than by finite differencing)
+  void enable_automatic_differentiation()
+  {
+    Use_automatic_differentiation = true;
+  }
+
+
+  /// Compute the Jacobian by finite differencing (default)
+  void disable_automatic_differentiation()
+  {
+    Use_automatic_differentiation = false;
+  }
+
+
+  /// Compute the derivatives w.r.t. the nodal positions by finite
+  /// differences, updating only the contributions of the elements
+  /// adjacent to the perturbed node (rather than re-computing the drag
+  /// and torque on the entire beam for each perturbation)
+  void enable_incremental_finite_differences()
+  {
+    Use_incremental_finite_differences = true;
+  }
+
+
+  /// Use the default finite differencing (default)
+  void disable_incremental_finite_differences()
+  {
+    Use_incremental_finite_differences = false;
+  }
+
+
+  /// Check the Jacobians computed by automatic differentiation and by
+  /// incremental finite differencing against the one computed by
+  /// GeneralisedElement's (default) finite differencing: Throw an error
+  /// if either differs from it by more than tol times its max. entry
+  void check_jacobian(const double& tol = 1.0e-5)
+  {
+    // Reference Jacobian
+    unsigned n_dof = ndof();
+    Vector<double> residuals(n_dof, 0.0);
+    DenseMatrix<double> jacobian_fd(n_dof, n_dof, 0.0);
+    GeneralisedElement::fill_in_contribution_to_jacobian(residuals,
+                                                         jacobian_fd);
+    double scale = 0.0;
+    for (unsigned i = 0; i < n_dof; i++)
+    {
+      for (unsigned j = 0; j < n_dof; j++)
+      {
+        scale = std::max(scale, fabs(jacobian_fd(i, j)));
+      }
+    }
+
+    bool use_automatic_differentiation = Use_automatic_differentiation;
+    bool use_incremental_finite_differences =
+      Use_incremental_finite_differences;
+    std::string label[2] = {"automatic differentiation",
+                            "incremental finite differencing"};
+    for (unsigned method = 0; method < 2; method++)
+    {
+      Use_automatic_differentiation = (method == 0);
+      Use_incremental_finite_differences = (method == 1);
+      residuals.initialise(0.0);
+      DenseMatrix<double> jacobian(n_dof, n_dof, 0.0);
+      fill_in_contribution_to_jacobian(residuals, jacobian);
+      double diff = 0.0;
+      for (unsigned i = 0; i < n_dof; i++)
+      {
+        for (unsigned j = 0; j < n_dof; j++)
+        {
+          diff = std::max(diff, fabs(jacobian(i, j) - jacobian_fd(i, j)));
+        }
+      }
+      oomph_info << "RigidBodyElement Jacobian by " << label[method]
+                 << " vs finite differencing: max. difference " << diff
+                 << " (max. entry " << scale << ")" << std::endl;
+      if (diff > tol * scale)
+      {
+        Use_automatic_differentiation = use_automatic_differentiation;
+        Use_incremental_finite_differences =
+          use_incremental_finite_differences;
+        std::ostringstream error_message;
+        error_message << "RigidBodyElement Jacobian by " << label[method]
+                      << " differs from the finite-difference one: max. "
+                      << "difference " << diff << " for max. entry "
+                      << scale << std::endl;
+        throw OomphLibError(error_message.str(),
+                            OOMPH_CURRENT_FUNCTION,
+                            OOMPH_EXCEPTION_LOCATION);
       }
     }
+    Use_automatic_differentiation = use_automatic_differentiation;
+    Use_incremental_finite_differences = use_incremental_finite_differences;
+  }
+
+
+  /// Use the nonlocal slender body operator to correct the (local)
+  /// resistive-force traction (null: local traction only). If the
+  /// operator is shared by several bodies, first_arm is the index of
+  /// this body's first arm amongst all the arms handled by the operator.
+  void set_nonlocal_operator_pt(NonlocalSlenderBodyOperator* nonlocal_pt,
+                                const unsigned& first_arm = 0)
+  {
+    Nonlocal_operator_pt = nonlocal_pt;
+    Nonlocal_first_arm = first_arm;
+  }
+
+
+  /// Pointer to the nonlocal slender body operator (null if not used)
+  NonlocalSlenderBodyOperator* nonlocal_operator_pt() const
+  {
+    return Nonlocal_operator_pt;
   }
 
 
+  /// Re-compute the velocity induced by the traction on all arms (the
+  /// nonlocal correction) for the current configuration
+  void update_nonlocal_slender_body_traction();
+
+
+  /// Get the data required by the nonlocal slender body operator for
+  /// this body's arms: the integration point data (with the local
+  /// traction), the rotation angle, the translation and the elements of
+  /// each arm. The data is stored in the entries
+  /// [first_arm, first_arm + number of arms) of the vectors (which are
+  /// resized if they are too short), where first_arm is specified in
+  /// set_nonlocal_operator_pt(...).
+  void get_nonlocal_slender_body_data(
+    Vector<SlenderBodyTractionBatch>& batch,
+    Vector<double>& theta,
+    Vector<double>& shift_x,
+    Vector<double>& shift_y,
+    Vector<Vector<const FiniteElement*>>& element_pt);
+
+
   /// Compute the beam's centre of mass
-  void compute_centre_of_mass(Vector<double>& sum_r_centre);
+  void compute_centre_of_mass(FixedSizeVector<double, 2>& sum_r_centre);
 
 
   /// Compute the drag and torque on the entire beam structure according
   /// to slender body theory
-  void compute_drag_and_torque(Vector<double>& sum_total_drag,
+  void compute_drag_and_torque(FixedSizeVector<double, 2>& sum_total_drag,
                                double& sum_total_torque);
 
 
+  /// Compute the drag and torque on the entire beam structure with the
+  /// local (resistive-force) traction only, i.e. without the nonlocal
+  /// correction (if any)
+  void compute_local_drag_and_torque(
+    FixedSizeVector<double, 2>& sum_total_drag, double& sum_total_torque)
+  {
+    NonlocalSlenderBodyOperator* nonlocal_pt = Nonlocal_operator_pt;
+    Nonlocal_operator_pt = 0;
+    compute_drag_and_torque(sum_total_drag, sum_total_torque);
+    Nonlocal_operator_pt = nonlocal_pt;
+  }
+
+
+  /// Version of compute_drag_and_torque(...) that is templated on the
+  /// scalar type so it can be differentiated automatically. The rigid
+  /// body parameters (V, U0, Theta_eq, X0, Y0) and the values stored in
+  /// the external Data (the beam nodes' generalised positions) are
+  /// passed in explicitly.
+  template<class SCALAR>
+  void compute_drag_and_torque_generic(
+    const Vector<SCALAR>& parameter,
+    const Vector<Vector<SCALAR>>& external_value,
+    SCALAR sum_total_drag[2],
+    SCALAR& sum_total_torque);
+
+
   /// Output the Theta_eq, Theta_eq_orientation (make comparision with paper's
   /// results), drag and torque on the entire beam structure
   void output(std::ostream& outfile)
   {
-    Vector<double> sum_total_drag(2);
+    FixedSizeVector<double, 2> sum_total_drag;
     double sum_total_torque = 0.0;
 
     // Compute the drag and torque on the entire beam structure
@@ -226,70 +614,219 @@ public:
   }
 
 protected:
+  /// Fill in contribution to residuals and Jacobian, by automatic
+  /// differentiation or incremental finite differencing if enabled, by
+  /// (default) finite differencing otherwise
+  void fill_in_contribution_to_jacobian(Vector<double>& residuals,
+                                        DenseMatrix<double>& jacobian)
+  {
+    if (Use_automatic_differentiation)
+    {
+      fill_in_contribution_to_residuals(residuals);
+      fill_in_jacobian_by_automatic_differentiation(jacobian);
+      fill_in_jacobian_from_kinematic_conditions(jacobian);
+    }
+    else if (Use_incremental_finite_differences)
+    {
+      fill_in_contribution_to_residuals(residuals);
+      fill_in_jacobian_by_incremental_finite_differences(jacobian);
+      fill_in_jacobian_from_kinematic_conditions(jacobian);
+    }
+    else
+    {
+      GeneralisedElement::fill_in_contribution_to_jacobian(residuals,
+                                                           jacobian);
+    }
+  }
+
+
   // Fill in contribution to residuals
   void fill_in_contribution_to_residuals(Vector<double>& residuals)
   {
-    abort();
     // oomph_info << "ndof in element: " << residuals.size() << std::endl;
 
     // Get current total drag and torque
-    Vector<double> sum_total_drag(2);
+    FixedSizeVector<double, 2> sum_total_drag;
     double sum_total_torque = 0.0;
     compute_drag_and_torque(sum_total_drag, sum_total_torque);
 
-    unsigned n_internal = ninternal_data();
-    for (unsigned i = 0; i < n_internal; i++)
+    // Eqns for V and U0: drag; eqn for Theta_eq (or, in the
+    // time-dependent mode, for the angular velocity): torque
+    int local_eqn[3];
+    get_drag_and_torque_local_eqn(local_eqn);
+    double residual[3] = {
+      sum_total_drag[0], sum_total_drag[1], sum_total_torque};
+    for (unsigned i = 0; i < 3; i++)
     {
-      // Get the local equation number of the zeroth dof
-      // associated with this internal Data object
-      unsigned j = 0;
-      int eqn_number = internal_local_eqn(i, j);
+      if (local_eqn[i] >= 0)
+      {
+        residuals[local_eqn[i]] = residual[i];
+      }
+    }
 
-      // Is it an actual dof
-      if (eqn_number >= 0)
+    // Kinematic conditions for Theta_eq, X0 and Y0 in the time-dependent
+    // mode: Their rates of change are Omega, U0 and V, respectively
+    if (Time_stepper_pt != 0)
+    {
+      for (unsigned k = 0; k < 3; k++)
       {
-        if (i == 0)
-        {
-          // Eqn for V:
-          residuals[eqn_number] = sum_total_drag[0];
-          // internal_data_pt(i)->value(j)-
-          // Global_Physical_Variables::V;
-        }
-        else if (i == 1)
-        {
-          // Eqn for U0:
-          residuals[eqn_number] = sum_total_drag[1];
-          // internal_data_pt(i)->value(j)-
-          // Global_Physical_Variables::U0;
-        }
-        else if (i == 2)
-        {
-          // Eqn for Theta_eq:
-          residuals[eqn_number] = sum_total_torque;
-          // internal_data_pt(i)->value(j)-
-          // Global_Physical_Variables::Theta_eq;
-        }
-        else
+        int eqn_number = internal_local_eqn(Kinematic_position_index[k], 0);
+        if (eqn_number >= 0)
         {
-          oomph_info << "Never get here\n";
-          abort();
+          Data* data_pt = internal_data_pt(Kinematic_position_index[k]);
+          double dxdt = 0.0;
+          unsigned n_time = Time_stepper_pt->ntstorage();
+          for (unsigned t = 0; t < n_time; t++)
+          {
+            dxdt += Time_stepper_pt->weight(1, t) * data_pt->value(t, 0);
+          }
+          residuals[eqn_number] =
+            dxdt - internal_data_pt(Kinematic_velocity_index[k])->value(0);
         }
-
-        // std::cout << "internal data " << i << " is not pinned\n";
       }
-      else
+    }
+  }
+
+private:
+  /// Local equation numbers of the residuals that are given by the x and
+  /// y components of the drag and by the torque: those associated with
+  /// V, U0 and Theta_eq (or, in the time-dependent mode, in which the
+  /// equation associated with Theta_eq is a kinematic condition, with
+  /// V, U0 and the angular velocity)
+  void get_drag_and_torque_local_eqn(int local_eqn[3])
+  {
+    local_eqn[0] = internal_local_eqn(0, 0);
+    local_eqn[1] = internal_local_eqn(1, 0);
+    local_eqn[2] = internal_local_eqn((Time_stepper_pt == 0) ? 2 : 5, 0);
+  }
+
+  /// Add the (exact) derivatives of the kinematic conditions (only
+  /// present in the time-dependent mode) to the Jacobian
+  void fill_in_jacobian_from_kinematic_conditions(
+    DenseMatrix<double>& jacobian)
+  {
+    if (Time_stepper_pt == 0)
+    {
+      return;
+    }
+    for (unsigned k = 0; k < 3; k++)
+    {
+      int eqn_number = internal_local_eqn(Kinematic_position_index[k], 0);
+      if (eqn_number >= 0)
       {
-        // std::cout << "internal data " << i << " is pinned\n";
+        jacobian(eqn_number, eqn_number) += Time_stepper_pt->weight(1, 0);
+        int local_unknown = internal_local_eqn(Kinematic_velocity_index[k], 0);
+        if (local_unknown >= 0)
+        {
+          jacobian(eqn_number, local_unknown) -= 1.0;
+        }
       }
     }
   }
 
-private:
+  /// Indices of the internal Data that store the orientation and
+  /// position (Theta_eq, X0, Y0)...
+  static const unsigned Kinematic_position_index[3];
+
+  /// ...and of the internal Data that store their rates of change
+  /// (Omega, U0, V) in the time-dependent mode
+  static const unsigned Kinematic_velocity_index[3];
+
+  /// Add the derivatives of the drag and torque w.r.t. all unknowns to
+  /// the Jacobian, using forward-mode automatic differentiation with
+  /// dual numbers (N_dual_derivative unknowns per pass)
+  void fill_in_jacobian_by_automatic_differentiation(
+    DenseMatrix<double>& jacobian);
+
+  /// Number of unknowns that are seeded simultaneously in the automatic
+  /// differentiation
+  static const unsigned N_dual_derivative = 8;
+
+  /// Contribution of one element to the drag and torque, and to the
+  /// centre of mass of its arm
+  struct ElementContribution
+  {
+    /// Drag
+    double Drag[2];
+
+    /// Torque about the origin
+    double Torque_about_origin;
+
+    /// Integral of the position vector R_0 (before the rigid body
+    /// motion is applied)
+    double Int_r_0[2];
+
+    /// Length
+    double Length;
+  };
+
+  /// Compute the contribution of the element to the drag and torque
+  /// (for the given rigid body motion), and to the centre of mass
+  void compute_element_contribution(HaoHermiteBeamElement* elem_pt,
+                                    const double& V,
+                                    const double& U0,
+                                    const double& theta,
+                                    const double& X0,
+                                    const double& Y0,
+                                    const double& omega,
+                                    ElementContribution& contribution);
+
+  /// Add the derivatives of the drag and torque w.r.t. all unknowns to
+  /// the Jacobian, using finite differences. For the nodal positions,
+  /// only the contributions of the elements adjacent to the perturbed
+  /// node are re-computed and the changes in the drag, torque and centre
+  /// of mass are accumulated from the changes in these contributions.
+  void fill_in_jacobian_by_incremental_finite_differences(
+    DenseMatrix<double>& jacobian);
+
   /// Pointer to the Mesh of HaoHermiteBeamElements
   Vector<SolidMesh*> Beam_mesh_pt;
+
+  /// Index of the beam nodes' variable position Data in the element's
+  /// external Data
+  std::map<Node*, unsigned> Node_external_data_index;
+
+  /// Index of the generalised position x_gen(k,i) in the nodes'
+  /// variable position Data
+  unsigned Position_value_index[2][2];
+
+  /// Compute the Jacobian by automatic differentiation?
+  bool Use_automatic_differentiation;
+
+  /// Compute the Jacobian by incremental finite differencing?
+  bool Use_incremental_finite_differences;
+
+  /// Elements (arm, element number within the arm's mesh) that are
+  /// affected by each external Data
+  Vector<Vector<std::pair<unsigned, unsigned>>> Adjacent_element;
+
+  /// Workspace for the evaluation of the traction in a single element
+  SlenderBodyTractionBatch Element_traction_batch;
+
+  /// Pointer to the nonlocal slender body operator (null if not used)
+  NonlocalSlenderBodyOperator* Nonlocal_operator_pt;
+
+  /// Index of this body's first arm amongst the arms handled by the
+  /// nonlocal slender body operator
+  unsigned Nonlocal_first_arm;
+
+  /// Workspace for the batched evaluation of the traction at all
+  /// integration points of each beam mesh
+  Vector<SlenderBodyTractionBatch> Traction_batch;
+
+  /// Timestepper for the orientation and position (null if we're
+  /// solving for the pseudo "equilibrium position")
+  TimeStepper* Time_stepper_pt;
 };
 
 
+/// Indices of the internal Data that store Theta_eq, X0 and Y0
+const unsigned RigidBodyElement::Kinematic_position_index[3] = {2, 3, 4};
+
+/// Indices of the internal Data that store Omega, U0 and V
+const unsigned RigidBodyElement::Kinematic_velocity_index[3] = {5, 1, 0};
+
+
 /////////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////////
@@ -303,7 +840,11 @@ class HaoHermiteBeamElement : public virtual HermiteBeamElement
 public:
   /// Constructor: Initialise private member data
   HaoHermiteBeamElement()
-    : Rigid_body_element_pt(0), I_pt(0), Theta_initial_pt(0)
+    : Rigid_body_element_pt(0),
+      I_pt(0),
+      Theta_initial_pt(0),
+      Integration_point_cache_pt(0),
+      Fixed_quadrature_order(0)
   {
   }
 
@@ -320,14 +861,14 @@ public:
       Rigid_body_element_pt->rigid_body_parameters();
 
 #ifdef PARANOID
-    if (rigid_body_data_pt.size() != 5)
+    if (rigid_body_data_pt.size() != 6)
     {
       std::ostringstream error_message;
-      error_message << "rigid_body_data_pt should have size 5, not "
+      error_message << "rigid_body_data_pt should have size 6, not "
                     << rigid_body_data_pt.size() << std::endl;
 
       // loop over all entries
-      for (unsigned i = 0; i < 5; i++)
+      for (unsigned i = 0; i < rigid_body_data_pt.size(); i++)
       {
         if (rigid_body_data_pt[i]->nvalue() != 1)
         {
@@ -343,7 +884,7 @@ public:
 #endif
 
     // Add the rigid body parameters as the external data for this element
-    for (unsigned i = 0; i < 5; i++)
+    for (unsigned i = 0; i < 6; i++)
     {
       add_external_data(rigid_body_data_pt[i]);
     }
@@ -377,114 +918,142 @@ public:
   }
 
 
-  /// Compute the element's contribution to the (\int r ds) and length of beam
-  void compute_contribution_to_int_r_and_length(Vector<double>& int_r,
-                                                double& length)
+  /// Use the (shared) cached integration point data of the mesh
+  /// rather than recomputing the shape functions etc. at every
+  /// integration point. Null: don't use a cache.
+  void set_integration_point_cache_pt(
+    BeamIntegrationPointCache* integration_point_cache_pt)
   {
 #ifdef PARANOID
-    if (int_r.size() != 2)
+    if ((integration_point_cache_pt != 0) &&
+        (integration_point_cache_pt->nintpt() != integral_pt()->nweight()))
     {
       std::ostringstream error_message;
-      error_message << "int_r should have size 2, not " << int_r.size()
-                    << std::endl;
+      error_message << "Cache has " << integration_point_cache_pt->nintpt()
+                    << " integration points per element but the element has "
+                    << integral_pt()->nweight() << std::endl;
 
       throw OomphLibError(
         error_message.str(), OOMPH_CURRENT_FUNCTION, OOMPH_EXCEPTION_LOCATION);
     }
 #endif
+    Integration_point_cache_pt = integration_point_cache_pt;
+  }
 
-    // Initialise
-    int_r[0] = 0.0;
-    int_r[1] = 0.0;
-    length = 0.0;
-
-    // Local coordinate (1D!)
-    Vector<double> s(1);
 
-    // Set # of integration points
-    const unsigned n_intpt = integral_pt()->nweight();
+  /// Use the compile-time specialised implementation of the slender
+  /// body computations (with constexpr knots, weights and shape
+  /// functions, and fully unrolled loops over the integration points and
+  /// shape functions) for the n_intpt-point Gauss rule (n_intpt = 2, 3
+  /// or 4), and switch the element's integration scheme to that rule.
+  /// 0: Use the generic implementation (and the current integration
+  /// scheme).
+  void set_fixed_quadrature_order(const unsigned& n_intpt)
+  {
+#ifdef PARANOID
+    if ((nnode() != 2) || (nnodal_position_type() != 2))
+    {
+      std::ostringstream error_message;
+      error_message << "Element should have 2 nodes with 2 position types, "
+                    << "not " << nnode() << " nodes with "
+                    << nnodal_position_type() << " position types"
+                    << std::endl;
 
-    // Loop over the integration points
-    for (unsigned ipt = 0; ipt < n_intpt; ipt++)
+      throw OomphLibError(
+        error_message.str(), OOMPH_CURRENT_FUNCTION, OOMPH_EXCEPTION_LOCATION);
+    }
+#endif
+    switch (n_intpt)
     {
-      // Get the integral weight
-      double w = integral_pt()->weight(ipt);
+      case 0:
+        break;
 
-      // Return local coordinate s[j]  of i-th integration point.
-      unsigned j = 0;
-      s[j] = integral_pt()->knot(ipt, j);
+      case 2:
+        set_integration_scheme(GaussLegendreTable<2>::integral_pt());
+        break;
 
-      // Get position vector to and non-unit tangent vector on wall:
-      // dr/ds. NOTE: This is before we apply the rigid body motion!
-      // so in terms of the write-up the position vector is R_0
-      Vector<double> R_0(2);
-      Vector<double> drds(2);
-      get_non_unit_tangent(s, R_0, drds);
+      case 3:
+        set_integration_scheme(GaussLegendreTable<3>::integral_pt());
+        break;
 
-      // Jacobian of mapping between local and global coordinates
-      double J = sqrt(drds[0] * drds[0] + drds[1] * drds[1]);
+      case 4:
+        set_integration_scheme(GaussLegendreTable<4>::integral_pt());
+        break;
 
-      // Premultiply the weights and the Jacobian
-      double W = w * J;
+      default:
+        std::ostringstream error_message;
+        error_message << "Fixed quadrature order should be 0, 2, 3 or 4, not "
+                      << n_intpt << std::endl;
 
-      // Translate rigid body parameters into meaningful variables
-      // (Type=0: first arm, Type=1: second arm.)
-      double V = 0.0;
-      double U0 = 0.0;
-      double Theta_eq = 0.0;
-      double X0 = 0.0;
-      double Y0 = 0.0;
-      Rigid_body_element_pt->get_parameters(V, U0, Theta_eq, X0, Y0);
+        throw OomphLibError(error_message.str(),
+                            OOMPH_CURRENT_FUNCTION,
+                            OOMPH_EXCEPTION_LOCATION);
+    }
+    Fixed_quadrature_order = n_intpt;
+  }
 
-      // Note that we're looking for an pseudo "equilibrium position"
-      // where the angle (and the traction!) remain constant while
-      // the beam still moves as a rigid body!
-      double t = 0.0;
 
+  // Make the base class versions (which take Vectors) available too
+  using HermiteBeamElement::get_non_unit_tangent;
+  using HermiteBeamElement::get_normal;
 
-      // hierher use Theta_initial everywhere whenever you're processing
-      // Theta_eq
 
-      // Apply rigid body translation and rotation to get the actual
-      // shape of the deformed body in the fluid
-      Vector<double> R(2);
-      R[0] = cos(Theta_eq + theta_initial()) * R_0[0] -
-             sin(Theta_eq + theta_initial()) * R_0[1] + 0.5 * V * t * t +
-             U0 * t + X0;
-      R[1] = sin(Theta_eq + theta_initial()) * R_0[0] +
-             cos(Theta_eq + theta_initial()) * R_0[1] + V * t + Y0;
+  /// Get position vector to and non-unit tangent vector on the beam
+  /// (before the rigid body motion is applied) at local coordinate s.
+  /// Allocation-free version of get_non_unit_tangent(...).
+  void get_non_unit_tangent(const double& s,
+                            FixedSizeVector<double, 2>& r,
+                            FixedSizeVector<double, 2>& drds)
+  {
+    double psi[4];
+    double dpsids[4];
+    hermite_shape(s, psi, dpsids);
+    interpolate_position_and_tangent(psi, dpsids, r, drds);
+  }
 
-      // Add 'em.
-      length += W;
-      int_r[0] += R[0] * W;
-      int_r[1] += R[1] * W;
-    }
+
+  /// Get position vector to and unit normal on the beam (before the
+  /// rigid body motion is applied) at local coordinate s.
+  /// Allocation-free version of get_normal(...).
+  void get_normal(const double& s,
+                  FixedSizeVector<double, 2>& r,
+                  FixedSizeVector<double, 2>& N)
+  {
+    FixedSizeVector<double, 2> drds;
+    get_non_unit_tangent(s, r, drds);
+    double length = sqrt(drds[0] * drds[0] + drds[1] * drds[1]);
+    N[0] = -drds[1] / length;
+    N[1] = drds[0] / length;
   }
 
 
-  /// Compute the slender body traction acting on the actual beam onto the
-  /// element at local coordinate s
-  void compute_slender_body_traction_on_actual_beam(const Vector<double>& s,
-                                                    Vector<double>& traction)
+  /// Compute the element's contribution to the (\int r ds) and length of beam
+  void compute_contribution_to_int_r_and_length(
+    FixedSizeVector<double, 2>& int_r, double& length)
   {
-#ifdef PARANOID
-    if (traction.size() != 2)
+    // Use the compile-time specialised version?
+    switch (Fixed_quadrature_order)
     {
-      std::ostringstream error_message;
-      error_message << "traction should have size 2, not " << traction.size()
-                    << std::endl;
+      case 2:
+        fixed_order_contribution_to_int_r_and_length<2>(int_r, length);
+        return;
 
-      throw OomphLibError(
-        error_message.str(), OOMPH_CURRENT_FUNCTION, OOMPH_EXCEPTION_LOCATION);
+      case 3:
+        fixed_order_contribution_to_int_r_and_length<3>(int_r, length);
+        return;
+
+      case 4:
+        fixed_order_contribution_to_int_r_and_length<4>(int_r, length);
+        return;
     }
-#endif
 
-    // Get the Eulerian position and the unit normal.
-    // NOTE: This is before we apply the rigid body motion!
-    // so in terms of the write-up the position vector is R_0 and N_0
-    Vector<double> R_0(2);
-    Vector<double> N_0(2);
-    get_normal(s, R_0, N_0);
+    // Initialise
+    int_r[0] = 0.0;
+    int_r[1] = 0.0;
+    length = 0.0;
+
+    // Set # of integration points
+    const unsigned n_intpt = integral_pt()->nweight();
 
     // Translate rigid body parameters into meaningful variables
     // (Type=0: first arm, Type=1: second arm.)
@@ -500,47 +1069,77 @@ public:
     // the beam still moves as a rigid body!
     double t = 0.0;
 
-    // Compute R which is after translation and rotation
-    Vector<double> R(2);
-    R[0] = cos(Theta_eq + theta_initial()) * R_0[0] -
-           sin(Theta_eq + theta_initial()) * R_0[1] + 0.5 * V * t * t + U0 * t +
-           X0;
-    R[1] = sin(Theta_eq + theta_initial()) * R_0[0] +
-           cos(Theta_eq + theta_initial()) * R_0[1] + V * t + Y0;
+    // hierher use Theta_initial everywhere whenever you're processing
+    // Theta_eq
+    const double cos_theta = cos(Theta_eq + theta_initial());
+    const double sin_theta = sin(Theta_eq + theta_initial());
 
-    // Compute normal N which is after translation and rotation
-    Vector<double> N(2);
-    N[0] = cos(Theta_eq + theta_initial()) * N_0[0] -
-           sin(Theta_eq + theta_initial()) * N_0[1];
-    N[1] = sin(Theta_eq + theta_initial()) * N_0[0] +
-           cos(Theta_eq + theta_initial()) * N_0[1];
+    // Position vector to and non-unit tangent vector on wall: dr/ds.
+    // NOTE: This is before we apply the rigid body motion!
+    // so in terms of the write-up the position vector is R_0
+    FixedSizeVector<double, 2> R_0;
+    FixedSizeVector<double, 2> drds;
 
-    // Compute the traction onto the element at local coordinate s
-    traction[0] = 0.5 * (V * t - R[1] + U0) * N[1] * N[1] -
-                  0.5 * N[1] * N[0] * V - V * t - U0 + R[1];
+    // Loop over the integration points
+    for (unsigned ipt = 0; ipt < n_intpt; ipt++)
+    {
+      // Get the integral weight
+      double w = integration_weight(ipt);
 
-    traction[1] =
-      0.5 * V * N[0] * N[0] - 0.5 * N[1] * (V * t - R[1] + U0) * N[0] - V;
-  }
+      // Get position vector and non-unit tangent vector
+      get_non_unit_tangent_at_knot(ipt, R_0, drds);
 
+      // Jacobian of mapping between local and global coordinates
+      double J = sqrt(drds[0] * drds[0] + drds[1] * drds[1]);
 
-  /// Compute the slender body traction acting on the beam in the reference
-  /// configuration (i.e. without rigid body motion!) at local coordinate s
-  void compute_slender_body_traction_on_beam_in_reference_configuration(
-    const Vector<double>& s, Vector<double>& traction_0)
-  {
-#ifdef PARANOID
-    if (traction_0.size() != 2)
-    {
-      std::ostringstream error_message;
-      error_message << "traction_0 should have size 2, not "
-                    << traction_0.size() << std::endl;
+      // Premultiply the weights and the Jacobian
+      double W = w * J;
 
-      throw OomphLibError(
-        error_message.str(), OOMPH_CURRENT_FUNCTION, OOMPH_EXCEPTION_LOCATION);
+      // Apply rigid body translation and rotation to get the actual
+      // shape of the deformed body in the fluid
+      double R_x = cos_theta * R_0[0] - sin_theta * R_0[1] +
+                   0.5 * V * t * t + U0 * t + X0;
+      double R_y = sin_theta * R_0[0] + cos_theta * R_0[1] + V * t + Y0;
+
+      // Add 'em.
+      length += W;
+      int_r[0] += R_x * W;
+      int_r[1] += R_y * W;
     }
-#endif
+  }
+
+
+  /// Compute the slender body traction acting on the actual beam onto the
+  /// element at local coordinate s
+  void compute_slender_body_traction_on_actual_beam(
+    const double& s, FixedSizeVector<double, 2>& traction)
+  {
+    // Get the Eulerian position and the unit normal.
+    // NOTE: This is before we apply the rigid body motion!
+    // so in terms of the write-up the position vector is R_0 and N_0
+    FixedSizeVector<double, 2> R_0;
+    FixedSizeVector<double, 2> N_0;
+    get_normal(s, R_0, N_0);
+
+    // Translate rigid body parameters into meaningful variables
+    // (Type=0: first arm, Type=1: second arm.)
+    double V = 0.0;
+    double U0 = 0.0;
+    double Theta_eq = 0.0;
+    double X0 = 0.0;
+    double Y0 = 0.0;
+    Rigid_body_element_pt->get_parameters(V, U0, Theta_eq, X0, Y0);
+
+    // Compute the traction
+    slender_body_traction(R_0, N_0, V, U0, Theta_eq, X0, Y0, traction);
+  }
+
 
+  /// Compute the slender body traction acting on the beam in the reference
+  /// configuration (i.e. without rigid body motion!) at local coordinate s
+  void compute_slender_body_traction_on_beam_in_reference_configuration(
+    const double& s, FixedSizeVector<double, 2>& traction_0)
+  {
     // Translate rigid body parameters into meaningful variables
     double V = 0.0;
     double U0 = 0.0;
@@ -550,9 +1149,13 @@ public:
     Rigid_body_element_pt->get_parameters(V, U0, Theta_eq, X0, Y0);
 
     // Compute the slender body traction acting on the actual beam onto the
-    // element at local coordinate s
-    Vector<double> traction(2);
-    compute_slender_body_traction_on_actual_beam(s, traction);
+    // element at local coordinate s (without fetching the rigid body
+    // parameters again)
+    FixedSizeVector<double, 2> R_0;
+    FixedSizeVector<double, 2> N_0;
+    get_normal(s, R_0, N_0);
+    FixedSizeVector<double, 2> traction;
+    slender_body_traction(R_0, N_0, V, U0, Theta_eq, X0, Y0, traction);
 
     // Rotate the traction from the actual beam back to the reference
     // configuration.
@@ -565,57 +1168,90 @@ public:
 
   // overloaded load_vector to apply the computed traction_0 (i.e. the
   // traction acting on the beam before its rigid body motion is applied)
-  // including the non-dimensional coefficient I (FSI)
+  // including the non-dimensional coefficient I (FSI). The position
+  // vector x and unit normal N (R_0 and N_0 in terms of the write-up)
+  // have already been interpolated by the caller so we don't recompute
+  // them.
   void load_vector(const unsigned& intpt,
                    const Vector<double>& xi,
                    const Vector<double>& x,
                    const Vector<double>& N,
                    Vector<double>& load)
   {
-    /// Return local coordinate s[j] at the specified integration point.
-    Vector<double> s(1);
-    unsigned j = 0;
-    s[j] = integral_pt()->knot(intpt, j);
+    // Translate rigid body parameters into meaningful variables
+    double V = 0.0;
+    double U0 = 0.0;
+    double Theta_eq = 0.0;
+    double X0 = 0.0;
+    double Y0 = 0.0;
+    Rigid_body_element_pt->get_parameters(V, U0, Theta_eq, X0, Y0);
 
-    compute_slender_body_traction_on_beam_in_reference_configuration(s, load);
-    // load[0] = *(i_pt()) * load[0];
-    // load[1] = *(i_pt()) * load[1];
+    // Compute the slender body traction acting on the actual beam and
+    // rotate it back to the reference configuration (traction_0)
+    double t = 0.0;
+    double omega = Rigid_body_element_pt->angular_velocity();
+    double traction_x = 0.0;
+    double traction_y = 0.0;
+    SlenderBodyTractionKernel::evaluate(1,
+                                        &x[0],
+                                        &x[1],
+                                        &N[0],
+                                        &N[1],
+                                        V,
+                                        U0,
+                                        Theta_eq + theta_initial(),
+                                        X0,
+                                        Y0,
+                                        t,
+                                        omega,
+                                        0,
+                                        &traction_x,
+                                        &traction_y,
+                                        &load[0],
+                                        &load[1],
+                                        0);
+
+    // Add the nonlocal correction (the induced velocity is in the actual
+    // configuration so rotate it back to the reference configuration)
+    NonlocalSlenderBodyOperator* nonlocal_pt =
+      Rigid_body_element_pt->nonlocal_operator_pt();
+    double u_x = 0.0;
+    double u_y = 0.0;
+    if ((nonlocal_pt != 0) &&
+        nonlocal_pt->induced_velocity(this, intpt, u_x, u_y))
+    {
+      double cos_theta = cos(Theta_eq + theta_initial());
+      double sin_theta = sin(Theta_eq + theta_initial());
+      double u_0_x = cos_theta * u_x + sin_theta * u_y;
+      double u_0_y = cos_theta * u_y - sin_theta * u_x;
+      double delta_f_x = 0.0;
+      double delta_f_y = 0.0;
+      NonlocalSlenderBodyOperator::traction_correction(
+        u_0_x, u_0_y, N[0], N[1], delta_f_x, delta_f_y);
+      load[0] += delta_f_x;
+      load[1] += delta_f_y;
+    }
 
-    // Test! Give constant pressure to the beam
-    load[0] = 1.0e-7;
-    load[1] = 0.0;
+    // Scale by the non-dimensional coefficient I (FSI)
+    load[0] = *(i_pt()) * load[0];
+    load[1] = *(i_pt()) * load[1];
   }
 
 
   // Compute the element's contribution to the total drag and torque on
   // the entire beam structure according to slender body theory
-  void compute_contribution_to_drag_and_torque(Vector<double>& drag,
-                                               double& torque)
+  void compute_contribution_to_drag_and_torque(
+    FixedSizeVector<double, 2>& drag, double& torque)
   {
-#ifdef PARANOID
-    if (drag.size() != 2)
-    {
-      std::ostringstream error_message;
-      error_message << "drag should have size 2, not " << drag.size()
-                    << std::endl;
-
-      throw OomphLibError(
-        error_message.str(), OOMPH_CURRENT_FUNCTION, OOMPH_EXCEPTION_LOCATION);
-    }
-#endif
-
     // Initialise
     drag[0] = 0.0;
     drag[1] = 0.0;
     torque = 0.0;
 
     // Compute the beam's positon of centre of mass
-    Vector<double> sum_r_centre(2);
+    FixedSizeVector<double, 2> sum_r_centre;
     Rigid_body_element_pt->compute_centre_of_mass(sum_r_centre);
 
-    // Local coordinate (1D!)
-    Vector<double> s(1);
-
     // Set # of integration points
     const unsigned n_intpt = integral_pt()->nweight();
 
@@ -633,24 +1269,26 @@ public:
     // the beam still moves as a rigid body!
     double t = 0.0;
 
+    const double cos_theta = cos(Theta_eq + theta_initial());
+    const double sin_theta = sin(Theta_eq + theta_initial());
+
+    // Position vector to, non-unit tangent vector on and unit normal to
+    // the wall
+    // NOTE: This is before we apply the rigid body motion!
+    // so in terms of the write-up the position vector is R_0
+    FixedSizeVector<double, 2> R_0;
+    FixedSizeVector<double, 2> drds;
+    FixedSizeVector<double, 2> N_0;
+    FixedSizeVector<double, 2> traction;
+
     // Loop over the integration points
     for (unsigned ipt = 0; ipt < n_intpt; ipt++)
     {
       // Get the integral weight
-      double w = integral_pt()->weight(ipt);
-
-      /// Return local coordinate s[j] of i-th integration point.
-      unsigned j = 0;
-      s[j] = integral_pt()->knot(ipt, j);
+      double w = integration_weight(ipt);
 
-
-      // Get position vector to and non-unit tangent vector on wall:
-      // dr/ds
-      // NOTE: This is before we apply the rigid body motion!
-      // so in terms of the write-up the position vector is R_0
-      Vector<double> R_0(2);
-      Vector<double> drds(2);
-      get_non_unit_tangent(s, R_0, drds);
+      // Get position vector and non-unit tangent vector
+      get_non_unit_tangent_at_knot(ipt, R_0, drds);
 
       // Jacobian. Since Jacobian is the same for R, still use it here.
       double J = sqrt(drds[0] * drds[0] + drds[1] * drds[1]);
@@ -658,23 +1296,22 @@ public:
       // Premultiply the weights and the Jacobian
       double W = w * J;
 
-      // Compute the slender body traction on actual beam; note this is
-      // inefficient since we've already computed certain quantities that will
-      // be needed in this function
-      Vector<double> traction(2);
-      compute_slender_body_traction_on_actual_beam(s, traction);
+      // Unit normal (as in get_normal(...))
+      N_0[0] = -drds[1] / J;
+      N_0[1] = drds[0] / J;
+
+      // Compute the slender body traction on actual beam, re-using the
+      // quantities we've already computed
+      slender_body_traction(R_0, N_0, V, U0, Theta_eq, X0, Y0, traction);
 
       // Compute R (after translation and rotation)
-      Vector<double> R(2);
-      R[0] = cos(Theta_eq + theta_initial()) * R_0[0] -
-             sin(Theta_eq + theta_initial()) * R_0[1] + 0.5 * V * t * t +
-             U0 * t + X0;
-      R[1] = sin(Theta_eq + theta_initial()) * R_0[0] +
-             cos(Theta_eq + theta_initial()) * R_0[1] + V * t + Y0;
+      double R_x = cos_theta * R_0[0] - sin_theta * R_0[1] +
+                   0.5 * V * t * t + U0 * t + X0;
+      double R_y = sin_theta * R_0[0] + cos_theta * R_0[1] + V * t + Y0;
 
       // calculate the contribution to torque
-      double local_torque = (R[0] - sum_r_centre[0]) * traction[1] -
-                            (R[1] - sum_r_centre[1]) * traction[0];
+      double local_torque = (R_x - sum_r_centre[0]) * traction[1] -
+                            (R_y - sum_r_centre[1]) * traction[0];
 
       // Add 'em
       drag[0] += traction[0] * W;
@@ -684,157 +1321,470 @@ public:
   }
 
 
+  /// Store the position vector R_0 and unit normal N_0 (before the
+  /// rigid body motion is applied) and the integration weight
+  /// premultiplied by the Jacobian at the element's integration points
+  /// in the batch, starting at entry offset
+  void get_slender_body_integration_point_data(
+    SlenderBodyTractionBatch& batch, const unsigned& offset)
+  {
+    // Use the compile-time specialised version?
+    switch (Fixed_quadrature_order)
+    {
+      case 2:
+        fixed_order_slender_body_integration_point_data<2>(batch, offset);
+        return;
+
+      case 3:
+        fixed_order_slender_body_integration_point_data<3>(batch, offset);
+        return;
+
+      case 4:
+        fixed_order_slender_body_integration_point_data<4>(batch, offset);
+        return;
+    }
+
+    // Set # of integration points
+    const unsigned n_intpt = integral_pt()->nweight();
+
+    FixedSizeVector<double, 2> R_0;
+    FixedSizeVector<double, 2> drds;
+    for (unsigned ipt = 0; ipt < n_intpt; ipt++)
+    {
+      // Get position vector and non-unit tangent vector
+      get_non_unit_tangent_at_knot(ipt, R_0, drds);
+
+      // Jacobian of mapping between local and global coordinates
+      double J = sqrt(drds[0] * drds[0] + drds[1] * drds[1]);
+
+      unsigned i = offset + ipt;
+      batch.R_0_x[i] = R_0[0];
+      batch.R_0_y[i] = R_0[1];
+      batch.N_0_x[i] = -drds[1] / J;
+      batch.N_0_y[i] = drds[0] / J;
+      batch.W[i] = integration_weight(ipt) * J;
+    }
+  }
+
+
   /// Overloaded output function
   void output(std::ostream& outfile, const unsigned& n_plot)
   {
-    // Local variables
-    Vector<double> s(1);
+    Vector<double> psi;
+    Vector<double> dpsids;
+    tabulate_plot_point_shape(n_plot, psi, dpsids);
+    SlenderBodyTractionBatch batch;
+    NumericOutputBuffer buffer(outfile);
+    output(buffer, n_plot, psi, dpsids, batch);
+  }
 
-    // Tecplot header info
-    outfile << "ZONE I=" << n_plot << std::endl;
 
-    // Set the number of lagrangian coordinates
-    unsigned n_lagrangian = Undeformed_beam_pt->nlagrangian();
+  /// Shape functions and their derivatives at n_plot equally spaced plot
+  /// points, ordered as psi(l,k) at plot point l1 -> psi[4*l1+2*l+k]
+  static void tabulate_plot_point_shape(const unsigned& n_plot,
+                                        Vector<double>& psi,
+                                        Vector<double>& dpsids)
+  {
+    psi.resize(4 * n_plot);
+    dpsids.resize(4 * n_plot);
+    for (unsigned l1 = 0; l1 < n_plot; l1++)
+    {
+      double s = -1.0 + l1 * 2.0 / (n_plot - 1);
+      hermite_shape(s, &psi[4 * l1], &dpsids[4 * l1]);
+    }
+  }
+
+
+  /// Get the data at n_plot equally spaced plot points, given the shape
+  /// functions tabulated by tabulate_plot_point_shape(...): Interpolates
+  /// the positions R_0 and normals N_0 (before the rigid body motion) at
+  /// all plot points, then computes the tractions on the actual beam and
+  /// in the reference configuration in one call to the batched kernel.
+  /// All of these are returned in the batch. The rigid body motion maps
+  /// R_0 to R = Q R_0 + shift and N_0 to N = Q N_0 where Q is the
+  /// rotation by the angle with the given cosine and sine.
+  void get_plot_point_data(const unsigned& n_plot,
+                           const Vector<double>& psi,
+                           const Vector<double>& dpsids,
+                           SlenderBodyTractionBatch& batch,
+                           double& cos_theta,
+                           double& sin_theta,
+                           double& shift_x,
+                           double& shift_y)
+  {
+    // Translate rigid body parameters into meaningful variables
+    double V = 0.0;
+    double U0 = 0.0;
+    double Theta_eq = 0.0;
+    double X0 = 0.0;
+    double Y0 = 0.0;
+    Rigid_body_element_pt->get_parameters(V, U0, Theta_eq, X0, Y0);
+    double omega = Rigid_body_element_pt->angular_velocity();
+
+    // Note that we're looking for an pseudo "equilibrium position"
+    // where the angle (and the traction!) remain constant while
+    // the beam still moves as a rigid body!
+    double t = 0.0;
+
+    // Rigid body motion
+    cos_theta = cos(Theta_eq + theta_initial());
+    sin_theta = sin(Theta_eq + theta_initial());
+    shift_x = 0.5 * V * t * t + U0 * t + X0;
+    shift_y = V * t + Y0;
+
+    // Get the position vector R_0 and the normal vector N_0 at all plot
+    // points
+    batch.resize(n_plot);
+    FixedSizeVector<double, 2> R_0;
+    FixedSizeVector<double, 2> drds;
+    for (unsigned l1 = 0; l1 < n_plot; l1++)
+    {
+      interpolate_position_and_tangent(
+        &psi[4 * l1], &dpsids[4 * l1], R_0, drds);
+      double length = sqrt(drds[0] * drds[0] + drds[1] * drds[1]);
+      batch.R_0_x[l1] = R_0[0];
+      batch.R_0_y[l1] = R_0[1];
+      batch.N_0_x[l1] = -drds[1] / length;
+      batch.N_0_y[l1] = drds[0] / length;
+    }
+
+    // Compute the slender body traction acting on the actual beam and on
+    // the beam in the reference configuration
+    SlenderBodyTractionKernel::evaluate(
+      batch, V, U0, Theta_eq + theta_initial(), X0, Y0, t, omega, 0);
+  }
 
-    // Set the dimension of the global coordinates
-    unsigned n_dim = Undeformed_beam_pt->ndim();
 
-    // Find out how many nodes there are
-    unsigned n_node = nnode();
+  /// Output at n_plot equally spaced plot points, given the shape
+  /// functions tabulated by tabulate_plot_point_shape(...) (batch is
+  /// workspace), formatted through the buffer. Per plot point: R_0, R
+  /// (after translation and rotation), N_0, N, the traction in the
+  /// reference configuration and on the actual beam, and the velocity of
+  /// the background flow.
+  void output(NumericOutputBuffer& buffer,
+              const unsigned& n_plot,
+              const Vector<double>& psi,
+              const Vector<double>& dpsids,
+              SlenderBodyTractionBatch& batch)
+  {
+    // Tecplot header info
+    buffer << "ZONE I=" << n_plot << '\n';
 
-    // Find out how many positional dofs there are
-    unsigned n_position_dofs = nnodal_position_type();
+    double cos_theta = 0.0;
+    double sin_theta = 0.0;
+    double shift_x = 0.0;
+    double shift_y = 0.0;
+    get_plot_point_data(
+      n_plot, psi, dpsids, batch, cos_theta, sin_theta, shift_x, shift_y);
 
-    Vector<double> R_0(n_dim);
+    for (unsigned l1 = 0; l1 < n_plot; l1++)
+    {
+      // Compute R and N after translation and rotation
+      double R_x =
+        cos_theta * batch.R_0_x[l1] - sin_theta * batch.R_0_y[l1] + shift_x;
+      double R_y =
+        sin_theta * batch.R_0_x[l1] + cos_theta * batch.R_0_y[l1] + shift_y;
+      double N_x = cos_theta * batch.N_0_x[l1] - sin_theta * batch.N_0_y[l1];
+      double N_y = sin_theta * batch.N_0_x[l1] + cos_theta * batch.N_0_y[l1];
+
+      // R_0 (clamped at the origin), R, N_0, N, traction in the reference
+      // configuration, traction on the actual beam and the velocity of the
+      // background
+      buffer << batch.R_0_x[l1] << ' ' << batch.R_0_y[l1] << ' ' << R_x << ' '
+             << R_y << ' ' << batch.N_0_x[l1] << ' ' << batch.N_0_y[l1] << ' '
+             << N_x << ' ' << N_y << ' ' << batch.Traction_0_x[l1] << ' '
+             << batch.Traction_0_y[l1] << ' ' << batch.Traction_x[l1] << ' '
+             << batch.Traction_y[l1] << ' ' << R_y << "  " << 0 << '\n';
+    }
+  }
 
-    // # of nodes, # of positional dofs
-    Shape psi(n_node, n_position_dofs);
 
-    // Loop over element plot points
+  /// Add the element's plot points to the VTU writer as a polyline, with
+  /// the same data as in the Tecplot output: the points are the actual
+  /// positions R and the point data are R_0, N_0, N, the tractions in the
+  /// reference configuration and on the actual beam, and the velocity of
+  /// the background flow. The shape functions at the plot points are
+  /// tabulated by tabulate_plot_point_shape(...); batch is workspace.
+  void output_vtu(VTUPolylineWriter& writer,
+                  const unsigned& n_plot,
+                  const Vector<double>& psi,
+                  const Vector<double>& dpsids,
+                  SlenderBodyTractionBatch& batch)
+  {
+    double cos_theta = 0.0;
+    double sin_theta = 0.0;
+    double shift_x = 0.0;
+    double shift_y = 0.0;
+    get_plot_point_data(
+      n_plot, psi, dpsids, batch, cos_theta, sin_theta, shift_x, shift_y);
+
+    unsigned r_0_index = writer.point_data_index("R_0", 3);
+    unsigned n_0_index = writer.point_data_index("N_0", 3);
+    unsigned n_index = writer.point_data_index("N", 3);
+    unsigned traction_0_index = writer.point_data_index("Traction_0", 3);
+    unsigned traction_index = writer.point_data_index("Traction", 3);
+    unsigned background_index =
+      writer.point_data_index("Background_velocity", 1);
+    writer.add_polyline(n_plot);
     for (unsigned l1 = 0; l1 < n_plot; l1++)
     {
-      s[0] = -1.0 + l1 * 2.0 / (n_plot - 1);
+      // Compute R and N after translation and rotation
+      double R_x =
+        cos_theta * batch.R_0_x[l1] - sin_theta * batch.R_0_y[l1] + shift_x;
+      double R_y =
+        sin_theta * batch.R_0_x[l1] + cos_theta * batch.R_0_y[l1] + shift_y;
+      double N_x = cos_theta * batch.N_0_x[l1] - sin_theta * batch.N_0_y[l1];
+      double N_y = sin_theta * batch.N_0_x[l1] + cos_theta * batch.N_0_y[l1];
+      writer.add_point(R_x, R_y);
+      writer.add_point_data(r_0_index, batch.R_0_x[l1], batch.R_0_y[l1]);
+      writer.add_point_data(n_0_index, batch.N_0_x[l1], batch.N_0_y[l1]);
+      writer.add_point_data(n_index, N_x, N_y);
+      writer.add_point_data(
+        traction_0_index, batch.Traction_0_x[l1], batch.Traction_0_y[l1]);
+      writer.add_point_data(
+        traction_index, batch.Traction_x[l1], batch.Traction_y[l1]);
+      writer.add_point_data(background_index, R_y);
+    }
+  }
+
+private:
+  /// Integration weight of integration point ipt (from the cache if
+  /// available)
+  double integration_weight(const unsigned& ipt)
+  {
+    if (Integration_point_cache_pt == 0)
+    {
+      return integral_pt()->weight(ipt);
+    }
+    return Integration_point_cache_pt->weight(ipt);
+  }
 
-      // Get shape functions
-      shape(s, psi);
 
-      Vector<double> interpolated_xi(n_lagrangian);
-      interpolated_xi[0] = 0.0;
+  /// One-dimensional Hermite shape functions and their derivatives
+  /// w.r.t. the local coordinate s, ordered as psi(l,k) -> psi[2*l+k]
+  /// (as in OneDimensionalHermite::shape(...) and dshape(...))
+  static void hermite_shape(const double& s, double psi[4], double dpsids[4])
+  {
+    for (unsigned j = 0; j < 4; j++)
+    {
+      psi[j] = OneDHermiteShape::psi(j, s);
+      dpsids[j] = OneDHermiteShape::dpsids(j, s);
+    }
+  }
+
 
-      // Loop over coordinate directions/components of Vector
-      for (unsigned i = 0; i < n_dim; i++)
+  /// Position vector R_0 and non-unit tangent vector (before the rigid
+  /// body motion is applied) at the integration points of the
+  /// NINTPT-point Gauss rule
+  template<unsigned NINTPT>
+  void fixed_order_position_and_tangent(double R_0[NINTPT][2],
+                                        double drds[NINTPT][2])
+  {
+    // Generalised nodal positions: x_gen[2*l+k][i]
+    double x_gen[4][2];
+    for (unsigned l = 0; l < 2; l++)
+    {
+      for (unsigned k = 0; k < 2; k++)
       {
-        // Initialise
-        R_0[i] = 0.0;
+        for (unsigned i = 0; i < 2; i++)
+        {
+          x_gen[2 * l + k][i] = nodal_position_gen(l, k, i);
+        }
       }
+    }
 
-      // Calculate positions
-      for (unsigned l = 0; l < n_node; l++)
+    for (unsigned ipt = 0; ipt < NINTPT; ipt++)
+    {
+      const double s = GaussLegendreTable<NINTPT>::knot(ipt);
+      for (unsigned i = 0; i < 2; i++)
       {
-        // Loop over positional dofs
-        for (unsigned k = 0; k < n_position_dofs; k++)
+        R_0[ipt][i] = 0.0;
+        drds[ipt][i] = 0.0;
+        for (unsigned j = 0; j < 4; j++)
         {
-          // Loop over Lagrangian coordinate directions [xi_gen[] are the
-          // the *gen*eralised Lagrangian coordinates: node, type, direction]
-          for (unsigned i = 0; i < n_lagrangian; i++)
-          {
-            interpolated_xi[i] +=
-              raw_lagrangian_position_gen(l, k, i) * psi(l, k);
-          }
-
-          // Loop over components of the deformed position Vector
-          for (unsigned i = 0; i < n_dim; i++)
-          {
-            R_0[i] += raw_dnodal_position_gen_dt(0, l, k, i) * psi(l, k);
-          }
+          R_0[ipt][i] += x_gen[j][i] * OneDHermiteShape::psi(j, s);
+          drds[ipt][i] += x_gen[j][i] * OneDHermiteShape::dpsids(j, s);
         }
       }
+    }
+  }
 
-      // Get the normal vector N0 at each plotted point
-      Vector<double> N_0(n_dim);
-      get_normal(s, N_0);
 
-      // Compute slender body traction acting on the actual beam
-      Vector<double> traction(n_dim);
-      compute_slender_body_traction_on_actual_beam(s, traction);
+  /// Compile-time specialised version of
+  /// compute_contribution_to_int_r_and_length(...) for the NINTPT-point
+  /// Gauss rule
+  template<unsigned NINTPT>
+  void fixed_order_contribution_to_int_r_and_length(
+    FixedSizeVector<double, 2>& int_r, double& length)
+  {
+    double R_0[NINTPT][2];
+    double drds[NINTPT][2];
+    fixed_order_position_and_tangent<NINTPT>(R_0, drds);
 
-      // Compute slender body traction acting on the beam in the reference
-      // configuration
-      Vector<double> traction_0(n_dim);
-      compute_slender_body_traction_on_beam_in_reference_configuration(
-        s, traction_0);
+    // Translate rigid body parameters into meaningful variables
+    double V = 0.0;
+    double U0 = 0.0;
+    double Theta_eq = 0.0;
+    double X0 = 0.0;
+    double Y0 = 0.0;
+    Rigid_body_element_pt->get_parameters(V, U0, Theta_eq, X0, Y0);
 
-      // Translate rigid body parameters into meaningful variables
-      double V = 0.0;
-      double U0 = 0.0;
-      double Theta_eq = 0.0;
-      double X0 = 0.0;
-      double Y0 = 0.0;
-      Rigid_body_element_pt->get_parameters(V, U0, Theta_eq, X0, Y0);
-
-      // Note that we're looking for an pseudo "equilibrium position"
-      // where the angle (and the traction!) remain constant while
-      // the beam still moves as a rigid body!
-      double t = 0.0;
-
-      // Compute R after translation and rotation
-      Vector<double> R(n_dim);
-      R[0] = cos(Theta_eq + theta_initial()) * R_0[0] -
-             sin(Theta_eq + theta_initial()) * R_0[1] + 0.5 * V * t * t +
-             U0 * t + X0;
-      R[1] = sin(Theta_eq + theta_initial()) * R_0[0] +
-             cos(Theta_eq + theta_initial()) * R_0[1] + V * t + Y0;
-
-      // Compute normal N after translation and rotation
-      Vector<double> N(n_dim);
-      N[0] = cos(Theta_eq + theta_initial()) * N_0[0] -
-             sin(Theta_eq + theta_initial()) * N_0[1];
-      N[1] = sin(Theta_eq + theta_initial()) * N_0[0] +
-             cos(Theta_eq + theta_initial()) * N_0[1];
-
-      // Output R0 which is clamped at the origin
-      for (unsigned i = 0; i < n_dim; i++)
-      {
-        outfile << R_0[i] << " ";
-      }
+    // Pseudo "equilibrium position"
+    double t = 0.0;
 
-      // Output R which is after translation and rotation
-      for (unsigned i = 0; i < n_dim; i++)
-      {
-        outfile << R[i] << " ";
-      }
+    const double cos_theta = cos(Theta_eq + theta_initial());
+    const double sin_theta = sin(Theta_eq + theta_initial());
 
-      // Output unit normal N0
-      for (unsigned i = 0; i < n_dim; i++)
-      {
-        outfile << N_0[i] << " ";
-      }
+    int_r[0] = 0.0;
+    int_r[1] = 0.0;
+    length = 0.0;
+    for (unsigned ipt = 0; ipt < NINTPT; ipt++)
+    {
+      double J = sqrt(drds[ipt][0] * drds[ipt][0] +
+                      drds[ipt][1] * drds[ipt][1]);
+      double W = GaussLegendreTable<NINTPT>::weight(ipt) * J;
+      double R_x = cos_theta * R_0[ipt][0] - sin_theta * R_0[ipt][1] +
+                   0.5 * V * t * t + U0 * t + X0;
+      double R_y =
+        sin_theta * R_0[ipt][0] + cos_theta * R_0[ipt][1] + V * t + Y0;
+      length += W;
+      int_r[0] += R_x * W;
+      int_r[1] += R_y * W;
+    }
+  }
 
-      // Output unit normal N which is after translation and rotation
-      for (unsigned i = 0; i < n_dim; i++)
-      {
-        outfile << N[i] << " ";
-      }
 
-      // Output traction acting on the beam in the reference configuration
-      for (unsigned i = 0; i < n_dim; i++)
-      {
-        outfile << traction_0[i] << " ";
-      }
+  /// Compile-time specialised version of
+  /// get_slender_body_integration_point_data(...) for the NINTPT-point
+  /// Gauss rule
+  template<unsigned NINTPT>
+  void fixed_order_slender_body_integration_point_data(
+    SlenderBodyTractionBatch& batch, const unsigned& offset)
+  {
+    double R_0[NINTPT][2];
+    double drds[NINTPT][2];
+    fixed_order_position_and_tangent<NINTPT>(R_0, drds);
+
+    for (unsigned ipt = 0; ipt < NINTPT; ipt++)
+    {
+      double J = sqrt(drds[ipt][0] * drds[ipt][0] +
+                      drds[ipt][1] * drds[ipt][1]);
+      unsigned i = offset + ipt;
+      batch.R_0_x[i] = R_0[ipt][0];
+      batch.R_0_y[i] = R_0[ipt][1];
+      batch.N_0_x[i] = -drds[ipt][1] / J;
+      batch.N_0_y[i] = drds[ipt][0] / J;
+      batch.W[i] = GaussLegendreTable<NINTPT>::weight(ipt) * J;
+    }
+  }
+
+
+  /// Interpolate position vector and non-unit tangent vector from the
+  /// nodal positions, given the shape functions and their derivatives
+  /// (ordered as psi(l,k) -> psi[2*l+k])
+  void interpolate_position_and_tangent(const double* psi,
+                                        const double* dpsids,
+                                        FixedSizeVector<double, 2>& r,
+                                        FixedSizeVector<double, 2>& drds)
+  {
+#ifdef PARANOID
+    if ((nnode() != 2) || (nnodal_position_type() != 2))
+    {
+      std::ostringstream error_message;
+      error_message << "Element should have 2 nodes with 2 position types, "
+                    << "not " << nnode() << " nodes with "
+                    << nnodal_position_type() << " position types"
+                    << std::endl;
 
-      // Output traction acting on the actual beam
-      for (unsigned i = 0; i < n_dim; i++)
+      throw OomphLibError(
+        error_message.str(), OOMPH_CURRENT_FUNCTION, OOMPH_EXCEPTION_LOCATION);
+    }
+#endif
+    for (unsigned i = 0; i < 2; i++)
+    {
+      r[i] = 0.0;
+      drds[i] = 0.0;
+    }
+    for (unsigned l = 0; l < 2; l++)
+    {
+      for (unsigned k = 0; k < 2; k++)
       {
-        outfile << traction[i] << " ";
+        unsigned j = 2 * l + k;
+        for (unsigned i = 0; i < 2; i++)
+        {
+          double x_gen = nodal_position_gen(l, k, i);
+          r[i] += x_gen * psi[j];
+          drds[i] += x_gen * dpsids[j];
+        }
       }
+    }
+  }
 
-      // Output the velocity of the background
-      outfile << R[1] << "  " << 0;
-      outfile << std::endl;
+
+  /// Get position vector to and non-unit tangent vector on the beam
+  /// (before the rigid body motion is applied) at integration point ipt.
+  /// Uses the cached shape functions if available.
+  void get_non_unit_tangent_at_knot(const unsigned& ipt,
+                                    FixedSizeVector<double, 2>& R_0,
+                                    FixedSizeVector<double, 2>& drds)
+  {
+    // No cache: Evaluate the shape functions from scratch
+    if (Integration_point_cache_pt == 0)
+    {
+      get_non_unit_tangent(integral_pt()->knot(ipt, 0), R_0, drds);
+      return;
     }
+
+    interpolate_position_and_tangent(
+      Integration_point_cache_pt->psi_at_knot(ipt),
+      Integration_point_cache_pt->dpsids_at_knot(ipt),
+      R_0,
+      drds);
+  }
+
+
+  /// Slender body traction acting on the actual beam at the point whose
+  /// position vector and unit normal before the rigid body motion are
+  /// R_0 and N_0, for the given rigid body parameters
+  void slender_body_traction(const FixedSizeVector<double, 2>& R_0,
+                             const FixedSizeVector<double, 2>& N_0,
+                             const double& V,
+                             const double& U0,
+                             const double& Theta_eq,
+                             const double& X0,
+                             const double& Y0,
+                             FixedSizeVector<double, 2>& traction) const
+  {
+    // Note that we're looking for an pseudo "equilibrium position"
+    // where the angle (and the traction!) remain constant while
+    // the beam still moves as a rigid body!
+    double t = 0.0;
+    double omega = Rigid_body_element_pt->angular_velocity();
+
+    // Use the batched kernel (for a single point) so all tractions are
+    // computed in exactly the same way
+    double traction_0_x = 0.0;
+    double traction_0_y = 0.0;
+    SlenderBodyTractionKernel::evaluate(1,
+                                        &R_0[0],
+                                        &R_0[1],
+                                        &N_0[0],
+                                        &N_0[1],
+                                        V,
+                                        U0,
+                                        Theta_eq + theta_initial(),
+                                        X0,
+                                        Y0,
+                                        t,
+                                        omega,
+                                        0,
+                                        &traction[0],
+                                        &traction[1],
+                                        &traction_0_x,
+                                        &traction_0_y,
+                                        0);
   }
 
-private:
   /// Pointer to element that controls the rigid body motion
   RigidBodyElement* Rigid_body_element_pt;
 
@@ -844,6 +1794,14 @@ private:
   /// Pointer to initial rotation of the element when it's in its (otherwise)
   /// undeformed configuration
   const double* Theta_initial_pt;
+
+  /// Pointer to the cached integration point data of the mesh (null if
+  /// not used)
+  BeamIntegrationPointCache* Integration_point_cache_pt;
+
+  /// Number of Gauss points for the compile-time specialised slender
+  /// body computations (0: use the generic implementation)
+  unsigned Fixed_quadrature_order;
 };
 
 
@@ -853,30 +1811,95 @@ private:
 
 
 //=============================================================================
-/// Compute the beam's centre of mass (defined outside class to avoid
-/// forward references)
+/// Output all elements of a mesh of HaoHermiteBeamElements at n_plot plot
+/// points each (same as Mesh::output(...) but the shape functions at the
+/// plot points are only tabulated once, the workspace is shared by all
+/// elements and the output is formatted through a single buffer)
+//=============================================================================
+void output_beam_mesh(Mesh* mesh_pt,
+                      std::ostream& outfile,
+                      const unsigned& n_plot)
+{
+  Vector<double> psi;
+  Vector<double> dpsids;
+  HaoHermiteBeamElement::tabulate_plot_point_shape(n_plot, psi, dpsids);
+  SlenderBodyTractionBatch batch;
+  NumericOutputBuffer buffer(outfile);
+  unsigned n_element = mesh_pt->nelement();
+  for (unsigned e = 0; e < n_element; e++)
+  {
+    dynamic_cast<HaoHermiteBeamElement*>(mesh_pt->element_pt(e))
+      ->output(buffer, n_plot, psi, dpsids, batch);
+  }
+}
+
+
+//=============================================================================
+/// Add all elements of a mesh of HaoHermiteBeamElements to the VTU writer
+/// (one polyline per element, with n_plot plot points each)
+//=============================================================================
+void add_beam_mesh_to_vtu(Mesh* mesh_pt,
+                          VTUPolylineWriter& writer,
+                          const unsigned& n_plot)
+{
+  Vector<double> psi;
+  Vector<double> dpsids;
+  HaoHermiteBeamElement::tabulate_plot_point_shape(n_plot, psi, dpsids);
+  SlenderBodyTractionBatch batch;
+  unsigned n_element = mesh_pt->nelement();
+  for (unsigned e = 0; e < n_element; e++)
+  {
+    dynamic_cast<HaoHermiteBeamElement*>(mesh_pt->element_pt(e))
+      ->output_vtu(writer, n_plot, psi, dpsids, batch);
+  }
+}
+
+
 //=============================================================================
-void RigidBodyElement::compute_centre_of_mass(Vector<double>& sum_r_centre)
+/// Add the state of the rigid bodies to the VTU writer as field data: one
+/// tuple (V, U0, Theta_eq, X0, Y0, Omega) per body
+//=============================================================================
+void add_rigid_body_state_to_vtu(
+  const Vector<RigidBodyElement*>& rigid_body_element_pt,
+  VTUPolylineWriter& writer)
 {
+  unsigned n_body = rigid_body_element_pt.size();
+  Vector<double> state(6 * n_body, 0.0);
+  for (unsigned b = 0; b < n_body; b++)
+  {
+    double* state_pt = &state[6 * b];
+    rigid_body_element_pt[b]->get_parameters(
+      state_pt[0], state_pt[1], state_pt[2], state_pt[3], state_pt[4]);
+    state_pt[5] = rigid_body_element_pt[b]->angular_velocity();
+  }
+  writer.add_field_data("Rigid_body_parameters", 6, state);
+}
 
- // hierher
- 
-// #ifdef PARANOID
-//   if (r_centre.size() != 2)
-//   {
-//     std::ostringstream error_message;
-//     error_message << "r_centre should have size 2, not " << r_centre.size()
-//                   << std::endl;
 
-//     throw OomphLibError(
-//       error_message.str(), OOMPH_CURRENT_FUNCTION, OOMPH_EXCEPTION_LOCATION);
-//   }
-// #endif
+//=============================================================================
+/// Encoding of the VTU output: base64 with --vtk_base64, raw otherwise
+//=============================================================================
+VTUPolylineWriter::Encoding vtu_encoding()
+{
+  if (CommandLineArgs::command_line_flag_has_been_set("--vtk_base64"))
+  {
+    return VTUPolylineWriter::Appended_base64;
+  }
+  return VTUPolylineWriter::Appended_raw;
+}
+
 
+//=============================================================================
+/// Compute the beam's centre of mass (defined outside class to avoid
+/// forward references)
+//=============================================================================
+void RigidBodyElement::compute_centre_of_mass(
+  FixedSizeVector<double, 2>& sum_r_centre)
+{
   // Initialise
   sum_r_centre[0] = 0.0;
   sum_r_centre[1] = 0.0;
-  Vector<double> int_r(2);
+  FixedSizeVector<double, 2> int_r;
   double length = 0.0;
 
   // Find number of beam meshes
@@ -886,7 +1909,7 @@ void RigidBodyElement::compute_centre_of_mass(Vector<double>& sum_r_centre)
   for (unsigned i = 0; i < npointer; i++)
   {
     // Initialise
-    Vector<double> total_int_r(2);
+    FixedSizeVector<double, 2> total_int_r(0.0);
     double total_length = 0.0;
 
     // Find number of elements in the mesh
@@ -912,7 +1935,7 @@ void RigidBodyElement::compute_centre_of_mass(Vector<double>& sum_r_centre)
 
     // Assemble the (\int r ds) and beam length to get the centre of mass for
     // one arm
-    Vector<double> r_centre(2);
+    FixedSizeVector<double, 2> r_centre;
     r_centre[0] = (1.0 / total_length) * total_int_r[0];
     r_centre[1] = (1.0 / total_length) * total_int_r[1];
 
@@ -927,684 +1950,3291 @@ void RigidBodyElement::compute_centre_of_mass(Vector<double>& sum_r_centre)
 /// Compute the drag and torque on the entire beam structure according to
 /// slender body theory (Type=0: first arm, Type=1: second arm.)
 //=============================================================================
-void RigidBodyElement::compute_drag_and_torque(Vector<double>& sum_total_drag,
-                                               double& sum_total_torque)
+void RigidBodyElement::compute_drag_and_torque(
+  FixedSizeVector<double, 2>& sum_total_drag, double& sum_total_torque)
 {
-
-// hierher
- 
-// #ifdef PARANOID
-//   if (total_drag.size() != 2)
-//   {
-//     std::ostringstream error_message;
-//     error_message << "total_drag should have size 2, not " << total_drag.size()
-//                   << std::endl;
-
-//     throw OomphLibError(
-//       error_message.str(), OOMPH_CURRENT_FUNCTION, OOMPH_EXCEPTION_LOCATION);
-//   }
-// #endif
-
   // Initialise
   sum_total_drag[0] = 0.0;
   sum_total_drag[1] = 0.0;
   sum_total_torque = 0.0;
 
-  Vector<double> drag(2);
-  double torque = 0.0;
+  // Compute the beam's positon of centre of mass
+  FixedSizeVector<double, 2> sum_r_centre;
+  compute_centre_of_mass(sum_r_centre);
+
+  // Translate rigid body parameters into meaningful variables
+  double V = 0.0;
+  double U0 = 0.0;
+  double Theta_eq = 0.0;
+  double X0 = 0.0;
+  double Y0 = 0.0;
+  get_parameters(V, U0, Theta_eq, X0, Y0);
+  double omega = angular_velocity();
+
+  // Note that we're looking for an pseudo "equilibrium position"
+  // where the angle (and the traction!) remain constant while
+  // the beam still moves as a rigid body! (In the time-dependent mode,
+  // X0, Y0 and Theta_eq describe the current position and orientation
+  // so t = 0 is the current instant.)
+  double t = 0.0;
 
   // Find number of beam meshes
   unsigned npointer = Beam_mesh_pt.size();
+  Traction_batch.resize(npointer);
 
   // Loop over the beam meshes to compute the drag and torque of the entire beam
   for (unsigned i = 0; i < npointer; i++)
   {
-    // Initialise
-    Vector<double> total_drag(2);
-    double total_torque = 0.0;
-
     // Find number of elements in the mesh
     unsigned n_element = Beam_mesh_pt[i]->nelement();
+    if (n_element == 0)
+    {
+      continue;
+    }
 
-    // Loop over the elements to compute the sum of elements' contribution to
-    // the drag and torque on the entire beam structure
+    // All elements in the mesh have the same number of integration points
+    // and initial rotation
+    HaoHermiteBeamElement* first_elem_pt =
+      dynamic_cast<HaoHermiteBeamElement*>(Beam_mesh_pt[i]->element_pt(0));
+    unsigned n_intpt = first_elem_pt->integral_pt()->nweight();
+
+    // Collect the data at the integration points of all elements
+    SlenderBodyTractionBatch& batch = Traction_batch[i];
+    batch.resize(n_element * n_intpt);
     for (unsigned e = 0; e < n_element; e++)
     {
       // Upcast to the specific element type
       HaoHermiteBeamElement* elem_pt =
         dynamic_cast<HaoHermiteBeamElement*>(Beam_mesh_pt[i]->element_pt(e));
 
-      // Compute contribution to the drag and torque within the e-th element
-      elem_pt->compute_contribution_to_drag_and_torque(drag, torque);
+#ifdef PARANOID
+      if (elem_pt->integral_pt()->nweight() != n_intpt)
+      {
+        std::ostringstream error_message;
+        error_message << "Element " << e << " has "
+                      << elem_pt->integral_pt()->nweight()
+                      << " integration points rather than " << n_intpt
+                      << std::endl;
+
+        throw OomphLibError(error_message.str(),
+                            OOMPH_CURRENT_FUNCTION,
+                            OOMPH_EXCEPTION_LOCATION);
+      }
+#endif
 
-      // Sum the elements' contribution to the drag and torque
-      total_drag[0] += drag[0];
-      total_drag[1] += drag[1];
-      total_torque += torque;
-    } // end of loop over elements
+      elem_pt->get_slender_body_integration_point_data(batch, e * n_intpt);
+    }
+
+    // Evaluate the traction and torque density at all integration points
+    // in one go and integrate them
+    double theta = Theta_eq + first_elem_pt->theta_initial();
+    SlenderBodyTractionKernel::evaluate(
+      batch, V, U0, theta, X0, Y0, t, omega, &sum_r_centre[0]);
+
+    // Add the nonlocal correction
+    if (Nonlocal_operator_pt != 0)
+    {
+      Nonlocal_operator_pt->add_correction(Nonlocal_first_arm + i,
+                                           theta,
+                                           0.5 * V * t * t + U0 * t + X0,
+                                           V * t + Y0,
+                                           &sum_r_centre[0],
+                                           batch);
+    }
+    double drag_x = 0.0;
+    double drag_y = 0.0;
+    double torque = 0.0;
+    SlenderBodyTractionKernel::integrate_drag_and_torque(
+      batch, drag_x, drag_y, torque);
 
     // Compute the drag and torque of the entire beam
-    sum_total_drag[0] = sum_total_drag[0] + total_drag[0];
-    sum_total_drag[1] = sum_total_drag[1] + total_drag[1];
-    sum_total_torque = sum_total_torque + total_torque;
+    sum_total_drag[0] = sum_total_drag[0] + drag_x;
+    sum_total_drag[1] = sum_total_drag[1] + drag_y;
+    sum_total_torque = sum_total_torque + torque;
   }
 }
 
 
-//======start_of_problem_class==========================================
-/// Beam problem object
-//======================================================================
-class ElasticBeamProblem : public Problem
+//=============================================================================
+/// Re-compute the velocity induced by the traction on all arms: Collect
+/// the local traction at the integration points of all arms and pass it
+/// to the nonlocal slender body operator
+//=============================================================================
+void RigidBodyElement::update_nonlocal_slender_body_traction()
 {
-public:
-  /// Constructor: The arguments are the number of elements and the parameter to
-  /// determine the length of the beam
-  ElasticBeamProblem(const unsigned& n_elem1, const unsigned& n_elem2);
+  if (Nonlocal_operator_pt == 0)
+  {
+    return;
+  }
 
-  /// Conduct a parameter study
-  void parameter_study();
+  Vector<double> theta;
+  Vector<double> shift_x;
+  Vector<double> shift_y;
+  Vector<Vector<const FiniteElement*>> element_pt;
+  get_nonlocal_slender_body_data(
+    Traction_batch, theta, shift_x, shift_y, element_pt);
+  Nonlocal_operator_pt->update(
+    Traction_batch, theta, shift_x, shift_y, element_pt);
+}
 
-  /// No actions need to be performed after a solve
-  void actions_after_newton_solve() {}
 
-  /// No actions need to be performed before a solve
-  void actions_before_newton_solve() {}
+//=============================================================================
+/// Get the data required by the nonlocal slender body operator for this
+/// body's arms (stored from entry Nonlocal_first_arm onwards)
+//=============================================================================
+void RigidBodyElement::get_nonlocal_slender_body_data(
+  Vector<SlenderBodyTractionBatch>& batch,
+  Vector<double>& theta,
+  Vector<double>& shift_x,
+  Vector<double>& shift_y,
+  Vector<Vector<const FiniteElement*>>& element_pt)
+{
+  // Translate rigid body parameters into meaningful variables
+  double V = 0.0;
+  double U0 = 0.0;
+  double Theta_eq = 0.0;
+  double X0 = 0.0;
+  double Y0 = 0.0;
+  get_parameters(V, U0, Theta_eq, X0, Y0);
+  double omega = angular_velocity();
+  double t = 0.0;
 
-  /// Dump problem data to allow for later restart
-  void dump_it(ofstream& dump_file)
+  unsigned npointer = Beam_mesh_pt.size();
+  unsigned n_arm = Nonlocal_first_arm + npointer;
+  if (batch.size() < n_arm)
   {
-    // Current value of the FSI parameter
-    dump_file << Global_Physical_Variables::I << " # FSI parameter"
-              << std::endl;
-
-    // hierher maybe add q and alpha but then issue warning
-    // if it differs from the one specified on the command line
-
-    // Dump the refinement pattern and the generic problem data
-    Problem::dump(dump_file);
+    batch.resize(n_arm);
   }
-
-  /// Read problem data for restart
-  void restart(ifstream& restart_file)
+  if (theta.size() < n_arm)
   {
-    // Read line up to termination sign
-    string input_string;
-    getline(restart_file, input_string, '#');
-
-    // Ignore rest of line
-    restart_file.ignore(80, '\n');
-
-    // Read in FSI parameter
-    Global_Physical_Variables::I = double(atof(input_string.c_str()));
+    theta.resize(n_arm, 0.0);
+  }
+  if (shift_x.size() < n_arm)
+  {
+    shift_x.resize(n_arm, 0.0);
+  }
+  if (shift_y.size() < n_arm)
+  {
+    shift_y.resize(n_arm, 0.0);
+  }
+  if (element_pt.size() < n_arm)
+  {
+    element_pt.resize(n_arm);
+  }
+  for (unsigned i = 0; i < npointer; i++)
+  {
+    unsigned arm = Nonlocal_first_arm + i;
+    SlenderBodyTractionBatch& arm_batch = batch[arm];
+    element_pt[arm].clear();
+    shift_x[arm] = 0.5 * V * t * t + U0 * t + X0;
+    shift_y[arm] = V * t + Y0;
+    unsigned n_element = Beam_mesh_pt[i]->nelement();
+    if (n_element == 0)
+    {
+      arm_batch.resize(0);
+      theta[arm] = 0.0;
+      continue;
+    }
+    HaoHermiteBeamElement* first_elem_pt =
+      dynamic_cast<HaoHermiteBeamElement*>(Beam_mesh_pt[i]->element_pt(0));
+    unsigned n_intpt = first_elem_pt->integral_pt()->nweight();
+    arm_batch.resize(n_element * n_intpt);
+    for (unsigned e = 0; e < n_element; e++)
+    {
+      HaoHermiteBeamElement* elem_pt =
+        dynamic_cast<HaoHermiteBeamElement*>(Beam_mesh_pt[i]->element_pt(e));
+      elem_pt->get_slender_body_integration_point_data(arm_batch,
+                                                       e * n_intpt);
+      element_pt[arm].push_back(elem_pt);
+    }
 
-    // Refine the mesh and read in the generic problem data
-    Problem::read(restart_file);
+    // Local traction
+    theta[arm] = Theta_eq + first_elem_pt->theta_initial();
+    SlenderBodyTractionKernel::evaluate(
+      arm_batch, V, U0, theta[arm], X0, Y0, t, omega, 0);
   }
+}
 
-private:
-  /// Pointer to geometric object that represents the beam's undeformed shape
-  GeomObject* Undef_beam_pt1;
 
-  GeomObject* Undef_beam_pt2;
+//=============================================================================
+/// Compute the drag and torque on the entire beam structure, templated on
+/// the scalar type. Same as compute_centre_of_mass(...) followed by
+/// compute_drag_and_torque(...) but with the rigid body parameters and the
+/// beam nodes' generalised positions taken from the arguments.
+//=============================================================================
+template<class SCALAR>
+void RigidBodyElement::compute_drag_and_torque_generic(
+  const Vector<SCALAR>& parameter,
+  const Vector<Vector<SCALAR>>& external_value,
+  SCALAR sum_total_drag[2],
+  SCALAR& sum_total_torque)
+{
+  using std::cos;
+  using std::sin;
+  using std::sqrt;
+
+  // Translate rigid body parameters into meaningful variables
+  const SCALAR& V = parameter[0];
+  const SCALAR& U0 = parameter[1];
+  const SCALAR& Theta_eq = parameter[2];
+  const SCALAR& X0 = parameter[3];
+  const SCALAR& Y0 = parameter[4];
+  const SCALAR& Omega = parameter[5];
+
+  // Pseudo "equilibrium position" (or current position in the
+  // time-dependent mode)
+  const double t = 0.0;
+  const SCALAR shift_x = 0.5 * V * t * t + U0 * t + X0;
+  const SCALAR shift_y = V * t + Y0;
+  const SCALAR vt_plus_u0 = V * t + U0;
+
+  // Position vector, unit normal (before the rigid body motion is
+  // applied) and premultiplied integration weight at all integration
+  // points of all arms
+  Vector<SCALAR> r0_x;
+  Vector<SCALAR> r0_y;
+  Vector<SCALAR> n0_x;
+  Vector<SCALAR> n0_y;
+  Vector<SCALAR> W;
+
+  // First integration point and cos/sin of the angle of rotation of
+  // each arm
+  unsigned npointer = Beam_mesh_pt.size();
+  Vector<unsigned> first_point(npointer + 1, 0);
+  Vector<SCALAR> cos_theta(npointer);
+  Vector<SCALAR> sin_theta(npointer);
 
-  /// Pointer to RigidBodyElement that actually contains the rigid body data
-  RigidBodyElement* Rigid_body_element_pt;
+  // Centre of mass of the entire beam
+  SCALAR sum_r_centre[2] = {0.0, 0.0};
+  for (unsigned i = 0; i < npointer; i++)
+  {
+    first_point[i + 1] = first_point[i];
+    unsigned n_element = Beam_mesh_pt[i]->nelement();
+    if (n_element == 0)
+    {
+      continue;
+    }
+    HaoHermiteBeamElement* first_elem_pt =
+      dynamic_cast<HaoHermiteBeamElement*>(Beam_mesh_pt[i]->element_pt(0));
+    cos_theta[i] = cos(Theta_eq + first_elem_pt->theta_initial());
+    sin_theta[i] = sin(Theta_eq + first_elem_pt->theta_initial());
 
-  /// Pointer to beam mesh (first arm)
-  OneDLagrangianMesh<HaoHermiteBeamElement>* Beam_mesh_first_arm_pt;
+    SCALAR total_int_r[2] = {0.0, 0.0};
+    SCALAR total_length = 0.0;
+    for (unsigned e = 0; e < n_element; e++)
+    {
+      HaoHermiteBeamElement* elem_pt =
+        dynamic_cast<HaoHermiteBeamElement*>(Beam_mesh_pt[i]->element_pt(e));
 
-  /// Pointer to beam mesh (second arm)
-  OneDLagrangianMesh<HaoHermiteBeamElement>* Beam_mesh_second_arm_pt;
+      // Generalised nodal positions: x_gen[2*l+k][d]
+      const SCALAR* x_gen[4][2];
+      for (unsigned l = 0; l < 2; l++)
+      {
+        const Vector<SCALAR>& value =
+          external_value[Node_external_data_index[elem_pt->node_pt(l)]];
+        for (unsigned k = 0; k < 2; k++)
+        {
+          for (unsigned d = 0; d < 2; d++)
+          {
+            x_gen[2 * l + k][d] = &value[Position_value_index[k][d]];
+          }
+        }
+      }
 
-  /// Pointer to mesh containing the rigid body element
-  Mesh* Rigid_body_element_mesh_pt;
+      unsigned n_intpt = elem_pt->integral_pt()->nweight();
+      for (unsigned ipt = 0; ipt < n_intpt; ipt++)
+      {
+        double s = elem_pt->integral_pt()->knot(ipt, 0);
+        double w = elem_pt->integral_pt()->weight(ipt);
 
-}; // end of problem class
+        // Position vector and non-unit tangent vector
+        SCALAR R_0[2] = {0.0, 0.0};
+        SCALAR drds[2] = {0.0, 0.0};
+        for (unsigned j = 0; j < 4; j++)
+        {
+          double psi = OneDHermiteShape::psi(j, s);
+          double dpsids = OneDHermiteShape::dpsids(j, s);
+          for (unsigned d = 0; d < 2; d++)
+          {
+            R_0[d] += *x_gen[j][d] * psi;
+            drds[d] += *x_gen[j][d] * dpsids;
+          }
+        }
 
+        // Jacobian of mapping between local and global coordinates
+        SCALAR J = sqrt(drds[0] * drds[0] + drds[1] * drds[1]);
+        r0_x.push_back(R_0[0]);
+        r0_y.push_back(R_0[1]);
+        n0_x.push_back(-drds[1] / J);
+        n0_y.push_back(drds[0] / J);
+        W.push_back(w * J);
+
+        // Rigid body motion
+        SCALAR R_x = cos_theta[i] * R_0[0] - sin_theta[i] * R_0[1] + shift_x;
+        SCALAR R_y = sin_theta[i] * R_0[0] + cos_theta[i] * R_0[1] + shift_y;
+        total_length += w * J;
+        total_int_r[0] += R_x * w * J;
+        total_int_r[1] += R_y * w * J;
+      }
+    }
+    first_point[i + 1] = W.size();
+    sum_r_centre[0] += total_int_r[0] / total_length;
+    sum_r_centre[1] += total_int_r[1] / total_length;
+  }
 
-/////////////////////////////////////////////////////////////////////
-/////////////////////////////////////////////////////////////////////
-/////////////////////////////////////////////////////////////////////
+  // Drag and torque
+  sum_total_drag[0] = 0.0;
+  sum_total_drag[1] = 0.0;
+  sum_total_torque = 0.0;
+  for (unsigned i = 0; i < npointer; i++)
+  {
+    for (unsigned p = first_point[i]; p < first_point[i + 1]; p++)
+    {
+      SCALAR rx, ry, traction_x, traction_y;
+      SlenderBodyTractionKernel::evaluate_point(r0_x[p],
+                                                r0_y[p],
+                                                n0_x[p],
+                                                n0_y[p],
+                                                cos_theta[i],
+                                                sin_theta[i],
+                                                shift_x,
+                                                shift_y,
+                                                V,
+                                                vt_plus_u0,
+                                                Omega,
+                                                rx,
+                                                ry,
+                                                traction_x,
+                                                traction_y);
+      sum_total_drag[0] += W[p] * traction_x;
+      sum_total_drag[1] += W[p] * traction_y;
+      sum_total_torque += W[p] * ((rx - sum_r_centre[0]) * traction_y -
+                                  (ry - sum_r_centre[1]) * traction_x);
+    }
+  }
+}
 
 
-//=========================================================================
-/// Steady, straight 1D line in 2D space
-///  \f[ x = 0.0 \f]
-///  \f[ y = \zeta \f]
-//=========================================================================
-class StraightLineVertical : public GeomObject
+//=============================================================================
+/// Add the derivatives of the drag and torque (the residuals associated
+/// with V, U0 and Theta_eq) w.r.t. all unknowns to the Jacobian. The
+/// unknowns are seeded N_dual_derivative at a time, so the Jacobian is
+/// assembled in (# of unknowns)/N_dual_derivative passes, each of which
+/// provides the exact derivatives w.r.t. N_dual_derivative unknowns.
+//=============================================================================
+void RigidBodyElement::fill_in_jacobian_by_automatic_differentiation(
+  DenseMatrix<double>& jacobian)
 {
-public:
-  /// Constructor derives from GeomObject(1, 2)
-  StraightLineVertical() : GeomObject(1, 2) {}
-
-  /// Broken copy constructor
-  StraightLineVertical(const StraightLineVertical& dummy) = delete;
+  typedef DualNumber<N_dual_derivative> dual_t;
 
-  /// Broken assignment operator
-  void operator=(const StraightLineVertical&) = delete;
-
-  /// Position Vector at Lagrangian coordinate zeta
-  void position(const Vector<double>& zeta, Vector<double>& r) const
+  // Rigid body parameters and external values as constants
+  unsigned n_internal = ninternal_data();
+  Vector<dual_t> parameter(n_internal);
+  for (unsigned i = 0; i < n_internal; i++)
   {
-    r[0] = 0.0;
-    r[1] = zeta[0];
+    parameter[i] = internal_data_pt(i)->value(0);
   }
-
-
-  /// Derivative of position Vector w.r.t. to coordinates:
-  /// \f$ \frac{dR_i}{d \zeta_\alpha}\f$ = drdzeta(alpha,i).
-  /// Evaluated at current time.
-  virtual void dposition(const Vector<double>& zeta,
-                         DenseMatrix<double>& drdzeta) const
+  unsigned n_external = nexternal_data();
+  Vector<Vector<dual_t>> external_value(n_external);
+  for (unsigned j = 0; j < n_external; j++)
   {
-    // Tangent vector
-    drdzeta(0, 0) = 0.0;
-    drdzeta(0, 1) = 1.0;
+    unsigned n_value = external_data_pt(j)->nvalue();
+    external_value[j].resize(n_value);
+    for (unsigned v = 0; v < n_value; v++)
+    {
+      external_value[j][v] = external_data_pt(j)->value(v);
+    }
   }
 
-
-  /// 2nd derivative of position Vector w.r.t. to coordinates:
-  /// \f$ \frac{d^2R_i}{d \zeta_\alpha d \zeta_\beta}\f$ =
-  /// ddrdzeta(alpha,beta,i). Evaluated at current time.
-  virtual void d2position(const Vector<double>& zeta,
-                          RankThreeTensor<double>& ddrdzeta) const
+  // Collect the unknowns: pointer to the corresponding dual number and
+  // local equation number
+  Vector<dual_t*> unknown_pt;
+  Vector<int> unknown_local_eqn;
+  for (unsigned i = 0; i < n_internal; i++)
   {
-    // Derivative of tangent vector
-    ddrdzeta(0, 0, 0) = 0.0;
-    ddrdzeta(0, 0, 1) = 0.0;
+    int local_unknown = internal_local_eqn(i, 0);
+    if (local_unknown >= 0)
+    {
+      unknown_pt.push_back(&parameter[i]);
+      unknown_local_eqn.push_back(local_unknown);
+    }
+  }
+  for (unsigned j = 0; j < n_external; j++)
+  {
+    unsigned n_value = external_value[j].size();
+    for (unsigned v = 0; v < n_value; v++)
+    {
+      int local_unknown = external_local_eqn(j, v);
+      if (local_unknown >= 0)
+      {
+        unknown_pt.push_back(&external_value[j][v]);
+        unknown_local_eqn.push_back(local_unknown);
+      }
+    }
   }
 
+  // Local equation numbers of the residuals (drag x, drag y, torque)
+  int local_eqn[3];
+  get_drag_and_torque_local_eqn(local_eqn);
 
-  /// Posn Vector and its  1st & 2nd derivatives
-  /// w.r.t. to coordinates:
-  /// \f$ \frac{dR_i}{d \zeta_\alpha}\f$ = drdzeta(alpha,i).
-  /// \f$ \frac{d^2R_i}{d \zeta_\alpha d \zeta_\beta}\f$ =
-  /// ddrdzeta(alpha,beta,i).
-  /// Evaluated at current time.
-  virtual void d2position(const Vector<double>& zeta,
-                          Vector<double>& r,
-                          DenseMatrix<double>& drdzeta,
-                          RankThreeTensor<double>& ddrdzeta) const
+  // Loop over the groups of unknowns
+  unsigned n_unknown = unknown_pt.size();
+  for (unsigned first = 0; first < n_unknown; first += N_dual_derivative)
   {
-    // Position Vector
-    r[0] = 0.0;
-    r[1] = zeta[0];
+    unsigned n_seed = n_unknown - first;
+    if (n_seed > N_dual_derivative)
+    {
+      n_seed = N_dual_derivative;
+    }
 
-    // Tangent vector
-    drdzeta(0, 0) = 0.0;
-    drdzeta(0, 1) = 1.0;
+    // Seed
+    for (unsigned d = 0; d < n_seed; d++)
+    {
+      dual_t& x = *unknown_pt[first + d];
+      x = dual_t(x.value(), d);
+    }
 
-    // Derivative of tangent vector
-    ddrdzeta(0, 0, 0) = 0.0;
-    ddrdzeta(0, 0, 1) = 0.0;
+    dual_t drag[2];
+    dual_t torque;
+    compute_drag_and_torque_generic(parameter, external_value, drag, torque);
+    const dual_t* residual[3] = {&drag[0], &drag[1], &torque};
+
+    for (unsigned i = 0; i < 3; i++)
+    {
+      if (local_eqn[i] >= 0)
+      {
+        for (unsigned d = 0; d < n_seed; d++)
+        {
+          jacobian(local_eqn[i], unknown_local_eqn[first + d]) +=
+            residual[i]->derivative(d);
+        }
+      }
+    }
+
+    // Unseed
+    for (unsigned d = 0; d < n_seed; d++)
+    {
+      dual_t& x = *unknown_pt[first + d];
+      x = dual_t(x.value());
+    }
   }
-};
+}
 
-//=========================================================================
-/// Steady, straight 1D line in 2D space with stretch_ratio
-///  \f[ x = 0.0 \f]
-///  \f[ y = \zeta*stretch_ratio  \f]
-//=========================================================================
-class NewStraightLineVertical : public GeomObject
+//=============================================================================
+/// Compute the contribution of the element to the drag and torque (about
+/// the origin) for the given rigid body motion, and the integral of R_0
+/// and the length that determine its contribution to the centre of mass.
+//=============================================================================
+void RigidBodyElement::compute_element_contribution(
+  HaoHermiteBeamElement* elem_pt,
+  const double& V,
+  const double& U0,
+  const double& theta,
+  const double& X0,
+  const double& Y0,
+  const double& omega,
+  ElementContribution& contribution)
 {
-public:
-  /// Constructor derives from GeomObject(1, 2)
-  /// Pass stretch_ratio to this class
-  NewStraightLineVertical(const double& stretch_ratio) : GeomObject(1, 2)
+  // Position vector, unit normal and weight at the integration points
+  SlenderBodyTractionBatch& batch = Element_traction_batch;
+  unsigned n_intpt = elem_pt->integral_pt()->nweight();
+  batch.resize(n_intpt);
+  elem_pt->get_slender_body_integration_point_data(batch, 0);
+
+  // Drag and torque about the origin
+  double t = 0.0;
+  double origin[2] = {0.0, 0.0};
+  SlenderBodyTractionKernel::evaluate(
+    batch, V, U0, theta, X0, Y0, t, omega, origin);
+  SlenderBodyTractionKernel::integrate_drag_and_torque(
+    batch,
+    contribution.Drag[0],
+    contribution.Drag[1],
+    contribution.Torque_about_origin);
+
+  // Contribution to the centre of mass
+  contribution.Int_r_0[0] = 0.0;
+  contribution.Int_r_0[1] = 0.0;
+  contribution.Length = 0.0;
+  for (unsigned ipt = 0; ipt < n_intpt; ipt++)
   {
-    Stretch_ratio = stretch_ratio;
+    contribution.Int_r_0[0] += batch.W[ipt] * batch.R_0_x[ipt];
+    contribution.Int_r_0[1] += batch.W[ipt] * batch.R_0_y[ipt];
+    contribution.Length += batch.W[ipt];
   }
+}
 
-  /// Broken copy constructor
-  NewStraightLineVertical(const NewStraightLineVertical& dummy) = delete;
 
-  /// Broken assignment operator
-  void operator=(const NewStraightLineVertical&) = delete;
+//=============================================================================
+/// Add the derivatives of the drag and torque (the residuals associated
+/// with V, U0 and Theta_eq) w.r.t. all unknowns to the Jacobian, using
+/// finite differences.
+///
+/// The total torque about the centre of mass c is T = T_0 - c x D where
+/// T_0 is the torque about the origin and D the drag; D and T_0 are sums of
+/// element contributions, and so are the integrals of R_0 and the lengths
+/// of the arms that determine c. Perturbing a nodal position only changes
+/// the contributions of the (one or two) adjacent elements, so the
+/// changes in D, T_0 and c (and hence T) are accumulated from the changes
+/// in these contributions: Each column costs O(1) element evaluations
+/// rather than a sweep over the entire beam. The derivatives w.r.t. the
+/// rigid body parameters (which affect all elements) are obtained from
+/// complete re-evaluations of the drag and torque.
+//=============================================================================
+void RigidBodyElement::fill_in_jacobian_by_incremental_finite_differences(
+  DenseMatrix<double>& jacobian)
+{
+  const double fd_step = GeneralisedElement::Default_fd_jacobian_step;
 
-  /// Position Vector at Lagrangian coordinate zeta
-  void position(const Vector<double>& zeta, Vector<double>& r) const
+  // Local equation numbers of the residuals (drag x, drag y, torque)
+  int local_eqn[3];
+  get_drag_and_torque_local_eqn(local_eqn);
+
+  // Derivatives w.r.t. the rigid body parameters: Complete re-evaluation
+  //---------------------------------------------------------------------
+  FixedSizeVector<double, 2> drag;
+  double torque = 0.0;
+  compute_drag_and_torque(drag, torque);
+  unsigned n_internal = ninternal_data();
+  for (unsigned j = 0; j < n_internal; j++)
   {
-    r[0] = 0.0;
-    r[1] = zeta[0] * Stretch_ratio;
+    int local_unknown = internal_local_eqn(j, 0);
+    if (local_unknown < 0)
+    {
+      continue;
+    }
+    double* value_pt = internal_data_pt(j)->value_pt(0);
+    double backup = *value_pt;
+    *value_pt += fd_step;
+    FixedSizeVector<double, 2> new_drag;
+    double new_torque = 0.0;
+    compute_drag_and_torque(new_drag, new_torque);
+    *value_pt = backup;
+    double new_residual[3] = {new_drag[0], new_drag[1], new_torque};
+    double residual[3] = {drag[0], drag[1], torque};
+    for (unsigned i = 0; i < 3; i++)
+    {
+      if (local_eqn[i] >= 0)
+      {
+        jacobian(local_eqn[i], local_unknown) +=
+          (new_residual[i] - residual[i]) / fd_step;
+      }
+    }
   }
 
-
-  /// Derivative of position Vector w.r.t. to coordinates:
-  /// \f$ \frac{dR_i}{d \zeta_\alpha}\f$ = drdzeta(alpha,i).
-  /// Evaluated at current time.
+  // Derivatives w.r.t. the nodal positions: Incremental updates
+  //------------------------------------------------------------
+  double V = 0.0;
+  double U0 = 0.0;
+  double Theta_eq = 0.0;
+  double X0 = 0.0;
+  double Y0 = 0.0;
+  get_parameters(V, U0, Theta_eq, X0, Y0);
+  double omega = angular_velocity();
+
+  // Element contributions and their sums over each arm at the current
+  // state
+  unsigned n_arm = Beam_mesh_pt.size();
+  Vector<Vector<ElementContribution>> contribution(n_arm);
+  Vector<ElementContribution> arm_sum(n_arm);
+  Vector<double> theta(n_arm, 0.0);
+  for (unsigned a = 0; a < n_arm; a++)
+  {
+    ElementContribution& sum = arm_sum[a];
+    sum.Drag[0] = sum.Drag[1] = 0.0;
+    sum.Torque_about_origin = 0.0;
+    sum.Int_r_0[0] = sum.Int_r_0[1] = 0.0;
+    sum.Length = 0.0;
+    unsigned n_element = Beam_mesh_pt[a]->nelement();
+    if (n_element == 0)
+    {
+      continue;
+    }
+    HaoHermiteBeamElement* first_elem_pt =
+      dynamic_cast<HaoHermiteBeamElement*>(Beam_mesh_pt[a]->element_pt(0));
+    theta[a] = Theta_eq + first_elem_pt->theta_initial();
+    contribution[a].resize(n_element);
+    for (unsigned e = 0; e < n_element; e++)
+    {
+      HaoHermiteBeamElement* elem_pt =
+        dynamic_cast<HaoHermiteBeamElement*>(Beam_mesh_pt[a]->element_pt(e));
+      ElementContribution& c = contribution[a][e];
+      compute_element_contribution(
+        elem_pt, V, U0, theta[a], X0, Y0, omega, c);
+      sum.Drag[0] += c.Drag[0];
+      sum.Drag[1] += c.Drag[1];
+      sum.Torque_about_origin += c.Torque_about_origin;
+      sum.Int_r_0[0] += c.Int_r_0[0];
+      sum.Int_r_0[1] += c.Int_r_0[1];
+      sum.Length += c.Length;
+    }
+  }
+
+  // Total drag and centre of mass
+  double total_drag[2] = {0.0, 0.0};
+  double r_centre[2] = {0.0, 0.0};
+  for (unsigned a = 0; a < n_arm; a++)
+  {
+    if (arm_sum[a].Length == 0.0)
+    {
+      continue;
+    }
+    total_drag[0] += arm_sum[a].Drag[0];
+    total_drag[1] += arm_sum[a].Drag[1];
+    double cos_theta = cos(theta[a]);
+    double sin_theta = sin(theta[a]);
+    double r0_x = arm_sum[a].Int_r_0[0] / arm_sum[a].Length;
+    double r0_y = arm_sum[a].Int_r_0[1] / arm_sum[a].Length;
+    r_centre[0] += cos_theta * r0_x - sin_theta * r0_y + X0;
+    r_centre[1] += sin_theta * r0_x + cos_theta * r0_y + Y0;
+  }
+
+  // Loop over the nodal positions
+  unsigned n_external = nexternal_data();
+  Vector<ElementContribution> delta(n_arm);
+  ElementContribution new_contribution;
+  for (unsigned j = 0; j < n_external; j++)
+  {
+    unsigned n_value = external_data_pt(j)->nvalue();
+    for (unsigned v = 0; v < n_value; v++)
+    {
+      int local_unknown = external_local_eqn(j, v);
+      if (local_unknown < 0)
+      {
+        continue;
+      }
+
+      // Perturb and accumulate the changes in the contributions of the
+      // adjacent elements
+      for (unsigned a = 0; a < n_arm; a++)
+      {
+        delta[a].Drag[0] = delta[a].Drag[1] = 0.0;
+        delta[a].Torque_about_origin = 0.0;
+        delta[a].Int_r_0[0] = delta[a].Int_r_0[1] = 0.0;
+        delta[a].Length = 0.0;
+      }
+      double* value_pt = external_data_pt(j)->value_pt(v);
+      double backup = *value_pt;
+      *value_pt += fd_step;
+      unsigned n_adjacent = Adjacent_element[j].size();
+      for (unsigned k = 0; k < n_adjacent; k++)
+      {
+        unsigned a = Adjacent_element[j][k].first;
+        unsigned e = Adjacent_element[j][k].second;
+        HaoHermiteBeamElement* elem_pt =
+          dynamic_cast<HaoHermiteBeamElement*>(Beam_mesh_pt[a]->element_pt(e));
+        compute_element_contribution(
+          elem_pt, V, U0, theta[a], X0, Y0, omega, new_contribution);
+        const ElementContribution& c = contribution[a][e];
+        delta[a].Drag[0] += new_contribution.Drag[0] - c.Drag[0];
+        delta[a].Drag[1] += new_contribution.Drag[1] - c.Drag[1];
+        delta[a].Torque_about_origin +=
+          new_contribution.Torque_about_origin - c.Torque_about_origin;
+        delta[a].Int_r_0[0] += new_contribution.Int_r_0[0] - c.Int_r_0[0];
+        delta[a].Int_r_0[1] += new_contribution.Int_r_0[1] - c.Int_r_0[1];
+        delta[a].Length += new_contribution.Length - c.Length;
+      }
+      *value_pt = backup;
+
+      // Changes in the drag, the torque about the origin and the centre
+      // of mass
+      double delta_drag[2] = {0.0, 0.0};
+      double delta_torque_about_origin = 0.0;
+      double delta_r_centre[2] = {0.0, 0.0};
+      for (unsigned a = 0; a < n_arm; a++)
+      {
+        if (arm_sum[a].Length == 0.0)
+        {
+          continue;
+        }
+        delta_drag[0] += delta[a].Drag[0];
+        delta_drag[1] += delta[a].Drag[1];
+        delta_torque_about_origin += delta[a].Torque_about_origin;
+
+        // Change in Int_r_0/Length
+        double length = arm_sum[a].Length;
+        double new_length = length + delta[a].Length;
+        double delta_r0[2];
+        for (unsigned i = 0; i < 2; i++)
+        {
+          delta_r0[i] = (delta[a].Int_r_0[i] * length -
+                         arm_sum[a].Int_r_0[i] * delta[a].Length) /
+                        (length * new_length);
+        }
+        double cos_theta = cos(theta[a]);
+        double sin_theta = sin(theta[a]);
+        delta_r_centre[0] += cos_theta * delta_r0[0] - sin_theta * delta_r0[1];
+        delta_r_centre[1] += sin_theta * delta_r0[0] + cos_theta * delta_r0[1];
+      }
+
+      // Change in the torque about the centre of mass,
+      // T = T_0 - (c_x D_y - c_y D_x)
+      double delta_torque =
+        delta_torque_about_origin -
+        (r_centre[0] * delta_drag[1] + delta_r_centre[0] * total_drag[1] +
+         delta_r_centre[0] * delta_drag[1]) +
+        (r_centre[1] * delta_drag[0] + delta_r_centre[1] * total_drag[0] +
+         delta_r_centre[1] * delta_drag[0]);
+
+      double delta_residual[3] = {delta_drag[0], delta_drag[1], delta_torque};
+      for (unsigned i = 0; i < 3; i++)
+      {
+        if (local_eqn[i] >= 0)
+        {
+          jacobian(local_eqn[i], local_unknown) += delta_residual[i] / fd_step;
+        }
+      }
+    }
+  }
+}
+
+
+//======start_of_problem_class==========================================
+/// Beam problem object
+//======================================================================
+class ElasticBeamProblem : public Problem
+{
+public:
+  /// Constructor: The arguments are the number of elements and the parameter to
+  /// determine the length of the beam
+  ElasticBeamProblem(const unsigned& n_elem1, const unsigned& n_elem2);
+
+  /// Conduct a parameter study
+  void parameter_study();
+
+  /// Compute the time-dependent sedimentation of the beam with adaptive
+  /// BDF2 timestepping
+  void unsteady_run();
+
+  /// Solve for the specified value of I, starting from I = 0 (the
+  /// current configuration is the initial guess) and increasing I in
+  /// Global_Physical_Variables::N_steady_step equal steps
+  void steady_solve(const double& i_target);
+
+  /// Document I, the rigid body parameters V, U0 and Theta_eq, and the
+  /// positions of the tips of the two arms (on one line, e.g. to compare
+  /// the solutions obtained with different solvers)
+  void doc_steady_solution(std::ostream& outfile)
+  {
+    double V = 0.0;
+    double U0 = 0.0;
+    double Theta_eq = 0.0;
+    double X0 = 0.0;
+    double Y0 = 0.0;
+    Rigid_body_element_pt->get_parameters(V, U0, Theta_eq, X0, Y0);
+    outfile << Global_Physical_Variables::I << "  " << V << "  " << U0
+            << "  " << Theta_eq;
+    Vector<SolidMesh*> mesh_pt = beam_mesh_pt();
+    for (unsigned m = 0; m < 2; m++)
+    {
+      Node* tip_node_pt = mesh_pt[m]->boundary_node_pt(1, 0);
+      outfile << "  " << tip_node_pt->x(0) << "  " << tip_node_pt->x(1);
+    }
+    outfile << std::endl;
+  }
+
+  /// Check the RigidBodyElement's Jacobians by automatic differentiation
+  /// and incremental finite differencing against finite differencing
+  void check_rigid_body_jacobian()
+  {
+    Rigid_body_element_pt->check_jacobian();
+  }
+
+  /// Check the banded LU factorisation against SuperLU: Solve a linear
+  /// system with the Jacobian at the current solution (and a fixed right
+  /// hand side) with both and throw an error if the solutions differ by
+  /// more than the given (relative) tolerance
+  void check_banded_lu(const double& tol = 1.0e-8)
+  {
+    DoubleVector residuals;
+    CRDoubleMatrix jacobian;
+    get_jacobian(residuals, jacobian);
+    unsigned n_dof = ndof();
+    DoubleVector rhs(residuals.distribution_pt(), 0.0);
+    for (unsigned i = 0; i < n_dof; i++)
+    {
+      rhs[i] = sin(double(i) + 1.0);
+    }
+
+    // Banded LU (the bandwidth follows from the sparsity pattern)
+    BandedLUFactorisation banded_lu;
+    banded_lu.build(jacobian);
+    banded_lu.factorise();
+    Vector<double> x_banded(rhs.values_pt(), rhs.values_pt() + n_dof);
+    banded_lu.solve(&x_banded[0]);
+
+    // Direct solver
+    SuperLUSolver direct_solver;
+    DoubleVector x_direct;
+    direct_solver.solve(&jacobian, rhs, x_direct);
+
+    double diff = 0.0;
+    double scale = 0.0;
+    for (unsigned i = 0; i < n_dof; i++)
+    {
+      diff = std::max(diff, fabs(x_banded[i] - x_direct[i]));
+      scale = std::max(scale, fabs(x_direct[i]));
+    }
+    oomph_info << "Banded LU (kl = " << banded_lu.kl()
+               << ", ku = " << banded_lu.ku() << ") vs SuperLU for " << n_dof
+               << " dofs: max. difference " << diff << " (max. entry "
+               << scale << ")" << std::endl;
+    if (diff > tol * scale)
+    {
+      std::ostringstream error_message;
+      error_message << "Banded LU and SuperLU solutions differ: max. "
+                    << "difference " << diff << " for max. entry " << scale
+                    << std::endl;
+      throw OomphLibError(error_message.str(),
+                          OOMPH_CURRENT_FUNCTION,
+                          OOMPH_EXCEPTION_LOCATION);
+    }
+  }
+
+  /// Global temporal error norm for the adaptive timestepping: RMS of
+  /// the estimated errors in the rigid body's orientation and position
+  double global_temporal_error_norm()
+  {
+    double global_error = 0.0;
+    unsigned n_error = 0;
+    for (unsigned i = 2; i < 5; i++)
+    {
+      Data* data_pt = Rigid_body_element_pt->internal_data_pt(i);
+      if (!data_pt->is_pinned(0))
+      {
+        double error =
+          data_pt->time_stepper_pt()->temporal_error_in_value(data_pt, 0);
+        global_error += error * error;
+        n_error++;
+      }
+    }
+    if (n_error > 0)
+    {
+      global_error /= double(n_error);
+    }
+    return sqrt(global_error);
+  }
+
+  /// Move the nodes of the beam meshes to equidistribute the
+  /// curvature-based monitor function, interpolating the current solution
+  void r_adapt();
+
+  /// Write the beam (both arms) and the state of the rigid body to a
+  /// (binary) VTU file, with the "time" (time or continuation parameter)
+  /// and I as field data
+  void output_vtu(const std::string& filename, const double& time)
+  {
+    VTUPolylineWriter writer;
+    add_beam_mesh_to_vtu(Beam_mesh_first_arm_pt, writer, 5);
+    add_beam_mesh_to_vtu(Beam_mesh_second_arm_pt, writer, 5);
+    add_rigid_body_state_to_vtu(
+      Vector<RigidBodyElement*>(1, Rigid_body_element_pt), writer);
+    writer.add_field_data("TimeValue", 1, Vector<double>(1, time));
+    writer.add_field_data(
+      "I", 1, Vector<double>(1, Global_Physical_Variables::I));
+    writer.write(filename, vtu_encoding());
+  }
+
+  /// Gather the nodal state of the beam (both arms) and the rigid body
+  /// data (at all time levels) into a snapshot for the compressed archive
+  void get_snapshot(Vector<double>& values)
+  {
+    NodalSnapshot::get_values(
+      beam_mesh_pt(),
+      Vector<GeneralisedElement*>(1, Rigid_body_element_pt),
+      values);
+  }
+
+  /// Read the snapshot with the given index from a compressed archive
+  /// written by parameter_study() and restore the state (and I, which is
+  /// the snapshot's label) bitwise-exactly
+  void restart_from_snapshot(const std::string& filename,
+                             const unsigned& index)
+  {
+    CompressedSnapshotReader reader(filename);
+    double label = 0.0;
+    Vector<double> values;
+    for (unsigned i = 0; i <= index; i++)
+    {
+      if (!reader.read_next_snapshot(label, values))
+      {
+        std::ostringstream error_message;
+        error_message << filename << " only contains " << i
+                      << " snapshots" << std::endl;
+        throw OomphLibError(error_message.str(),
+                            OOMPH_CURRENT_FUNCTION,
+                            OOMPH_EXCEPTION_LOCATION);
+      }
+    }
+    NodalSnapshot::set_values(
+      beam_mesh_pt(),
+      Vector<GeneralisedElement*>(1, Rigid_body_element_pt),
+      values);
+    Global_Physical_Variables::I = label;
+
+    // The Lagrangian coordinates may have changed
+    if (Global_Physical_Variables::R_adapt_interval > 0)
+    {
+      Integration_point_cache_first_arm_pt->build();
+      Integration_point_cache_second_arm_pt->build();
+    }
+  }
+
+  /// Use the persistent solution cache in the specified (existing)
+  /// directory: parameter_study() adds each converged solution to it
+  void use_solution_cache(const std::string& directory)
+  {
+    // Scales of q, alpha and I for the distance between cached solutions
+    Vector<double> parameter_scale(3);
+    parameter_scale[0] = 0.1;
+    parameter_scale[1] = 0.1;
+    parameter_scale[2] = 1.0;
+    delete Solution_cache_pt;
+    Solution_cache_pt = new BeamSolutionCache(directory, parameter_scale);
+  }
+
+  /// Seed the beam's shape (both arms) and the rigid body data with the
+  /// cached solution(s) nearest to the current values of q, alpha and I
+  /// (interpolated onto the current meshes). Returns false if there's no
+  /// cache or it's empty.
+  bool warm_start_from_solution_cache()
+  {
+    if (Solution_cache_pt == 0)
+    {
+      return false;
+    }
+    return Solution_cache_pt->warm_start(solution_cache_parameters(),
+                                         beam_mesh_pt(),
+                                         rigid_body_data_pt());
+  }
+
+  /// Check the round trip through the solution cache: Add the current
+  /// solution to the cache, overwrite the dofs, seed them from the cache
+  /// and throw an error if they differ from the original ones by more
+  /// than tol times their max. magnitude. The original dofs are restored.
+  void check_solution_cache(const double& tol = 1.0e-10)
+  {
+    if (Solution_cache_pt == 0)
+    {
+      throw OomphLibError("No solution cache: specify --solution_cache",
+                          OOMPH_CURRENT_FUNCTION,
+                          OOMPH_EXCEPTION_LOCATION);
+    }
+    store_in_solution_cache();
+    DoubleVector dofs;
+    get_dofs(dofs);
+    DoubleVector zero_dofs(dofs.distribution_pt(), 0.0);
+    set_dofs(zero_dofs);
+    if (!warm_start_from_solution_cache())
+    {
+      set_dofs(dofs);
+      throw OomphLibError("No warm start from the solution cache",
+                          OOMPH_CURRENT_FUNCTION,
+                          OOMPH_EXCEPTION_LOCATION);
+    }
+    DoubleVector cached_dofs;
+    get_dofs(cached_dofs);
+    set_dofs(dofs);
+    unsigned n_dof = ndof();
+    double diff = 0.0;
+    double scale = 0.0;
+    for (unsigned i = 0; i < n_dof; i++)
+    {
+      diff = std::max(diff, fabs(cached_dofs[i] - dofs[i]));
+      scale = std::max(scale, fabs(dofs[i]));
+    }
+    oomph_info << "Solution cache round trip: max. difference " << diff
+               << " (max. dof " << scale << ")" << std::endl;
+    if (diff > tol * scale)
+    {
+      std::ostringstream error_message;
+      error_message << "Solution from the cache differs from the stored "
+                    << "one: max. difference " << diff << " for max. dof "
+                    << scale << std::endl;
+      throw OomphLibError(error_message.str(),
+                          OOMPH_CURRENT_FUNCTION,
+                          OOMPH_EXCEPTION_LOCATION);
+    }
+  }
+
+  /// Stability analysis of the current (converged) solution. In the
+  /// time-dependent formulation the orientation evolves according to
+  /// dTheta_eq/dt = Omega, while the beam, V, U0 and Omega adjust
+  /// instantaneously (there's no inertia) so that the drag, the torque
+  /// and the beam equations vanish. Linearising about the steady solution
+  /// (in which Omega = 0) with perturbations proportional to
+  /// exp(lambda t), so that Omega = lambda Theta_eq, gives the generalised
+  /// eigenproblem J v = lambda M v, where J is the Jacobian of the steady
+  /// problem and M is nonzero only in the column of Theta_eq, which is
+  /// -dR/dOmega (see get_stability_mass_matrix(...)). (X0 and Y0, which
+  /// drift with the body, are pinned in the steady formulation.) The
+  /// finite eigenvalues of this pencil are the growth rates of
+  /// perturbations of the orientation -- here just one, dOmega/dTheta_eq
+  /// along the branch of quasi-steady states -- and the solution is stable
+  /// if all of them have negative real part; the (infinite) eigenvalues
+  /// of the instantaneous constraints play no role. They're computed
+  /// with the shift-invert Arnoldi method, re-using the factorisation of
+  /// the Jacobian from the last Newton step (with --jacobian_reuse: its
+  /// current approximation of the inverse Jacobian). Write I, the number
+  /// of eigenvalues with positive real part (zero if the solution is
+  /// stable) and, for each eigenvalue, its real and imaginary parts and
+  /// the residual |J v - lambda M v| of the eigenpair (which shows how
+  /// well the factorisation represents the current Jacobian) to the file
+  void doc_stability(std::ostream& stability_file)
+  {
+    if (Stability_eigensolver_pt == 0)
+    {
+      return;
+    }
+    double t_start = TimingHelpers::timer();
+    Vector<unsigned> mass_column_index;
+    Vector<DoubleVector> mass_column;
+    get_stability_mass_matrix(mass_column_index, mass_column);
+    Vector<std::complex<double>> eigenvalue;
+    Vector<double> residual;
+    Stability_eigensolver_pt->solve(
+      this,
+      linear_solver_pt(),
+      mass_column_index,
+      mass_column,
+      0.0,
+      Global_Physical_Variables::N_stability_eigenvalue,
+      eigenvalue,
+      residual);
+    unsigned n_eigenvalue = eigenvalue.size();
+    unsigned n_unstable = 0;
+    for (unsigned e = 0; e < n_eigenvalue; e++)
+    {
+      if (eigenvalue[e].real() > 0.0)
+      {
+        n_unstable++;
+      }
+    }
+    stability_file << Global_Physical_Variables::I << " " << n_unstable;
+    for (unsigned e = 0; e < n_eigenvalue; e++)
+    {
+      stability_file << " " << eigenvalue[e].real() << " "
+                     << eigenvalue[e].imag() << " " << residual[e];
+    }
+    stability_file << std::endl;
+    oomph_info << "Stability analysis at I = " << Global_Physical_Variables::I
+               << ": " << n_unstable << " of the " << n_eigenvalue
+               << " growth rates of the orientation are positive ("
+               << TimingHelpers::timer() - t_start << " sec)" << std::endl;
+    if (CommandLineArgs::command_line_flag_has_been_set("--check_stability"))
+    {
+      check_stability_eigenvalues(mass_column_index, mass_column, eigenvalue);
+    }
+  }
+
+  /// The "mass matrix" M of the linearised orientation dynamics (see
+  /// doc_stability(...)), specified by its nonzero columns: the column
+  /// of Theta_eq is -dR/dOmega, computed by finite differencing since
+  /// Omega is pinned (at zero) in the steady formulation. There are no
+  /// columns if Theta_eq is pinned.
+  void get_stability_mass_matrix(Vector<unsigned>& mass_column_index,
+                                 Vector<DoubleVector>& mass_column)
+  {
+    mass_column_index.clear();
+    mass_column.clear();
+    int theta_eqn = Rigid_body_element_pt->internal_data_pt(2)->eqn_number(0);
+    if (theta_eqn < 0)
+    {
+      return;
+    }
+    Data* omega_data_pt = Rigid_body_element_pt->internal_data_pt(5);
+    double omega_backup = omega_data_pt->value(0);
+    double eps = std::sqrt(std::numeric_limits<double>::epsilon()) *
+                 (1.0 + std::fabs(omega_backup));
+    DoubleVector residuals;
+    get_residuals(residuals);
+    omega_data_pt->set_value(0, omega_backup + eps);
+    DoubleVector perturbed_residuals;
+    get_residuals(perturbed_residuals);
+    omega_data_pt->set_value(0, omega_backup);
+
+    mass_column_index.push_back(unsigned(theta_eqn));
+    mass_column.resize(1);
+    mass_column[0].build(dof_distribution_pt(), 0.0);
+    unsigned n_dof = ndof();
+    for (unsigned i = 0; i < n_dof; i++)
+    {
+      mass_column[0][i] = -(perturbed_residuals[i] - residuals[i]) / eps;
+    }
+  }
+
+  /// Check the eigenvalues computed by the stability analysis against
+  /// the finite eigenvalues of J v = lambda M v from a dense reduction:
+  /// With M = C P, where the columns of C are M's nonzero columns and P
+  /// selects the corresponding entries of v, the finite eigenvalues are
+  /// the reciprocals of the nonzero eigenvalues of the small matrix
+  /// P J^{-1} C, with J^{-1} C computed by a dense LU decomposition of
+  /// the (freshly assembled) Jacobian. Each eigenvalue must agree with
+  /// one of these to within tol times its modulus and there must be as
+  /// many as requested (or as there are finite eigenvalues). Throws an
+  /// error otherwise.
+  void check_stability_eigenvalues(
+    const Vector<unsigned>& mass_column_index,
+    const Vector<DoubleVector>& mass_column,
+    const Vector<std::complex<double>>& eigenvalue,
+    const double& tol = 1.0e-4)
+  {
+    DoubleVector residuals;
+    DenseDoubleMatrix jacobian;
+    get_jacobian(residuals, jacobian);
+
+    // P J^{-1} C
+    unsigned n_column = mass_column_index.size();
+    DenseDoubleMatrix reduced_matrix(n_column, n_column, 0.0);
+    for (unsigned l = 0; l < n_column; l++)
+    {
+      DoubleVector j_inverse_c;
+      jacobian.solve(mass_column[l], j_inverse_c);
+      for (unsigned k = 0; k < n_column; k++)
+      {
+        reduced_matrix(k, l) = j_inverse_c[mass_column_index[k]];
+      }
+    }
+    Vector<std::complex<double>> mu;
+    ShiftInvertArnoldiEigensolver::dense_eigenvalues(reduced_matrix, mu);
+
+    // Finite eigenvalues (the reciprocals of the nonzero mu)
+    double mu_max = 0.0;
+    for (unsigned k = 0; k < n_column; k++)
+    {
+      mu_max = std::max(mu_max, std::abs(mu[k]));
+    }
+    Vector<std::complex<double>> dense_eigenvalue;
+    for (unsigned k = 0; k < n_column; k++)
+    {
+      if (std::abs(mu[k]) > 1.0e-10 * mu_max)
+      {
+        dense_eigenvalue.push_back(1.0 / mu[k]);
+      }
+    }
+
+    unsigned n_dense = dense_eigenvalue.size();
+    unsigned n_eigenvalue = eigenvalue.size();
+    double max_error = 0.0;
+    bool ok = (n_eigenvalue ==
+               std::min(n_dense,
+                        Global_Physical_Variables::N_stability_eigenvalue));
+    for (unsigned e = 0; ok && (e < n_eigenvalue); e++)
+    {
+      // Nearest eigenvalue from the dense reduction
+      double error = std::numeric_limits<double>::max();
+      double dense_modulus = 0.0;
+      for (unsigned k = 0; k < n_dense; k++)
+      {
+        double diff = std::abs(eigenvalue[e] - dense_eigenvalue[k]);
+        if (diff < error)
+        {
+          error = diff;
+          dense_modulus = std::abs(dense_eigenvalue[k]);
+        }
+      }
+      max_error = std::max(max_error, error);
+      ok = (error <= tol * dense_modulus);
+    }
+    oomph_info << "Stability analysis vs dense reduction of the "
+               << jacobian.nrow() << " x " << jacobian.nrow()
+               << " pencil: max. difference " << max_error << std::endl;
+    if (!ok)
+    {
+      std::ostringstream error_message;
+      error_message << "Eigenvalues from the stability analysis at I = "
+                    << Global_Physical_Variables::I
+                    << " aren't the finite eigenvalues of J v = lambda M v"
+                    << std::endl;
+      throw OomphLibError(error_message.str(),
+                          OOMPH_CURRENT_FUNCTION,
+                          OOMPH_EXCEPTION_LOCATION);
+    }
+  }
+
+  /// Check that the nonlocal slender body traction differs from the
+  /// local one for the current solution: Compare the drag and torque
+  /// (the integrals of the traction) with and without the nonlocal
+  /// correction and throw an error if they agree to within the given
+  /// (relative) tolerance
+  void check_nonlocal_slender_body_traction(const double& tol = 1.0e-8)
+  {
+    if (Nonlocal_operator_pt == 0)
+    {
+      throw OomphLibError("The nonlocal slender body traction isn't used",
+                          OOMPH_CURRENT_FUNCTION,
+                          OOMPH_EXCEPTION_LOCATION);
+    }
+
+    // Make sure the induced velocity is up to date
+    Rigid_body_element_pt->update_nonlocal_slender_body_traction();
+
+    FixedSizeVector<double, 2> drag;
+    double torque = 0.0;
+    Rigid_body_element_pt->compute_drag_and_torque(drag, torque);
+    FixedSizeVector<double, 2> local_drag;
+    double local_torque = 0.0;
+    Rigid_body_element_pt->compute_local_drag_and_torque(local_drag,
+                                                         local_torque);
+
+    double diff = std::max(std::max(fabs(drag[0] - local_drag[0]),
+                                    fabs(drag[1] - local_drag[1])),
+                           fabs(torque - local_torque));
+    double scale = std::max(std::max(fabs(local_drag[0]), fabs(local_drag[1])),
+                            fabs(local_torque));
+    oomph_info << "Nonlocal vs local slender body traction at I = "
+               << Global_Physical_Variables::I << ": drag (" << drag[0]
+               << ", " << drag[1] << ") vs (" << local_drag[0] << ", "
+               << local_drag[1] << "), torque " << torque << " vs "
+               << local_torque << "; max. difference " << diff << std::endl;
+    if (diff <= tol * scale)
+    {
+      std::ostringstream error_message;
+      error_message << "The nonlocal correction doesn't change the drag and "
+                    << "torque: max. difference " << diff
+                    << " for max. local drag/torque " << scale << std::endl;
+      throw OomphLibError(error_message.str(),
+                          OOMPH_CURRENT_FUNCTION,
+                          OOMPH_EXCEPTION_LOCATION);
+    }
+  }
+
+  /// Pointer to RigidBodyElement that contains the rigid body data
+  RigidBodyElement* rigid_body_element_pt()
+  {
+    return Rigid_body_element_pt;
+  }
+
+  /// No actions need to be performed after a solve
+  void actions_after_newton_solve() {}
+
+  /// No actions need to be performed before a solve
+  void actions_before_newton_solve() {}
+
+  /// Record the number of iterations taken by an iterative linear solver
+  /// in the Newton step just completed
+  void actions_after_newton_step()
+  {
+    IterativeLinearSolver* solver_pt =
+      dynamic_cast<IterativeLinearSolver*>(linear_solver_pt());
+    if (solver_pt != 0)
+    {
+      Max_n_linear_solver_iteration =
+        std::max(Max_n_linear_solver_iteration, solver_pt->iterations());
+    }
+  }
+
+  /// Update the (lagged) nonlocal slender body traction for the current
+  /// configuration before each Newton convergence check
+  void actions_before_newton_convergence_check()
+  {
+    if (Nonlocal_operator_pt != 0)
+    {
+      Rigid_body_element_pt->update_nonlocal_slender_body_traction();
+    }
+  }
+
+  /// Dump problem data to allow for later restart
+  void dump_it(ofstream& dump_file)
+  {
+    // Current value of the FSI parameter
+    dump_file << Global_Physical_Variables::I << " # FSI parameter"
+              << std::endl;
+
+    // hierher maybe add q and alpha but then issue warning
+    // if it differs from the one specified on the command line
+
+    // Nodes may have been moved by r-adaptation
+    if (Global_Physical_Variables::R_adapt_interval > 0)
+    {
+      Beam_mesh_first_arm_pt->dump_lagrangian_coordinates(dump_file);
+      Beam_mesh_second_arm_pt->dump_lagrangian_coordinates(dump_file);
+    }
+
+    // Dump the refinement pattern and the generic problem data
+    Problem::dump(dump_file);
+  }
+
+  /// Read problem data for restart
+  void restart(ifstream& restart_file)
+  {
+    // Read line up to termination sign
+    string input_string;
+    getline(restart_file, input_string, '#');
+
+    // Ignore rest of line
+    restart_file.ignore(80, '\n');
+
+    // Read in FSI parameter
+    Global_Physical_Variables::I = double(atof(input_string.c_str()));
+
+    // Nodes may have been moved by r-adaptation
+    if (Global_Physical_Variables::R_adapt_interval > 0)
+    {
+      Beam_mesh_first_arm_pt->read_lagrangian_coordinates(restart_file);
+      Beam_mesh_second_arm_pt->read_lagrangian_coordinates(restart_file);
+      Integration_point_cache_first_arm_pt->build();
+      Integration_point_cache_second_arm_pt->build();
+    }
+
+    // Refine the mesh and read in the generic problem data
+    Problem::read(restart_file);
+  }
+
+private:
+  /// Pointer to geometric object that represents the beam's undeformed shape
+  /// (first arm)
+  GeomObject* Undef_beam_pt1;
+
+  /// Pointer to geometric object that represents the beam's undeformed shape
+  /// (second arm)
+  GeomObject* Undef_beam_pt2;
+
+  /// Pointer to RigidBodyElement that actually contains the rigid body data
+  RigidBodyElement* Rigid_body_element_pt;
+
+  /// Pointer to beam mesh (first arm)
+  GradedOneDLagrangianMesh<HaoHermiteBeamElement>* Beam_mesh_first_arm_pt;
+
+  /// Pointer to beam mesh (second arm)
+  GradedOneDLagrangianMesh<HaoHermiteBeamElement>* Beam_mesh_second_arm_pt;
+
+  /// Pointer to mesh containing the rigid body element
+  Mesh* Rigid_body_element_mesh_pt;
+
+  /// Pointer to the grading of the beam meshes (null if uniform)
+  OneDMeshGrading* Mesh_grading_pt;
+
+  /// Pointer to the cached integration point data of the beam mesh
+  /// (first arm)
+  BeamIntegrationPointCache* Integration_point_cache_first_arm_pt;
+
+  /// Pointer to the cached integration point data of the beam mesh
+  /// (second arm)
+  BeamIntegrationPointCache* Integration_point_cache_second_arm_pt;
+
+  /// Pointer to the linear solver that re-uses the Jacobian's
+  /// factorisation (null if not used)
+  JacobianReuseNewtonSolver* Jacobian_reuse_solver_pt;
+
+  /// Pointer to the nonlocal slender body operator (null if not used)
+  NonlocalSlenderBodyOperator* Nonlocal_operator_pt;
+
+  /// Pointer to the persistent solution cache (null if not used)
+  BeamSolutionCache* Solution_cache_pt;
+
+  /// Pointer to the eigensolver for the stability analysis (null if not
+  /// used)
+  ShiftInvertArnoldiEigensolver* Stability_eigensolver_pt;
+
+  /// Max. number of iterations taken by an iterative linear solver in
+  /// the Newton steps since it was last reset
+  unsigned Max_n_linear_solver_iteration;
+
+  /// The beam meshes (first and second arm)
+  Vector<SolidMesh*> beam_mesh_pt()
+  {
+    Vector<SolidMesh*> mesh_pt(2);
+    mesh_pt[0] = Beam_mesh_first_arm_pt;
+    mesh_pt[1] = Beam_mesh_second_arm_pt;
+    return mesh_pt;
+  }
+
+  /// Parameters that index the solution cache: q, alpha and I
+  Vector<double> solution_cache_parameters()
+  {
+    Vector<double> parameters(3);
+    parameters[0] = Global_Physical_Variables::Q;
+    parameters[1] = Global_Physical_Variables::Alpha;
+    parameters[2] = Global_Physical_Variables::I;
+    return parameters;
+  }
+
+  /// The rigid body data (stored in the solution cache)
+  Vector<Data*> rigid_body_data_pt()
+  {
+    unsigned n_internal = Rigid_body_element_pt->ninternal_data();
+    Vector<Data*> data_pt(n_internal);
+    for (unsigned i = 0; i < n_internal; i++)
+    {
+      data_pt[i] = Rigid_body_element_pt->internal_data_pt(i);
+    }
+    return data_pt;
+  }
+
+  /// Add the current (converged) solution to the solution cache (if used)
+  void store_in_solution_cache()
+  {
+    if (Solution_cache_pt != 0)
+    {
+      Solution_cache_pt->store(solution_cache_parameters(),
+                               beam_mesh_pt(),
+                               rigid_body_data_pt());
+    }
+  }
+
+}; // end of problem class
+
+
+/////////////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////////
+
+
+//=========================================================================
+/// Steady, straight 1D line in 2D space
+///  \f[ x = 0.0 \f]
+///  \f[ y = \zeta \f]
+//=========================================================================
+class StraightLineVertical : public GeomObject
+{
+public:
+  /// Constructor derives from GeomObject(1, 2)
+  StraightLineVertical() : GeomObject(1, 2) {}
+
+  /// Broken copy constructor
+  StraightLineVertical(const StraightLineVertical& dummy) = delete;
+
+  /// Broken assignment operator
+  void operator=(const StraightLineVertical&) = delete;
+
+  /// Position Vector at Lagrangian coordinate zeta
+  void position(const Vector<double>& zeta, Vector<double>& r) const
+  {
+    r[0] = 0.0;
+    r[1] = zeta[0];
+  }
+
+
+  /// Derivative of position Vector w.r.t. to coordinates:
+  /// \f$ \frac{dR_i}{d \zeta_\alpha}\f$ = drdzeta(alpha,i).
+  /// Evaluated at current time.
+  virtual void dposition(const Vector<double>& zeta,
+                         DenseMatrix<double>& drdzeta) const
+  {
+    // Tangent vector
+    drdzeta(0, 0) = 0.0;
+    drdzeta(0, 1) = 1.0;
+  }
+
+
+  /// 2nd derivative of position Vector w.r.t. to coordinates:
+  /// \f$ \frac{d^2R_i}{d \zeta_\alpha d \zeta_\beta}\f$ =
+  /// ddrdzeta(alpha,beta,i). Evaluated at current time.
+  virtual void d2position(const Vector<double>& zeta,
+                          RankThreeTensor<double>& ddrdzeta) const
+  {
+    // Derivative of tangent vector
+    ddrdzeta(0, 0, 0) = 0.0;
+    ddrdzeta(0, 0, 1) = 0.0;
+  }
+
+
+  /// Posn Vector and its  1st & 2nd derivatives
+  /// w.r.t. to coordinates:
+  /// \f$ \frac{dR_i}{d \zeta_\alpha}\f$ = drdzeta(alpha,i).
+  /// \f$ \frac{d^2R_i}{d \zeta_\alpha d \zeta_\beta}\f$ =
+  /// ddrdzeta(alpha,beta,i).
+  /// Evaluated at current time.
+  virtual void d2position(const Vector<double>& zeta,
+                          Vector<double>& r,
+                          DenseMatrix<double>& drdzeta,
+                          RankThreeTensor<double>& ddrdzeta) const
+  {
+    // Position Vector
+    r[0] = 0.0;
+    r[1] = zeta[0];
+
+    // Tangent vector
+    drdzeta(0, 0) = 0.0;
+    drdzeta(0, 1) = 1.0;
+
+    // Derivative of tangent vector
+    ddrdzeta(0, 0, 0) = 0.0;
+    ddrdzeta(0, 0, 1) = 0.0;
+  }
+};
+
+//=========================================================================
+/// Steady, straight 1D line in 2D space with stretch_ratio
+///  \f[ x = 0.0 \f]
+///  \f[ y = \zeta*stretch_ratio  \f]
+//=========================================================================
+class NewStraightLineVertical : public GeomObject
+{
+public:
+  /// Constructor derives from GeomObject(1, 2)
+  /// Pass stretch_ratio to this class
+  NewStraightLineVertical(const double& stretch_ratio) : GeomObject(1, 2)
+  {
+    Stretch_ratio = stretch_ratio;
+  }
+
+  /// Broken copy constructor
+  NewStraightLineVertical(const NewStraightLineVertical& dummy) = delete;
+
+  /// Broken assignment operator
+  void operator=(const NewStraightLineVertical&) = delete;
+
+  /// Position Vector at Lagrangian coordinate zeta
+  void position(const Vector<double>& zeta, Vector<double>& r) const
+  {
+    r[0] = 0.0;
+    r[1] = zeta[0] * Stretch_ratio;
+  }
+
+
+  /// Derivative of position Vector w.r.t. to coordinates:
+  /// \f$ \frac{dR_i}{d \zeta_\alpha}\f$ = drdzeta(alpha,i).
+  /// Evaluated at current time.
   virtual void dposition(const Vector<double>& zeta,
                          DenseMatrix<double>& drdzeta) const
   {
-    // Tangent vector
-    drdzeta(0, 0) = 0.0;
-    drdzeta(0, 1) = Stretch_ratio;
+    // Tangent vector
+    drdzeta(0, 0) = 0.0;
+    drdzeta(0, 1) = Stretch_ratio;
+  }
+
+
+  /// 2nd derivative of position Vector w.r.t. to coordinates:
+  /// \f$ \frac{d^2R_i}{d \zeta_\alpha d \zeta_\beta}\f$ =
+  /// ddrdzeta(alpha,beta,i). Evaluated at current time.
+  virtual void d2position(const Vector<double>& zeta,
+                          RankThreeTensor<double>& ddrdzeta) const
+  {
+    // Derivative of tangent vector
+    ddrdzeta(0, 0, 0) = 0.0;
+    ddrdzeta(0, 0, 1) = 0.0;
+  }
+
+
+  /// Posn Vector and its  1st & 2nd derivatives
+  /// w.r.t. to coordinates:
+  /// \f$ \frac{dR_i}{d \zeta_\alpha}\f$ = drdzeta(alpha,i).
+  /// \f$ \frac{d^2R_i}{d \zeta_\alpha d \zeta_\beta}\f$ =
+  /// ddrdzeta(alpha,beta,i).
+  /// Evaluated at current time.
+  virtual void d2position(const Vector<double>& zeta,
+                          Vector<double>& r,
+                          DenseMatrix<double>& drdzeta,
+                          RankThreeTensor<double>& ddrdzeta) const
+  {
+    // Position Vector
+    r[0] = 0.0;
+    r[1] = zeta[0] * Stretch_ratio;
+
+    // Tangent vector
+    drdzeta(0, 0) = 0.0;
+    drdzeta(0, 1) = Stretch_ratio;
+
+    // Derivative of tangent vector
+    ddrdzeta(0, 0, 0) = 0.0;
+    ddrdzeta(0, 0, 1) = 0.0;
+  }
+
+private:
+  /// Define the length of the beam
+  double Stretch_ratio;
+};
+
+
+//=============start_of_constructor=====================================
+/// Constructor for elastic beam problem
+//======================================================================
+ElasticBeamProblem::ElasticBeamProblem(const unsigned& n_elem1,
+                                       const unsigned& n_elem2)
+  : Mesh_grading_pt(0),
+    Jacobian_reuse_solver_pt(0),
+    Nonlocal_operator_pt(0),
+    Solution_cache_pt(0),
+    Stability_eigensolver_pt(0),
+    Max_n_linear_solver_iteration(0)
+{
+  // Drift speed and acceleration of horizontal motion
+  double v = 0.0;
+
+  // Speed of horizontal motion
+  double u0 = 0.0;
+
+  // Beam's inclination
+  double theta_eq = Global_Physical_Variables::Initial_value_for_theta_eq;
+
+  // x position of clamped point
+  double x0 = 0.0;
+
+  // y position of clamped point
+  double y0 = 0.0;
+
+  // Time-dependent sedimentation? The rigid body's orientation and
+  // position are integrated with adaptive BDF2; the beam's deformation
+  // and the rigid body velocities are inertia-free (overdamped) so they
+  // don't need a timestepper
+  TimeStepper* rigid_body_time_stepper_pt = 0;
+  if (CommandLineArgs::command_line_flag_has_been_set("--unsteady"))
+  {
+    add_time_stepper_pt(new BDF<2>(true));
+    rigid_body_time_stepper_pt = time_stepper_pt();
+  }
+
+  // Make the RigidBodyElement that stores the parameters for the rigid body
+  // motion
+  Rigid_body_element_pt = new RigidBodyElement(
+    v, u0, theta_eq, x0, y0, rigid_body_time_stepper_pt);
+
+  // Differentiate the drag and torque automatically?
+  if (CommandLineArgs::command_line_flag_has_been_set(
+        "--automatic_differentiation"))
+  {
+    Rigid_body_element_pt->enable_automatic_differentiation();
+  }
+  // ...or by incremental finite differencing?
+  else if (CommandLineArgs::command_line_flag_has_been_set(
+             "--incremental_fd_jacobian"))
+  {
+    Rigid_body_element_pt->enable_incremental_finite_differences();
+  }
+
+  // Account for the hydrodynamic interaction between (and within) the
+  // arms with the nonlocal slender body operator?
+  if (CommandLineArgs::command_line_flag_has_been_set(
+        "--nonlocal_slender_body"))
+  {
+    double kappa =
+      1.0 / (2.0 * log(1.0 / Global_Physical_Variables::Slenderness));
+    Nonlocal_operator_pt = new NonlocalSlenderBodyOperator(
+      kappa, Global_Physical_Variables::Nonlocal_cutoff);
+    Nonlocal_operator_pt->opening_angle() =
+      Global_Physical_Variables::Nonlocal_opening_angle;
+    Rigid_body_element_pt->set_nonlocal_operator_pt(Nonlocal_operator_pt);
+  }
+
+  // Add the rigid body element to its own mesh
+  Rigid_body_element_mesh_pt = new Mesh;
+  Rigid_body_element_mesh_pt->add_element_pt(Rigid_body_element_pt);
+
+  // Set the undeformed beam shape for two arms (in the reference orientation
+  // before applying the rigid body motion)
+  // Undef_beam_pt = new StraightLineVertical();
+
+  // Aspect ratio to determine the length of the beam
+  // first arm length = |q+0.5|, second arm length = |q-0.5|
+  double* q_pt = &Global_Physical_Variables::Q;
+
+  // Set for test! Switch between old and new code
+  bool old_version = false;
+  if (CommandLineArgs::command_line_flag_has_been_set("--old_version"))
+  {
+    old_version = true;
+  }
+
+  // Assign values to the stretch ratios and lengths for different versions
+  // of the code
+  double stretch_ratio_1 = 0.0;
+  double stretch_ratio_2 = 0.0;
+  double length_1 = 0.0;
+  double length_2 = 0.0;
+  if (old_version == false)
+  {
+    // New code
+    stretch_ratio_1 = *q_pt + 0.5;
+    stretch_ratio_2 = fabs(*q_pt - 0.5);
+    length_1 = 1.0;
+    length_2 = 1.0;
+  }
+  else
+  {
+    // Old code
+    stretch_ratio_1 = 1.0;
+    stretch_ratio_2 = 1.0;
+    length_1 = *q_pt + 0.5;
+    length_2 = fabs(*q_pt - 0.5);
+  }
+  // Set the undeformed beam shapes
+  Undef_beam_pt1 = new NewStraightLineVertical(stretch_ratio_1);
+  Undef_beam_pt2 = new NewStraightLineVertical(stretch_ratio_2);
+
+  // Cluster the nodes near the clamped junction and the free tip?
+  switch (Global_Physical_Variables::Mesh_grading)
+  {
+    case 0:
+      break;
+
+    case 1:
+      Mesh_grading_pt = new GeometricOneDMeshGrading(
+        Global_Physical_Variables::Grading_parameter,
+        ClusteredOneDMeshGrading::Cluster_at_both_ends);
+      break;
+
+    case 2:
+      Mesh_grading_pt = new TanhOneDMeshGrading(
+        Global_Physical_Variables::Grading_parameter,
+        ClusteredOneDMeshGrading::Cluster_at_both_ends);
+      break;
+
+    case 3:
+      Mesh_grading_pt =
+        new DensityOneDMeshGrading(&Global_Physical_Variables::element_density);
+      break;
+
+    default:
+      std::ostringstream error_message;
+      error_message << "Mesh_grading should be 0, 1, 2 or 3, not "
+                    << Global_Physical_Variables::Mesh_grading << std::endl;
+      throw OomphLibError(
+        error_message.str(), OOMPH_CURRENT_FUNCTION, OOMPH_EXCEPTION_LOCATION);
+  }
+
+  // Create the (Lagrangian!) meshes, using the NewStraightLineVertical
+  // objects to specify the initial (Eulerian) position of the nodes
+  // (uniform if Mesh_grading_pt is null)
+  Beam_mesh_first_arm_pt = new GradedOneDLagrangianMesh<HaoHermiteBeamElement>(
+    n_elem1, length_1, Undef_beam_pt1, Mesh_grading_pt);
+  Beam_mesh_second_arm_pt =
+    new GradedOneDLagrangianMesh<HaoHermiteBeamElement>(
+      n_elem2, length_2, Undef_beam_pt2, Mesh_grading_pt);
+
+  // Use the compile-time specialised slender body computations (this
+  // also sets the elements' integration scheme so it has to be done
+  // before the integration point data is cached)
+  if (Global_Physical_Variables::Fixed_quadrature_order != 0)
+  {
+    Vector<SolidMesh*> mesh_pt = beam_mesh_pt();
+    for (unsigned m = 0; m < 2; m++)
+    {
+      unsigned n_element = mesh_pt[m]->nelement();
+      for (unsigned e = 0; e < n_element; e++)
+      {
+        dynamic_cast<HaoHermiteBeamElement*>(mesh_pt[m]->element_pt(e))
+          ->set_fixed_quadrature_order(
+            Global_Physical_Variables::Fixed_quadrature_order);
+      }
+    }
+  }
+
+  // Tabulate the shape functions and undeformed geometry at the
+  // integration points once and for all
+  Integration_point_cache_first_arm_pt =
+    new BeamIntegrationPointCache(Beam_mesh_first_arm_pt, Undef_beam_pt1);
+  Integration_point_cache_second_arm_pt =
+    new BeamIntegrationPointCache(Beam_mesh_second_arm_pt, Undef_beam_pt2);
+
+  // Pass the pointer of the mesh to the RigidBodyElement class
+  // so it can work out the drag and torque on the entire structure
+  Rigid_body_element_pt->set_pointer_to_beam_meshes(beam_mesh_pt());
+
+  // Build the problem's global mesh
+  add_sub_mesh(Beam_mesh_first_arm_pt);
+  add_sub_mesh(Beam_mesh_second_arm_pt);
+  add_sub_mesh(Rigid_body_element_mesh_pt);
+  build_global_mesh();
+
+  // Set the boundary conditions: One end of the beam is clamped in space
+  // Pin displacements in both x and y directions, and pin the derivative of
+  // position Vector w.r.t. to coordinates in x direction. (first arm)
+  Beam_mesh_first_arm_pt->boundary_node_pt(0, 0)->pin_position(0);
+  Beam_mesh_first_arm_pt->boundary_node_pt(0, 0)->pin_position(1);
+  Beam_mesh_first_arm_pt->boundary_node_pt(0, 0)->pin_position(1, 0);
+
+  // Find number of elements in the mesh (first arm)
+  unsigned n_element = Beam_mesh_first_arm_pt->nelement();
+
+  // Loop over the elements to set physical parameters etc. (first arm)
+  for (unsigned e = 0; e < n_element; e++)
+  {
+    // Upcast to the specific element type
+    HaoHermiteBeamElement* elem_pt = dynamic_cast<HaoHermiteBeamElement*>(
+      Beam_mesh_first_arm_pt->element_pt(e));
+
+    // Pass the pointer of RigidBodyElement to the each element
+    // so we can work out the rigid body motion
+    elem_pt->set_pointer_to_rigid_body_element(Rigid_body_element_pt);
+
+    // Set physical parameters for each element:
+    elem_pt->h_pt() = &Global_Physical_Variables::H;
+    elem_pt->i_pt() = &Global_Physical_Variables::I;
+
+    // Note: no rotation!
+
+    // Set the undeformed shape for each element
+    elem_pt->undeformed_beam_pt() = Undef_beam_pt1;
+
+    // Use the cached integration point data
+    if (!CommandLineArgs::command_line_flag_has_been_set(
+          "--no_integration_point_cache"))
+    {
+      elem_pt->set_integration_point_cache_pt(
+        Integration_point_cache_first_arm_pt);
+    }
+
+  } // end of loop over elements
+
+
+  // Set the boundary conditions: One end of the beam is clamped in space
+  // Pin displacements in both x and y directions, and pin the derivative of
+  // position Vector w.r.t. to coordinates in x direction. (second arm)
+  Beam_mesh_second_arm_pt->boundary_node_pt(0, 0)->pin_position(0);
+  Beam_mesh_second_arm_pt->boundary_node_pt(0, 0)->pin_position(1);
+  Beam_mesh_second_arm_pt->boundary_node_pt(0, 0)->pin_position(1, 0);
+
+  // Find number of elements in the mesh (second arm)
+  n_element = Beam_mesh_second_arm_pt->nelement();
+
+  // Loop over the elements to set physical parameters etc. (second arm)
+  for (unsigned e = 0; e < n_element; e++)
+  {
+    // Upcast to the specific element type
+    HaoHermiteBeamElement* elem_pt = dynamic_cast<HaoHermiteBeamElement*>(
+      Beam_mesh_second_arm_pt->element_pt(e));
+
+    // Pass the pointer of RigidBodyElement to the each element
+    // so we can work out the rigid body motion
+    elem_pt->set_pointer_to_rigid_body_element(Rigid_body_element_pt);
+
+    // Set physical parameters for each element:
+    elem_pt->h_pt() = &Global_Physical_Variables::H;
+    elem_pt->i_pt() = &Global_Physical_Variables::I;
+
+    // Rotate by opening angle
+    elem_pt->theta_initial_pt(&Global_Physical_Variables::Alpha);
+
+    // Set the undeformed shape for each element
+    elem_pt->undeformed_beam_pt() = Undef_beam_pt2;
+
+    // Use the cached integration point data
+    if (!CommandLineArgs::command_line_flag_has_been_set(
+          "--no_integration_point_cache"))
+    {
+      elem_pt->set_integration_point_cache_pt(
+        Integration_point_cache_second_arm_pt);
+    }
+
+  } // end of loop over elements
+
+  // Assign the global and local equation numbers
+  cout << "# of dofs " << assign_eqn_numbers() << std::endl;
+
+  // Use the Jacobian-free Newton-Krylov solver?
+  if (CommandLineArgs::command_line_flag_has_been_set("--jfnk"))
+  {
+    // Preconditioner: Banded beam stiffness plus the (dense) block of
+    // derivatives of the rigid body residuals w.r.t. the rigid body
+    // unknowns
+    BeamBlockBandedPreconditioner* prec_pt =
+      new BeamBlockBandedPreconditioner(this);
+    Vector<Mesh*> mesh_pt(2);
+    mesh_pt[0] = Beam_mesh_first_arm_pt;
+    mesh_pt[1] = Beam_mesh_second_arm_pt;
+    prec_pt->set_beam_meshes(mesh_pt);
+    prec_pt->set_rigid_body_element(Rigid_body_element_pt);
+
+    // Never assemble the Jacobian; memory stays O(N) with bounded
+    // Krylov basis
+    JacobianFreeNewtonKrylovSolver* jfnk_solver_pt =
+      new JacobianFreeNewtonKrylovSolver(this);
+    jfnk_solver_pt->krylov_dimension() =
+      Global_Physical_Variables::Krylov_dimension;
+    jfnk_solver_pt->preconditioner_pt() = prec_pt;
+    linear_solver_pt() = jfnk_solver_pt;
+  }
+  // Use GMRES, preconditioned by geometric multigrid?
+  else if (CommandLineArgs::command_line_flag_has_been_set("--multigrid"))
+  {
+    HermiteBeamMultigridPreconditioner* prec_pt =
+      new HermiteBeamMultigridPreconditioner;
+    prec_pt->set_beam_meshes(beam_mesh_pt());
+    prec_pt->enable_doc_hierarchy();
+
+    GMRES<CRDoubleMatrix>* solver_pt = new GMRES<CRDoubleMatrix>;
+    solver_pt->preconditioner_pt() = prec_pt;
+    linear_solver_pt() = solver_pt;
+  }
+  // Keep the factorised Jacobian across Newton iterations and
+  // continuation steps (modified Newton with Broyden updates)?
+  else if (CommandLineArgs::command_line_flag_has_been_set("--jacobian_reuse"))
+  {
+    Jacobian_reuse_solver_pt = new JacobianReuseNewtonSolver(this);
+    Jacobian_reuse_solver_pt->set_parameter_pt(&Global_Physical_Variables::I);
+    Jacobian_reuse_solver_pt->max_contraction_rate() =
+      Global_Physical_Variables::Max_contraction_rate;
+    linear_solver_pt() = Jacobian_reuse_solver_pt;
+
+    // Convergence is only linear (superlinear with the Broyden updates)
+    // so allow more iterations
+    Problem::Max_newton_iterations = 20;
+  }
+
+  // Stability analysis after each converged step? It re-uses the
+  // factorised Jacobian from the last Newton step so it needs a direct
+  // solver that keeps its factors
+  if (CommandLineArgs::command_line_flag_has_been_set("--stability"))
+  {
+    if (CommandLineArgs::command_line_flag_has_been_set("--jfnk") ||
+        CommandLineArgs::command_line_flag_has_been_set("--multigrid"))
+    {
+      oomph_info << "Warning: --stability requires a direct solver; "
+                 << "no stability analysis" << std::endl;
+    }
+    else
+    {
+      linear_solver_pt()->enable_resolve();
+      Stability_eigensolver_pt = new ShiftInvertArnoldiEigensolver(
+        Global_Physical_Variables::Arnoldi_dimension);
+    }
+  }
+
+} // end of constructor
+
+
+//=======start_of_unsteady_run=============================================
+/// Compute the time-dependent sedimentation of the beam from its current
+/// configuration (impulsive start): The orientation and position of the
+/// rigid body are integrated with adaptive BDF2 timesteps; the rigid
+/// body velocities follow from the (inertia-free) balance of drag and
+/// torque at each instant. With --jacobian_reuse, the factorised
+/// Jacobian is kept across timesteps.
+//=========================================================================
+void ElasticBeamProblem::unsteady_run()
+{
+  // Create label for output
+  DocInfo doc_info;
+
+  // Set output directory
+  doc_info.set_directory("RESLT");
+
+  // Trajectory of the rigid body: t, X0, Y0, Theta_eq, U0, V, Omega
+  ofstream trajectory_file;
+  char filename[100];
+  sprintf(filename, "%s/trajectory.dat", doc_info.directory().c_str());
+  trajectory_file.open(filename);
+
+  // Time series of the VTU output (with --vtk)
+  bool doc_vtk = CommandLineArgs::command_line_flag_has_been_set("--vtk");
+  PVDFile pvd_file(doc_info.directory() + "/beam_unsteady.pvd");
+
+  // Compressed archive of the state at every timestep (with
+  // --snapshot_archive)
+  CompressedSnapshotWriter* snapshot_archive_pt = 0;
+  if (CommandLineArgs::command_line_flag_has_been_set("--snapshot_archive"))
+  {
+    snapshot_archive_pt = new CompressedSnapshotWriter(
+      doc_info.directory() + "/beam_unsteady_snapshots.bin");
+  }
+  Vector<double> snapshot;
+
+  // Initialise the timestep and assign the history values for an
+  // impulsive start
+  double dt = Global_Physical_Variables::Dt;
+  initialise_dt(dt);
+  assign_initial_values_impulsive(dt);
+
+  unsigned n_step = 0;
+  while (time_pt()->time() < Global_Physical_Variables::T_max)
+  {
+    // Document the trajectory
+    double V = 0.0;
+    double U0 = 0.0;
+    double Theta_eq = 0.0;
+    double X0 = 0.0;
+    double Y0 = 0.0;
+    Rigid_body_element_pt->get_parameters(V, U0, Theta_eq, X0, Y0);
+    trajectory_file << time_pt()->time() << "  " << X0 << "  " << Y0
+                    << "  " << Theta_eq << "  " << U0 << "  " << V << "  "
+                    << Rigid_body_element_pt->angular_velocity()
+                    << std::endl;
+
+    // Archive the state
+    if (snapshot_archive_pt != 0)
+    {
+      get_snapshot(snapshot);
+      snapshot_archive_pt->add_snapshot(time_pt()->time(), snapshot);
+    }
+
+    // Document the beam shape
+    if (n_step % Global_Physical_Variables::Unsteady_doc_interval == 0)
+    {
+      ofstream beam_file;
+      sprintf(filename,
+              "%s/beam_first_arm_unsteady%i.dat",
+              doc_info.directory().c_str(),
+              doc_info.number());
+      beam_file.open(filename);
+      output_beam_mesh(Beam_mesh_first_arm_pt, beam_file, 5);
+      beam_file.close();
+      sprintf(filename,
+              "%s/beam_second_arm_unsteady%i.dat",
+              doc_info.directory().c_str(),
+              doc_info.number());
+      beam_file.open(filename);
+      output_beam_mesh(Beam_mesh_second_arm_pt, beam_file, 5);
+      beam_file.close();
+      if (doc_vtk)
+      {
+        sprintf(filename, "beam_unsteady%i.vtu", doc_info.number());
+        output_vtu(doc_info.directory() + "/" + filename, time_pt()->time());
+        pvd_file.add_dataset(time_pt()->time(), filename);
+      }
+      doc_info.number()++;
+    }
+
+    // Reset the per-step statistics of the Jacobian re-use
+    if (Jacobian_reuse_solver_pt != 0)
+    {
+      Jacobian_reuse_solver_pt->start_new_step();
+    }
+
+    // Take a timestep (repeated with smaller dt if the temporal error
+    // is too large) and get the suggested next timestep
+    dt = adaptive_unsteady_newton_solve(
+      dt, Global_Physical_Variables::Temporal_tolerance);
+
+    // Doc the factorisations saved by re-using the Jacobian
+    if (Jacobian_reuse_solver_pt != 0)
+    {
+      Jacobian_reuse_solver_pt->doc_statistics(oomph_info);
+    }
+
+    oomph_info << "Timestep " << n_step << ": t = " << time_pt()->time()
+               << ", next dt = " << dt << std::endl;
+    n_step++;
+  }
+
+  trajectory_file.close();
+  if (snapshot_archive_pt != 0)
+  {
+    oomph_info << "Snapshot archive: " << snapshot_archive_pt->n_raw_byte()
+               << " bytes of state in "
+               << snapshot_archive_pt->n_compressed_byte() << " bytes"
+               << std::endl;
+    delete snapshot_archive_pt;
+  }
+}
+
+
+//=======start_of_steady_solve=============================================
+/// Solve for the specified value of I by (natural parameter) continuation
+/// from I = 0
+//=========================================================================
+void ElasticBeamProblem::steady_solve(const double& i_target)
+{
+  // Without the beam meshes the drag and torque vanish identically and
+  // the rigid body parameters are arbitrary
+  if (Rigid_body_element_pt->nbeam_mesh() == 0)
+  {
+    throw OomphLibError("The RigidBodyElement has no beam meshes",
+                        OOMPH_CURRENT_FUNCTION,
+                        OOMPH_EXCEPTION_LOCATION);
+  }
+
+  Max_n_linear_solver_iteration = 0;
+  unsigned n_step = std::max(Global_Physical_Variables::N_steady_step, 1u);
+  for (unsigned k = 0; k <= n_step; k++)
+  {
+    Global_Physical_Variables::I = i_target * double(k) / double(n_step);
+    if (Jacobian_reuse_solver_pt != 0)
+    {
+      Jacobian_reuse_solver_pt->start_new_step();
+    }
+    newton_solve();
+    if (Jacobian_reuse_solver_pt != 0)
+    {
+      Jacobian_reuse_solver_pt->doc_statistics(oomph_info);
+    }
+  }
+
+  // Doc the cost of the linear solves if they're iterative
+  if (dynamic_cast<IterativeLinearSolver*>(linear_solver_pt()) != 0)
+  {
+    oomph_info << "Max. number of linear solver iterations: "
+               << Max_n_linear_solver_iteration << std::endl;
+  }
+
+} // end of steady_solve
+
+
+//=======start_of_parameter_study==========================================
+/// Solver loop to perform parameter study
+//=========================================================================
+void ElasticBeamProblem::parameter_study()
+{
+  // Over-ride the default maximum value for the residuals
+  // Problem::Max_residuals = 1.0e10;
+  // Problem::Max_newton_iterations = 20;
+  Problem::Always_take_one_newton_step = true;
+  Problem::Scale_arc_length = false;
+  Problem::Theta_squared = 0.3;
+
+  // Create label for output
+  DocInfo doc_info;
+
+  // Set output directory -- this function checks if the output
+  // directory exists and issues a warning if it doesn't.
+  doc_info.set_directory("RESLT");
+
+  // Output file stream used for writing results
+  ofstream file;
+
+  // String used for the filename
+  char filename[100];
+
+  // Write the file name
+  sprintf(filename,
+          "RESLT/elastic_beam_I_theta_s_%.3f_alpha_%.3fpi_initial_%.2f.dat",
+          Global_Physical_Variables::Q,
+          Global_Physical_Variables::Alpha / acos(-1.0),
+          Global_Physical_Variables::Initial_value_for_theta_eq);
+  file.open(filename);
+
+  // Counter to record the iterations for the while loop
+  unsigned counter = 0;
+
+  // Initialize the value of backup for dofs
+  DoubleVector dofs_backup;
+
+  // Series of the VTU output over the continuation steps (with --vtk)
+  bool doc_vtk = CommandLineArgs::command_line_flag_has_been_set("--vtk");
+  PVDFile pvd_file(doc_info.directory() + "/beam_continuation.pvd");
+
+  // Compressed archive of the state at every continuation step (with
+  // --snapshot_archive; the snapshots are labelled by I)
+  CompressedSnapshotWriter* snapshot_archive_pt = 0;
+  if (CommandLineArgs::command_line_flag_has_been_set("--snapshot_archive"))
+  {
+    snapshot_archive_pt = new CompressedSnapshotWriter(
+      doc_info.directory() + "/beam_continuation_snapshots.bin");
+  }
+  Vector<double> snapshot;
+
+  // Keep the archived snapshots to check that they are recovered
+  // bitwise-exactly from the archive (with --check_snapshot_archive)
+  bool check_snapshot_archive =
+    CommandLineArgs::command_line_flag_has_been_set("--check_snapshot_archive");
+  Vector<double> archived_label;
+  Vector<Vector<double>> archived_snapshot;
+
+  // Growth rates of the orientation at every continuation step (with
+  // --stability)
+  ofstream stability_file;
+  if (CommandLineArgs::command_line_flag_has_been_set("--stability"))
+  {
+    sprintf(filename, "%s/stability.dat", doc_info.directory().c_str());
+    stability_file.open(filename);
+  }
+
+
+  // Loop over different values for Non-dimensional coefficient (FSI) I by
+  // using arclength increment
+  // The loop stops when I becomes negative since only positive values of I are
+  // considered (or after the max. number of continuation steps, if set).
+  double I_backup = 0.0;
+  double ds = 0.0;
+  while ((Global_Physical_Variables::I >= 0.0) &&
+         ((Global_Physical_Variables::Max_continuation_steps == 0) ||
+          (counter < Global_Physical_Variables::Max_continuation_steps)))
+  {
+    // Get the dofs
+    Problem::get_dofs(dofs_backup);
+
+    // Reset the per-step statistics of the Jacobian re-use
+    if (Jacobian_reuse_solver_pt != 0)
+    {
+      Jacobian_reuse_solver_pt->start_new_step();
+    }
+
+    try
+    {
+      if (counter == 0)
+      {
+        // Solve the system
+        newton_solve();
+      }
+      else
+      {
+        // Backup the FSI coefficient I
+        I_backup = Global_Physical_Variables::I;
+
+        // To prevent large solution jumps in critical intervals for I, try to
+        // reduce ds specifically in those areas for smoother and more precise
+        // results
+
+        // First I interval [Interval1_start,Interval1_end]
+        if (Global_Physical_Variables::Ds_default >
+              Global_Physical_Variables::Ds_interval1 &&
+            Global_Physical_Variables::I >=
+              Global_Physical_Variables::Interval1_start &&
+            Global_Physical_Variables::I <=
+              Global_Physical_Variables::Interval1_end)
+        {
+          ds = Global_Physical_Variables::Ds_interval1;
+        }
+        // Second I interval [Interval2_start,Interval2_end]
+        else if (Global_Physical_Variables::Ds_default >
+                   Global_Physical_Variables::Ds_interval2 &&
+                 Global_Physical_Variables::I >=
+                   Global_Physical_Variables::Interval2_start &&
+                 Global_Physical_Variables::I <=
+                   Global_Physical_Variables::Interval2_end)
+        {
+          ds = Global_Physical_Variables::Ds_interval2;
+        }
+        else
+        {
+          // Use the default one
+          ds = Global_Physical_Variables::Ds_default;
+        }
+
+        /// Use the arclength solve
+        ds = arc_length_step_solve(&Global_Physical_Variables::I, ds);
+      }
+
+      // Doc the factorisations saved by re-using the Jacobian
+      if (Jacobian_reuse_solver_pt != 0)
+      {
+        Jacobian_reuse_solver_pt->doc_statistics(oomph_info);
+      }
+
+      // Move the nodes to follow the deformation?
+      if ((Global_Physical_Variables::R_adapt_interval > 0) &&
+          (counter > 0) &&
+          (counter % Global_Physical_Variables::R_adapt_interval == 0))
+      {
+        r_adapt();
+      }
+
+      // Document I
+      file << Global_Physical_Variables::I << "  ";
+
+      // Document the solution of Theta_eq, Theta_eq_orientation
+      Rigid_body_element_pt->output(file);
+
+      // Document maximum residuals at start and after each newton iteration
+      file << Problem::Max_res[0] << "  ";
+
+      // Document actual number of Newton iterations taken during the most
+      // recent iteration
+      file << Problem::Nnewton_iter_taken << "  ";
+
+      // Step label
+      file << counter << std::endl;
+
+      // Output file stream used for writing results
+      ofstream file1;
+      ofstream file2;
+      ofstream file3;
+
+      // Document the solution (first arm)
+      sprintf(filename,
+              "RESLT/beam_first_arm_initial_%.2f_%d.dat",
+              Global_Physical_Variables::Initial_value_for_theta_eq,
+              counter);
+      file1.open(filename);
+      output_beam_mesh(Beam_mesh_first_arm_pt, file1, 5);
+      file1.close();
+
+      // Document the solution in VTU format (for ParaView; the PVD file
+      // uses I as the "time")
+      if (doc_vtk)
+      {
+        sprintf(filename, "beam_continuation%i.vtu", counter);
+        output_vtu(doc_info.directory() + "/" + filename,
+                   Global_Physical_Variables::I);
+        pvd_file.add_dataset(Global_Physical_Variables::I, filename);
+      }
+
+      // Archive the state (compressed, restart-grade)
+      if (snapshot_archive_pt != 0)
+      {
+        get_snapshot(snapshot);
+        snapshot_archive_pt->add_snapshot(Global_Physical_Variables::I,
+                                          snapshot);
+        if (check_snapshot_archive)
+        {
+          archived_label.push_back(Global_Physical_Variables::I);
+          archived_snapshot.push_back(snapshot);
+        }
+      }
+
+      // Keep the solution for warm starts of later runs
+      store_in_solution_cache();
+
+      // Stability of the solution
+      doc_stability(stability_file);
+
+      // Document the solution (second arm)
+      sprintf(filename,
+              "RESLT/beam_second_arm_initial_%.2f_%d.dat",
+              Global_Physical_Variables::Initial_value_for_theta_eq,
+              counter);
+      file2.open(filename);
+      output_beam_mesh(Beam_mesh_second_arm_pt, file2, 5);
+      file2.close();
+
+      // Write restart file
+      sprintf(filename, "RESLT/restart%i.dat", counter);
+      file2.open(filename);
+      dump_it(file2);
+      file2.close();
+
+      // Bump counter for output
+      counter = counter + 1;
+    }
+    catch (...)
+    {
+      // If the initial values are not appropriate, the newton method cannot
+      // converge at the starting point I=0.0
+      if (counter == 0)
+      {
+        oomph_info
+          << "Initial values for I=0.0 are not appropriate. Please modify them!"
+          << std::endl;
+        break;
+      }
+      else
+      {
+        // Check if default ds is small enough
+        if (Global_Physical_Variables::Ds_default < 1.0e-8)
+        {
+          // Since the default is not small enough, assign a smaller value
+          Global_Physical_Variables::Ds_default = 1.0e-8;
+
+          // Since the newton method cannot converge in this turn, overwrite the
+          // failed I value
+          Global_Physical_Variables::I = I_backup;
+        }
+        else
+        {
+          // If default ds is already small enough, it means there is no
+          // solution any more
+          break;
+        }
+      }
+
+      // Reset the dofs
+      Problem::set_dofs(dofs_backup);
+    }
+  }
+  file.close();
+  stability_file.close();
+  if (snapshot_archive_pt != 0)
+  {
+    oomph_info << "Snapshot archive: " << snapshot_archive_pt->n_raw_byte()
+               << " bytes of state in "
+               << snapshot_archive_pt->n_compressed_byte() << " bytes"
+               << std::endl;
+    delete snapshot_archive_pt;
+
+    // Read the archive back and compare with the archived snapshots
+    if (check_snapshot_archive)
+    {
+      CompressedSnapshotReader reader(doc_info.directory() +
+                                      "/beam_continuation_snapshots.bin");
+      unsigned n_snapshot = archived_snapshot.size();
+      unsigned n_mismatch = 0;
+      double label = 0.0;
+      for (unsigned s = 0; s < n_snapshot; s++)
+      {
+        if (!reader.read_next_snapshot(label, snapshot))
+        {
+          std::ostringstream error_message;
+          error_message << "Snapshot archive holds only " << s << " of "
+                        << n_snapshot << " snapshots" << std::endl;
+          throw OomphLibError(error_message.str(),
+                              OOMPH_CURRENT_FUNCTION,
+                              OOMPH_EXCEPTION_LOCATION);
+        }
+        bool match = (SnapshotModel::bits(label) ==
+                      SnapshotModel::bits(archived_label[s])) &&
+                     (snapshot.size() == archived_snapshot[s].size());
+        unsigned n_value = snapshot.size();
+        for (unsigned i = 0; match && (i < n_value); i++)
+        {
+          match = (SnapshotModel::bits(snapshot[i]) ==
+                   SnapshotModel::bits(archived_snapshot[s][i]));
+        }
+        if (!match)
+        {
+          n_mismatch++;
+        }
+      }
+      if (reader.read_next_snapshot(label, snapshot))
+      {
+        throw OomphLibError("Snapshot archive holds surplus snapshots",
+                            OOMPH_CURRENT_FUNCTION,
+                            OOMPH_EXCEPTION_LOCATION);
+      }
+      oomph_info << "Snapshot archive: " << n_snapshot - n_mismatch << " of "
+                 << n_snapshot << " snapshots recovered bitwise-exactly"
+                 << std::endl;
+      if (n_mismatch > 0)
+      {
+        throw OomphLibError("Snapshots differ from the archived ones",
+                            OOMPH_CURRENT_FUNCTION,
+                            OOMPH_EXCEPTION_LOCATION);
+      }
+    }
+  }
+
+
+} // end of parameter study
+
+//======start_of_namespace=================================================
+/// Richardson extrapolation of the results (the quantities documented by
+/// RigidBodyElement::output(...)) obtained on meshes with n, 2n and 4n
+/// elements per arm.
+//=========================================================================
+namespace RichardsonExtrapolation
+{
+  /// Order of convergence that is assumed if the observed order cannot
+  /// be determined (non-monotonic convergence)
+  double Formal_order = 4.0;
+
+  /// Safety factor for the error bar, as in Roache's grid convergence
+  /// index for three-mesh studies
+  double Safety_factor = 1.25;
+
+  /// Given the values of a quantity on the coarse, medium and fine
+  /// meshes (mesh size halved each time), compute the observed order of
+  /// convergence, the extrapolated value and its error bar (the
+  /// estimated error of the fine-mesh value, scaled by the safety factor).
+  /// Returns false if the convergence is not monotonic and the formal
+  /// order has been used instead.
+  bool extrapolate(const double& q_coarse,
+                   const double& q_medium,
+                   const double& q_fine,
+                   double& order,
+                   double& q_extrapolated,
+                   double& error_bar)
+  {
+    bool monotonic = false;
+    order = Formal_order;
+    double diff_coarse = q_coarse - q_medium;
+    double diff_fine = q_medium - q_fine;
+    if ((diff_fine != 0.0) && (diff_coarse / diff_fine > 1.0))
+    {
+      order = log(diff_coarse / diff_fine) / log(2.0);
+      monotonic = true;
+    }
+    else if ((diff_fine == 0.0) && (diff_coarse == 0.0))
+    {
+      // Converged to machine precision
+      monotonic = true;
+    }
+    q_extrapolated = q_fine + (q_fine - q_medium) / (pow(2.0, order) - 1.0);
+    error_bar = Safety_factor * fabs(q_extrapolated - q_fine);
+    return monotonic;
+  }
+
+
+  /// Name of the file that contains the results for n_element elements
+  std::string result_filename(const unsigned& n_element)
+  {
+    std::ostringstream filename;
+    filename << "RESLT/richardson_n" << n_element << ".dat";
+    return filename.str();
   }
 
 
-  /// 2nd derivative of position Vector w.r.t. to coordinates:
-  /// \f$ \frac{d^2R_i}{d \zeta_\alpha d \zeta_\beta}\f$ =
-  /// ddrdzeta(alpha,beta,i). Evaluated at current time.
-  virtual void d2position(const Vector<double>& zeta,
-                          RankThreeTensor<double>& ddrdzeta) const
+  /// Solve the problem with n_element elements per arm (stepping I up
+  /// from zero to its current value) and write the quantities documented
+  /// by RigidBodyElement::output(...) to file
+  void solve(const unsigned& n_element)
   {
-    // Derivative of tangent vector
-    ddrdzeta(0, 0, 0) = 0.0;
-    ddrdzeta(0, 0, 1) = 0.0;
+    double i_target = Global_Physical_Variables::I;
+    ElasticBeamProblem problem(n_element, n_element);
+    problem.steady_solve(i_target);
+
+    std::ofstream file(result_filename(n_element).c_str());
+    file.precision(16);
+    problem.rigid_body_element_pt()->output(file);
+    file << std::endl;
+    file.close();
   }
 
 
-  /// Posn Vector and its  1st & 2nd derivatives
-  /// w.r.t. to coordinates:
-  /// \f$ \frac{dR_i}{d \zeta_\alpha}\f$ = drdzeta(alpha,i).
-  /// \f$ \frac{d^2R_i}{d \zeta_\alpha d \zeta_\beta}\f$ =
-  /// ddrdzeta(alpha,beta,i).
-  /// Evaluated at current time.
-  virtual void d2position(const Vector<double>& zeta,
-                          Vector<double>& r,
-                          DenseMatrix<double>& drdzeta,
-                          RankThreeTensor<double>& ddrdzeta) const
+  /// Solve on meshes with n_element, 2 n_element and 4 n_element elements
+  /// per arm (in parallel processes where possible), then document the
+  /// observed order and the extrapolated quantities
+  void run(const unsigned& n_element)
   {
-    // Position Vector
-    r[0] = 0.0;
-    r[1] = zeta[0] * Stretch_ratio;
+    unsigned n_level = 3;
+    Vector<unsigned> n_element_level(n_level);
+    for (unsigned l = 0; l < n_level; l++)
+    {
+      n_element_level[l] = n_element << l;
+    }
 
-    // Tangent vector
-    drdzeta(0, 0) = 0.0;
-    drdzeta(0, 1) = Stretch_ratio;
+    // Launch one process per mesh; solve in-process if we can't fork
+    std::cout.flush();
+    Vector<pid_t> pid(n_level, -1);
+    for (unsigned l = 0; l < n_level; l++)
+    {
+      pid[l] = fork();
+      if (pid[l] == 0)
+      {
+        // Child: Keep its log separate
+        std::ostringstream log_filename;
+        log_filename << "RESLT/richardson_n" << n_element_level[l]
+                     << "_log.dat";
+        std::ofstream log_file(log_filename.str().c_str());
+        oomph_info.stream_pt() = &log_file;
+        int status = 0;
+        try
+        {
+          solve(n_element_level[l]);
+        }
+        catch (std::exception& error)
+        {
+          log_file << error.what() << std::endl;
+          status = 1;
+        }
+        log_file.close();
+        _exit(status);
+      }
+      else if (pid[l] < 0)
+      {
+        oomph_info << "Couldn't fork; solving with " << n_element_level[l]
+                   << " elements in this process" << std::endl;
+        solve(n_element_level[l]);
+      }
+    }
 
-    // Derivative of tangent vector
-    ddrdzeta(0, 0, 0) = 0.0;
-    ddrdzeta(0, 0, 1) = 0.0;
+    // Wait for the children
+    for (unsigned l = 0; l < n_level; l++)
+    {
+      if (pid[l] > 0)
+      {
+        int status = 0;
+        waitpid(pid[l], &status, 0);
+        if (!WIFEXITED(status) || (WEXITSTATUS(status) != 0))
+        {
+          std::ostringstream error_message;
+          error_message << "Solve with " << n_element_level[l]
+                        << " elements failed; see "
+                        << "RESLT/richardson_n" << n_element_level[l]
+                        << "_log.dat" << std::endl;
+          throw OomphLibError(error_message.str(),
+                              OOMPH_CURRENT_FUNCTION,
+                              OOMPH_EXCEPTION_LOCATION);
+        }
+      }
+    }
+
+    // Read the results
+    Vector<Vector<double>> result(n_level);
+    for (unsigned l = 0; l < n_level; l++)
+    {
+      std::ifstream file(result_filename(n_element_level[l]).c_str());
+      double value = 0.0;
+      while (file >> value)
+      {
+        result[l].push_back(value);
+      }
+      file.close();
+    }
+
+    // Extrapolate and document
+    const char* label[5] = {
+      "Theta_eq", "Theta_eq_orientation", "drag_x", "drag_y", "torque"};
+    std::ofstream file("RESLT/richardson.dat");
+    file.precision(16);
+    file << "# quantity  n=" << n_element_level[0]
+         << "  n=" << n_element_level[1] << "  n=" << n_element_level[2]
+         << "  observed_order  extrapolated  error_bar" << std::endl;
+    oomph_info << "\nRichardson extrapolation for I = "
+               << Global_Physical_Variables::I << ":\n";
+    unsigned n_quantity = result[0].size();
+    for (unsigned i = 0; i < n_quantity; i++)
+    {
+      double order = 0.0;
+      double q_extrapolated = 0.0;
+      double error_bar = 0.0;
+      bool monotonic = extrapolate(result[0][i],
+                                   result[1][i],
+                                   result[2][i],
+                                   order,
+                                   q_extrapolated,
+                                   error_bar);
+
+      std::string name = "quantity";
+      if (i < 5) name = label[i];
+      file << name << "  " << result[0][i] << "  " << result[1][i] << "  "
+           << result[2][i] << "  " << order << "  " << q_extrapolated << "  "
+           << error_bar << std::endl;
+      oomph_info << name << " = " << q_extrapolated << " +/- " << error_bar
+                 << " (order " << order;
+      if (!monotonic)
+      {
+        oomph_info << "; non-monotonic convergence, formal order assumed";
+      }
+      oomph_info << ")" << std::endl;
+    }
+    file.close();
   }
 
-private:
-  /// Define the length of the beam
-  double Stretch_ratio;
-};
+} // namespace RichardsonExtrapolation
 
 
-//=============start_of_constructor=====================================
-/// Constructor for elastic beam problem
-//======================================================================
-ElasticBeamProblem::ElasticBeamProblem(const unsigned& n_elem1,
-                                       const unsigned& n_elem2)
+//=======start_of_r_adapt==================================================
+/// Move the nodes of the beam meshes to equidistribute the curvature-based
+/// monitor function (separately for each arm), interpolating the current
+/// solution. The number of dofs (and the equation numbering) is unchanged.
+//=========================================================================
+void ElasticBeamProblem::r_adapt()
 {
-  // Drift speed and acceleration of horizontal motion
-  double v = 0.0;
+  Vector<SolidMesh*> mesh_pt = beam_mesh_pt();
+  for (unsigned m = 0; m < 2; m++)
+  {
+    GradedOneDLagrangianMesh<HaoHermiteBeamElement>* arm_mesh_pt =
+      dynamic_cast<GradedOneDLagrangianMesh<HaoHermiteBeamElement>*>(
+        mesh_pt[m]);
+
+    // Tabulate the monitor function for the current solution
+    unsigned n_sample_per_element = 4;
+    Vector<double> xi_sample;
+    Vector<double> monitor;
+    arm_mesh_pt->get_curvature_monitor(
+      Global_Physical_Variables::Monitor_weight,
+      n_sample_per_element,
+      xi_sample,
+      monitor);
+
+    // Move the nodes (the mesh doesn't retain the grading)
+    EquidistributingOneDMeshGrading grading(xi_sample, monitor);
+    arm_mesh_pt->redistribute_nodes(&grading);
+
+    // Ratio of largest to smallest element
+    double h_min = std::numeric_limits<double>::max();
+    double h_max = 0.0;
+    unsigned n_element = arm_mesh_pt->nelement();
+    for (unsigned e = 0; e < n_element; e++)
+    {
+      FiniteElement* el_pt = arm_mesh_pt->finite_element_pt(e);
+      double h = static_cast<SolidNode*>(el_pt->node_pt(1))->xi(0) -
+                 static_cast<SolidNode*>(el_pt->node_pt(0))->xi(0);
+      h_min = std::min(h_min, h);
+      h_max = std::max(h_max, h);
+    }
+    oomph_info << "r-adapted beam mesh (arm " << m + 1
+               << ") at I = " << Global_Physical_Variables::I
+               << "; ratio of largest to smallest element: " << h_max / h_min
+               << std::endl;
+  }
 
-  // Speed of horizontal motion
-  double u0 = 0.0;
+  // The Lagrangian coordinates at the integration points have changed
+  Integration_point_cache_first_arm_pt->build();
+  Integration_point_cache_second_arm_pt->build();
 
-  // Beam's inclination
-  double theta_eq = Global_Physical_Variables::Initial_value_for_theta_eq;
+  // The dofs now refer to different material points so the stored
+  // derivatives w.r.t. the arclength are meaningless: Restart the
+  // continuation (with the current step size) from here
+  double theta_squared = Problem::Theta_squared;
+  reset_arc_length_parameters();
+  Problem::Theta_squared = theta_squared;
 
-  // x position of clamped point
-  double x0 = 0.0;
+  // ...and the Jacobian
+  if (Jacobian_reuse_solver_pt != 0)
+  {
+    Jacobian_reuse_solver_pt->force_refresh();
+  }
 
-  // y position of clamped point
-  double y0 = 0.0;
+} // end of r_adapt
 
-  // Make the RigidBodyElement that stores the parameters for the rigid body
-  // motion
-  Rigid_body_element_pt = new RigidBodyElement(v, u0, theta_eq, x0, y0);
 
-  // Add the rigid body element to its own mesh
-  Rigid_body_element_mesh_pt = new Mesh;
-  Rigid_body_element_mesh_pt->add_element_pt(Rigid_body_element_pt);
+//=========================================================================
+/// Suspension of interacting elastic boomerangs that sediment in a
+/// viscous fluid: Each particle has its own RigidBodyElement and two arm
+/// meshes, set up as in the ElasticBeamProblem (the second arm is
+/// rotated by the opening angle Alpha); the particles interact
+/// hydrodynamically through the (shared) nonlocal slender body
+/// operator. The interactions are lagged (updated before each Newton
+/// convergence check) so the Jacobian is block-diagonal with one block
+/// per particle and the Newton systems are solved particle by particle
+/// with the ParticleBlockDiagonalSolver.
+//=========================================================================
+class BoomerangSuspensionProblem : public Problem
+{
+public:
+  /// Constructor: Pass the number of particles and the number of
+  /// elements per arm
+  BoomerangSuspensionProblem(const unsigned& n_particle,
+                             const unsigned& n_elem);
+
+  /// Compute the time-dependent sedimentation of the suspension with
+  /// adaptive BDF2 timestepping
+  void unsteady_run();
+
+  /// Global temporal error norm for the adaptive timestepping: RMS of
+  /// the estimated errors in the orientations and positions of all
+  /// particles
+  double global_temporal_error_norm()
+  {
+    double global_error = 0.0;
+    unsigned n_error = 0;
+    unsigned n_particle = Rigid_body_element_pt.size();
+    for (unsigned p = 0; p < n_particle; p++)
+    {
+      for (unsigned i = 2; i < 5; i++)
+      {
+        Data* data_pt = Rigid_body_element_pt[p]->internal_data_pt(i);
+        if (!data_pt->is_pinned(0))
+        {
+          double error =
+            data_pt->time_stepper_pt()->temporal_error_in_value(data_pt, 0);
+          global_error += error * error;
+          n_error++;
+        }
+      }
+    }
+    if (n_error > 0)
+    {
+      global_error /= double(n_error);
+    }
+    return sqrt(global_error);
+  }
 
-  // Set the undeformed beam shape for two arms (in the reference orientation
-  // before applying the rigid body motion)
-  // Undef_beam_pt = new StraightLineVertical();
+  /// No actions need to be performed after a solve
+  void actions_after_newton_solve() {}
 
-  // Aspect ratio to determine the length of the beam
-  // first arm length = |q+0.5|, second arm length = |q-0.5|
-  double* q_pt = &Global_Physical_Variables::Q;
+  /// No actions need to be performed before a solve
+  void actions_before_newton_solve() {}
 
-  // Set for test! Switch between old and new code
-  bool old_version = false;
-  if (CommandLineArgs::command_line_flag_has_been_set("--old_version"))
+  /// Update the (lagged) velocity induced by all particles for the
+  /// current configuration before each Newton convergence check
+  void actions_before_newton_convergence_check()
   {
-    old_version = true;
+    unsigned n_particle = Rigid_body_element_pt.size();
+    for (unsigned p = 0; p < n_particle; p++)
+    {
+      Rigid_body_element_pt[p]->get_nonlocal_slender_body_data(
+        Traction_batch, Arm_theta, Arm_shift_x, Arm_shift_y, Arm_element_pt);
+    }
+    Nonlocal_operator_pt->update(
+      Traction_batch, Arm_theta, Arm_shift_x, Arm_shift_y, Arm_element_pt);
   }
 
-  // Assign values to the stretch_ratio and length_1 for different versions of
-  // the code
-  double stretch_ratio = 0.0;
-  double length_1 = 0.0;
-  if (old_version == false)
-  {
-    // New code
-    stretch_ratio = *q_pt + 0.5;
-    length_1 = 1.0;
-  }
-  else
+private:
+  /// The beam meshes (first and second arm) of particle p
+  Vector<SolidMesh*> beam_mesh_pt(const unsigned& p)
   {
-    // Old code
-    stretch_ratio = 1.0;
-    length_1 = *q_pt + 0.5;
+    Vector<SolidMesh*> mesh_pt(2);
+    mesh_pt[0] = Beam_mesh_pt[p][0];
+    mesh_pt[1] = Beam_mesh_pt[p][1];
+    return mesh_pt;
   }
-  // Set the undeformed beam shape
-  Undef_beam_pt1 = new NewStraightLineVertical(stretch_ratio);
-  // Undef_beam_pt2 = new StraightLineVertical_new(fabs(*stretch_ratio_pt -
-  // 0.5));
-
-  // Create the (Lagrangian!) mesh, using the StraightLineVertical object
-  // Undef_beam_pt to specify the initial (Eulerian) position of the
-  // nodes. (first arm)
-  // double length_1 = fabs(*q_pt + 0.5);
-  // double length_1 = 1.0;
-  Beam_mesh_first_arm_pt = new OneDLagrangianMesh<HaoHermiteBeamElement>(
-    n_elem1, length_1, Undef_beam_pt1);
-
-  // // Create the (Lagrangian!) mesh, using the StraightLineVertical object
-  // // Undef_beam_pt to specify the initial (Eulerian) position of the
-  // // nodes. (second arm)
-  // // double length_2 = fabs(*q_pt - 0.5);
-  // double length_2 = 1.0;
-  // Beam_mesh_second_arm_pt = new OneDLagrangianMesh<HaoHermiteBeamElement>(
-  //   n_elem2, length_2, Undef_beam_pt2);
-
-  // // Pass the pointer of the mesh to the RigidBodyElement class
-  // // so it can work out the drag and torque on the entire structure
-  // Vector<SolidMesh*> Beam_mesh_pt(2);
-  // Beam_mesh_pt[0] = Beam_mesh_first_arm_pt;
-  // Beam_mesh_pt[1] = Beam_mesh_second_arm_pt;
-  // Rigid_body_element_pt->set_pointer_to_beam_meshes(Beam_mesh_pt);
 
-  // Build the problem's global mesh
-  add_sub_mesh(Beam_mesh_first_arm_pt);
-  // add_sub_mesh(Beam_mesh_second_arm_pt);
-  // add_sub_mesh(Rigid_body_element_mesh_pt);
-  build_global_mesh();
+  /// Pointers to geometric objects that represent the undeformed shapes
+  /// of the first and second arm (the same for all particles)
+  Vector<GeomObject*> Undef_beam_pt;
 
-  // Set the boundary conditions: One end of the beam is clamped in space
-  // Pin displacements in both x and y directions, and pin the derivative of
-  // position Vector w.r.t. to coordinates in x direction. (first arm)
-  Beam_mesh_first_arm_pt->boundary_node_pt(0, 0)->pin_position(0);
-  Beam_mesh_first_arm_pt->boundary_node_pt(0, 0)->pin_position(1);
-  Beam_mesh_first_arm_pt->boundary_node_pt(0, 0)->pin_position(1, 0);
+  /// Pointers to the RigidBodyElements of the particles
+  Vector<RigidBodyElement*> Rigid_body_element_pt;
 
-  // Find number of elements in the mesh (first arm)
-  unsigned n_element = Beam_mesh_first_arm_pt->nelement();
+  /// Pointers to the particles' beam meshes: [particle][arm]
+  Vector<Vector<GradedOneDLagrangianMesh<HaoHermiteBeamElement>*>>
+    Beam_mesh_pt;
 
-  // Loop over the elements to set physical parameters etc. (first arm)
-  for (unsigned e = 0; e < n_element; e++)
-  {
-    // Upcast to the specific element type
-    HaoHermiteBeamElement* elem_pt = dynamic_cast<HaoHermiteBeamElement*>(
-      Beam_mesh_first_arm_pt->element_pt(e));
+  /// Pointers to the cached integration point data of the beam meshes:
+  /// [particle][arm]
+  Vector<Vector<BeamIntegrationPointCache*>> Integration_point_cache_pt;
 
-    // Pass the pointer of RigidBodyElement to the each element
-    // so we can work out the rigid body motion
-    elem_pt->set_pointer_to_rigid_body_element(Rigid_body_element_pt);
+  /// Pointer to mesh containing the rigid body elements
+  Mesh* Rigid_body_element_mesh_pt;
 
-    // Set physical parameters for each element:
-    elem_pt->h_pt() = &Global_Physical_Variables::H;
-    elem_pt->i_pt() = &Global_Physical_Variables::I;
+  /// Pointer to the nonlocal slender body operator (shared by all
+  /// particles)
+  NonlocalSlenderBodyOperator* Nonlocal_operator_pt;
 
-    // Note: no rotation!
+  /// Pointer to the block-diagonal linear solver
+  ParticleBlockDiagonalSolver* Block_solver_pt;
 
-    // Set the undeformed shape for each element
-    elem_pt->undeformed_beam_pt() = Undef_beam_pt1;
+  /// Workspace for the data passed to the nonlocal slender body operator
+  /// (one entry per arm, i.e. two per particle)
+  Vector<SlenderBodyTractionBatch> Traction_batch;
+  Vector<double> Arm_theta;
+  Vector<double> Arm_shift_x;
+  Vector<double> Arm_shift_y;
+  Vector<Vector<const FiniteElement*>> Arm_element_pt;
 
-  } // end of loop over elements
+}; // end of suspension problem class
 
 
-  // // Set the boundary conditions: One end of the beam is clamped in space
-  // // Pin displacements in both x and y directions, and pin the derivative of
-  // // position Vector w.r.t. to coordinates in x direction. (second arm)
-  // Beam_mesh_second_arm_pt->boundary_node_pt(0, 0)->pin_position(0);
-  // Beam_mesh_second_arm_pt->boundary_node_pt(0, 0)->pin_position(1);
-  // Beam_mesh_second_arm_pt->boundary_node_pt(0, 0)->pin_position(1, 0);
+//=============start_of_constructor=====================================
+/// Constructor for the suspension problem: The particles are placed on
+/// a square lattice with spacing Global_Physical_Variables::
+/// Particle_spacing; their initial orientations are staggered by the
+/// golden angle so no two particles are aligned.
+//======================================================================
+BoomerangSuspensionProblem::BoomerangSuspensionProblem(
+  const unsigned& n_particle, const unsigned& n_elem)
+{
+  // The orientations and positions are always time-dependent
+  add_time_stepper_pt(new BDF<2>(true));
+
+  // All particles interact through the nonlocal slender body operator
+  double kappa =
+    1.0 / (2.0 * log(1.0 / Global_Physical_Variables::Slenderness));
+  Nonlocal_operator_pt = new NonlocalSlenderBodyOperator(
+    kappa, Global_Physical_Variables::Nonlocal_cutoff);
+  Nonlocal_operator_pt->opening_angle() =
+    Global_Physical_Variables::Nonlocal_opening_angle;
+
+  // Undeformed shapes of the arms (in the reference orientation):
+  // first arm length = |q+0.5|, second arm length = |q-0.5|
+  Undef_beam_pt.resize(2);
+  Undef_beam_pt[0] =
+    new NewStraightLineVertical(Global_Physical_Variables::Q + 0.5);
+  Undef_beam_pt[1] =
+    new NewStraightLineVertical(fabs(Global_Physical_Variables::Q - 0.5));
+  double length = 1.0;
+
+  // Layout of the particles
+  unsigned n_side = unsigned(ceil(sqrt(double(n_particle))));
+  double golden_angle = 4.0 * atan(1.0) * (3.0 - sqrt(5.0));
+  double spacing = Global_Physical_Variables::Particle_spacing;
 
-  // // Find number of elements in the mesh (second arm)
-  // n_element = Beam_mesh_second_arm_pt->nelement();
+  Rigid_body_element_mesh_pt = new Mesh;
+  Rigid_body_element_pt.resize(n_particle);
+  Beam_mesh_pt.resize(n_particle);
+  Integration_point_cache_pt.resize(n_particle);
+  for (unsigned p = 0; p < n_particle; p++)
+  {
+    // Make the RigidBodyElement that stores the particle's rigid body
+    // parameters
+    double theta_eq = Global_Physical_Variables::Initial_value_for_theta_eq +
+                      double(p) * golden_angle;
+    double x0 = double(p % n_side) * spacing;
+    double y0 = double(p / n_side) * spacing;
+    Rigid_body_element_pt[p] =
+      new RigidBodyElement(0.0, 0.0, theta_eq, x0, y0, time_stepper_pt());
+    Rigid_body_element_mesh_pt->add_element_pt(Rigid_body_element_pt[p]);
+
+    // Create the (uniform) beam meshes of the two arms
+    Beam_mesh_pt[p].resize(2);
+    Integration_point_cache_pt[p].resize(2);
+    for (unsigned arm = 0; arm < 2; arm++)
+    {
+      Beam_mesh_pt[p][arm] =
+        new GradedOneDLagrangianMesh<HaoHermiteBeamElement>(
+          n_elem, length, Undef_beam_pt[arm], 0);
+      unsigned n_element = Beam_mesh_pt[p][arm]->nelement();
+
+      // Use the compile-time specialised slender body computations
+      // (before the integration point data is cached)
+      if (Global_Physical_Variables::Fixed_quadrature_order != 0)
+      {
+        for (unsigned e = 0; e < n_element; e++)
+        {
+          dynamic_cast<HaoHermiteBeamElement*>(
+            Beam_mesh_pt[p][arm]->element_pt(e))
+            ->set_fixed_quadrature_order(
+              Global_Physical_Variables::Fixed_quadrature_order);
+        }
+      }
+      Integration_point_cache_pt[p][arm] = new BeamIntegrationPointCache(
+        Beam_mesh_pt[p][arm], Undef_beam_pt[arm]);
 
-  // // Loop over the elements to set physical parameters etc. (second arm)
-  // for (unsigned e = 0; e < n_element; e++)
-  // {
-  //   // Upcast to the specific element type
-  //   HaoHermiteBeamElement* elem_pt = dynamic_cast<HaoHermiteBeamElement*>(
-  //     Beam_mesh_second_arm_pt->element_pt(e));
+      // Clamp the arm at the junction
+      Beam_mesh_pt[p][arm]->boundary_node_pt(0, 0)->pin_position(0);
+      Beam_mesh_pt[p][arm]->boundary_node_pt(0, 0)->pin_position(1);
+      Beam_mesh_pt[p][arm]->boundary_node_pt(0, 0)->pin_position(1, 0);
 
-  //   // Pass the pointer of RigidBodyElement to the each element
-  //   // so we can work out the rigid body motion
-  //   elem_pt->set_pointer_to_rigid_body_element(Rigid_body_element_pt);
+      // Set physical parameters etc.
+      for (unsigned e = 0; e < n_element; e++)
+      {
+        HaoHermiteBeamElement* elem_pt = dynamic_cast<HaoHermiteBeamElement*>(
+          Beam_mesh_pt[p][arm]->element_pt(e));
+        elem_pt->set_pointer_to_rigid_body_element(Rigid_body_element_pt[p]);
+        elem_pt->h_pt() = &Global_Physical_Variables::H;
+        elem_pt->i_pt() = &Global_Physical_Variables::I;
+
+        // Rotate the second arm by the opening angle
+        if (arm == 1)
+        {
+          elem_pt->theta_initial_pt(&Global_Physical_Variables::Alpha);
+        }
+        elem_pt->undeformed_beam_pt() = Undef_beam_pt[arm];
+        elem_pt->set_integration_point_cache_pt(
+          Integration_point_cache_pt[p][arm]);
+      }
 
-  //   // Set physical parameters for each element:
-  //   elem_pt->h_pt() = &Global_Physical_Variables::H;
-  //   elem_pt->i_pt() = &Global_Physical_Variables::I;
+      add_sub_mesh(Beam_mesh_pt[p][arm]);
+    }
 
-  //   // Rotate by opening angle
-  //   elem_pt->theta_initial_pt(&Global_Physical_Variables::Alpha);
+    // The drag and torque on the particle depend on its beam meshes
+    Rigid_body_element_pt[p]->set_pointer_to_beam_meshes(beam_mesh_pt(p));
 
-  //   // Set the undeformed shape for each element
-  //   elem_pt->undeformed_beam_pt() = Undef_beam_pt2;
+    // The particle's arms are arms 2p and 2p+1 of the nonlocal operator
+    Rigid_body_element_pt[p]->set_nonlocal_operator_pt(Nonlocal_operator_pt,
+                                                       2 * p);
+  }
 
-  // } // end of loop over elements
+  // Build the problem's global mesh
+  add_sub_mesh(Rigid_body_element_mesh_pt);
+  build_global_mesh();
 
   // Assign the global and local equation numbers
   cout << "# of dofs " << assign_eqn_numbers() << std::endl;
 
+  // Solve the (block-diagonal) Newton systems particle by particle
+  Block_solver_pt = new ParticleBlockDiagonalSolver(this);
+  for (unsigned p = 0; p < n_particle; p++)
+  {
+    Vector<Mesh*> mesh_pt(2);
+    mesh_pt[0] = Beam_mesh_pt[p][0];
+    mesh_pt[1] = Beam_mesh_pt[p][1];
+    Block_solver_pt->add_particle(mesh_pt, Rigid_body_element_pt[p]);
+  }
+  if (!CommandLineArgs::command_line_flag_has_been_set(
+        "--particle_direct_solver"))
+  {
+    linear_solver_pt() = Block_solver_pt;
+  }
+
 } // end of constructor
 
 
-//=======start_of_parameter_study==========================================
-/// Solver loop to perform parameter study
+//=======start_of_unsteady_run=============================================
+/// Compute the time-dependent sedimentation of the suspension from its
+/// initial configuration (impulsive start) with adaptive BDF2 timesteps
 //=========================================================================
-void ElasticBeamProblem::parameter_study()
+void BoomerangSuspensionProblem::unsteady_run()
 {
-  // Over-ride the default maximum value for the residuals
-  // Problem::Max_residuals = 1.0e10;
-  // Problem::Max_newton_iterations = 20;
-  Problem::Always_take_one_newton_step = true;
-  Problem::Scale_arc_length = false;
-  Problem::Theta_squared = 0.3;
-
   // Create label for output
   DocInfo doc_info;
 
-  // Set output directory -- this function checks if the output
-  // directory exists and issues a warning if it doesn't.
+  // Set output directory
   doc_info.set_directory("RESLT");
 
-  // Output file stream used for writing results
-  ofstream file;
-
-  // String used for the filename
+  // Trajectories of the particles: t, particle, X0, Y0, Theta_eq, U0, V,
+  // Omega
+  ofstream trajectory_file;
   char filename[100];
+  sprintf(
+    filename, "%s/suspension_trajectory.dat", doc_info.directory().c_str());
+  trajectory_file.open(filename);
+
+  // Time series of the VTU output (with --vtk)
+  bool doc_vtk = CommandLineArgs::command_line_flag_has_been_set("--vtk");
+  PVDFile pvd_file(doc_info.directory() + "/suspension.pvd");
+
+  // Initialise the timestep and assign the history values for an
+  // impulsive start
+  double dt = Global_Physical_Variables::Dt;
+  initialise_dt(dt);
+  assign_initial_values_impulsive(dt);
+
+  unsigned n_particle = Rigid_body_element_pt.size();
+  unsigned n_step = 0;
+  while (time_pt()->time() < Global_Physical_Variables::T_max)
+  {
+    // Document the trajectories
+    for (unsigned p = 0; p < n_particle; p++)
+    {
+      double V = 0.0;
+      double U0 = 0.0;
+      double Theta_eq = 0.0;
+      double X0 = 0.0;
+      double Y0 = 0.0;
+      Rigid_body_element_pt[p]->get_parameters(V, U0, Theta_eq, X0, Y0);
+      trajectory_file << time_pt()->time() << "  " << p << "  " << X0
+                      << "  " << Y0 << "  " << Theta_eq << "  " << U0
+                      << "  " << V << "  "
+                      << Rigid_body_element_pt[p]->angular_velocity()
+                      << std::endl;
+    }
 
-  // // Write the file name
-  // sprintf(filename,
-  //         "RESLT/elastic_beam_I_theta_s_%.3f_alpha_%.3fpi_initial_%.2f.dat",
-  //         Global_Physical_Variables::Q,
-  //         Global_Physical_Variables::Alpha / acos(-1.0),
-  //         Global_Physical_Variables::Initial_value_for_theta_eq);
-  // file.open(filename);
-
-  // Counter to record the iterations for the while loop
-  unsigned counter = 0;
+    // Document the beam shapes
+    if (n_step % Global_Physical_Variables::Unsteady_doc_interval == 0)
+    {
+      ofstream beam_file;
+      sprintf(filename,
+              "%s/suspension_beams%i.dat",
+              doc_info.directory().c_str(),
+              doc_info.number());
+      beam_file.open(filename);
+      for (unsigned p = 0; p < n_particle; p++)
+      {
+        output_beam_mesh(Beam_mesh_pt[p][0], beam_file, 5);
+        output_beam_mesh(Beam_mesh_pt[p][1], beam_file, 5);
+      }
+      beam_file.close();
 
-  // Initialize the value of backup for dofs
-  DoubleVector dofs_backup;
+      // All particles and their rigid body states in one VTU file
+      if (doc_vtk)
+      {
+        VTUPolylineWriter writer;
+        for (unsigned p = 0; p < n_particle; p++)
+        {
+          add_beam_mesh_to_vtu(Beam_mesh_pt[p][0], writer, 5);
+          add_beam_mesh_to_vtu(Beam_mesh_pt[p][1], writer, 5);
+        }
+        add_rigid_body_state_to_vtu(Rigid_body_element_pt, writer);
+        writer.add_field_data(
+          "TimeValue", 1, Vector<double>(1, time_pt()->time()));
+        sprintf(filename, "suspension%i.vtu", doc_info.number());
+        writer.write(doc_info.directory() + "/" + filename, vtu_encoding());
+        pvd_file.add_dataset(time_pt()->time(), filename);
+      }
+      doc_info.number()++;
+    }
 
+    // Take a timestep (repeated with smaller dt if the temporal error
+    // is too large) and get the suggested next timestep
+    dt = adaptive_unsteady_newton_solve(
+      dt, Global_Physical_Variables::Temporal_tolerance);
 
-  /////////////////////////////////////////////////////////////////////////////////
-  // TEST!(temporarily set here for test!)
+    oomph_info << "Timestep " << n_step << ": t = " << time_pt()->time()
+               << ", next dt = " << dt << ", GMRES iterations for the "
+               << "interactions: " << Nonlocal_operator_pt->iterations()
+               << std::endl;
+    n_step++;
+  }
 
-  // Solve the system
-  newton_solve();
+  trajectory_file.close();
+}
 
-  // Document the solution (first arm)
-  ofstream file1;
-  sprintf(filename,
-          "RESLT/beam_first_arm_initial_%.2f_%d.dat",
-          Global_Physical_Variables::Initial_value_for_theta_eq,
-          counter);
-  file1.open(filename);
-  Beam_mesh_first_arm_pt->output(file1, 5);
-  file1.close();
 
-  // // Document the solution (second arm)
-  // sprintf(filename,
-  //         "RESLT/beam_second_arm_initial_%.2f_%d.dat",
-  //         Global_Physical_Variables::Initial_value_for_theta_eq,
-  //         counter);
-  // file2.open(filename);
-  // Beam_mesh_second_arm_pt->output(file2, 5);
-  // file2.close();
+//=========================================================================
+/// Ensemble of independent (two-armed) boomerangs with perturbed aspect
+/// ratios, opening angles and thicknesses, e.g. for uncertainty
+/// quantification: The members' arms are set up as in the
+/// ElasticBeamProblem. All members are stored in a single Problem so the
+/// meshes, equation numbering and linear solver are only set up once,
+/// and the residuals and Jacobians of all members are assembled in one
+/// pass. The members don't interact so the Jacobian is block-diagonal
+/// and the Newton systems are solved member by member (in parallel if
+/// OpenMP is enabled) with the ParticleBlockDiagonalSolver.
+//=========================================================================
+class BoomerangEnsembleProblem : public Problem
+{
+public:
+  /// Constructor: Pass the members' aspect ratios, opening angles (in
+  /// radians) and thicknesses, and the number of elements per arm
+  BoomerangEnsembleProblem(const Vector<double>& q,
+                           const Vector<double>& alpha,
+                           const Vector<double>& h,
+                           const unsigned& n_elem);
 
-  // Ignore the following code
-  exit(0);
+  /// Solve for the pseudo "equilibrium positions" of all members (for
+  /// the current value of I) and document them
+  void solve_and_document();
 
-  /////////////////////////////////////////////////////////////////////////////////
+  /// No actions need to be performed after a solve
+  void actions_after_newton_solve() {}
 
+  /// No actions need to be performed before a solve
+  void actions_before_newton_solve() {}
 
-  // Loop over different values for Non-dimensional coefficient (FSI) I by
-  // using arclength increment
-  // The loop stops when I becomes negative since only positive values of I are
-  // considered.
-  double I_backup = 0.0;
-  double ds = 0.0;
-  while (Global_Physical_Variables::I >= 0.0)
+private:
+  /// The beam meshes (first and second arm) of member m
+  Vector<SolidMesh*> beam_mesh_pt(const unsigned& m)
   {
-    // Get the dofs
-    Problem::get_dofs(dofs_backup);
-
-    try
-    {
-      if (counter == 0)
-      {
-        // Solve the system
-        newton_solve();
-      }
-      else
-      {
-        // Backup the FSI coefficient I
-        I_backup = Global_Physical_Variables::I;
+    Vector<SolidMesh*> mesh_pt(2);
+    mesh_pt[0] = Beam_mesh_pt[m][0];
+    mesh_pt[1] = Beam_mesh_pt[m][1];
+    return mesh_pt;
+  }
 
-        // To prevent large solution jumps in critical intervals for I, try to
-        // reduce ds specifically in those areas for smoother and more precise
-        // results
+  /// Aspect ratio of each member
+  Vector<double> Member_q;
 
-        // First I interval [Interval1_start,Interval1_end]
-        if (Global_Physical_Variables::Ds_default >
-              Global_Physical_Variables::Ds_interval1 &&
-            Global_Physical_Variables::I >=
-              Global_Physical_Variables::Interval1_start &&
-            Global_Physical_Variables::I <=
-              Global_Physical_Variables::Interval1_end)
-        {
-          ds = Global_Physical_Variables::Ds_interval1;
-        }
-        // Second I interval [Interval2_start,Interval2_end]
-        else if (Global_Physical_Variables::Ds_default >
-                   Global_Physical_Variables::Ds_interval2 &&
-                 Global_Physical_Variables::I >=
-                   Global_Physical_Variables::Interval2_start &&
-                 Global_Physical_Variables::I <=
-                   Global_Physical_Variables::Interval2_end)
-        {
-          ds = Global_Physical_Variables::Ds_interval2;
-        }
-        else
-        {
-          // Use the default one
-          ds = Global_Physical_Variables::Ds_default;
-        }
+  /// Opening angle of each member (the elements of the second arms
+  /// store pointers to it)
+  Vector<double> Member_alpha;
 
-        /// Use the arclength solve
-        ds = arc_length_step_solve(&Global_Physical_Variables::I, ds);
-      }
+  /// Thickness of each member (the elements store pointers to it)
+  Vector<double> Member_h;
 
-      // Document I
-      file << Global_Physical_Variables::I << "  ";
+  /// Pointers to geometric objects that represent the members'
+  /// undeformed shapes: [member][arm]
+  Vector<Vector<GeomObject*>> Undef_beam_pt;
 
-      // Document the solution of Theta_eq, Theta_eq_orientation
-      Rigid_body_element_pt->output(file);
+  /// Pointers to the RigidBodyElements of the members
+  Vector<RigidBodyElement*> Rigid_body_element_pt;
 
-      // Document maximum residuals at start and after each newton iteration
-      file << Problem::Max_res[0] << "  ";
+  /// Pointers to the members' beam meshes: [member][arm]
+  Vector<Vector<GradedOneDLagrangianMesh<HaoHermiteBeamElement>*>>
+    Beam_mesh_pt;
 
-      // Document actual number of Newton iterations taken during the most
-      // recent iteration
-      file << Problem::Nnewton_iter_taken << "  ";
+  /// Pointers to the cached integration point data of the beam meshes:
+  /// [member][arm]
+  Vector<Vector<BeamIntegrationPointCache*>> Integration_point_cache_pt;
 
-      // Step label
-      file << counter << std::endl;
+  /// Pointer to mesh containing the rigid body elements
+  Mesh* Rigid_body_element_mesh_pt;
 
-      // Output file stream used for writing results
-      ofstream file1;
-      ofstream file2;
-      ofstream file3;
+  /// Pointer to the block-diagonal linear solver
+  ParticleBlockDiagonalSolver* Block_solver_pt;
 
-      // Document the solution (first arm)
-      sprintf(filename,
-              "RESLT/beam_first_arm_initial_%.2f_%d.dat",
-              Global_Physical_Variables::Initial_value_for_theta_eq,
-              counter);
-      file1.open(filename);
-      Beam_mesh_first_arm_pt->output(file1, 5);
-      file1.close();
+}; // end of ensemble problem class
 
-      // Document the solution (second arm)
-      sprintf(filename,
-              "RESLT/beam_second_arm_initial_%.2f_%d.dat",
-              Global_Physical_Variables::Initial_value_for_theta_eq,
-              counter);
-      file2.open(filename);
-      Beam_mesh_second_arm_pt->output(file2, 5);
-      file2.close();
 
-      // Write restart file
-      sprintf(filename, "RESLT/restart%i.dat", counter);
-      file2.open(filename);
-      dump_it(file2);
-      file2.close();
+//=============start_of_constructor=====================================
+/// Constructor for the ensemble problem
+//======================================================================
+BoomerangEnsembleProblem::BoomerangEnsembleProblem(
+  const Vector<double>& q,
+  const Vector<double>& alpha,
+  const Vector<double>& h,
+  const unsigned& n_elem)
+  : Member_q(q), Member_alpha(alpha), Member_h(h)
+{
+  unsigned n_member = Member_q.size();
+#ifdef PARANOID
+  if ((Member_alpha.size() != n_member) || (Member_h.size() != n_member))
+  {
+    std::ostringstream error_message;
+    error_message << "Numbers of opening angles (" << Member_alpha.size()
+                  << ") and thicknesses (" << Member_h.size()
+                  << ") don't match number of aspect ratios (" << n_member
+                  << ")" << std::endl;
+    throw OomphLibError(
+      error_message.str(), OOMPH_CURRENT_FUNCTION, OOMPH_EXCEPTION_LOCATION);
+  }
+#endif
 
-      // Bump counter for output
-      counter = counter + 1;
-    }
-    catch (...)
+  double length = 1.0;
+  double theta_eq = Global_Physical_Variables::Initial_value_for_theta_eq;
+  Rigid_body_element_mesh_pt = new Mesh;
+  Undef_beam_pt.resize(n_member);
+  Rigid_body_element_pt.resize(n_member);
+  Beam_mesh_pt.resize(n_member);
+  Integration_point_cache_pt.resize(n_member);
+  for (unsigned m = 0; m < n_member; m++)
+  {
+    // Make the RigidBodyElement that stores the member's rigid body
+    // parameters
+    Rigid_body_element_pt[m] =
+      new RigidBodyElement(0.0, 0.0, theta_eq, 0.0, 0.0);
+    Rigid_body_element_mesh_pt->add_element_pt(Rigid_body_element_pt[m]);
+
+    // Undeformed shapes of the arms (in the reference orientation):
+    // first arm length = |q+0.5|, second arm length = |q-0.5|
+    Undef_beam_pt[m].resize(2);
+    Undef_beam_pt[m][0] = new NewStraightLineVertical(Member_q[m] + 0.5);
+    Undef_beam_pt[m][1] =
+      new NewStraightLineVertical(fabs(Member_q[m] - 0.5));
+
+    // Create the (uniform) beam meshes of the two arms
+    Beam_mesh_pt[m].resize(2);
+    Integration_point_cache_pt[m].resize(2);
+    for (unsigned arm = 0; arm < 2; arm++)
     {
-      // If the initial values are not appropriate, the newton method cannot
-      // converge at the starting point I=0.0
-      if (counter == 0)
+      Beam_mesh_pt[m][arm] =
+        new GradedOneDLagrangianMesh<HaoHermiteBeamElement>(
+          n_elem, length, Undef_beam_pt[m][arm], 0);
+      unsigned n_element = Beam_mesh_pt[m][arm]->nelement();
+
+      // Use the compile-time specialised slender body computations
+      // (before the integration point data is cached)
+      if (Global_Physical_Variables::Fixed_quadrature_order != 0)
       {
-        oomph_info
-          << "Initial values for I=0.0 are not appropriate. Please modify them!"
-          << std::endl;
-        break;
-      }
-      else
-      {
-        // Check if default ds is small enough
-        if (Global_Physical_Variables::Ds_default < 1.0e-8)
+        for (unsigned e = 0; e < n_element; e++)
         {
-          // Since the default is not small enough, assign a smaller value
-          Global_Physical_Variables::Ds_default = 1.0e-8;
-
-          // Since the newton method cannot converge in this turn, overwrite the
-          // failed I value
-          Global_Physical_Variables::I = I_backup;
+          dynamic_cast<HaoHermiteBeamElement*>(
+            Beam_mesh_pt[m][arm]->element_pt(e))
+            ->set_fixed_quadrature_order(
+              Global_Physical_Variables::Fixed_quadrature_order);
         }
-        else
+      }
+      Integration_point_cache_pt[m][arm] = new BeamIntegrationPointCache(
+        Beam_mesh_pt[m][arm], Undef_beam_pt[m][arm]);
+
+      // Clamp the arm at the junction
+      Beam_mesh_pt[m][arm]->boundary_node_pt(0, 0)->pin_position(0);
+      Beam_mesh_pt[m][arm]->boundary_node_pt(0, 0)->pin_position(1);
+      Beam_mesh_pt[m][arm]->boundary_node_pt(0, 0)->pin_position(1, 0);
+
+      // Set physical parameters etc.
+      for (unsigned e = 0; e < n_element; e++)
+      {
+        HaoHermiteBeamElement* elem_pt = dynamic_cast<HaoHermiteBeamElement*>(
+          Beam_mesh_pt[m][arm]->element_pt(e));
+        elem_pt->set_pointer_to_rigid_body_element(Rigid_body_element_pt[m]);
+        elem_pt->h_pt() = &Member_h[m];
+        elem_pt->i_pt() = &Global_Physical_Variables::I;
+
+        // Rotate the second arm by the member's opening angle
+        if (arm == 1)
         {
-          // If default ds is already small enough, it means there is no
-          // solution any more
-          break;
+          elem_pt->theta_initial_pt(&Member_alpha[m]);
         }
+        elem_pt->undeformed_beam_pt() = Undef_beam_pt[m][arm];
+        elem_pt->set_integration_point_cache_pt(
+          Integration_point_cache_pt[m][arm]);
       }
 
-      // Reset the dofs
-      Problem::set_dofs(dofs_backup);
+      add_sub_mesh(Beam_mesh_pt[m][arm]);
     }
+
+    // The drag and torque on the member depend on its beam meshes
+    Rigid_body_element_pt[m]->set_pointer_to_beam_meshes(beam_mesh_pt(m));
   }
-  file.close();
 
+  // Build the problem's global mesh
+  add_sub_mesh(Rigid_body_element_mesh_pt);
+  build_global_mesh();
+
+  // Assign the global and local equation numbers
+  cout << "# of dofs " << assign_eqn_numbers() << std::endl;
+
+  // Solve the (block-diagonal) Newton systems member by member
+  Block_solver_pt = new ParticleBlockDiagonalSolver(this);
+  for (unsigned m = 0; m < n_member; m++)
+  {
+    Vector<Mesh*> mesh_pt(2);
+    mesh_pt[0] = Beam_mesh_pt[m][0];
+    mesh_pt[1] = Beam_mesh_pt[m][1];
+    Block_solver_pt->add_particle(mesh_pt, Rigid_body_element_pt[m]);
+  }
+  if (!CommandLineArgs::command_line_flag_has_been_set(
+        "--particle_direct_solver"))
+  {
+    linear_solver_pt() = Block_solver_pt;
+  }
+
+} // end of constructor
+
+
+//=======start_of_solve_and_document=======================================
+/// Solve for the pseudo "equilibrium positions" of all members and
+/// document them in RESLT/ensemble.dat: member, q, alpha, H, I, V, U0,
+/// Theta_eq
+//=========================================================================
+void BoomerangEnsembleProblem::solve_and_document()
+{
+  // Create label for output
+  DocInfo doc_info;
+
+  // Set output directory
+  doc_info.set_directory("RESLT");
+
+  double t_start = TimingHelpers::timer();
+  newton_solve();
+  unsigned n_member = Rigid_body_element_pt.size();
+  oomph_info << "Time for the solve of the ensemble of " << n_member
+             << " boomerangs [sec]: " << TimingHelpers::timer() - t_start
+             << std::endl;
+
+  ofstream file;
+  char filename[100];
+  sprintf(filename, "%s/ensemble.dat", doc_info.directory().c_str());
+  file.open(filename);
+  for (unsigned m = 0; m < n_member; m++)
+  {
+    double V = 0.0;
+    double U0 = 0.0;
+    double Theta_eq = 0.0;
+    double X0 = 0.0;
+    double Y0 = 0.0;
+    Rigid_body_element_pt[m]->get_parameters(V, U0, Theta_eq, X0, Y0);
+    file << m << "  " << Member_q[m] << "  " << Member_alpha[m] << "  "
+         << Member_h[m] << "  "
+         << Global_Physical_Variables::I << "  " << V << "  " << U0 << "  "
+         << Theta_eq << std::endl;
+  }
+  file.close();
+}
 
-} // end of parameter study
 
 //========start_of_main================================================
 /// Driver for beam (string under tension) test problem
@@ -1655,13 +5285,233 @@ int main(int argc, char** argv)
   CommandLineArgs::specify_command_line_flag(
     "--ds_interval2", &Global_Physical_Variables::Ds_interval2);
 
+  // Max. number of continuation steps
+  CommandLineArgs::specify_command_line_flag(
+    "--max_continuation_steps",
+    &Global_Physical_Variables::Max_continuation_steps);
+
   // Switch to the old version of the code
   CommandLineArgs::specify_command_line_flag("--old_version");
 
+  // Use Jacobian-free Newton-Krylov solver
+  CommandLineArgs::specify_command_line_flag("--jfnk");
+
+  // Use GMRES with geometric multigrid preconditioner
+  CommandLineArgs::specify_command_line_flag("--multigrid");
+
+  // Max. dimension of the Krylov subspace (before restart) for JFNK
+  CommandLineArgs::specify_command_line_flag(
+    "--krylov_dimension", &Global_Physical_Variables::Krylov_dimension);
+
+  // Node distribution in the beam meshes (0: uniform; 1: geometric;
+  // 2: tanh; 3: user-specified element density)
+  CommandLineArgs::specify_command_line_flag(
+    "--mesh_grading", &Global_Physical_Variables::Mesh_grading);
+
+  // Parameter for the graded meshes
+  CommandLineArgs::specify_command_line_flag(
+    "--grading_parameter", &Global_Physical_Variables::Grading_parameter);
+
+  // Number of continuation steps between r-adaptations (0: none)
+  CommandLineArgs::specify_command_line_flag(
+    "--r_adapt_interval", &Global_Physical_Variables::R_adapt_interval);
+
+  // Weight of the curvature in the monitor function for r-adaptation
+  CommandLineArgs::specify_command_line_flag(
+    "--monitor_weight", &Global_Physical_Variables::Monitor_weight);
+
+  // Evaluate the shape functions and undeformed geometry at the
+  // integration points from scratch (rather than from the cache)
+  CommandLineArgs::specify_command_line_flag("--no_integration_point_cache");
+
+  // Check the (vectorised) slender body traction kernel against its
+  // scalar version before doing anything else
+  CommandLineArgs::specify_command_line_flag("--check_traction_kernel");
+
+  // Number of Gauss points for the compile-time specialised beam
+  // elements (0: generic elements)
+  CommandLineArgs::specify_command_line_flag(
+    "--fixed_quadrature_order",
+    &Global_Physical_Variables::Fixed_quadrature_order);
+
+  // Re-use the factorised Jacobian across Newton iterations and
+  // continuation steps
+  CommandLineArgs::specify_command_line_flag("--jacobian_reuse");
+
+  // Max. contraction rate of the residuals before the Jacobian is
+  // re-factorised
+  CommandLineArgs::specify_command_line_flag(
+    "--max_contraction_rate", &Global_Physical_Variables::Max_contraction_rate);
+
+  // Document the growth rates of the orientation (the finite eigenvalues
+  // of J v = lambda M v) after each converged continuation step
+  // (re-using the factorised Jacobian)
+  CommandLineArgs::specify_command_line_flag("--stability");
+
+  // Number of eigenvalues for --stability
+  CommandLineArgs::specify_command_line_flag(
+    "--n_stability_eigenvalue",
+    &Global_Physical_Variables::N_stability_eigenvalue);
+
+  // Dimension of the Krylov subspace for --stability
+  CommandLineArgs::specify_command_line_flag(
+    "--arnoldi_dimension", &Global_Physical_Variables::Arnoldi_dimension);
+
+  // Check the eigenvalues from --stability against a dense reduction of
+  // J v = lambda M v
+  CommandLineArgs::specify_command_line_flag("--check_stability");
+
+  // Compute the RigidBodyElement's Jacobian by automatic differentiation
+  CommandLineArgs::specify_command_line_flag("--automatic_differentiation");
+
+  // Compute the RigidBodyElement's Jacobian by finite differencing with
+  // incremental (per-element) updates
+  CommandLineArgs::specify_command_line_flag("--incremental_fd_jacobian");
+
+  // Use the nonlocal slender body traction
+  CommandLineArgs::specify_command_line_flag("--nonlocal_slender_body");
+
+  // Slenderness of the beam (for the nonlocal slender body traction)
+  CommandLineArgs::specify_command_line_flag(
+    "--slenderness", &Global_Physical_Variables::Slenderness);
+
+  // Arclength cutoff for the local region (for the nonlocal slender body
+  // traction)
+  CommandLineArgs::specify_command_line_flag(
+    "--nonlocal_cutoff", &Global_Physical_Variables::Nonlocal_cutoff);
+
+  // Opening angle of the treecode for the nonlocal slender body traction
+  // (0: direct summation)
+  CommandLineArgs::specify_command_line_flag(
+    "--nonlocal_opening_angle",
+    &Global_Physical_Variables::Nonlocal_opening_angle);
+
+  // Solve for the current value of I (with --nonlocal_slender_body) and
+  // check that the nonlocal correction changes the drag and torque
+  CommandLineArgs::specify_command_line_flag("--check_nonlocal_traction");
+
+  // Compute the time-dependent sedimentation (rather than the pseudo
+  // "equilibrium position")
+  CommandLineArgs::specify_command_line_flag("--unsteady");
+
+  // Initial timestep for --unsteady
+  CommandLineArgs::specify_command_line_flag("--dt",
+                                             &Global_Physical_Variables::Dt);
+
+  // End time for --unsteady
+  CommandLineArgs::specify_command_line_flag(
+    "--t_max", &Global_Physical_Variables::T_max);
+
+  // Target for the temporal error in the adaptive timestepping
+  CommandLineArgs::specify_command_line_flag(
+    "--temporal_tolerance", &Global_Physical_Variables::Temporal_tolerance);
+
+  // Number of timesteps between outputs of the beam shape
+  CommandLineArgs::specify_command_line_flag(
+    "--unsteady_doc_interval",
+    &Global_Physical_Variables::Unsteady_doc_interval);
+
+  // Number of particles for the sedimentation of a suspension
+  CommandLineArgs::specify_command_line_flag(
+    "--n_particle", &Global_Physical_Variables::N_particle);
+
+  // Distance between neighbouring particles in the suspension
+  CommandLineArgs::specify_command_line_flag(
+    "--particle_spacing", &Global_Physical_Variables::Particle_spacing);
+
+  // Solve the Newton systems for the suspension or the ensemble with the
+  // default (direct) linear solver rather than particle by particle
+  CommandLineArgs::specify_command_line_flag("--particle_direct_solver");
+
+  // Number of members of an ensemble of independent boomerangs
+  CommandLineArgs::specify_command_line_flag(
+    "--n_ensemble", &Global_Physical_Variables::N_ensemble);
+
+  // Max. relative perturbation of q, alpha and H for the ensemble members
+  CommandLineArgs::specify_command_line_flag(
+    "--ensemble_perturbation",
+    &Global_Physical_Variables::Ensemble_perturbation);
+
+  // Seed for the random perturbations of the ensemble members
+  CommandLineArgs::specify_command_line_flag(
+    "--ensemble_seed", &Global_Physical_Variables::Ensemble_seed);
+
+  // Write the beam meshes and rigid body states in (binary) VTU format,
+  // with a PVD index over the continuation steps or timesteps
+  CommandLineArgs::specify_command_line_flag("--vtk");
+
+  // Encode the VTU files' binary data in base64 (rather than raw)
+  CommandLineArgs::specify_command_line_flag("--vtk_base64");
+
+  // Write the state at each continuation step or timestep to a
+  // lossless compressed archive
+  CommandLineArgs::specify_command_line_flag("--snapshot_archive");
+
+  // ...and check that the snapshots are recovered bitwise-exactly from
+  // the archive at the end of the parameter study
+  CommandLineArgs::specify_command_line_flag("--check_snapshot_archive");
+
+  // Number of elements per arm
+  unsigned n_element = 20;
+  CommandLineArgs::specify_command_line_flag("--n_element", &n_element);
+
+  // Solve for a single value of I with n_element, 2 n_element and
+  // 4 n_element elements and document the Richardson-extrapolated results
+  CommandLineArgs::specify_command_line_flag("--richardson");
+
+  // Value of I for --richardson
+  CommandLineArgs::specify_command_line_flag("--I",
+                                             &Global_Physical_Variables::I);
+
+  // Number of steps in which I is increased to its target value for
+  // --richardson and --steady_solve
+  CommandLineArgs::specify_command_line_flag(
+    "--n_steady_step", &Global_Physical_Variables::N_steady_step);
+
+  // Solve for the value of I specified with --I (rather than conducting
+  // the parameter study) and document the solution in
+  // RESLT/steady_solution.dat
+  CommandLineArgs::specify_command_line_flag("--steady_solve");
+
+  // ...and check the banded LU factorisation against SuperLU for the
+  // Jacobian of the solution
+  CommandLineArgs::specify_command_line_flag("--check_banded_lu");
+
+  // ...and check the RigidBodyElement's Jacobians by automatic
+  // differentiation and incremental finite differencing against finite
+  // differencing
+  CommandLineArgs::specify_command_line_flag("--check_jacobian");
+
+  // ...and check the round trip of the solution through the solution
+  // cache (requires --solution_cache)
+  CommandLineArgs::specify_command_line_flag("--check_solution_cache");
+
+  // Order of convergence assumed for --richardson if the observed order
+  // cannot be determined
+  CommandLineArgs::specify_command_line_flag(
+    "--formal_order", &RichardsonExtrapolation::Formal_order);
+
   // Restart file
   std::string restart_file;
   CommandLineArgs::specify_command_line_flag("--restart_file", &restart_file);
 
+  // Restart from a snapshot in a compressed archive of a parameter study
+  std::string restart_snapshot_archive;
+  CommandLineArgs::specify_command_line_flag("--restart_snapshot_archive",
+                                             &restart_snapshot_archive);
+
+  // Index of the snapshot for --restart_snapshot_archive
+  unsigned restart_snapshot_index = 0;
+  CommandLineArgs::specify_command_line_flag("--restart_snapshot_index",
+                                             &restart_snapshot_index);
+
+  // Directory of the persistent cache of converged solutions: the
+  // parameter study adds its solutions and (without a restart) the
+  // run is seeded with the nearest cached solution
+  std::string solution_cache_directory;
+  CommandLineArgs::specify_command_line_flag("--solution_cache",
+                                             &solution_cache_directory);
+
   // Parse command line
   CommandLineArgs::parse_and_assign();
 
@@ -1676,10 +5526,62 @@ int main(int argc, char** argv)
   // Set the non-dimensional thickness
   Global_Physical_Variables::H = 0.01;
 
+  // Check the slender body traction kernel?
+  if (CommandLineArgs::command_line_flag_has_been_set(
+        "--check_traction_kernel"))
+  {
+    if (SlenderBodyTractionKernel::self_test() != 0)
+    {
+      throw OomphLibError("Slender body traction kernel self-test failed",
+                          OOMPH_CURRENT_FUNCTION,
+                          OOMPH_EXCEPTION_LOCATION);
+    }
+  }
+
   // Number of elements (choose an even number if you want the control point
   // to be located at the centre of the beam)
-  unsigned n_element1 = 20;
-  unsigned n_element2 = 20;
+  unsigned n_element1 = n_element;
+  unsigned n_element2 = n_element;
+
+  // Convergence study instead of continuation?
+  if (CommandLineArgs::command_line_flag_has_been_set("--richardson"))
+  {
+    RichardsonExtrapolation::run(n_element);
+    return 0;
+  }
+
+  // Sedimentation of a suspension of interacting particles?
+  if (Global_Physical_Variables::N_particle > 0)
+  {
+    BoomerangSuspensionProblem suspension_problem(
+      Global_Physical_Variables::N_particle, n_element);
+    suspension_problem.unsteady_run();
+    return 0;
+  }
+
+  // Ensemble of independent boomerangs with randomly perturbed aspect
+  // ratio, opening angle and thickness (for the current value of I)?
+  if (Global_Physical_Variables::N_ensemble > 0)
+  {
+    unsigned n_member = Global_Physical_Variables::N_ensemble;
+    double eps = Global_Physical_Variables::Ensemble_perturbation;
+    Vector<double> q(n_member);
+    Vector<double> alpha(n_member);
+    Vector<double> h(n_member);
+    srand(Global_Physical_Variables::Ensemble_seed);
+    for (unsigned m = 0; m < n_member; m++)
+    {
+      double r_q = 2.0 * double(rand()) / double(RAND_MAX) - 1.0;
+      double r_alpha = 2.0 * double(rand()) / double(RAND_MAX) - 1.0;
+      double r_h = 2.0 * double(rand()) / double(RAND_MAX) - 1.0;
+      q[m] = Global_Physical_Variables::Q * (1.0 + eps * r_q);
+      alpha[m] = Global_Physical_Variables::Alpha * (1.0 + eps * r_alpha);
+      h[m] = Global_Physical_Variables::H * (1.0 + eps * r_h);
+    }
+    BoomerangEnsembleProblem ensemble_problem(q, alpha, h, n_element);
+    ensemble_problem.solve_and_document();
+    return 0;
+  }
 
   // Construct the problem
   ElasticBeamProblem problem(n_element1, n_element2);
@@ -1693,6 +5595,69 @@ int main(int argc, char** argv)
     problem.restart(file2);
     file2.close();
   }
+  else if (CommandLineArgs::command_line_flag_has_been_set(
+             "--restart_snapshot_archive"))
+  {
+    problem.restart_from_snapshot(restart_snapshot_archive,
+                                  restart_snapshot_index);
+  }
+
+  // Use the solution cache (and seed the run from it, unless restarted)
+  if (CommandLineArgs::command_line_flag_has_been_set("--solution_cache"))
+  {
+    problem.use_solution_cache(solution_cache_directory);
+    if ((!CommandLineArgs::command_line_flag_has_been_set("--restart_file")) &&
+        (!CommandLineArgs::command_line_flag_has_been_set(
+          "--restart_snapshot_archive")))
+    {
+      if (!problem.warm_start_from_solution_cache())
+      {
+        oomph_info << "Solution cache is empty: no warm start" << std::endl;
+      }
+    }
+  }
+
+  // Check the nonlocal slender body traction instead of the parameter
+  // study?
+  if (CommandLineArgs::command_line_flag_has_been_set(
+        "--check_nonlocal_traction"))
+  {
+    problem.newton_solve();
+    problem.check_nonlocal_slender_body_traction();
+    return 0;
+  }
+
+  // Steady solve for the specified I instead of the parameter study?
+  if (CommandLineArgs::command_line_flag_has_been_set("--steady_solve"))
+  {
+    double i_target = Global_Physical_Variables::I;
+    problem.steady_solve(i_target);
+    ofstream steady_file("RESLT/steady_solution.dat");
+    steady_file.precision(16);
+    problem.doc_steady_solution(steady_file);
+    steady_file.close();
+    if (CommandLineArgs::command_line_flag_has_been_set("--check_banded_lu"))
+    {
+      problem.check_banded_lu();
+    }
+    if (CommandLineArgs::command_line_flag_has_been_set("--check_jacobian"))
+    {
+      problem.check_rigid_body_jacobian();
+    }
+    if (CommandLineArgs::command_line_flag_has_been_set(
+          "--check_solution_cache"))
+    {
+      problem.check_solution_cache();
+    }
+    return 0;
+  }
+
+  // Time-dependent sedimentation instead of the parameter study?
+  if (CommandLineArgs::command_line_flag_has_been_set("--unsteady"))
+  {
+    problem.unsteady_run();
+    return 0;
+  }
 
   // Conduct parameter study
   problem.parameter_study();
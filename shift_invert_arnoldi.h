@@ -0,0 +1,670 @@
+// LIC// ====================================================================
+// LIC// This file forms part of oomph-lib, the object-oriented,
+// LIC// multi-physics finite-element library, available
+// LIC// at http://www.oomph-lib.org.
+// LIC//
+// LIC// Copyright (C) 2006-2023 Matthias Heil and Andrew Hazel
+// LIC//
+// LIC// This library is free software; you can redistribute it and/or
+// LIC// modify it under the terms of the GNU Lesser General Public
+// LIC// License as published by the Free Software Foundation; either
+// LIC// version 2.1 of the License, or (at your option) any later version.
+// LIC//
+// LIC// This library is distributed in the hope that it will be useful,
+// LIC// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// LIC// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// LIC// Lesser General Public License for more details.
+// LIC//
+// LIC// You should have received a copy of the GNU Lesser General Public
+// LIC// License along with this library; if not, write to the Free Software
+// LIC// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+// LIC// 02110-1301  USA.
+// LIC//
+// LIC// The authors may be contacted at oomph-lib@maths.man.ac.uk.
+// LIC//
+// Shift-invert Arnoldi eigensolver for the generalised eigenproblem
+// J v = lambda M v that re-uses a factorised Jacobian
+
+#ifndef SHIFT_INVERT_ARNOLDI_HEADER
+#define SHIFT_INVERT_ARNOLDI_HEADER
+
+#include <complex>
+
+// OOMPH-LIB includes
+#include "generic.h"
+
+namespace oomph
+{
+  //=========================================================================
+  /// Finite eigenvalues of the generalised eigenproblem J v = lambda M v
+  /// nearest to a shift sigma, where J is a Problem's Jacobian (the
+  /// derivatives of the residuals w.r.t. the dofs) and M is the "mass
+  /// matrix" of the linearised dynamics, computed with the Arnoldi method
+  /// applied to (J - sigma M)^{-1} M. M is specified by its nonzero
+  /// columns (those of the unknowns whose rates of change enter the
+  /// equations); it's typically singular, so the pencil has infinite
+  /// eigenvalues (those of the constraints that hold instantaneously),
+  /// which correspond to the zero eigenvalues of (J - sigma M)^{-1} M and
+  /// are discarded.
+  ///
+  /// The inverse is applied by the resolve(...) of a linear solver that
+  /// has already factorised J - sigma M. For sigma = 0 this is the
+  /// factorisation of the Jacobian from the last Newton step, so (once
+  /// the linear solver keeps its factors) the eigenvalues nearest zero
+  /// cost one back-substitution per Krylov vector. Since the operator's
+  /// range is spanned by the solutions for M's columns, the Krylov
+  /// subspace is at most as large as their number.
+  ///
+  /// The eigenvalues of the (small) Hessenberg matrix are computed by the
+  /// shifted QR algorithm. The residuals |J v - lambda M v| of the
+  /// eigenpairs (with |v| = 1) are computed with finite-difference
+  /// Jacobian-vector products of the residuals at the current dofs. They
+  /// show how accurate the eigenpairs are, e.g. if the factorisation
+  /// is an approximation of the current Jacobian.
+  //=========================================================================
+  class ShiftInvertArnoldiEigensolver
+  {
+  public:
+    /// Constructor: Pass the dimension of the Krylov subspace (the number
+    /// of back-substitutions)
+    ShiftInvertArnoldiEigensolver(const unsigned& krylov_dimension = 20)
+      : Krylov_dimension(krylov_dimension)
+    {
+    }
+
+    /// Broken copy constructor
+    ShiftInvertArnoldiEigensolver(const ShiftInvertArnoldiEigensolver&
+                                    dummy) = delete;
+
+    /// Broken assignment operator
+    void operator=(const ShiftInvertArnoldiEigensolver&) = delete;
+
+    /// Access to the dimension of the Krylov subspace
+    unsigned& krylov_dimension()
+    {
+      return Krylov_dimension;
+    }
+
+    /// Compute the n_eigenvalue finite eigenvalues of J v = lambda M v
+    /// nearest to sigma (sorted by distance from sigma; fewer if there
+    /// aren't as many) and the residuals of the eigenpairs. Column
+    /// mass_column_index[k] of M is mass_column[k]; all others vanish.
+    /// The linear solver's resolve(...) must apply (J - sigma M)^{-1}.
+    void solve(Problem* const& problem_pt,
+               LinearSolver* const& solver_pt,
+               const Vector<unsigned>& mass_column_index,
+               const Vector<DoubleVector>& mass_column,
+               const double& sigma,
+               const unsigned& n_eigenvalue,
+               Vector<std::complex<double>>& eigenvalue,
+               Vector<double>& residual);
+
+    /// All eigenvalues of a (small) dense square matrix, by reduction to
+    /// upper Hessenberg form and the shifted QR algorithm (e.g. to check
+    /// the eigenvalues computed by solve(...) against a dense reduction
+    /// of the generalised eigenproblem)
+    static void dense_eigenvalues(const DenseMatrix<double>& a,
+                                  Vector<std::complex<double>>& eigenvalue);
+
+  private:
+    /// Eigenvalues of the n x n upper Hessenberg matrix h (row-major;
+    /// overwritten) by the shifted QR algorithm
+    static void hessenberg_eigenvalues(
+      const unsigned& n,
+      Vector<std::complex<double>>& h,
+      Vector<std::complex<double>>& eigenvalue);
+
+    /// Eigenvector (normalised) of the n x n upper Hessenberg matrix h
+    /// (row-major) for its eigenvalue mu, by inverse iteration
+    static void hessenberg_eigenvector(
+      const unsigned& n,
+      const Vector<std::complex<double>>& h,
+      const std::complex<double>& mu,
+      Vector<std::complex<double>>& y);
+
+    /// Product y = M x of the mass matrix (specified by its nonzero
+    /// columns) and x
+    static void multiply_by_mass_matrix(
+      const Vector<unsigned>& mass_column_index,
+      const Vector<DoubleVector>& mass_column,
+      const DoubleVector& x,
+      DoubleVector& y);
+
+    /// Dimension of the Krylov subspace
+    unsigned Krylov_dimension;
+  };
+
+
+  //=========================================================================
+  /// Arnoldi iteration (modified Gram-Schmidt with one re-orthogonalisation)
+  /// for (J - sigma M)^{-1} M, whose eigenvalues mu of largest modulus
+  /// correspond to the finite eigenvalues lambda = sigma + 1/mu of
+  /// J v = lambda M v nearest sigma. The starting vector is in the range
+  /// of the operator, so the Krylov subspace contains no components of
+  /// the eigenvectors for the infinite eigenvalues.
+  //=========================================================================
+  inline void ShiftInvertArnoldiEigensolver::solve(
+    Problem* const& problem_pt,
+    LinearSolver* const& solver_pt,
+    const Vector<unsigned>& mass_column_index,
+    const Vector<DoubleVector>& mass_column,
+    const double& sigma,
+    const unsigned& n_eigenvalue,
+    Vector<std::complex<double>>& eigenvalue,
+    Vector<double>& residual)
+  {
+    const unsigned n_dof = problem_pt->ndof();
+    const unsigned m =
+      std::min(Krylov_dimension, unsigned(mass_column_index.size()));
+    eigenvalue.clear();
+    residual.clear();
+    if (m == 0)
+    {
+      return;
+    }
+
+    // Krylov basis, starting from the operator applied to a
+    // (reproducible) pseudo-random vector
+    Vector<DoubleVector> v(m + 1);
+    DoubleVector m_v(problem_pt->dof_distribution_pt(), 0.0);
+    v[0].build(problem_pt->dof_distribution_pt(), 0.0);
+    double seed = 0.5;
+    for (unsigned i = 0; i < n_dof; i++)
+    {
+      seed = std::fmod(seed * 3.7 + 0.31, 1.0);
+      v[0][i] = seed - 0.5;
+    }
+    multiply_by_mass_matrix(mass_column_index, mass_column, v[0], m_v);
+    solver_pt->resolve(m_v, v[0]);
+    double norm0 = v[0].norm();
+    if (norm0 == 0.0)
+    {
+      return;
+    }
+    for (unsigned i = 0; i < n_dof; i++)
+    {
+      v[0][i] /= norm0;
+    }
+
+    // Hessenberg matrix ((m+1) x m, row-major)
+    Vector<double> h((m + 1) * m, 0.0);
+    unsigned k = 0;
+    for (k = 0; k < m; k++)
+    {
+      multiply_by_mass_matrix(mass_column_index, mass_column, v[k], m_v);
+      solver_pt->resolve(m_v, v[k + 1]);
+      double norm_before = v[k + 1].norm();
+      for (unsigned pass = 0; pass < 2; pass++)
+      {
+        for (unsigned j = 0; j <= k; j++)
+        {
+          double proj = v[j].dot(v[k + 1]);
+          h[j * m + k] += proj;
+          for (unsigned i = 0; i < n_dof; i++)
+          {
+            v[k + 1][i] -= proj * v[j][i];
+          }
+        }
+      }
+      double norm = v[k + 1].norm();
+
+      // Invariant subspace found? (What's left after the
+      // orthogonalisation is round-off once the Krylov subspace spans
+      // the operator's range.)
+      if (norm <= 1.0e-12 * norm_before)
+      {
+        k++;
+        break;
+      }
+      h[(k + 1) * m + k] = norm;
+      for (unsigned i = 0; i < n_dof; i++)
+      {
+        v[k + 1][i] /= norm;
+      }
+    }
+    const unsigned n_krylov = std::min(k, m);
+
+    // Eigenvalues of the (square part of the) Hessenberg matrix
+    Vector<std::complex<double>> h_square(n_krylov * n_krylov);
+    for (unsigned i = 0; i < n_krylov; i++)
+    {
+      for (unsigned j = 0; j < n_krylov; j++)
+      {
+        h_square[i * n_krylov + j] = h[i * m + j];
+      }
+    }
+    Vector<std::complex<double>> h_copy(h_square);
+    Vector<std::complex<double>> mu;
+    hessenberg_eigenvalues(n_krylov, h_copy, mu);
+
+    // Largest mu first (nearest sigma)
+    Vector<unsigned> order(n_krylov);
+    for (unsigned i = 0; i < n_krylov; i++)
+    {
+      order[i] = i;
+    }
+    for (unsigned i = 1; i < n_krylov; i++)
+    {
+      unsigned j = i;
+      while ((j > 0) && (std::abs(mu[order[j]]) > std::abs(mu[order[j - 1]])))
+      {
+        std::swap(order[j], order[j - 1]);
+        j--;
+      }
+    }
+
+    // Discard the (numerically) zero mu, i.e. the infinite eigenvalues
+    unsigned n_finite = 0;
+    while ((n_finite < n_krylov) &&
+           (std::abs(mu[order[n_finite]]) >
+            1.0e-10 * std::abs(mu[order[0]])))
+    {
+      n_finite++;
+    }
+
+    // Eigenvalues of the pencil and the residuals of the eigenpairs
+    const unsigned n_out = std::min(n_eigenvalue, n_finite);
+    eigenvalue.resize(n_out);
+    residual.resize(n_out);
+    DoubleVector dofs(problem_pt->dof_distribution_pt(), 0.0);
+    for (unsigned i = 0; i < n_dof; i++)
+    {
+      dofs[i] = problem_pt->dof(i);
+    }
+    DoubleVector r0;
+    problem_pt->get_residuals(r0);
+    double dof_max = 0.0;
+    for (unsigned i = 0; i < n_dof; i++)
+    {
+      dof_max = std::max(dof_max, std::fabs(dofs[i]));
+    }
+    double eps =
+      std::sqrt(std::numeric_limits<double>::epsilon()) * (1.0 + dof_max);
+    for (unsigned e = 0; e < n_out; e++)
+    {
+      std::complex<double> mu_e = mu[order[e]];
+      eigenvalue[e] = sigma + 1.0 / mu_e;
+
+      // Ritz vector x = V y (real and imaginary parts), normalised
+      Vector<std::complex<double>> y;
+      hessenberg_eigenvector(n_krylov, h_square, mu_e, y);
+      DoubleVector x_real(problem_pt->dof_distribution_pt(), 0.0);
+      DoubleVector x_imag(problem_pt->dof_distribution_pt(), 0.0);
+      for (unsigned j = 0; j < n_krylov; j++)
+      {
+        for (unsigned i = 0; i < n_dof; i++)
+        {
+          x_real[i] += y[j].real() * v[j][i];
+          x_imag[i] += y[j].imag() * v[j][i];
+        }
+      }
+
+      // Finite-difference Jacobian-vector products J x_real, J x_imag
+      Vector<DoubleVector> jx(2);
+      for (unsigned part = 0; part < 2; part++)
+      {
+        const DoubleVector& x = (part == 0) ? x_real : x_imag;
+        for (unsigned i = 0; i < n_dof; i++)
+        {
+          problem_pt->dof(i) = dofs[i] + eps * x[i];
+        }
+        problem_pt->get_residuals(jx[part]);
+        for (unsigned i = 0; i < n_dof; i++)
+        {
+          jx[part][i] = (jx[part][i] - r0[i]) / eps;
+          problem_pt->dof(i) = dofs[i];
+        }
+      }
+
+      // |J x - lambda M x|
+      DoubleVector mx_real(problem_pt->dof_distribution_pt(), 0.0);
+      DoubleVector mx_imag(problem_pt->dof_distribution_pt(), 0.0);
+      multiply_by_mass_matrix(mass_column_index, mass_column, x_real, mx_real);
+      multiply_by_mass_matrix(mass_column_index, mass_column, x_imag, mx_imag);
+      double res = 0.0;
+      double lambda_r = eigenvalue[e].real();
+      double lambda_i = eigenvalue[e].imag();
+      for (unsigned i = 0; i < n_dof; i++)
+      {
+        double r_real =
+          jx[0][i] - lambda_r * mx_real[i] + lambda_i * mx_imag[i];
+        double r_imag =
+          jx[1][i] - lambda_r * mx_imag[i] - lambda_i * mx_real[i];
+        res += r_real * r_real + r_imag * r_imag;
+      }
+      residual[e] = std::sqrt(res);
+    }
+  }
+
+
+  //=========================================================================
+  /// Product of the mass matrix and a vector: the sum of M's nonzero
+  /// columns, weighted by the corresponding entries of x
+  //=========================================================================
+  inline void ShiftInvertArnoldiEigensolver::multiply_by_mass_matrix(
+    const Vector<unsigned>& mass_column_index,
+    const Vector<DoubleVector>& mass_column,
+    const DoubleVector& x,
+    DoubleVector& y)
+  {
+    const unsigned n_dof = x.nrow();
+    for (unsigned i = 0; i < n_dof; i++)
+    {
+      y[i] = 0.0;
+    }
+    unsigned n_column = mass_column_index.size();
+    for (unsigned k = 0; k < n_column; k++)
+    {
+      double x_k = x[mass_column_index[k]];
+      for (unsigned i = 0; i < n_dof; i++)
+      {
+        y[i] += x_k * mass_column[k][i];
+      }
+    }
+  }
+
+
+  //=========================================================================
+  /// Reduction to upper Hessenberg form by Householder reflections
+  /// H <- P H P with P = I - 2 u u^H / |u|^2, followed by the shifted QR
+  /// algorithm
+  //=========================================================================
+  inline void ShiftInvertArnoldiEigensolver::dense_eigenvalues(
+    const DenseMatrix<double>& a, Vector<std::complex<double>>& eigenvalue)
+  {
+    typedef std::complex<double> complex;
+    const unsigned n = a.nrow();
+    Vector<complex> h(n * n);
+    for (unsigned i = 0; i < n; i++)
+    {
+      for (unsigned j = 0; j < n; j++)
+      {
+        h[i * n + j] = a(i, j);
+      }
+    }
+
+    Vector<complex> u(n);
+    for (unsigned k = 0; k + 2 < n; k++)
+    {
+      // Householder vector that maps column k below the subdiagonal onto
+      // a multiple of the first unit vector
+      double norm_x = 0.0;
+      for (unsigned i = k + 1; i < n; i++)
+      {
+        norm_x += std::norm(h[i * n + k]);
+      }
+      norm_x = std::sqrt(norm_x);
+      if (norm_x == 0.0)
+      {
+        continue;
+      }
+      complex x0 = h[(k + 1) * n + k];
+      complex alpha =
+        (std::abs(x0) > 0.0) ? -x0 / std::abs(x0) * norm_x : complex(-norm_x);
+      double norm_u2 = 0.0;
+      for (unsigned i = k + 1; i < n; i++)
+      {
+        u[i] = h[i * n + k];
+      }
+      u[k + 1] -= alpha;
+      for (unsigned i = k + 1; i < n; i++)
+      {
+        norm_u2 += std::norm(u[i]);
+      }
+      if (norm_u2 == 0.0)
+      {
+        continue;
+      }
+
+      // H <- P H (column k becomes alpha e_{k+1} below the diagonal)
+      for (unsigned j = k + 1; j < n; j++)
+      {
+        complex dot = 0.0;
+        for (unsigned i = k + 1; i < n; i++)
+        {
+          dot += std::conj(u[i]) * h[i * n + j];
+        }
+        dot *= 2.0 / norm_u2;
+        for (unsigned i = k + 1; i < n; i++)
+        {
+          h[i * n + j] -= u[i] * dot;
+        }
+      }
+      h[(k + 1) * n + k] = alpha;
+      for (unsigned i = k + 2; i < n; i++)
+      {
+        h[i * n + k] = 0.0;
+      }
+
+      // H <- H P
+      for (unsigned i = 0; i < n; i++)
+      {
+        complex dot = 0.0;
+        for (unsigned j = k + 1; j < n; j++)
+        {
+          dot += h[i * n + j] * u[j];
+        }
+        dot *= 2.0 / norm_u2;
+        for (unsigned j = k + 1; j < n; j++)
+        {
+          h[i * n + j] -= dot * std::conj(u[j]);
+        }
+      }
+    }
+
+    hessenberg_eigenvalues(n, h, eigenvalue);
+  }
+
+
+  //=========================================================================
+  /// Shifted QR algorithm (in complex arithmetic, so complex conjugate
+  /// pairs need no special treatment) for the eigenvalues of an upper
+  /// Hessenberg matrix: Givens rotations for the QR steps, Wilkinson
+  /// shifts and deflation of negligible subdiagonal entries. Only the
+  /// active (undeflated) block is updated since the eigenvectors aren't
+  /// required.
+  //=========================================================================
+  inline void ShiftInvertArnoldiEigensolver::hessenberg_eigenvalues(
+    const unsigned& n,
+    Vector<std::complex<double>>& h,
+    Vector<std::complex<double>>& eigenvalue)
+  {
+    typedef std::complex<double> complex;
+    const double eps = std::numeric_limits<double>::epsilon();
+    eigenvalue.resize(n);
+    if (n == 0)
+    {
+      return;
+    }
+    Vector<complex> c(n);
+    Vector<complex> s(n);
+    unsigned n_iter = 0;
+    int hi = int(n) - 1;
+    while (hi > 0)
+    {
+      // Lowest row of the active block
+      int lo = hi;
+      while ((lo > 0) &&
+             (std::abs(h[lo * n + lo - 1]) >
+              eps * (std::abs(h[(lo - 1) * n + lo - 1]) +
+                     std::abs(h[lo * n + lo]))))
+      {
+        lo--;
+      }
+
+      // Deflate
+      if (lo == hi)
+      {
+        eigenvalue[hi] = h[hi * n + hi];
+        hi--;
+        n_iter = 0;
+        continue;
+      }
+      if (++n_iter > 100 * n)
+      {
+        throw OomphLibError("QR algorithm failed to converge",
+                            OOMPH_CURRENT_FUNCTION,
+                            OOMPH_EXCEPTION_LOCATION);
+      }
+
+      // Wilkinson shift: eigenvalue of the trailing 2x2 block nearer its
+      // last diagonal entry (an exceptional shift every 10 iterations to
+      // avoid cycles)
+      complex a = h[(hi - 1) * n + hi - 1];
+      complex b = h[(hi - 1) * n + hi];
+      complex cc = h[hi * n + hi - 1];
+      complex d = h[hi * n + hi];
+      complex half_trace = 0.5 * (a + d);
+      complex disc = std::sqrt(half_trace * half_trace - (a * d - b * cc));
+      complex shift = half_trace + disc;
+      if (std::abs(half_trace - disc - d) < std::abs(shift - d))
+      {
+        shift = half_trace - disc;
+      }
+      if (n_iter % 10 == 0)
+      {
+        shift = d + std::abs(cc);
+      }
+
+      // QR step on the active block: H - shift I = QR, H <- RQ + shift I
+      for (int i = lo; i <= hi; i++)
+      {
+        h[i * n + i] -= shift;
+      }
+      for (int k = lo; k < hi; k++)
+      {
+        complex x = h[k * n + k];
+        complex y = h[(k + 1) * n + k];
+        double r = std::sqrt(std::norm(x) + std::norm(y));
+        c[k] = (r == 0.0) ? complex(1.0) : x / r;
+        s[k] = (r == 0.0) ? complex(0.0) : y / r;
+        for (int j = k; j <= hi; j++)
+        {
+          complex u = h[k * n + j];
+          complex w = h[(k + 1) * n + j];
+          h[k * n + j] = std::conj(c[k]) * u + std::conj(s[k]) * w;
+          h[(k + 1) * n + j] = -s[k] * u + c[k] * w;
+        }
+      }
+      for (int k = lo; k < hi; k++)
+      {
+        int i_max = std::min(k + 2, hi);
+        for (int i = lo; i <= i_max; i++)
+        {
+          complex u = h[i * n + k];
+          complex w = h[i * n + k + 1];
+          h[i * n + k] = u * c[k] + w * s[k];
+          h[i * n + k + 1] = -u * std::conj(s[k]) + w * std::conj(c[k]);
+        }
+      }
+      for (int i = lo; i <= hi; i++)
+      {
+        h[i * n + i] += shift;
+      }
+    }
+    eigenvalue[0] = h[0];
+  }
+
+
+  //=========================================================================
+  /// Inverse iteration (two steps, Gaussian elimination with partial
+  /// pivoting) for the eigenvector of an upper Hessenberg matrix; the
+  /// eigenvalue is perturbed slightly so H - mu I isn't exactly singular
+  //=========================================================================
+  inline void ShiftInvertArnoldiEigensolver::hessenberg_eigenvector(
+    const unsigned& n,
+    const Vector<std::complex<double>>& h,
+    const std::complex<double>& mu,
+    Vector<std::complex<double>>& y)
+  {
+    typedef std::complex<double> complex;
+    double h_norm = 0.0;
+    for (unsigned i = 0; i < n * n; i++)
+    {
+      h_norm = std::max(h_norm, std::abs(h[i]));
+    }
+    complex mu_perturbed =
+      mu + complex(1.0e-10 * std::max(h_norm, std::abs(mu)), 0.0);
+
+    // LU decomposition of H - mu I
+    Vector<complex> a(h);
+    Vector<unsigned> pivot(n);
+    for (unsigned i = 0; i < n; i++)
+    {
+      a[i * n + i] -= mu_perturbed;
+    }
+    for (unsigned k = 0; k < n; k++)
+    {
+      unsigned p = k;
+      for (unsigned i = k + 1; i < n; i++)
+      {
+        if (std::abs(a[i * n + k]) > std::abs(a[p * n + k]))
+        {
+          p = i;
+        }
+      }
+      pivot[k] = p;
+      if (p != k)
+      {
+        for (unsigned j = 0; j < n; j++)
+        {
+          std::swap(a[k * n + j], a[p * n + j]);
+        }
+      }
+      if (a[k * n + k] == complex(0.0))
+      {
+        a[k * n + k] = complex(std::numeric_limits<double>::epsilon() *
+                               std::max(h_norm, 1.0));
+      }
+      for (unsigned i = k + 1; i < n; i++)
+      {
+        complex factor = a[i * n + k] / a[k * n + k];
+        a[i * n + k] = factor;
+        for (unsigned j = k + 1; j < n; j++)
+        {
+          a[i * n + j] -= factor * a[k * n + j];
+        }
+      }
+    }
+
+    // Two steps of inverse iteration from a vector of ones
+    y.assign(n, complex(1.0));
+    for (unsigned iter = 0; iter < 2; iter++)
+    {
+      // (all pivots are applied first since the rows were swapped in
+      // their entirety)
+      for (unsigned k = 0; k < n; k++)
+      {
+        std::swap(y[k], y[pivot[k]]);
+      }
+      for (unsigned k = 0; k < n; k++)
+      {
+        for (unsigned i = k + 1; i < n; i++)
+        {
+          y[i] -= a[i * n + k] * y[k];
+        }
+      }
+      for (int i = int(n) - 1; i >= 0; i--)
+      {
+        for (unsigned j = i + 1; j < n; j++)
+        {
+          y[i] -= a[i * n + j] * y[j];
+        }
+        y[i] /= a[i * n + i];
+      }
+      double norm = 0.0;
+      for (unsigned i = 0; i < n; i++)
+      {
+        norm += std::norm(y[i]);
+      }
+      norm = std::sqrt(norm);
+      for (unsigned i = 0; i < n; i++)
+      {
+        y[i] /= norm;
+      }
+    }
+  }
+
+} // namespace oomph
+
+#endif
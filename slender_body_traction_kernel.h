@@ -0,0 +1,645 @@
+// LIC// ====================================================================
+// LIC// This file forms part of oomph-lib, the object-oriented,
+// LIC// multi-physics finite-element library, available
+// LIC// at http://www.oomph-lib.org.
+// LIC//
+// LIC// Copyright (C) 2006-2023 Matthias Heil and Andrew Hazel
+// LIC//
+// LIC// This library is free software; you can redistribute it and/or
+// LIC// modify it under the terms of the GNU Lesser General Public
+// LIC// License as published by the Free Software Foundation; either
+// LIC// version 2.1 of the License, or (at your option) any later version.
+// LIC//
+// LIC// This library is distributed in the hope that it will be useful,
+// LIC// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// LIC// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// LIC// Lesser General Public License for more details.
+// LIC//
+// LIC// You should have received a copy of the GNU Lesser General Public
+// LIC// License along with this library; if not, write to the Free Software
+// LIC// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+// LIC// 02110-1301  USA.
+// LIC//
+// LIC// The authors may be contacted at oomph-lib@maths.man.ac.uk.
+// LIC//
+// LIC//====================================================================
+// Batched (SIMD) evaluation of the resistive-force slender body traction
+
+#ifndef SLENDER_BODY_TRACTION_KERNEL_HEADER
+#define SLENDER_BODY_TRACTION_KERNEL_HEADER
+
+#if defined(__AVX512F__) || defined(__AVX__)
+#include <immintrin.h>
+#endif
+
+// OOMPH-LIB includes
+#include "generic.h"
+
+namespace oomph
+{
+  //=========================================================================
+  /// Structure-of-arrays storage for the slender body traction at a batch
+  /// of points (typically all integration points of one arm): the inputs
+  /// (position vector R_0, unit normal N_0 before the rigid body motion
+  /// is applied, and the integration weight premultiplied by the
+  /// Jacobian) and the outputs (traction on the actual beam, traction in
+  /// the reference configuration and torque density). Storage only
+  /// grows, so re-using a batch doesn't allocate any memory once it has
+  /// reached its final size.
+  //=========================================================================
+  class SlenderBodyTractionBatch
+  {
+  public:
+    /// Constructor: Empty batch
+    SlenderBodyTractionBatch() : N_point(0) {}
+
+    /// Set the number of points
+    void resize(const unsigned& n_point)
+    {
+      N_point = n_point;
+      if (R_0_x.size() < n_point)
+      {
+        R_0_x.resize(n_point);
+        R_0_y.resize(n_point);
+        N_0_x.resize(n_point);
+        N_0_y.resize(n_point);
+        W.resize(n_point);
+        Traction_x.resize(n_point);
+        Traction_y.resize(n_point);
+        Traction_0_x.resize(n_point);
+        Traction_0_y.resize(n_point);
+        Torque_density.resize(n_point);
+      }
+    }
+
+    /// Number of points
+    unsigned npoint() const
+    {
+      return N_point;
+    }
+
+    /// Components of the position vector R_0 (before the rigid body
+    /// motion is applied)
+    std::vector<double> R_0_x;
+    std::vector<double> R_0_y;
+
+    /// Components of the unit normal N_0 (before the rigid body motion is
+    /// applied)
+    std::vector<double> N_0_x;
+    std::vector<double> N_0_y;
+
+    /// Integration weight, premultiplied by the Jacobian
+    std::vector<double> W;
+
+    /// Components of the traction on the actual beam
+    std::vector<double> Traction_x;
+    std::vector<double> Traction_y;
+
+    /// Components of the traction in the reference configuration
+    std::vector<double> Traction_0_x;
+    std::vector<double> Traction_0_y;
+
+    /// Torque density (about the centre of mass)
+    std::vector<double> Torque_density;
+
+  private:
+    /// Number of points
+    unsigned N_point;
+  };
+
+
+  //=========================================================================
+  /// Kernels for the evaluation of the resistive-force slender body
+  /// traction
+  ///
+  ///   traction_x = 0.5 (U_x - R_y) N_y^2 - 0.5 N_y N_x U_y - U_x + R_y
+  ///   traction_y = 0.5 U_y N_x^2 - 0.5 N_y (U_x - R_y) N_x - U_y
+  ///
+  /// where R and N are the position vector and unit normal after the
+  /// rigid body motion (rotation by theta and translation) has been
+  /// applied and (U_x, U_y) is the velocity of the beam at R. For a
+  /// translation with velocity (V t + U0, V) and an angular velocity
+  /// omega about the translated origin, (X, Y),
+  ///
+  ///   U_x = V t + U0 - omega (R_y - Y),   U_y = V + omega (R_x - X);
+  ///
+  /// omega = 0 for the pseudo-equilibrium in which the beam's
+  /// orientation doesn't change. The kernels process batches of points
+  /// in AVX-512 (8 lanes) or AVX (4 lanes) registers, if the compiler
+  /// targets these instruction sets, or in scalar code otherwise. All
+  /// code paths perform the same sequence of (unfused) floating point
+  /// operations for each point; incomplete groups of points are padded
+  /// and processed in the same way as complete ones. The weighted sums
+  /// always use eight partial sums (point i contributes to partial sum
+  /// i%8) that are combined in a fixed order, so the reductions are
+  /// bitwise reproducible and independent of the lane width. (The
+  /// results of the different code paths are bitwise identical
+  /// provided the compiler doesn't contract multiplications and
+  /// additions into fused multiply-adds, e.g. with -ffp-contract=off.)
+  //=========================================================================
+  namespace SlenderBodyTractionKernel
+  {
+    /// Number of partial sums used in the reductions (and max. number
+    /// of lanes)
+    const unsigned N_partial_sum = 8;
+
+#if defined(__AVX512F__)
+    /// Number of points processed simultaneously
+    const unsigned N_lane = 8;
+#elif defined(__AVX__)
+    /// Number of points processed simultaneously
+    const unsigned N_lane = 4;
+#else
+    /// Number of points processed simultaneously
+    const unsigned N_lane = 1;
+#endif
+
+    /// Evaluate the traction for N_lane points, starting at the given
+    /// pointers. The rigid body motion is specified by the cosine and
+    /// sine of the angle of rotation and the translation (shift_x,
+    /// shift_y); vt_plus_u0 is V*t+U0 and omega the angular velocity
+    /// (about the translated origin). Torque density (about r_centre)
+    /// is only computed if torque_density is non-null.
+    inline void evaluate_lanes(const double* r0_x,
+                               const double* r0_y,
+                               const double* n0_x,
+                               const double* n0_y,
+                               const double& cos_theta,
+                               const double& sin_theta,
+                               const double& shift_x,
+                               const double& shift_y,
+                               const double& V,
+                               const double& vt_plus_u0,
+                               const double& omega,
+                               const double* r_centre,
+                               double* traction_x,
+                               double* traction_y,
+                               double* traction_0_x,
+                               double* traction_0_y,
+                               double* torque_density)
+    {
+#if defined(__AVX512F__)
+      typedef __m512d lane_t;
+#define SBT_SET1 _mm512_set1_pd
+#define SBT_LOAD _mm512_loadu_pd
+#define SBT_STORE _mm512_storeu_pd
+#define SBT_ADD _mm512_add_pd
+#define SBT_SUB _mm512_sub_pd
+#define SBT_MUL _mm512_mul_pd
+#elif defined(__AVX__)
+      typedef __m256d lane_t;
+#define SBT_SET1 _mm256_set1_pd
+#define SBT_LOAD _mm256_loadu_pd
+#define SBT_STORE _mm256_storeu_pd
+#define SBT_ADD _mm256_add_pd
+#define SBT_SUB _mm256_sub_pd
+#define SBT_MUL _mm256_mul_pd
+#else
+      typedef double lane_t;
+#define SBT_SET1(a) (a)
+#define SBT_LOAD(p) (*(p))
+#define SBT_STORE(p, a) (*(p) = (a))
+#define SBT_ADD(a, b) ((a) + (b))
+#define SBT_SUB(a, b) ((a) - (b))
+#define SBT_MUL(a, b) ((a) * (b))
+#endif
+      const lane_t c = SBT_SET1(cos_theta);
+      const lane_t s = SBT_SET1(sin_theta);
+      const lane_t half = SBT_SET1(0.5);
+      const lane_t v = SBT_SET1(V);
+      const lane_t vt_u0 = SBT_SET1(vt_plus_u0);
+      const lane_t om = SBT_SET1(omega);
+
+      const lane_t x0 = SBT_LOAD(r0_x);
+      const lane_t y0 = SBT_LOAD(r0_y);
+      const lane_t nx0 = SBT_LOAD(n0_x);
+      const lane_t ny0 = SBT_LOAD(n0_y);
+
+      // Position vector and normal after translation and rotation
+      const lane_t rx =
+        SBT_ADD(SBT_SUB(SBT_MUL(c, x0), SBT_MUL(s, y0)), SBT_SET1(shift_x));
+      const lane_t ry =
+        SBT_ADD(SBT_ADD(SBT_MUL(s, x0), SBT_MUL(c, y0)), SBT_SET1(shift_y));
+      const lane_t nx = SBT_SUB(SBT_MUL(c, nx0), SBT_MUL(s, ny0));
+      const lane_t ny = SBT_ADD(SBT_MUL(s, nx0), SBT_MUL(c, ny0));
+
+      // Velocity of the beam (translation plus rotation about the
+      // translated origin)
+      const lane_t ux =
+        SBT_SUB(vt_u0, SBT_MUL(om, SBT_SUB(ry, SBT_SET1(shift_y))));
+      const lane_t uy =
+        SBT_ADD(v, SBT_MUL(om, SBT_SUB(rx, SBT_SET1(shift_x))));
+
+      // Traction on the actual beam
+      const lane_t a = SBT_SUB(ux, ry);
+      const lane_t tx = SBT_ADD(
+        SBT_SUB(SBT_SUB(SBT_MUL(SBT_MUL(SBT_MUL(half, a), ny), ny),
+                        SBT_MUL(SBT_MUL(SBT_MUL(half, ny), nx), uy)),
+                ux),
+        ry);
+      const lane_t ty =
+        SBT_SUB(SBT_SUB(SBT_MUL(SBT_MUL(SBT_MUL(half, uy), nx), nx),
+                        SBT_MUL(SBT_MUL(SBT_MUL(half, ny), a), nx)),
+                uy);
+      SBT_STORE(traction_x, tx);
+      SBT_STORE(traction_y, ty);
+
+      // Rotate back to the reference configuration
+      SBT_STORE(traction_0_x, SBT_ADD(SBT_MUL(tx, c), SBT_MUL(ty, s)));
+      SBT_STORE(traction_0_y, SBT_SUB(SBT_MUL(ty, c), SBT_MUL(tx, s)));
+
+      // Torque density about the centre of mass
+      if (torque_density != 0)
+      {
+        const lane_t dx = SBT_SUB(rx, SBT_SET1(r_centre[0]));
+        const lane_t dy = SBT_SUB(ry, SBT_SET1(r_centre[1]));
+        SBT_STORE(torque_density, SBT_SUB(SBT_MUL(dx, ty), SBT_MUL(dy, tx)));
+      }
+#undef SBT_SET1
+#undef SBT_LOAD
+#undef SBT_STORE
+#undef SBT_ADD
+#undef SBT_SUB
+#undef SBT_MUL
+    }
+
+
+    /// Scalar version of evaluate_lanes(...) for a single point,
+    /// templated on the scalar type so it can be used with dual numbers
+    /// (for the automatic differentiation of the drag and torque). Also
+    /// returns the position vector (rx, ry) after the rigid body motion.
+    /// Performs the same sequence of operations as evaluate_lanes(...).
+    template<class SCALAR>
+    inline void evaluate_point(const SCALAR& r0_x,
+                               const SCALAR& r0_y,
+                               const SCALAR& n0_x,
+                               const SCALAR& n0_y,
+                               const SCALAR& cos_theta,
+                               const SCALAR& sin_theta,
+                               const SCALAR& shift_x,
+                               const SCALAR& shift_y,
+                               const SCALAR& V,
+                               const SCALAR& vt_plus_u0,
+                               const SCALAR& omega,
+                               SCALAR& rx,
+                               SCALAR& ry,
+                               SCALAR& traction_x,
+                               SCALAR& traction_y)
+    {
+      // Position vector and normal after translation and rotation
+      rx = cos_theta * r0_x - sin_theta * r0_y + shift_x;
+      ry = sin_theta * r0_x + cos_theta * r0_y + shift_y;
+      const SCALAR nx = cos_theta * n0_x - sin_theta * n0_y;
+      const SCALAR ny = sin_theta * n0_x + cos_theta * n0_y;
+
+      // Velocity of the beam (translation plus rotation about the
+      // translated origin)
+      const SCALAR ux = vt_plus_u0 - omega * (ry - shift_y);
+      const SCALAR uy = V + omega * (rx - shift_x);
+
+      // Traction on the actual beam
+      const SCALAR a = ux - ry;
+      traction_x = 0.5 * a * ny * ny - 0.5 * ny * nx * uy - ux + ry;
+      traction_y = 0.5 * uy * nx * nx - 0.5 * ny * a * nx - uy;
+    }
+
+
+    /// Evaluate the traction on the actual beam and in the reference
+    /// configuration at n_point points whose position vectors and unit
+    /// normals (before the rigid body motion is applied) are
+    /// (r0_x, r0_y) and (n0_x, n0_y). Rigid body motion: Rotation by
+    /// theta, translation (0.5 V t^2 + U0 t + X0, V t + Y0) and angular
+    /// velocity omega. If r_centre is non-null, the torque density about
+    /// r_centre is computed as well.
+    inline void evaluate(const unsigned& n_point,
+                         const double* r0_x,
+                         const double* r0_y,
+                         const double* n0_x,
+                         const double* n0_y,
+                         const double& V,
+                         const double& U0,
+                         const double& theta,
+                         const double& X0,
+                         const double& Y0,
+                         const double& t,
+                         const double& omega,
+                         const double* r_centre,
+                         double* traction_x,
+                         double* traction_y,
+                         double* traction_0_x,
+                         double* traction_0_y,
+                         double* torque_density)
+    {
+      const double cos_theta = std::cos(theta);
+      const double sin_theta = std::sin(theta);
+      const double shift_x = 0.5 * V * t * t + U0 * t + X0;
+      const double shift_y = V * t + Y0;
+      const double vt_plus_u0 = V * t + U0;
+
+      // Complete groups of lanes
+      unsigned n_full = (n_point / N_lane) * N_lane;
+      for (unsigned i = 0; i < n_full; i += N_lane)
+      {
+        evaluate_lanes(r0_x + i,
+                       r0_y + i,
+                       n0_x + i,
+                       n0_y + i,
+                       cos_theta,
+                       sin_theta,
+                       shift_x,
+                       shift_y,
+                       V,
+                       vt_plus_u0,
+                       omega,
+                       r_centre,
+                       traction_x + i,
+                       traction_y + i,
+                       traction_0_x + i,
+                       traction_0_y + i,
+                       (torque_density == 0) ? 0 : torque_density + i);
+      }
+
+      // Remainder: pad and process like a complete group
+      unsigned n_rest = n_point - n_full;
+      if (n_rest > 0)
+      {
+        double in[4][N_lane];
+        double out[5][N_lane];
+        for (unsigned j = 0; j < N_lane; j++)
+        {
+          unsigned i = (j < n_rest) ? n_full + j : n_full;
+          in[0][j] = r0_x[i];
+          in[1][j] = r0_y[i];
+          in[2][j] = n0_x[i];
+          in[3][j] = n0_y[i];
+        }
+        evaluate_lanes(in[0],
+                       in[1],
+                       in[2],
+                       in[3],
+                       cos_theta,
+                       sin_theta,
+                       shift_x,
+                       shift_y,
+                       V,
+                       vt_plus_u0,
+                       omega,
+                       r_centre,
+                       out[0],
+                       out[1],
+                       out[2],
+                       out[3],
+                       (torque_density == 0) ? 0 : out[4]);
+        for (unsigned j = 0; j < n_rest; j++)
+        {
+          traction_x[n_full + j] = out[0][j];
+          traction_y[n_full + j] = out[1][j];
+          traction_0_x[n_full + j] = out[2][j];
+          traction_0_y[n_full + j] = out[3][j];
+          if (torque_density != 0)
+          {
+            torque_density[n_full + j] = out[4][j];
+          }
+        }
+      }
+    }
+
+
+    /// Evaluate the traction etc. for all points in the batch
+    inline void evaluate(SlenderBodyTractionBatch& batch,
+                         const double& V,
+                         const double& U0,
+                         const double& theta,
+                         const double& X0,
+                         const double& Y0,
+                         const double& t,
+                         const double& omega,
+                         const double* r_centre)
+    {
+      if (batch.npoint() == 0)
+      {
+        return;
+      }
+      evaluate(batch.npoint(),
+               &batch.R_0_x[0],
+               &batch.R_0_y[0],
+               &batch.N_0_x[0],
+               &batch.N_0_y[0],
+               V,
+               U0,
+               theta,
+               X0,
+               Y0,
+               t,
+               omega,
+               r_centre,
+               &batch.Traction_x[0],
+               &batch.Traction_y[0],
+               &batch.Traction_0_x[0],
+               &batch.Traction_0_y[0],
+               (r_centre == 0) ? 0 : &batch.Torque_density[0]);
+    }
+
+
+    /// Return sum_i w[i]*f[i] over n_point points, using N_partial_sum
+    /// partial sums combined in a fixed order. An incomplete last group
+    /// of points is padded with zeroes.
+    inline double weighted_sum(const unsigned& n_point,
+                               const double* w,
+                               const double* f)
+    {
+      // Padded copy of the last (incomplete) group of points
+      double w_pad[N_partial_sum];
+      double f_pad[N_partial_sum];
+      unsigned n_full = (n_point / N_partial_sum) * N_partial_sum;
+      unsigned n_group = n_full / N_partial_sum;
+      if (n_full < n_point)
+      {
+        for (unsigned j = 0; j < N_partial_sum; j++)
+        {
+          bool in_range = (n_full + j < n_point);
+          w_pad[j] = in_range ? w[n_full + j] : 0.0;
+          f_pad[j] = in_range ? f[n_full + j] : 0.0;
+        }
+        n_group++;
+      }
+
+      double partial[N_partial_sum];
+#if defined(__AVX512F__)
+      __m512d acc = _mm512_setzero_pd();
+#elif defined(__AVX__)
+      __m256d acc_lo = _mm256_setzero_pd();
+      __m256d acc_hi = _mm256_setzero_pd();
+#else
+      for (unsigned j = 0; j < N_partial_sum; j++)
+      {
+        partial[j] = 0.0;
+      }
+#endif
+      for (unsigned g = 0; g < n_group; g++)
+      {
+        const double* w_pt = w + g * N_partial_sum;
+        const double* f_pt = f + g * N_partial_sum;
+        if (g * N_partial_sum == n_full)
+        {
+          w_pt = w_pad;
+          f_pt = f_pad;
+        }
+#if defined(__AVX512F__)
+        acc = _mm512_add_pd(
+          acc, _mm512_mul_pd(_mm512_loadu_pd(w_pt), _mm512_loadu_pd(f_pt)));
+#elif defined(__AVX__)
+        acc_lo = _mm256_add_pd(
+          acc_lo, _mm256_mul_pd(_mm256_loadu_pd(w_pt), _mm256_loadu_pd(f_pt)));
+        acc_hi = _mm256_add_pd(acc_hi,
+                               _mm256_mul_pd(_mm256_loadu_pd(w_pt + 4),
+                                             _mm256_loadu_pd(f_pt + 4)));
+#else
+        for (unsigned j = 0; j < N_partial_sum; j++)
+        {
+          partial[j] += w_pt[j] * f_pt[j];
+        }
+#endif
+      }
+#if defined(__AVX512F__)
+      _mm512_storeu_pd(partial, acc);
+#elif defined(__AVX__)
+      _mm256_storeu_pd(partial, acc_lo);
+      _mm256_storeu_pd(partial + 4, acc_hi);
+#endif
+
+      // Combine the partial sums pairwise in a fixed order
+      double sum_01 = partial[0] + partial[1];
+      double sum_23 = partial[2] + partial[3];
+      double sum_45 = partial[4] + partial[5];
+      double sum_67 = partial[6] + partial[7];
+      return (sum_01 + sum_23) + (sum_45 + sum_67);
+    }
+
+
+    /// Drag (integral of the traction on the actual beam) and torque
+    /// (integral of the torque density) from the points in the batch
+    inline void integrate_drag_and_torque(
+      const SlenderBodyTractionBatch& batch,
+      double& drag_x,
+      double& drag_y,
+      double& torque)
+    {
+      drag_x = 0.0;
+      drag_y = 0.0;
+      torque = 0.0;
+      unsigned n_point = batch.npoint();
+      if (n_point == 0)
+      {
+        return;
+      }
+      drag_x = weighted_sum(n_point, &batch.W[0], &batch.Traction_x[0]);
+      drag_y = weighted_sum(n_point, &batch.W[0], &batch.Traction_y[0]);
+      torque = weighted_sum(n_point, &batch.W[0], &batch.Torque_density[0]);
+    }
+
+
+    /// Self-test: Compare the traction, its rotation to the reference
+    /// configuration and the torque density computed by evaluate(...)
+    /// (complete groups of lanes and a padded remainder) and the weighted
+    /// sum with the scalar evaluate_point(...) and a plain loop for a
+    /// set of test points. Returns 0 if they agree to within roundoff,
+    /// 1 otherwise.
+    inline unsigned self_test()
+    {
+      // Test points on a curve (with unit normals) and weights
+      const unsigned n_point = 2 * N_lane + 3;
+      Vector<double> r0_x(n_point), r0_y(n_point);
+      Vector<double> n0_x(n_point), n0_y(n_point), w(n_point);
+      for (unsigned i = 0; i < n_point; i++)
+      {
+        double phi = 0.3 * double(i);
+        r0_x[i] = 0.1 * double(i) + 0.05 * std::sin(phi);
+        r0_y[i] = 0.7 - 0.2 * std::cos(phi);
+        n0_x[i] = std::cos(phi);
+        n0_y[i] = std::sin(phi);
+        w[i] = 0.01 * (1.0 + 0.1 * double(i));
+      }
+
+      // Rigid body motion
+      const double V = -0.3, U0 = 0.2, theta = 0.4, X0 = 0.1, Y0 = -0.2;
+      const double t = 0.5, omega = 0.15;
+      const double r_centre[2] = {0.25, 0.3};
+
+      Vector<double> traction_x(n_point), traction_y(n_point);
+      Vector<double> traction_0_x(n_point), traction_0_y(n_point);
+      Vector<double> torque_density(n_point);
+      evaluate(n_point,
+               &r0_x[0],
+               &r0_y[0],
+               &n0_x[0],
+               &n0_y[0],
+               V,
+               U0,
+               theta,
+               X0,
+               Y0,
+               t,
+               omega,
+               r_centre,
+               &traction_x[0],
+               &traction_y[0],
+               &traction_0_x[0],
+               &traction_0_y[0],
+               &torque_density[0]);
+
+      // Scalar reference
+      const double cos_theta = std::cos(theta);
+      const double sin_theta = std::sin(theta);
+      double max_error = 0.0;
+      double sum = 0.0;
+      for (unsigned i = 0; i < n_point; i++)
+      {
+        double rx = 0.0, ry = 0.0, tx = 0.0, ty = 0.0;
+        evaluate_point(r0_x[i],
+                       r0_y[i],
+                       n0_x[i],
+                       n0_y[i],
+                       cos_theta,
+                       sin_theta,
+                       0.5 * V * t * t + U0 * t + X0,
+                       V * t + Y0,
+                       V,
+                       V * t + U0,
+                       omega,
+                       rx,
+                       ry,
+                       tx,
+                       ty);
+        double error[5] = {
+          traction_x[i] - tx,
+          traction_y[i] - ty,
+          traction_0_x[i] - (tx * cos_theta + ty * sin_theta),
+          traction_0_y[i] - (ty * cos_theta - tx * sin_theta),
+          torque_density[i] -
+            ((rx - r_centre[0]) * ty - (ry - r_centre[1]) * tx)};
+        for (unsigned k = 0; k < 5; k++)
+        {
+          max_error = std::max(max_error, std::fabs(error[k]));
+        }
+        sum += w[i] * traction_x[i];
+      }
+      double sum_error =
+        std::fabs(weighted_sum(n_point, &w[0], &traction_x[0]) - sum);
+
+      oomph_info << "Slender body traction kernel (" << N_lane
+                 << " lanes) vs scalar version: max. difference "
+                 << max_error << "; weighted sum: difference " << sum_error
+                 << std::endl;
+      if ((max_error > 1.0e-14) || (sum_error > 1.0e-14))
+      {
+        return 1;
+      }
+      return 0;
+    }
+
+  } // namespace SlenderBodyTractionKernel
+
+} // namespace oomph
+
+#endif
@@ -1,9 +1,44 @@
 #! /bin/bash
 
 
-make reparametrise_beam_test
+make reparametrise_beam_test beam_with_point_load
 
-rm -rf RESLT RESLT_old RESLT_new
+rm -rf RESLT RESLT_old RESLT_new RESLT_suspension RESLT_ensemble \
+  RESLT_unsteady RESLT_nonlocal RESLT_r_adapt \
+  RESLT_richardson RESLT_direct RESLT_jfnk RESLT_multigrid \
+  RESLT_multigrid_scaling \
+  RESLT_jacobian_reuse RESLT_automatic_differentiation \
+  RESLT_incremental_fd_jacobian RESLT_vtk RESLT_snapshot_archive \
+  RESLT_solution_cache RESLT_stability RESLT_slide_point_load \
+  RESLT_nonlocal_direct RESLT_nonlocal_treecode RESLT_fixed_quadrature \
+  RESLT_graded_mesh RESLT_load_cases RESLT_follower_load \
+  RESLT_follower_load_ad RESLT_point_load_array RESLT_point_load_array_ad \
+  RESLT_no_integration_point_cache RESLT_suspension_direct \
+  RESLT_ensemble_direct
+
+# Compare two files of numbers entry by entry: fails (with a message)
+# if the max. difference exceeds the (relative) tolerance times the max.
+# magnitude of the entries in the first file
+# Usage: compare_results file1 file2 tol label
+compare_results()
+{
+  if ! paste "$1" "$2" | awk -v tol="$3" '
+    {
+      n = NF / 2
+      for (i = 1; i <= n; i++)
+      {
+        d = $i - $(i + n); if (d < 0) d = -d
+        a = $i; if (a < 0) a = -a
+        if (d > diff) diff = d
+        if (a > scale) scale = a
+      }
+    }
+    END{print "max. difference", diff, "max. entry", scale;
+        exit !(diff <= tol * scale)}'; then
+    echo "$4 check failed: results differ"
+    exit 1
+  fi
+}
 
 mkdir RESLT
 ./reparametrise_beam_test --q 0.3
@@ -13,3 +48,314 @@ mkdir RESLT
 ./reparametrise_beam_test --q 0.3 --old_version
 mv RESLT RESLT_old
 
+# Sedimentation of a suspension of four interacting boomerangs (a few
+# timesteps); the driver exits with an error if a timestep fails
+mkdir RESLT
+./reparametrise_beam_test --n_particle 4 --I 0.01 --t_max 0.05 || exit 1
+mv RESLT RESLT_suspension
+
+# Same with the direct solver for the Newton systems (rather than the
+# particle-by-particle block solver): same trajectories
+mkdir RESLT
+./reparametrise_beam_test --n_particle 4 --I 0.01 --t_max 0.05 \
+  --particle_direct_solver || exit 1
+compare_results RESLT_suspension/suspension_trajectory.dat \
+  RESLT/suspension_trajectory.dat 1.0e-6 "Suspension: block solver vs direct"
+mv RESLT RESLT_suspension_direct
+
+# Ensemble of eight independent boomerangs; all members must have been
+# solved and documented
+mkdir RESLT
+./reparametrise_beam_test --n_ensemble 8 --I 0.01 || exit 1
+if [ $(wc -l < RESLT/ensemble.dat) -ne 8 ]; then
+  echo "Ensemble check failed: wrong number of members in ensemble.dat"
+  exit 1
+fi
+mv RESLT RESLT_ensemble
+
+# Same with the direct solver for the (block-diagonal) Newton system:
+# same results for all members
+mkdir RESLT
+./reparametrise_beam_test --n_ensemble 8 --I 0.01 --particle_direct_solver \
+  || exit 1
+compare_results RESLT_ensemble/ensemble.dat RESLT/ensemble.dat 1.0e-6 \
+  "Ensemble: block solver vs direct"
+mv RESLT RESLT_ensemble_direct
+
+# Time-dependent sedimentation of the two-armed boomerang (a few
+# timesteps); the rigid body must have moved
+mkdir RESLT
+./reparametrise_beam_test --q 0.3 --unsteady --I 0.01 --t_max 0.05 || exit 1
+if ! awk 'NR==1{x0=$2; theta=$4} END{exit !(($2!=x0) || ($4!=theta))}' \
+  RESLT/trajectory.dat; then
+  echo "Unsteady check failed: the rigid body didn't move"
+  exit 1
+fi
+mv RESLT RESLT_unsteady
+
+# The nonlocal slender body traction must differ from the local one
+mkdir RESLT
+./reparametrise_beam_test --q 0.3 --I 0.01 --nonlocal_slender_body \
+  --check_nonlocal_traction || exit 1
+mv RESLT RESLT_nonlocal
+
+# Continuation with r-adaptation after every second step: the adapted
+# meshes must have been reported (with their ratio of largest to
+# smallest element)
+mkdir RESLT
+./reparametrise_beam_test --q 0.3 --max_continuation_steps 5 \
+  --r_adapt_interval 2 > RESLT/log.dat || exit 1
+if ! grep "r-adapted beam mesh" RESLT/log.dat; then
+  echo "r-adaptation check failed: no adapted mesh"
+  exit 1
+fi
+mv RESLT RESLT_r_adapt
+
+# Richardson extrapolation with 8, 16 and 32 elements per arm (each
+# solve steps I up to 0.01); fails if any of the solves fails
+mkdir RESLT
+./reparametrise_beam_test --q 0.3 --richardson --I 0.01 --n_element 8 \
+  || exit 1
+cat RESLT/richardson.dat
+mv RESLT RESLT_richardson
+
+# Steady solve for I = 0.01 with the direct solver; reference for the
+# other linear solvers. Also checks the banded LU factorisation against
+# SuperLU, and the RigidBodyElement's Jacobians by automatic
+# differentiation and incremental finite differencing against finite
+# differencing, for the Jacobian of the solution, and the vectorised
+# slender body traction kernel against its scalar version
+mkdir RESLT
+./reparametrise_beam_test --q 0.3 --steady_solve --I 0.01 \
+  --check_banded_lu --check_jacobian --check_traction_kernel || exit 1
+mv RESLT RESLT_direct
+
+# Same solve with JFNK (GMRES with the beam block preconditioner)
+mkdir RESLT
+./reparametrise_beam_test --q 0.3 --steady_solve --I 0.01 --jfnk || exit 1
+compare_results RESLT_direct/steady_solution.dat RESLT/steady_solution.dat \
+  1.0e-6 "JFNK vs direct"
+mv RESLT RESLT_jfnk
+
+# Same solve with GMRES, preconditioned by geometric multigrid
+mkdir RESLT
+./reparametrise_beam_test --q 0.3 --steady_solve --I 0.01 --multigrid \
+  || exit 1
+compare_results RESLT_direct/steady_solution.dat RESLT/steady_solution.dat \
+  1.0e-6 "Multigrid vs direct"
+mv RESLT RESLT_multigrid
+
+# Mesh independence of the multigrid preconditioner: the max. number of
+# GMRES iterations per Newton step on meshes with 10, 20 and 40 elements
+# per arm (the coarsening merges elements, so odd element counts
+# arise on the coarser levels) mustn't grow by more than a factor of two
+mkdir RESLT
+for n_element in 10 20 40; do
+  ./reparametrise_beam_test --q 0.3 --steady_solve --I 0.01 --multigrid \
+    --n_element $n_element > RESLT/log_n$n_element.dat || exit 1
+  grep "Max. number of linear solver iterations" RESLT/log_n$n_element.dat \
+    | awk -v n=$n_element '{print n, $NF}' >> RESLT/iterations.dat
+done
+cat RESLT/iterations.dat
+if [ $(wc -l < RESLT/iterations.dat) -ne 3 ] || ! awk '
+  NR == 1 { min = $2; max = $2 }
+  { if ($2 < min) min = $2; if ($2 > max) max = $2 }
+  END { exit !(min > 0 && max <= 2 * min) }' RESLT/iterations.dat; then
+  echo "Multigrid scaling check failed: iteration counts not mesh-independent"
+  exit 1
+fi
+mv RESLT RESLT_multigrid_scaling
+
+# Same solve with the re-used (Broyden-updated) Jacobian...
+mkdir RESLT
+./reparametrise_beam_test --q 0.3 --steady_solve --I 0.01 \
+  --jacobian_reuse || exit 1
+compare_results RESLT_direct/steady_solution.dat RESLT/steady_solution.dat \
+  1.0e-6 "Jacobian reuse vs direct"
+
+# ...and in a few continuation steps, each of which must report its
+# statistics
+./reparametrise_beam_test --q 0.3 --max_continuation_steps 5 \
+  --jacobian_reuse > RESLT/log.dat || exit 1
+if [ $(grep -c "Jacobian reuse: step" RESLT/log.dat) -lt 5 ]; then
+  echo "Jacobian reuse check failed: no statistics for some steps"
+  exit 1
+fi
+mv RESLT RESLT_jacobian_reuse
+
+# Same solve with the RigidBodyElement's Jacobian by automatic
+# differentiation
+mkdir RESLT
+./reparametrise_beam_test --q 0.3 --steady_solve --I 0.01 \
+  --automatic_differentiation || exit 1
+compare_results RESLT_direct/steady_solution.dat RESLT/steady_solution.dat \
+  1.0e-6 "Automatic differentiation vs finite differencing"
+mv RESLT RESLT_automatic_differentiation
+
+# Same solve with the RigidBodyElement's Jacobian by incremental finite
+# differencing
+mkdir RESLT
+./reparametrise_beam_test --q 0.3 --steady_solve --I 0.01 \
+  --incremental_fd_jacobian || exit 1
+compare_results RESLT_direct/steady_solution.dat RESLT/steady_solution.dat \
+  1.0e-6 "Incremental vs full finite differencing"
+mv RESLT RESLT_incremental_fd_jacobian
+
+# Continuation with VTU output: the PVD file must list one dataset per
+# converged continuation step (each of which also writes a restart
+# file), and each dataset's file must exist
+mkdir RESLT
+./reparametrise_beam_test --q 0.3 --max_continuation_steps 5 --vtk || exit 1
+n_dataset=$(grep -c "<DataSet" RESLT/beam_continuation.pvd)
+if [ $n_dataset -lt 2 ] || \
+  [ $n_dataset -ne $(ls RESLT/restart*.dat | wc -l) ]; then
+  echo "VTK check failed: wrong number of datasets in the PVD file"
+  exit 1
+fi
+for vtu_file in $(sed -n 's/.*file="\([^"]*\)".*/\1/p' \
+  RESLT/beam_continuation.pvd); do
+  if [ ! -s RESLT/$vtu_file ]; then
+    echo "VTK check failed: RESLT/$vtu_file is missing"
+    exit 1
+  fi
+done
+mv RESLT RESLT_vtk
+
+# Continuation with the compressed snapshot archive: all snapshots must
+# be recovered bitwise-exactly from the archive (the driver exits with
+# an error otherwise)
+mkdir RESLT
+./reparametrise_beam_test --q 0.3 --max_continuation_steps 5 \
+  --snapshot_archive --check_snapshot_archive > RESLT/log.dat || exit 1
+grep "snapshots recovered bitwise-exactly" RESLT/log.dat || exit 1
+mv RESLT RESLT_snapshot_archive
+
+# Continuation with the solution cache: each converged step must have
+# been added to the cache...
+mkdir RESLT RESLT/cache
+./reparametrise_beam_test --q 0.3 --max_continuation_steps 5 \
+  --solution_cache RESLT/cache || exit 1
+if [ $(wc -l < RESLT/cache/index.dat) -lt 2 ]; then
+  echo "Solution cache check failed: too few entries in index.dat"
+  exit 1
+fi
+
+# ...and a steady solve, warm-started from the cache, must recover its
+# solution from the cache
+./reparametrise_beam_test --q 0.3 --steady_solve --I 0.01 \
+  --solution_cache RESLT/cache --check_solution_cache || exit 1
+mv RESLT RESLT_solution_cache
+
+# Continuation with the stability analysis: one line per converged step
+# in stability.dat, and the Arnoldi eigenvalues of J v = lambda M v (the
+# growth rates of the orientation) must agree with a dense reduction of
+# the pencil. (A failed check is treated like a failed step by
+# the continuation, so the step's line in stability.dat has no matching
+# restart file.)
+mkdir RESLT
+./reparametrise_beam_test --q 0.3 --max_continuation_steps 5 --stability \
+  --check_stability || exit 1
+if [ $(wc -l < RESLT/stability.dat) -lt 2 ] || \
+  [ $(wc -l < RESLT/stability.dat) -ne $(ls RESLT/restart*.dat | wc -l) ]; then
+  echo "Stability check failed: wrong number of lines in stability.dat"
+  exit 1
+fi
+mv RESLT RESLT_stability
+
+# Slide the point load to the end of the beam (of length 10) in large
+# steps: the load must stop at the end rather than leave the beam
+mkdir RESLT
+./beam_with_point_load --slide_point_load --xi_point_load_end_fraction 1.0 \
+  --ds_point_load 2.0 || exit 1
+if ! awk 'NR>1{xi=$1} END{exit !((xi>0.0) && (xi<=10.0))}' \
+  RESLT/trace_slide_point_load.dat; then
+  echo "Sliding point load check failed: the load left the beam"
+  exit 1
+fi
+mv RESLT RESLT_slide_point_load
+
+# Nonlocal slender body traction: the treecode must agree with direct
+# summation (opening angle 0) to within the accuracy of its (dipole)
+# expansions
+mkdir RESLT
+./reparametrise_beam_test --q 0.3 --steady_solve --I 0.01 \
+  --nonlocal_slender_body --nonlocal_opening_angle 0.0 || exit 1
+mv RESLT RESLT_nonlocal_direct
+mkdir RESLT
+./reparametrise_beam_test --q 0.3 --steady_solve --I 0.01 \
+  --nonlocal_slender_body || exit 1
+compare_results RESLT_nonlocal_direct/steady_solution.dat \
+  RESLT/steady_solution.dat 1.0e-2 "Treecode vs direct summation"
+mv RESLT RESLT_nonlocal_treecode
+
+# Same solve with the compile-time specialised elements for the
+# elements' default (three-point) Gauss rule: only roundoff differences
+mkdir RESLT
+./reparametrise_beam_test --q 0.3 --steady_solve --I 0.01 \
+  --fixed_quadrature_order 3 || exit 1
+compare_results RESLT_direct/steady_solution.dat RESLT/steady_solution.dat \
+  1.0e-8 "Fixed vs generic quadrature"
+mv RESLT RESLT_fixed_quadrature
+
+# Same solve on meshes with geometric, tanh and user-specified grading:
+# the solutions may only differ by the discretisation error
+for grading in 1 2 3; do
+  mkdir RESLT
+  ./reparametrise_beam_test --q 0.3 --steady_solve --I 0.01 \
+    --mesh_grading $grading || exit 1
+  compare_results RESLT_direct/steady_solution.dat \
+    RESLT/steady_solution.dat 1.0e-3 "Graded ($grading) vs uniform mesh"
+  mkdir -p RESLT_graded_mesh
+  mv RESLT RESLT_graded_mesh/RESLT_$grading
+done
+
+# Linearised responses to eight point load cases and a pressure
+# increment: the blocked banded solve must agree with separate solves
+# with SuperLU, and the influence matrix must have one row per case
+mkdir RESLT
+./beam_with_point_load --n_load_case 8 --check_load_cases || exit 1
+if [ $(grep -vc "^#" RESLT/influence_matrix.dat) -ne 9 ]; then
+  echo "Load case check failed: wrong number of rows in influence_matrix.dat"
+  exit 1
+fi
+mv RESLT RESLT_load_cases
+
+# Follower point load and point moment: the Jacobian with the point
+# load's hand-coded derivatives and the one by automatic differentiation
+# must agree with finite differencing, and so must the solutions
+mkdir RESLT
+./beam_with_point_load --follower_load_normal 1.0e-4 \
+  --follower_load_tangential 1.0e-5 --point_moment 1.0e-4 \
+  --check_jacobian || exit 1
+mv RESLT RESLT_follower_load
+mkdir RESLT
+./beam_with_point_load --follower_load_normal 1.0e-4 \
+  --follower_load_tangential 1.0e-5 --point_moment 1.0e-4 \
+  --automatic_differentiation --check_jacobian || exit 1
+compare_results RESLT_follower_load/trace_beam.dat RESLT/trace_beam.dat \
+  1.0e-6 "Follower load: automatic differentiation vs hand-coded"
+mv RESLT RESLT_follower_load_ad
+
+# Array of 40 follower point loads (four per element) that approximates
+# a distributed normal load: same checks, for elements with several
+# loads in their tables
+mkdir RESLT
+./beam_with_point_load --n_point_load_array 40 \
+  --point_load_array_pressure 1.0e-4 --check_jacobian || exit 1
+mv RESLT RESLT_point_load_array
+mkdir RESLT
+./beam_with_point_load --n_point_load_array 40 \
+  --point_load_array_pressure 1.0e-4 --automatic_differentiation \
+  --check_jacobian || exit 1
+compare_results RESLT_point_load_array/trace_beam.dat RESLT/trace_beam.dat \
+  1.0e-6 "Point load array: automatic differentiation vs hand-coded"
+mv RESLT RESLT_point_load_array_ad
+
+# Same solve without the integration point cache (shape functions and
+# undeformed geometry evaluated from scratch): only roundoff differences
+mkdir RESLT
+./reparametrise_beam_test --q 0.3 --steady_solve --I 0.01 \
+  --no_integration_point_cache || exit 1
+compare_results RESLT_direct/steady_solution.dat RESLT/steady_solution.dat \
+  1.0e-8 "Cached vs uncached integration point data"
+mv RESLT RESLT_no_integration_point_cache
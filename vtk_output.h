@@ -0,0 +1,477 @@
+// LIC// ====================================================================
+// LIC// This file forms part of oomph-lib, the object-oriented,
+// LIC// multi-physics finite-element library, available
+// LIC// at http://www.oomph-lib.org.
+// LIC//
+// LIC// Copyright (C) 2006-2023 Matthias Heil and Andrew Hazel
+// LIC//
+// LIC// This library is free software; you can redistribute it and/or
+// LIC// modify it under the terms of the GNU Lesser General Public
+// LIC// License as published by the Free Software Foundation; either
+// LIC// version 2.1 of the License, or (at your option) any later version.
+// LIC//
+// LIC// This library is distributed in the hope that it will be useful,
+// LIC// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// LIC// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// LIC// Lesser General Public License for more details.
+// LIC//
+// LIC// You should have received a copy of the GNU Lesser General Public
+// LIC// License along with this library; if not, write to the Free Software
+// LIC// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+// LIC// 02110-1301  USA.
+// LIC//
+// LIC// The authors may be contacted at oomph-lib@maths.man.ac.uk.
+// LIC//
+// Binary VTK (VTU) output of polylines and PVD time series
+
+#ifndef VTK_OUTPUT_HEADER
+#define VTK_OUTPUT_HEADER
+
+// OOMPH-LIB includes
+#include "generic.h"
+
+namespace oomph
+{
+  //=========================================================================
+  /// Writer for VTK XML unstructured grid (.vtu) files that consist of
+  /// polylines in the (x,y) plane, with point data (scalars or 2D vectors)
+  /// and field data (e.g. the state of the rigid bodies). All arrays are
+  /// written in binary form to the file's appended data section, either
+  /// raw or base64-encoded, so the files are compact and can be loaded
+  /// without any text parsing. Usage: add the polylines' points with
+  /// add_polyline(...) and add_point(...), the point data with
+  /// add_point_data(...) (in the same order as the points) and the field
+  /// data with add_field_data(...), then write(...).
+  //=========================================================================
+  class VTUPolylineWriter
+  {
+  public:
+    /// Encoding of the appended data
+    enum Encoding
+    {
+      Appended_raw,
+      Appended_base64
+    };
+
+    /// Constructor: Empty
+    VTUPolylineWriter() {}
+
+    /// Broken copy constructor
+    VTUPolylineWriter(const VTUPolylineWriter& dummy) = delete;
+
+    /// Broken assignment operator
+    void operator=(const VTUPolylineWriter&) = delete;
+
+    /// Wipe all points and data
+    void clear()
+    {
+      Coordinates.clear();
+      Polyline_offset.clear();
+      Point_data_name.clear();
+      Point_data_n_component.clear();
+      Point_data.clear();
+      Field_data_name.clear();
+      Field_data_n_component.clear();
+      Field_data.clear();
+    }
+
+    /// Number of points
+    unsigned npoint() const
+    {
+      return Coordinates.size() / 3;
+    }
+
+    /// The next n_point points form a polyline
+    void add_polyline(const unsigned& n_point)
+    {
+      unsigned offset = Polyline_offset.empty() ? 0 : Polyline_offset.back();
+      Polyline_offset.push_back(offset + n_point);
+    }
+
+    /// Add a point
+    void add_point(const double& x, const double& y)
+    {
+      Coordinates.push_back(x);
+      Coordinates.push_back(y);
+      Coordinates.push_back(0.0);
+    }
+
+    /// Index of the point data array with the given name and number of
+    /// components (1: scalar; 3: vector); the array is created if it
+    /// doesn't exist yet
+    unsigned point_data_index(const std::string& name,
+                              const unsigned& n_component)
+    {
+      unsigned n_array = Point_data_name.size();
+      for (unsigned a = 0; a < n_array; a++)
+      {
+        if (Point_data_name[a] == name)
+        {
+#ifdef PARANOID
+          if (Point_data_n_component[a] != n_component)
+          {
+            std::ostringstream error_message;
+            error_message << "Point data array " << name << " has "
+                          << Point_data_n_component[a]
+                          << " components, not " << n_component << std::endl;
+            throw OomphLibError(error_message.str(),
+                                OOMPH_CURRENT_FUNCTION,
+                                OOMPH_EXCEPTION_LOCATION);
+          }
+#endif
+          return a;
+        }
+      }
+      Point_data_name.push_back(name);
+      Point_data_n_component.push_back(n_component);
+      Point_data.push_back(Vector<double>());
+      return n_array;
+    }
+
+    /// Add the value of the (scalar) point data array with the given
+    /// index for the next point
+    void add_point_data(const unsigned& index, const double& value)
+    {
+      Point_data[index].push_back(value);
+    }
+
+    /// Add the value of the (vector) point data array with the given
+    /// index for the next point (the vectors are in the (x,y) plane)
+    void add_point_data(const unsigned& index,
+                        const double& value_x,
+                        const double& value_y)
+    {
+      Point_data[index].push_back(value_x);
+      Point_data[index].push_back(value_y);
+      Point_data[index].push_back(0.0);
+    }
+
+    /// Add a field data array with n_component components, i.e.
+    /// value.size()/n_component tuples
+    void add_field_data(const std::string& name,
+                        const unsigned& n_component,
+                        const Vector<double>& value)
+    {
+      Field_data_name.push_back(name);
+      Field_data_n_component.push_back(n_component);
+      Field_data.push_back(value);
+    }
+
+    /// Write the file
+    void write(const std::string& filename,
+               const Encoding& encoding = Appended_raw) const;
+
+  private:
+    /// Add a block of binary data to the appended data (in the given
+    /// encoding) and return its offset
+    static unsigned long add_block(const char* data,
+                                   const unsigned long& n_byte,
+                                   const Encoding& encoding,
+                                   std::string& appended_data);
+
+    /// Base64 encoding of n_byte bytes of data (appended to encoded)
+    static void base64_encode(const char* data,
+                              const unsigned long& n_byte,
+                              std::string& encoded);
+
+    /// Coordinates of the points (x, y, 0)
+    Vector<double> Coordinates;
+
+    /// Index of the point after the last point of each polyline
+    Vector<unsigned> Polyline_offset;
+
+    /// Names of the point data arrays
+    Vector<std::string> Point_data_name;
+
+    /// Number of components of the point data arrays
+    Vector<unsigned> Point_data_n_component;
+
+    /// Values of the point data arrays
+    Vector<Vector<double>> Point_data;
+
+    /// Names of the field data arrays
+    Vector<std::string> Field_data_name;
+
+    /// Number of components of the field data arrays
+    Vector<unsigned> Field_data_n_component;
+
+    /// Values of the field data arrays
+    Vector<Vector<double>> Field_data;
+  };
+
+
+  //=========================================================================
+  /// Add a block of binary data (preceded by its size as UInt64) to the
+  /// appended data and return its offset. In the base64 encoding the
+  /// header and the data are encoded separately.
+  //=========================================================================
+  inline unsigned long VTUPolylineWriter::add_block(const char* data,
+                                                    const unsigned long& n_byte,
+                                                    const Encoding& encoding,
+                                                    std::string& appended_data)
+  {
+    unsigned long offset = appended_data.size();
+    uint64_t header = n_byte;
+    if (encoding == Appended_raw)
+    {
+      appended_data.append(reinterpret_cast<const char*>(&header),
+                           sizeof(header));
+      appended_data.append(data, n_byte);
+    }
+    else
+    {
+      base64_encode(
+        reinterpret_cast<const char*>(&header), sizeof(header), appended_data);
+      base64_encode(data, n_byte, appended_data);
+    }
+    return offset;
+  }
+
+
+  //=========================================================================
+  /// Base64 encoding (with padding)
+  //=========================================================================
+  inline void VTUPolylineWriter::base64_encode(const char* data,
+                                               const unsigned long& n_byte,
+                                               std::string& encoded)
+  {
+    static const char alphabet[] =
+      "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    const unsigned char* byte = reinterpret_cast<const unsigned char*>(data);
+    encoded.reserve(encoded.size() + 4 * ((n_byte + 2) / 3));
+    unsigned long i = 0;
+    for (; i + 2 < n_byte; i += 3)
+    {
+      unsigned long triple = (byte[i] << 16) | (byte[i + 1] << 8) | byte[i + 2];
+      encoded += alphabet[(triple >> 18) & 63];
+      encoded += alphabet[(triple >> 12) & 63];
+      encoded += alphabet[(triple >> 6) & 63];
+      encoded += alphabet[triple & 63];
+    }
+    if (i < n_byte)
+    {
+      unsigned long triple = byte[i] << 16;
+      if (i + 1 < n_byte)
+      {
+        triple |= byte[i + 1] << 8;
+      }
+      encoded += alphabet[(triple >> 18) & 63];
+      encoded += alphabet[(triple >> 12) & 63];
+      encoded += (i + 1 < n_byte) ? alphabet[(triple >> 6) & 63] : '=';
+      encoded += '=';
+    }
+  }
+
+
+  //=========================================================================
+  /// Write the .vtu file
+  //=========================================================================
+  inline void VTUPolylineWriter::write(const std::string& filename,
+                                       const Encoding& encoding) const
+  {
+    const unsigned n_point = npoint();
+    const unsigned n_polyline = Polyline_offset.size();
+#ifdef PARANOID
+    if ((n_polyline > 0) && (Polyline_offset.back() != n_point))
+    {
+      std::ostringstream error_message;
+      error_message << "The polylines have " << Polyline_offset.back()
+                    << " points but " << n_point << " points were added"
+                    << std::endl;
+      throw OomphLibError(
+        error_message.str(), OOMPH_CURRENT_FUNCTION, OOMPH_EXCEPTION_LOCATION);
+    }
+    unsigned n_point_data = Point_data.size();
+    for (unsigned a = 0; a < n_point_data; a++)
+    {
+      if (Point_data[a].size() != n_point * Point_data_n_component[a])
+      {
+        std::ostringstream error_message;
+        error_message << "Point data array " << Point_data_name[a] << " has "
+                      << Point_data[a].size() << " values rather than "
+                      << n_point * Point_data_n_component[a] << std::endl;
+        throw OomphLibError(error_message.str(),
+                            OOMPH_CURRENT_FUNCTION,
+                            OOMPH_EXCEPTION_LOCATION);
+      }
+    }
+#endif
+
+    // Assemble the appended data and the XML description
+    std::string appended_data;
+    std::ostringstream xml;
+    const char* format = "format=\"appended\" offset=\"";
+
+    // Field data
+    unsigned n_field_data = Field_data.size();
+    if (n_field_data > 0)
+    {
+      xml << "    <FieldData>\n";
+      for (unsigned a = 0; a < n_field_data; a++)
+      {
+        unsigned n_value = Field_data[a].size();
+        unsigned long offset =
+          add_block(reinterpret_cast<const char*>(
+                      n_value > 0 ? &Field_data[a][0] : 0),
+                    n_value * sizeof(double),
+                    encoding,
+                    appended_data);
+        xml << "      <DataArray type=\"Float64\" Name=\"" << Field_data_name[a]
+            << "\" NumberOfComponents=\"" << Field_data_n_component[a]
+            << "\" NumberOfTuples=\"" << n_value / Field_data_n_component[a]
+            << "\" " << format << offset << "\"/>\n";
+      }
+      xml << "    </FieldData>\n";
+    }
+
+    xml << "    <Piece NumberOfPoints=\"" << n_point << "\" NumberOfCells=\""
+        << n_polyline << "\">\n";
+
+    // Point data
+    xml << "      <PointData>\n";
+    unsigned n_array = Point_data.size();
+    for (unsigned a = 0; a < n_array; a++)
+    {
+      unsigned long offset = add_block(
+        reinterpret_cast<const char*>(n_point > 0 ? &Point_data[a][0] : 0),
+        Point_data[a].size() * sizeof(double),
+        encoding,
+        appended_data);
+      xml << "        <DataArray type=\"Float64\" Name=\"" << Point_data_name[a]
+          << "\" NumberOfComponents=\"" << Point_data_n_component[a] << "\" "
+          << format << offset << "\"/>\n";
+    }
+    xml << "      </PointData>\n";
+
+    // Points
+    unsigned long offset = add_block(
+      reinterpret_cast<const char*>(n_point > 0 ? &Coordinates[0] : 0),
+      Coordinates.size() * sizeof(double),
+      encoding,
+      appended_data);
+    xml << "      <Points>\n"
+        << "        <DataArray type=\"Float64\" NumberOfComponents=\"3\" "
+        << format << offset << "\"/>\n"
+        << "      </Points>\n";
+
+    // Cells: the polylines (VTK_POLY_LINE = 4) connect consecutive points
+    Vector<int64_t> connectivity(n_point);
+    for (unsigned j = 0; j < n_point; j++)
+    {
+      connectivity[j] = j;
+    }
+    Vector<int64_t> cell_offset(n_polyline);
+    for (unsigned c = 0; c < n_polyline; c++)
+    {
+      cell_offset[c] = Polyline_offset[c];
+    }
+    Vector<unsigned char> cell_type(n_polyline, 4);
+    xml << "      <Cells>\n";
+    offset = add_block(
+      reinterpret_cast<const char*>(n_point > 0 ? &connectivity[0] : 0),
+      n_point * sizeof(int64_t),
+      encoding,
+      appended_data);
+    xml << "        <DataArray type=\"Int64\" Name=\"connectivity\" " << format
+        << offset << "\"/>\n";
+    offset = add_block(
+      reinterpret_cast<const char*>(n_polyline > 0 ? &cell_offset[0] : 0),
+      n_polyline * sizeof(int64_t),
+      encoding,
+      appended_data);
+    xml << "        <DataArray type=\"Int64\" Name=\"offsets\" " << format
+        << offset << "\"/>\n";
+    offset = add_block(
+      reinterpret_cast<const char*>(n_polyline > 0 ? &cell_type[0] : 0),
+      n_polyline * sizeof(unsigned char),
+      encoding,
+      appended_data);
+    xml << "        <DataArray type=\"UInt8\" Name=\"types\" " << format
+        << offset << "\"/>\n"
+        << "      </Cells>\n"
+        << "    </Piece>\n";
+
+    // Write the file
+    std::ofstream outfile(filename.c_str(), std::ios_base::binary);
+    if (!outfile)
+    {
+      std::ostringstream error_message;
+      error_message << "Couldn't open " << filename << std::endl;
+      throw OomphLibError(
+        error_message.str(), OOMPH_CURRENT_FUNCTION, OOMPH_EXCEPTION_LOCATION);
+    }
+    uint16_t one = 1;
+    bool little_endian = (*reinterpret_cast<unsigned char*>(&one) == 1);
+    outfile << "<?xml version=\"1.0\"?>\n"
+            << "<VTKFile type=\"UnstructuredGrid\" version=\"1.0\" "
+            << "byte_order=\""
+            << (little_endian ? "LittleEndian" : "BigEndian")
+            << "\" header_type=\"UInt64\">\n"
+            << "  <UnstructuredGrid>\n"
+            << xml.str() << "  </UnstructuredGrid>\n"
+            << "  <AppendedData encoding=\""
+            << ((encoding == Appended_raw) ? "raw" : "base64") << "\">\n"
+            << "   _";
+    outfile.write(appended_data.data(), appended_data.size());
+    outfile << "\n  </AppendedData>\n"
+            << "</VTKFile>\n";
+  }
+
+
+  //=========================================================================
+  /// ParaView data (.pvd) file that collects a series of datasets (e.g.
+  /// the .vtu files of the steps of a continuation or time-dependent
+  /// run) with their "time" values. The file is re-written whenever a
+  /// dataset is added so it's always complete, even if the run is
+  /// aborted.
+  //=========================================================================
+  class PVDFile
+  {
+  public:
+    /// Constructor: Pass the name of the .pvd file
+    PVDFile(const std::string& filename) : Filename(filename) {}
+
+    /// Broken copy constructor
+    PVDFile(const PVDFile& dummy) = delete;
+
+    /// Broken assignment operator
+    void operator=(const PVDFile&) = delete;
+
+    /// Add a dataset with the given "time" value (e.g. the time or the
+    /// continuation parameter). The name of the dataset's file has to
+    /// be relative to the directory that contains the .pvd file.
+    void add_dataset(const double& time, const std::string& dataset_filename)
+    {
+      Time.push_back(time);
+      Dataset_filename.push_back(dataset_filename);
+
+      std::ofstream outfile(Filename.c_str());
+      outfile.precision(16);
+      outfile << "<?xml version=\"1.0\"?>\n"
+              << "<VTKFile type=\"Collection\" version=\"0.1\">\n"
+              << "  <Collection>\n";
+      unsigned n_dataset = Time.size();
+      for (unsigned i = 0; i < n_dataset; i++)
+      {
+        outfile << "    <DataSet timestep=\"" << Time[i]
+                << "\" group=\"\" part=\"0\" file=\"" << Dataset_filename[i]
+                << "\"/>\n";
+      }
+      outfile << "  </Collection>\n"
+              << "</VTKFile>\n";
+    }
+
+  private:
+    /// Name of the .pvd file
+    std::string Filename;
+
+    /// "Time" values of the datasets
+    Vector<double> Time;
+
+    /// Names of the datasets' files
+    Vector<std::string> Dataset_filename;
+  };
+
+} // namespace oomph
+
+#endif